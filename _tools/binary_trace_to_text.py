@@ -0,0 +1,94 @@
+# Decodes binary trace saved by MfxBinaryTrace (c2_utils/src/mfx_binary_trace.cpp)
+# into text, one event per line sorted by time:
+#   <time, ms> <tid> <B|E|I> <module:name> [duration, ms] [frame=<index> | arg=<value>]
+# Times are relative to the first event unless --wall-clock is given.
+# Usage: python _tools/binary_trace_to_text.py -i mfx_c2_trace.bin -o trace.txt
+
+from __future__ import print_function  # Only needed for Python 2
+import argparse
+import datetime
+import struct
+import sys
+
+MAGIC = b"MFXC2TRC"
+EVENT_FORMAT = "<QIHHQ"
+EVENT_TYPES = { 1: "B", 2: "E", 3: "I" }
+FLAG_FRAME = 1
+FLAG_ARG = 2
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def read(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += struct.calcsize(fmt)
+        return values
+
+    def read_bytes(self, size):
+        res = self.data[self.offset:self.offset + size]
+        self.offset += size
+        return res
+
+def ReadTrace(path):
+    with open(path, "rb") as f:
+        reader = Reader(f.read())
+
+    if reader.read_bytes(len(MAGIC)) != MAGIC:
+        raise ValueError("not a binary trace: " + path)
+    version, event_size = reader.read("<II")
+    if version != 1 or event_size != struct.calcsize(EVENT_FORMAT):
+        raise ValueError("unsupported trace version {} event size {}".format(version, event_size))
+    steady_ns, realtime_ns = reader.read("<QQ")
+
+    names = []
+    (count,) = reader.read("<I")
+    for _ in range(count):
+        (length,) = reader.read("<I")
+        names.append(reader.read_bytes(length).decode("utf-8", "replace"))
+
+    events = []
+    (count,) = reader.read("<I")
+    for _ in range(count):
+        tid, event_count = reader.read("<II")
+        for _ in range(event_count):
+            time_ns, name_id, event_type, flags, arg = reader.read(EVENT_FORMAT)
+            events.append((time_ns, tid, event_type, name_id, flags, arg))
+    events.sort()
+    return names, events, realtime_ns - steady_ns
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-i", "--input", dest="input", required=True,
+                  help="binary trace file")
+parser.add_argument("-o", "--output", dest="output",
+                  help="destination text file, stdout if omitted")
+parser.add_argument("-w", "--wall-clock", dest="wall_clock", action="store_true",
+                  help="print wall-clock time of events")
+args = parser.parse_args()
+
+names, events, realtime_offset = ReadTrace(args.input)
+start_ns = events[0][0] if events else 0
+open_scopes = {} # (tid, name_id) -> stack of begin times
+
+with (open(args.output, "w") if args.output else sys.stdout) as dst:
+    for time_ns, tid, event_type, name_id, flags, arg in events:
+        name = names[name_id] if name_id < len(names) else "<unknown {}>".format(name_id)
+        if args.wall_clock:
+            stamp = datetime.datetime.fromtimestamp((time_ns + realtime_offset) / 1e9).strftime("%H:%M:%S.%f")
+        else:
+            stamp = "{:.6f}".format((time_ns - start_ns) / 1e6)
+
+        fields = [stamp, str(tid), EVENT_TYPES.get(event_type, "?"), name]
+        if event_type == 1:
+            open_scopes.setdefault((tid, name_id), []).append(time_ns)
+        elif event_type == 2:
+            # begin might be overwritten in the ring already
+            stack = open_scopes.get((tid, name_id))
+            if stack:
+                fields.append("{:.6f}".format((time_ns - stack.pop()) / 1e6))
+        if flags & FLAG_FRAME:
+            fields.append("frame={}".format(arg))
+        elif flags & FLAG_ARG:
+            fields.append("arg={}".format(arg))
+        print(" ".join(fields), file = dst)
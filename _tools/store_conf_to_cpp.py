@@ -0,0 +1,77 @@
+# Converts component store configuration (mfx_c2_store.conf and media codecs xml)
+# into built-in components table of the store, so no files are parsed on store creation.
+# Should be rerun whenever configuration files in c2_store/data are changed.
+# Usage: python _tools/store_conf_to_cpp.py -c c2_store/data/mfx_c2_store.conf
+#     -x c2_store/data/media_codecs_intel_c2_video.xml -o c2_store/src/mfx_c2_store_registry.cpp
+
+from __future__ import print_function  # Only needed for Python 2
+import argparse
+import xml.etree.ElementTree as ET
+
+license = """// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// This file is generated by _tools/store_conf_to_cpp.py, do not edit.
+"""
+
+FIELD_SEP = " : "
+
+def ParseBoolean(value):
+    return value.lower() in ("true", "yes", "1")
+
+def ReadXml(path):
+    codecs = {}
+    root = ET.parse(path).getroot()
+    for section, kind in (("Decoders", "KIND_DECODER"), ("Encoders", "KIND_ENCODER")):
+        for node in root.iter(section):
+            for codec in node.iter("MediaCodec"):
+                dump_output = False
+                for diag in codec.iter("Diagnostics"):
+                    dump_output = ParseBoolean(diag.get("dumpOutput", "false"))
+                codecs[codec.get("name")] = (codec.get("type", ""), kind, dump_output)
+    return codecs
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-c", "--conf", dest="conf", required=True,
+                  help="mfx_c2_store.conf file")
+parser.add_argument("-x", "--xml", dest="xml", required=True,
+                  help="media codecs xml file")
+parser.add_argument("-o", "--output", dest="output", required=True,
+                  help="destination .cpp file")
+args = parser.parse_args()
+
+codecs = ReadXml(args.xml)
+
+with open(args.conf, 'r') as conf, open(args.output, 'w') as dst:
+    print(license, file = dst)
+    dst.write('#include "mfx_c2_store_registry.h"\n\n')
+    dst.write("const MfxC2StoreComponentEntry g_mfxC2StoreComponents[] = {\n")
+    for line in conf:
+        fields = [f.strip() for f in line.strip().split(FIELD_SEP.strip())]
+        if len(fields) < 2 or not fields[0] or not fields[1]:
+            continue
+        name, module = fields[0], fields[1]
+        flags = int(fields[2], 16) if len(fields) > 2 and fields[2] else 0
+        # components missing in xml get the same defaults as MfxXmlParser gives
+        media_type, kind, dump_output = codecs.get(name, ("", "KIND_OTHER", False))
+        dst.write('    {{ "{}", "{}", "{}", {}, 0x{:x}, {} }},\n'.format(
+            name, module, media_type, kind, flags, "true" if dump_output else "false"))
+    dst.write("};\n\n")
+    dst.write("const size_t g_mfxC2StoreComponentsCount = MFX_GET_ARRAY_SIZE(g_mfxC2StoreComponents);\n")
@@ -22,6 +22,7 @@
 #include "mfx_debug.h"
 #include "mfx_c2_defs.h"
 #include "mfx_c2_utils.h"
+#include "mfx_c2_async_writer.h"
 #include "mfx_c2_debug.h"
 #include <string.h>
 #include <C2AllocatorGralloc.h>
@@ -132,14 +133,9 @@ c2_status_t MfxC2FrameIn::MfxC2LoadSurfaceInSW(C2ConstGraphicBlock& c_graph_bloc
         return res;
     }
 
-    const uint8_t *pY = m_c2GraphicView->data()[C2PlanarLayout::PLANE_Y];
-    const uint8_t *pU = m_c2GraphicView->data()[C2PlanarLayout::PLANE_U];
-    const uint8_t *pV = m_c2GraphicView->data()[C2PlanarLayout::PLANE_V];
-
     uint32_t width = c_graph_block.width();
     uint32_t height = c_graph_block.height();
     uint32_t stride = m_c2GraphicView->layout().planes[C2PlanarLayout::PLANE_Y].rowInc;
-    uint32_t y_plane_size = stride * height;
     MFX_DEBUG_TRACE_I32(width);
     MFX_DEBUG_TRACE_I32(height);
     MFX_DEBUG_TRACE_I32(stride);
@@ -168,20 +164,22 @@ c2_status_t MfxC2FrameIn::MfxC2LoadSurfaceInSW(C2ConstGraphicBlock& c_graph_bloc
         }
 
         //IYUV or YV12 to NV12 conversion
-        memcpy(m_yuvData.get(), pY, y_plane_size);
-
-        for (int j = 0; j < height / 2; j++) {
-            uint8_t *ptr = m_yuvData.get() + y_plane_size + j * stride;
-            for (int i = 0; i < stride / 2; i++) {
-                memcpy(&ptr[i * 2], &pU[j*stride/2 + i], 1);
-                memcpy(&ptr[i * 2 + 1], &pV[j*stride/2 + i], 1);
-            }
+        uint32_t nv12_pitches[C2PlanarLayout::MAX_NUM_PLANES] { stride, stride };
+        C2PlanarLayout nv12_layout {};
+        InitNV12PlaneLayout(nv12_pitches, &nv12_layout);
+
+        uint8_t* nv12_data[C2PlanarLayout::MAX_NUM_PLANES] {};
+        InitNV12PlaneData(stride, height, m_yuvData.get(), nv12_data);
+
+        res = CopyPlanes(width, height, m_c2GraphicView->layout(), m_c2GraphicView->data(),
+            nv12_layout, nv12_data);
+        if (C2_OK != res) {
+            return res;
         }
 
 #if MFX_DEBUG_DUMP_FRAME == MFX_DEBUG_YES
-        static int frameIndex = 0;
-        static YUVWriter writer("/data/local/tmp",std::vector<std::string>({}),"encoder_frame.log");
-        writer.Write(m_yuvData.get(), stride, height, frameIndex++);
+        static MfxC2AsyncWriter writer(MFX_C2_DUMP_DIR, std::vector<std::string>({}), "encoder_frame.nv12");
+        writer.WriteNV12(nv12_data[C2PlanarLayout::PLANE_Y], nv12_data[C2PlanarLayout::PLANE_U], stride, width, height);
 #endif
 
         mfx_sts = InitMfxFrameSW(buf_pack.ordinal.timestamp.peeku(), buf_pack.ordinal.frameIndex.peeku(),
@@ -2,7 +2,7 @@ LOCAL_PATH:= $(call my-dir)
 
 include $(MFX_C2_HOME)/mfx_c2_env.mk
 
-# Usage: $(call build_components, hw|sw|pure)
+# Usage: $(call build_components, hw|sw|pure|fake)
 define build_components
   include $$(CLEAR_VARS)
   include $$(MFX_C2_HOME)/mfx_c2_defs.mk
@@ -35,7 +35,7 @@ define build_components
   LOCAL_STATIC_LIBRARIES := \
     libmfx_c2_buffers
 
-  ifneq ($(1),pure)
+  ifeq ($(filter pure fake,$(1)),)
     MODULE_SUFFIX := _$(1)
 
     MSDK_IMPL := $(1)
@@ -45,14 +45,17 @@ define build_components
     LOCAL_SHARED_LIBRARIES += libva libva-android
     LOCAL_STATIC_LIBRARIES += libmfx_c2_utils_va
   else
-    MODULE_SUFFIX := _pure
+    MODULE_SUFFIX := _$(1)
 
     MSDK_IMPL := sw
 
     LOCAL_STATIC_LIBRARIES += libmfx_c2_utils
   endif
 
-  ifneq ($(USE_ONEVPL), true)
+  ifeq ($(1),fake)
+    # MediaSDK runtime is replaced with CPU fake from mock/mfx_runtime
+    LOCAL_SHARED_LIBRARIES := $$(filter-out libvpl,$$(LOCAL_SHARED_LIBRARIES)) libmfx_fake_runtime
+  else ifneq ($(USE_ONEVPL), true)
     LOCAL_SHARED_LIBRARIES_32 := libmfx$$(MSDK_IMPL)32
     LOCAL_SHARED_LIBRARIES_64 := libmfx$$(MSDK_IMPL)64
   endif
@@ -76,3 +79,7 @@ endif
 ifeq ($(MFX_C2_IMPL_PURE),true)
   $(eval $(call build_components,pure)) # pure components without libVA
 endif
+
+ifeq ($(MFX_C2_IMPL_FAKE),true)
+  $(eval $(call build_components,fake)) # pure components on CPU fake runtime for benchmarks
+endif
@@ -23,8 +23,12 @@
 #include <C2Component.h>
 
 #include "mfx_defs.h"
+#include "mfx_c2_metrics.h"
+#include "mfx_c2_params.h"
 #include "mfx_c2_param_storage.h"
 #include "util/C2InterfaceHelper.h"
+#include <atomic>
+#include <map>
 #include <mutex>
 
 class MfxC2Component : public C2ComponentInterface,
@@ -33,10 +37,26 @@ class MfxC2Component : public C2ComponentInterface,
                        public C2InterfaceHelper
 {
 public:
+    // Keeps started components within hardware capacity, provided by the store.
+    class Admission
+    {
+    public:
+        virtual ~Admission() = default;
+        // Called on start with component configured, component is not started on error.
+        virtual c2_status_t Admit(MfxC2Component* component) = 0;
+        // Called when admitted component stops, no-op for not admitted one.
+        virtual void Leave(MfxC2Component* component) = 0;
+    };
+
     struct CreateConfig
     {
         int flags{0};
         bool dump_output{false};
+        // Only parameters are initialized: no device, session or threads.
+        // Such instance is to be used as C2ComponentInterface only.
+        bool interface_only{false};
+        // Optional, consulted on every start.
+        std::shared_ptr<Admission> admission;
     };
 protected:
     /* State diagram:
@@ -88,6 +108,9 @@ public:
 private: // Non-virtual interface methods optionally overridden in descendants
     virtual c2_status_t Init() = 0;
 
+    // Called instead of Init for interface only instances.
+    virtual c2_status_t InitInterface() { return Init(); }
+
     virtual c2_status_t DoStart();
 
     virtual c2_status_t DoStop(bool abort);
@@ -98,6 +121,9 @@ private: // Non-virtual interface methods optionally overridden in descendants
 
     virtual c2_status_t Release() { return C2_OK; }
 
+    // Called from query after interface helper filled stackParams and heapParams,
+    // without any component lock held (state_lock is empty). Implementations put
+    // values from published snapshots into these params and leave interface helper params intact.
     virtual c2_status_t UpdateMfxParamToC2(std::unique_lock<std::mutex>/*state_lock*/,
         const std::vector<C2Param*>&/*stackParams*/,
         const std::vector<C2Param::Index> &/*heapParamIndices*/,
@@ -174,13 +200,59 @@ protected:
 
     std::unique_lock<std::mutex> AcquireRunningStateLock(bool may_block) const;
 
+    // Checks the worklet is for the tunnel target, such worklets follow the component's own
+    // and are left untouched, the work is passed to the target on completion.
+    bool IsTunnelWorklet(const C2Worklet& worklet);
+
+    // Runtime metrics shared by all instances of the component with the same name,
+    // named <component name>.<metric>.
+    struct Metrics
+    {
+        explicit Metrics(const C2String& component_name);
+
+        MfxC2Counter* frames_in;
+        MfxC2Counter* frames_out;
+        MfxC2Counter* drops; // works completed with an error
+        MfxC2Counter* flushes;
+        MfxC2Gauge* queue_depth; // works queued and not completed yet
+        MfxC2Counter* allocation_stalls; // retries to get a free output buffer
+        MfxC2Counter* device_busy; // retries of async calls on device busy
+        MfxC2Histogram* sync_latency_us; // waits of SyncOperation
+    };
+
 private:
     c2_status_t CheckStateTransitionConflict(
         const std::unique_lock<std::mutex>& state_lock,
         State next_state);
 
+    // Works going through tunnel (see createTunnel_sm) are kept as is: the target
+    // component gets the work with worklets processed by the source moved aside
+    // and the source output frame as the input. Restored back on completion and
+    // reported to the source listener, the intermediate frame is not returned.
+    struct TunnelledWork
+    {
+        std::weak_ptr<MfxC2Component> source;
+        C2FrameData input; // input of the work queued to the source
+        std::list<std::unique_ptr<C2Worklet>> worklets; // processed by the source
+    };
+
+    // Hands the work completed by this component over to the tunnel target
+    // if its next worklet is for the target, returns false if not handed over.
+    bool ForwardToTunnel(std::unique_ptr<C2Work>* work);
+
+    // Called on the target by the source, restores the work back on failure.
+    c2_status_t QueueTunnelled(const std::shared_ptr<MfxC2Component>& source,
+        std::unique_ptr<C2Work>* work);
+
+    // Restores the work if it came through tunnel, source is null if already destroyed.
+    bool RestoreTunnelledWork(C2Work* work, std::shared_ptr<MfxC2Component>* source);
+
+    // Passes completed work to the listener.
+    void ReportWorkDone(std::unique_ptr<C2Work>&& work);
+
 protected: // variables
-    State m_state = State::STOPPED;
+    // Atomic as query reads it without locks.
+    std::atomic<State> m_state { State::STOPPED };
     State m_nextState = State::STOPPED;
     // If next_state_ != state_ then it is a transition state.
     // If they are equal it is a stable state.
@@ -196,9 +268,29 @@ protected: // variables
 
     mfxIMPL m_mfxImplementation;
 
+    Metrics m_metrics;
+
+private:
+    // Value of runtime metrics param, replaced on query under m_metricsInfoMutex.
+    mutable std::shared_ptr<C2MetricsInfo> m_metricsInfo;
+    mutable std::mutex m_metricsInfoMutex;
+
+private:
+    // Updates the number of works in flight of this instance and metrics queue depth.
+    void AddWorksInFlight(int64_t count);
+
 private:
+    c2_node_id_t m_id; // unique among components of the module
+
+    std::mutex m_tunnelMutex;
+    std::weak_ptr<MfxC2Component> m_tunnelTarget;
+    c2_node_id_t m_tunnelTargetId { 0 };
+    std::map<const C2Work*, TunnelledWork> m_tunnelledWorks; // received from the source
+
     std::list<std::shared_ptr<Listener>> m_listeners;
 
+    std::atomic<int64_t> m_worksInFlight { 0 }; // this instance part of m_metrics.queue_depth
+
     std::mutex m_listenersMutex;
 };
 
@@ -206,6 +298,13 @@ typedef MfxC2Component* (CreateMfxC2ComponentFunc)(const char* name,
     const MfxC2Component::CreateConfig& config,
     std::shared_ptr<C2ReflectorHelper> reflector, c2_status_t* status);
 
+// Prints metrics of components module, each module has its own metrics registry.
+typedef void (DumpMfxC2MetricsFunc)(std::ostream& os);
+
+// Switch and save binary trace of components module, each module has its own trace.
+typedef void (EnableMfxC2BinaryTraceFunc)(bool enable);
+typedef bool (SaveMfxC2BinaryTraceFunc)(const char* filename);
+
 template<typename ComponentClass, typename... ArgTypes>
 struct MfxC2Component::Factory
 {
@@ -228,7 +327,7 @@ struct MfxC2Component::Factory
         MfxC2Component* component =
             new (std::nothrow) ConstructedClass(name, config, std::move(reflector), arg_values...);
         if(component != nullptr) {
-            result = component->Init();
+            result = config.interface_only ? component->InitInterface() : component->Init();
             if(result != C2_OK) {
                 delete component;
                 component = nullptr;
@@ -34,6 +34,8 @@
 // function declaration to make possible use this function statically too
 extern "C" CreateMfxC2ComponentFunc MfxCreateC2Component;
 
+extern "C" DumpMfxC2MetricsFunc MfxDumpC2Metrics;
+
 class MfxC2ComponentsRegistry
 {
 private:
@@ -30,6 +30,7 @@
 #include "mfx_gralloc_allocator.h"
 #include "mfx_c2_color_aspects_wrapper.h"
 #include "mfx_c2_setters.h"
+#include "mfx_c2_snapshot.h"
 
 class MfxC2DecoderComponent : public MfxC2Component
 {
@@ -65,6 +66,8 @@ public:
 protected:
     c2_status_t Init() override;
 
+    c2_status_t InitInterface() override;
+
     c2_status_t DoStart() override;
 
     c2_status_t DoStop(bool abort) override;
@@ -104,7 +107,18 @@ protected:
     c2_status_t Flush(std::list<std::unique_ptr<C2Work>>* const flushedWork) override;
 
 private:
-    c2_status_t UpdateC2Param(const mfxVideoParam* src, C2Param::Index index) const;
+    // Decoder state reported by query, published by the threads changing it.
+    struct QueryParams
+    {
+        mfxVideoParam video_params {};
+        C2BlockPool::local_id_t output_pool_id { C2BlockPool::PLATFORM_START };
+        std::shared_ptr<C2StreamColorAspectsInfo::output> color_aspects;
+    };
+
+    // Puts published value into the param returned by query.
+    c2_status_t UpdateC2Param(const QueryParams& src, C2Param* param) const;
+
+    void PublishQueryParams();
 
     void DoUpdateMfxParam(const std::vector<C2Param*> &params,
         std::vector<std::unique_ptr<C2SettingResult>>* const failures,
@@ -194,6 +208,8 @@ private:
 
     // Protects decoder initialization and m_mfxVideoParams
     mutable std::mutex m_initDecoderMutex;
+    // Lets queries go without m_initDecoderMutex.
+    MfxC2Snapshot<QueryParams> m_queryParams;
     // Width and height of decoding surfaces and respectively maximum frame size supported
     // without re-creation of decoder when resolution changed.
     mfxU16 m_uMaxWidth {};
@@ -27,8 +27,14 @@
 #include "mfx_c2_frame_in.h"
 #include "mfx_c2_bitstream_out.h"
 #include "mfx_c2_utils.h"
+#include "mfx_c2_async_writer.h"
 #include "mfx_c2_vpp_wrapp.h"
 #include "mfx_c2_setters.h"
+#include "mfx_c2_params.h"
+#include "mfx_c2_encoder_rendition.h"
+#include "mfx_c2_scene_change.h"
+#include "mfx_c2_snapshot.h"
+#include "mfx_c2_flat_index_map.h"
 
 // Assumes all calls are done from one (working) thread, no sync is needed.
 // m_ctrlOnce accumulates subsequent changes for one next frame.
@@ -73,6 +79,8 @@ public:
 protected:
     c2_status_t Init() override;
 
+    c2_status_t InitInterface() override;
+
     c2_status_t DoStart() override;
 
     c2_status_t DoStop(bool abort) override;
@@ -95,7 +103,14 @@ protected:
     c2_status_t Queue(std::list<std::unique_ptr<C2Work>>* const items) override;
 
 private:
-    c2_status_t UpdateC2Param(C2Param::Index index) const;
+    // Outputs of the simulcast renditions produced together with one main stream output.
+    // Rendition is shared with waiting thread, as working thread may reinitialize renditions
+    // before the output is synced.
+    typedef std::vector<std::pair<std::shared_ptr<MfxC2EncoderRendition>,
+        MfxC2EncoderRendition::Output>> RenditionOutputs;
+
+    // Puts MFX value into the param returned by query.
+    c2_status_t UpdateC2Param(const mfxInfoMFX& src, C2Param* param) const;
 
     std::unique_ptr<mfxVideoParam> GetParamsView() const;
 
@@ -113,6 +128,12 @@ private:
 
     void FreeEncoder();
 
+    void InitRenditions();
+
+    void EncodeRenditions(const mfxEncodeCtrl* ctrl, mfxFrameSurface1* surface);
+
+    RenditionOutputs PopRenditionOutputs();
+
     void RetainLockedFrame(MfxC2FrameIn&& input);
 
     mfxStatus EncodeFrameAsync(
@@ -127,6 +148,20 @@ private:
         bool queue_update);
 
     c2_status_t ApplyWorkTunings(C2Work& work);
+
+    // Forces next frame to be a key frame.
+    void RequestSyncFrame();
+
+    void DoUpdateBitrate(uint32_t bitrate_value, bool queue_update);
+
+    // Writes values applied from work tunings into interface params, called from config_vb.
+    void SyncWorkTunings(const std::vector<C2Param*> &params);
+
+#if MFX_ANDROID_VERSION > MFX_R
+    // Sets QP of the next frame, CQP mode only.
+    void SetFrameQp(const C2StreamPictureQuantizationTuning::output& frame_qp,
+        const mfxInfoMFX& mfx_info);
+#endif
     // Work routines
     void DoWork(std::unique_ptr<C2Work>&& work);
 
@@ -136,7 +171,8 @@ private:
     // waits for the sync_point and update work with encoder output then
     void WaitWork(std::unique_ptr<C2Work>&& work,
         std::unique_ptr<mfxEncodeCtrl>&& encode_ctrl,
-        MfxC2BitstreamOut&& bit_stream, mfxSyncPoint sync_point);
+        MfxC2BitstreamOut&& bit_stream, mfxSyncPoint sync_point,
+        RenditionOutputs&& rendition_outputs);
 
     void setColorAspects_l();
 
@@ -179,6 +215,9 @@ private:
     MfxVideoParamsWrapper m_mfxVideoParamsState {};
     // Protects encoder initializatin and m_mfxVideoParamsConfig/m_mfxVideoParamsState
     mutable std::mutex m_initEncoderMutex;
+    // Copy of m_mfxVideoParamsConfig.mfx published on every change,
+    // lets queries go without m_initEncoderMutex.
+    MfxC2Snapshot<mfxInfoMFX> m_mfxInfoSnapshot;
 
     // Members handling MFX_WRN_DEVICE_BUSY.
     // Active sync points got from EncodeFrameAsync for waiting on.
@@ -199,9 +238,14 @@ private:
 
     EncoderControl m_encoderControl;
 
+    // Last values applied from work tunings by parameter index, synced into interface params
+    // on next config_vb and returned by queries until then.
+    mutable std::mutex m_workTuningsMutex;
+    MfxC2FlatIndexMap<std::unique_ptr<C2Param>> m_workTunings;
+
     std::shared_ptr<C2BlockPool> m_c2Allocator;
 
-    std::unique_ptr<BinaryWriter> m_outputWriter;
+    std::unique_ptr<MfxC2AsyncWriter> m_outputWriter;
 
     bool m_bHeaderSent{false};
 
@@ -215,10 +259,32 @@ private:
     MfxC2Conversion m_inputVppType;
 
     mfxExtVideoSignalInfo m_signalInfo;
+    // QP bounds and other options attached to AVC/HEVC encoders.
+    mfxExtCodingOption2 m_codingOption2;
 
     // Input frame info with width or height not 16byte aligned
     mfxFrameInfo m_mfxInputInfo;
 
+    // Simulcast renditions configured through config_vb, applied on encoder init.
+    std::vector<C2RenditionStruct> m_renditionsConfig;
+    // Accessed from working thread, outputs are synced in waiting thread.
+    std::vector<std::shared_ptr<MfxC2EncoderRendition>> m_renditionEncoders;
+
+    // Temporal layers count configured through config_vb, 1 - no temporal scalability.
+    uint32_t m_uTemporalLayersConfig { 1 };
+    // Temporal layers count of the initialized encoder, used to tag output with layer ids.
+    // Updated with m_uTemporalFrameOrder through waiting queue, accessed from waiting thread only.
+    uint32_t m_uTemporalLayers { 1 };
+    // Frames output since the last IDR, accessed from waiting thread only.
+    uint32_t m_uTemporalFrameOrder { 0 };
+
+    // Lookahead depth configured through config_vb, applied on encoder init.
+    uint32_t m_uLookAheadDepth { 0 };
+
+    bool m_bSceneChangeDetection { false };
+    // Accessed from working thread only.
+    MfxC2SceneChangeDetector m_sceneChangeDetector;
+
     /* -----------------------C2Parameters--------------------------- */
     std::mutex m_c2ParameterMutex;
     std::shared_ptr<C2ComponentNameSetting> m_name;
@@ -239,6 +305,14 @@ private:
     std::shared_ptr<C2StreamIntraRefreshTuning::output> m_intraRefresh;
     std::shared_ptr<C2StreamColorAspectsInfo::input> m_colorAspects;
     std::shared_ptr<C2StreamColorAspectsInfo::output> m_codedColorAspects;
+    std::shared_ptr<C2StreamRenditionsTuning::output> m_renditions;
+    std::shared_ptr<C2StreamSceneChangeDetectionTuning::output> m_sceneChangeDetection;
+    std::shared_ptr<C2StreamLookAheadDepthTuning::output> m_lookAheadDepth;
+    std::shared_ptr<C2PortActualDelayTuning::input> m_actualInputDelay;
+    std::shared_ptr<C2StreamTemporalLayeringTuning::output> m_temporalLayering;
+#if MFX_ANDROID_VERSION > MFX_R
+    std::shared_ptr<C2StreamPictureQuantizationTuning::output> m_pictureQuantization;
+#endif
     /* ---------------------------------Setters------------------------------------------- */
     static C2R SizeSetter(bool mayBlock, const C2P<C2StreamPictureSizeInfo::input> &oldMe,
                         C2P<C2StreamPictureSizeInfo::input> &me);
@@ -251,6 +325,15 @@ private:
     static C2R GopSetter(bool mayBlock, C2P<C2StreamGopTuning::output> &me);
     static C2R IntraRefreshSetter(bool mayBlock, C2P<C2StreamIntraRefreshTuning::output> &me);
     static C2R ColorAspectsSetter(bool mayBlock, C2P<C2StreamColorAspectsInfo::input> &me);
+#if MFX_ANDROID_VERSION > MFX_R
+    static C2R PictureQuantizationSetter(bool mayBlock, C2P<C2StreamPictureQuantizationTuning::output> &me);
+#endif
+    static C2R TemporalLayeringSetter(bool mayBlock, C2P<C2StreamTemporalLayeringTuning::output> &me);
+    static C2R RenditionsSetter(bool mayBlock, C2P<C2StreamRenditionsTuning::output> &me);
+    static C2R LookAheadDepthSetter(bool mayBlock, C2P<C2StreamLookAheadDepthTuning::output> &me);
+    static C2R InputDelaySetter(bool mayBlock, C2P<C2PortActualDelayTuning::input> &me,
+                                const C2P<C2StreamLookAheadDepthTuning::output> &lookAheadDepth,
+                                const C2P<C2StreamBitrateModeTuning::output> &bitrateMode);
     static C2R CodedColorAspectsSetter(bool mayBlock, C2P<C2StreamColorAspectsInfo::output> &me,
                                     const C2P<C2StreamColorAspectsInfo::input> &coded);
 };
@@ -0,0 +1,109 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <queue>
+
+#include "mfx_dev.h"
+#include "mfx_c2_utils.h"
+#include "mfx_c2_params.h"
+#include "mfx_c2_vpp_wrapp.h"
+#include "mfx_c2_bitstream_out.h"
+
+struct MfxC2EncoderRenditionParam
+{
+#ifdef USE_ONEVPL
+    mfxSession         parent_session;
+#else
+    MFXVideoSession   *parent_session;
+    mfxIMPL            implementation;
+#endif
+    MfxDev            *device;
+    // Parameters of the main encoder, rendition inherits everything except size and bitrate.
+    const mfxVideoParam *main_params;
+    C2RenditionStruct  rendition;
+};
+
+// One additional stream of the simulcast (ABR ladder).
+// Surfaces fed to the main encoder are scaled by own VPP and encoded
+// by own encoder. Both live in a separate session joined to the main one,
+// so the main session schedules all the tasks.
+// Assumes all calls are done from encoder working thread except WaitOutput,
+// which is called from waiting thread. Waiting thread shares ownership while
+// it has outputs to sync, so the rendition may be released there.
+// Requires video memory input, Init returns MFX_ERR_UNSUPPORTED otherwise.
+class MfxC2EncoderRendition
+{
+public:
+    struct Output
+    {
+        MfxC2BitstreamOut bitstream;
+        mfxSyncPoint sync_point { nullptr };
+        // controls of the frames encoded by this moment, released after sync
+        std::vector<std::unique_ptr<mfxEncodeCtrl>> encode_ctrls;
+    };
+
+public:
+    explicit MfxC2EncoderRendition(uint32_t id);
+    ~MfxC2EncoderRendition();
+
+    mfxStatus Init(MfxC2EncoderRenditionParam* param);
+
+    void Close();
+
+    // Scales the surface and sends it to the encoder, nullptr surface drains the encoder.
+    // Produced output is kept in display order until fetched with PopOutput.
+    mfxStatus EncodeFrame(const mfxEncodeCtrl* ctrl, mfxFrameSurface1* surface,
+        const std::shared_ptr<C2BlockPool>& c2_allocator);
+
+    bool PopOutput(Output* output);
+
+    // Waits for the encoded frame and wraps it into C2Buffer tagged with rendition id.
+    mfxStatus WaitOutput(Output&& output, std::shared_ptr<C2Buffer>* buffer);
+
+private:
+    mfxStatus InitSession(MfxC2EncoderRenditionParam* param);
+
+    mfxStatus AllocateBitstream(const std::shared_ptr<C2BlockPool>& c2_allocator,
+        MfxC2BitstreamOut* mfx_bitstream);
+
+private:
+    uint32_t m_id;
+
+#ifdef USE_ONEVPL
+    mfxSession m_mfxSession { nullptr };
+#else
+    MFXVideoSession m_mfxSession;
+    bool m_bSessionInitialized { false };
+#endif
+    bool m_bJoined { false };
+
+    MfxVideoParamsWrapper m_mfxVideoParams;
+    MfxC2VppWrapp m_vpp;
+    std::unique_ptr<MFXVideoENCODE> m_mfxEncoder;
+    mfxU32 m_uBitstreamSize { 0 };
+
+    std::vector<std::unique_ptr<mfxEncodeCtrl>> m_pendingCtrls;
+    std::queue<Output> m_outputs;
+
+private:
+    MFX_CLASS_NO_COPY(MfxC2EncoderRendition)
+};
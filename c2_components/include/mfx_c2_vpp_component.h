@@ -0,0 +1,190 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "mfx_c2_component.h"
+#include "mfx_c2_components_registry.h"
+#include "mfx_dev.h"
+#include "mfx_cmd_queue.h"
+#include "mfx_c2_utils.h"
+#include "mfx_c2_vpp_wrapp.h"
+#include "mfx_c2_setters.h"
+#include "mfx_c2_params.h"
+
+// Video processing component: scales, converts color format and color space,
+// deinterlaces graphic buffers. Input and output buffers are imported as
+// VA surfaces, so frames stay in video memory.
+class MfxC2VppComponent : public MfxC2Component
+{
+protected:
+    MfxC2VppComponent(const C2String name, const CreateConfig& config,
+        std::shared_ptr<C2ReflectorHelper> reflector);
+
+    MFX_CLASS_NO_COPY(MfxC2VppComponent)
+
+public:
+    virtual ~MfxC2VppComponent();
+
+public:
+    static void RegisterClass(MfxC2ComponentsRegistry& registry);
+
+protected:
+    c2_status_t Init() override;
+
+    c2_status_t InitInterface() override;
+
+    c2_status_t DoStart() override;
+
+    c2_status_t DoStop(bool abort) override;
+
+    c2_status_t Release() override;
+
+    c2_status_t UpdateMfxParamToC2(
+        std::unique_lock<std::mutex> state_lock,
+        const std::vector<C2Param*> &stackParams,
+        const std::vector<C2Param::Index> &heapParamIndices,
+        c2_blocking_t mayBlock,
+        std::vector<std::unique_ptr<C2Param>>* const heapParams) const override;
+
+    c2_status_t UpdateC2ParamToMfx(
+        std::unique_lock<std::mutex> state_lock,
+        const std::vector<C2Param*> &params,
+        c2_blocking_t mayBlock,
+        std::vector<std::unique_ptr<C2SettingResult>>* const failures) override;
+
+    c2_status_t Queue(std::list<std::unique_ptr<C2Work>>* const items) override;
+
+    c2_status_t Flush(std::list<std::unique_ptr<C2Work>>* const flushedWork) override;
+
+private:
+    // Processing options collected from C2 parameters, applied on VPP initialization.
+    struct VppConfig
+    {
+        // Output size, 0 - input size is kept.
+        uint32_t width { 0 };
+        uint32_t height { 0 };
+        mfxU32 fourcc { MFX_FOURCC_NV12 };
+        mfxU16 in_matrix { MFX_TRANSFERMATRIX_UNKNOWN };
+        mfxU16 in_range { MFX_NOMINALRANGE_UNKNOWN };
+        mfxU16 out_matrix { MFX_TRANSFERMATRIX_UNKNOWN };
+        mfxU16 out_range { MFX_NOMINALRANGE_UNKNOWN };
+        bool deinterlace { false };
+        bool bottom_field_first { false };
+        C2BlockPool::local_id_t output_pool_id { C2BlockPool::BASIC_GRAPHIC };
+
+        bool operator==(const VppConfig& other) const;
+        bool operator!=(const VppConfig& other) const { return !(*this == other); }
+    };
+
+    // Input frame submitted to VPP, kept until VPP unlocks its surface:
+    // deinterlacer references previous frames.
+    struct VppInput
+    {
+        std::unique_ptr<C2ConstGraphicBlock> block;
+        mfxFrameSurface1 surface {};
+    };
+
+    mfxStatus InitSession();
+
+    mfxStatus InitVpp(const mfxFrameInfo& in_info, const VppConfig& config);
+
+    void FreeVpp();
+
+    c2_status_t ImportGraphicBlock(const C2Handle* handle, mfxMemId* mem_id);
+
+    c2_status_t AllocateOutput(const VppConfig& config, std::shared_ptr<C2GraphicBlock>* block);
+
+    // Work routines
+    void DoWork(std::unique_ptr<C2Work>&& work);
+
+    // Runs VPP on the input surface, null input drains frames buffered by VPP.
+    // Produced frame is returned with the pending work it comes from.
+    c2_status_t ProcessFrame(mfxFrameSurface1* in_surface, bool* output_ready);
+
+    void ReturnOutput(std::shared_ptr<C2GraphicBlock>&& out_block, mfxU64 timestamp);
+
+    // Returns frames buffered by VPP and the rest of pending works empty.
+    void DrainVpp();
+
+    void ReturnEmptyWork(std::unique_ptr<C2Work>&& work, c2_status_t res);
+
+private:
+    std::unique_ptr<MfxDev> m_device;
+
+#ifdef USE_ONEVPL
+    mfxSession m_mfxSession;
+    mfxLoader m_mfxLoader;
+#else
+    MFXVideoSession m_mfxSession;
+#endif
+
+    // Frames are processed synchronously, one by one.
+    MfxCmdQueue m_workingQueue;
+    MFX_TRACEABLE(m_workingQueue);
+
+    // Set while flush waits for working queue, works reaching working thread are collected then.
+    std::atomic<bool> m_bFlushing { false };
+    std::list<std::unique_ptr<C2Work>> m_flushedWorks;
+
+    // Protects m_vppConfig and m_uConfigGeneration updated from config_vb.
+    std::mutex m_configMutex;
+    VppConfig m_vppConfig;
+    // Incremented on every m_vppConfig change, makes working thread reinitialize VPP.
+    uint32_t m_uConfigGeneration { 0 };
+
+    // Accessed from working thread or stop method when working thread is stopped.
+    MfxC2VppWrapp m_vpp;
+    bool m_bVppInitialized { false };
+    uint32_t m_uVppGeneration { 0 };
+    VppConfig m_vppActiveConfig;
+    mfxFrameInfo m_vppInInfo;
+    mfxFrameInfo m_vppOutInfo;
+    mfxExtVPPVideoSignalInfo m_signalInfo;
+    mfxExtVPPDeinterlacing m_deinterlacing;
+    std::vector<mfxExtBuffer*> m_extBuffers;
+    // Works submitted to VPP and waiting for their output, in input order.
+    std::list<std::unique_ptr<C2Work>> m_pendingWorks;
+    std::list<VppInput> m_vppInputs;
+
+    std::shared_ptr<C2BlockPool> m_c2Allocator;
+
+    /* -----------------------C2Parameters--------------------------- */
+    std::shared_ptr<C2ComponentNameSetting> m_name;
+    std::shared_ptr<C2ComponentKindSetting> m_kind;
+    std::shared_ptr<C2ComponentDomainSetting> m_domain;
+    std::shared_ptr<C2StreamBufferTypeSetting::input> m_inputFormat;
+    std::shared_ptr<C2StreamBufferTypeSetting::output> m_outputFormat;
+    std::shared_ptr<C2PortMediaTypeSetting::input> m_inputMediaType;
+    std::shared_ptr<C2PortMediaTypeSetting::output> m_outputMediaType;
+    std::shared_ptr<C2StreamPictureSizeInfo::output> m_size;
+    std::shared_ptr<C2StreamPixelFormatInfo::output> m_pixelFormat;
+    std::shared_ptr<C2StreamColorAspectsInfo::input> m_colorAspects;
+    std::shared_ptr<C2StreamColorAspectsInfo::output> m_outColorAspects;
+    std::shared_ptr<C2StreamDeinterlaceTuning::output> m_deinterlace;
+    std::shared_ptr<C2StreamBottomFieldFirstTuning::input> m_bottomFieldFirst;
+    std::shared_ptr<C2PortBlockPoolsTuning::output> m_outputPoolIds;
+    /* ---------------------------------Setters------------------------------------------- */
+    static C2R SizeSetter(bool mayBlock, const C2P<C2StreamPictureSizeInfo::output> &oldMe,
+                        C2P<C2StreamPictureSizeInfo::output> &me);
+
+    template<typename ColorAspects>
+    static C2R ColorAspectsSetter(bool mayBlock, C2P<ColorAspects> &me);
+};
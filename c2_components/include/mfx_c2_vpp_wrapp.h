@@ -46,9 +46,18 @@ struct MfxC2VppWrappParam
     MFXVideoSession   *session;
 #endif
     mfxFrameInfo      *frame_info;
+    // Output size for scaling, input size is kept if not set.
+    // Non-zero FourCC and PicStruct of it are applied to output too.
+    mfxFrameInfo      *out_frame_info { nullptr };
     std::shared_ptr<MfxFrameAllocator> allocator;
 
     MfxC2Conversion   conversion;
+
+    // Attached to VPP init params, kept by caller while VPP is initialized.
+    mfxExtBuffer     **ext_buffers { nullptr };
+    mfxU16            num_ext_buffers { 0 };
+    // Output surfaces are passed with every frame, no internal ones are allocated.
+    bool              external_out_surfaces { false };
 };
 
 class MfxC2VppWrapp
@@ -60,10 +69,14 @@ public:
     mfxStatus Init(MfxC2VppWrappParam *param);
     mfxStatus Close(void);
     mfxStatus ProcessFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurface1 **out_srf);
+    // Processes into the surface given by caller, for external_out_surfaces mode.
+    // Null in_srf drains frames buffered by VPP.
+    mfxStatus ProcessFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurface1 *out_srf);
 
 protected:
-    mfxStatus FillVppParams(mfxFrameInfo *frame_info, MfxC2Conversion conversion);
+    mfxStatus FillVppParams(MfxC2VppWrappParam *param);
     mfxStatus AllocateOneSurface(void);
+    mfxStatus RunFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurface1 *out_srf);
 
     MFXVideoVPP *m_pVpp;
 #ifdef USE_ONEVPL
@@ -22,24 +22,85 @@
 #include "mfx_debug.h"
 #include "mfx_c2_debug.h"
 #include "mfx_c2_components_registry.h"
+#include "mfx_c2_params.h"
+#include "mfx_c2_setters.h"
 
 using namespace android;
 
 #undef MFX_DEBUG_MODULE_NAME
 #define MFX_DEBUG_MODULE_NAME "mfx_c2_component"
 
+namespace {
+
+// Components alive in the module, to find tunnel target by id.
+struct MfxC2LiveComponents
+{
+    std::mutex mutex;
+    c2_node_id_t next_id { 1 };
+    std::map<c2_node_id_t, MfxC2Component*> components;
+};
+
+MfxC2LiveComponents& GetLiveComponents()
+{
+    static MfxC2LiveComponents live_components;
+    return live_components;
+}
+
+} // namespace
+
 MfxC2Component::MfxC2Component(const C2String& name, const CreateConfig& config, std::shared_ptr<C2ReflectorHelper> reflector) :
     C2InterfaceHelper(reflector),
     m_name(name),
     m_createConfig(config),
-    m_mfxImplementation(MFX_IMPLEMENTATION)
+    m_mfxImplementation(MFX_IMPLEMENTATION),
+    m_metrics(name)
 {
     MFX_DEBUG_TRACE_FUNC;
+
+    // Value is replaced on every query, see query_vb.
+    addParameter(
+        DefineParam(m_metricsInfo, C2_PARAMKEY_METRICS)
+        .withConstValue(AllocSharedString<C2MetricsInfo>(""))
+        .build());
+
+    MfxC2LiveComponents& live_components = GetLiveComponents();
+    std::lock_guard<std::mutex> lock(live_components.mutex);
+    m_id = live_components.next_id++;
+    live_components.components[m_id] = this;
 }
 
 MfxC2Component::~MfxC2Component()
 {
     MFX_DEBUG_TRACE_FUNC;
+
+    if (m_createConfig.admission) {
+        m_createConfig.admission->Leave(this);
+    }
+
+    MfxC2LiveComponents& live_components = GetLiveComponents();
+    std::lock_guard<std::mutex> lock(live_components.mutex);
+    live_components.components.erase(m_id);
+}
+
+MfxC2Component::Metrics::Metrics(const C2String& component_name)
+{
+    MfxC2Metrics& metrics = MfxC2Metrics::GetInstance();
+    const std::string prefix = component_name + ".";
+
+    frames_in = metrics.GetCounter(prefix + "frames_in");
+    frames_out = metrics.GetCounter(prefix + "frames_out");
+    drops = metrics.GetCounter(prefix + "drops");
+    flushes = metrics.GetCounter(prefix + "flushes");
+    queue_depth = metrics.GetGauge(prefix + "queue_depth");
+    allocation_stalls = metrics.GetCounter(prefix + "allocation_stalls");
+    device_busy = metrics.GetCounter(prefix + "device_busy");
+    sync_latency_us = metrics.GetHistogram(prefix + "sync_latency_us");
+}
+
+void MfxC2Component::AddWorksInFlight(int64_t count)
+{
+    m_worksInFlight.fetch_add(count, std::memory_order_relaxed);
+    m_metrics.queue_depth->Add(count);
 }
 
 c2_status_t MfxC2Component::DoStart()
@@ -66,7 +127,9 @@ c2_node_id_t MfxC2Component::getId() const
 {
     MFX_DEBUG_TRACE_FUNC;
 
-    return {};
+    MFX_DEBUG_TRACE_U32(m_id);
+
+    return m_id;
 }
 
 std::unique_lock<std::mutex> MfxC2Component::AcquireStableStateLock(bool may_block) const
@@ -118,35 +181,30 @@ c2_status_t MfxC2Component::query_vb(
 
     c2_status_t res = C2_OK;
 
-    std::unique_lock<std::mutex> lock(m_releaseMutex, std::defer_lock);
-
-    if (mayBlock == C2_MAY_BLOCK) {
-        lock.lock();
-    } else {
-        lock.try_lock();
+    if (State::RELEASED == m_state) {
+        res = C2_BAD_STATE;
+        MFX_DEBUG_TRACE__android_c2_status_t(res);
+        return res;
     }
 
-    // Func query will return c2 params to framework, so we must update MFX params to c2 before calling it.
-    if (lock.owns_lock()) {
-        if (State::RELEASED != m_state) {
-            res = UpdateMfxParamToC2(std::move(lock), stackParams, heapParamIndices, mayBlock, heapParams);
-        } else {
-            res = C2_BAD_STATE;
-        }
+    // Metrics value is collected when queried, as it changes with every frame.
+    bool query_metrics = std::find(heapParamIndices.begin(), heapParamIndices.end(),
+        C2Param::Index(C2MetricsInfo::PARAM_TYPE)) != heapParamIndices.end();
+    if (query_metrics) {
+        std::lock_guard<std::mutex> lock(m_metricsInfoMutex);
+        m_metricsInfo = AllocSharedString<C2MetricsInfo>(MfxC2Metrics::GetInstance().Dump());
+        res = query(stackParams, heapParamIndices, mayBlock, heapParams);
     } else {
-        res = C2_BLOCKING;
-    }
-    
-    if (C2_OK != res)
-    {
-        MFX_DEBUG_TRACE__android_c2_status_t(res);
-        return res;
+        res = query(stackParams, heapParamIndices, mayBlock, heapParams);
     }
-    
-    res = query(stackParams, heapParamIndices, mayBlock, heapParams);
     MFX_DEBUG_TRACE__android_c2_status_t(res);
-    
-    return C2_OK;
+
+    // Values changed by MFX are put into the returned params, not into the params
+    // kept by interface helper, so no component lock is taken on this path.
+    res = UpdateMfxParamToC2(std::unique_lock<std::mutex>(), stackParams, heapParamIndices, mayBlock, heapParams);
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
 }
 
 c2_status_t MfxC2Component::config_vb(
@@ -175,22 +233,68 @@ c2_status_t MfxC2Component::config_vb(
     return res;
 }
 
+// Only components of the same module in the same process can be tunnelled,
+// a component has at most one tunnel target and tunnels are not chained.
+// Frames are passed as C2 blocks, so encoder working in video memory
+// gets decoded surfaces without mapping or copying.
 c2_status_t MfxC2Component::createTunnel_sm(c2_node_id_t targetComponent)
 {
     MFX_DEBUG_TRACE_FUNC;
 
-    (void)targetComponent;
+    MFX_DEBUG_TRACE_U32(targetComponent);
 
-    return C2_OMITTED;
+    c2_status_t res = C2_OK;
+
+    std::shared_ptr<MfxC2Component> target;
+    {
+        MfxC2LiveComponents& live_components = GetLiveComponents();
+        std::lock_guard<std::mutex> lock(live_components.mutex);
+        auto found = live_components.components.find(targetComponent);
+        if (found != live_components.components.end()) {
+            // null if the component is being destroyed
+            target = found->second->weak_from_this().lock();
+        }
+    }
+
+    if (nullptr == target) {
+        res = C2_NOT_FOUND;
+    } else if (target.get() == this) {
+        res = C2_BAD_VALUE;
+    } else {
+        std::lock_guard<std::mutex> lock(m_tunnelMutex);
+        if (targetComponent == m_tunnelTargetId) {
+            res = C2_DUPLICATE;
+        } else if (0 != m_tunnelTargetId) {
+            res = C2_CANNOT_DO;
+        } else {
+            m_tunnelTarget = target;
+            m_tunnelTargetId = targetComponent;
+        }
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
 }
 
 c2_status_t MfxC2Component::releaseTunnel_sm(c2_node_id_t targetComponent)
 {
     MFX_DEBUG_TRACE_FUNC;
 
-    (void)targetComponent;
+    MFX_DEBUG_TRACE_U32(targetComponent);
 
-    return C2_OMITTED;
+    c2_status_t res = C2_OK;
+
+    std::lock_guard<std::mutex> lock(m_tunnelMutex);
+    if (0 != m_tunnelTargetId && targetComponent == m_tunnelTargetId) {
+        // works already passed to the target still come back through this component
+        m_tunnelTarget.reset();
+        m_tunnelTargetId = 0;
+    } else {
+        res = C2_NOT_FOUND;
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
 }
 
 c2_status_t MfxC2Component::querySupportedParams_nb(
@@ -222,7 +326,15 @@ c2_status_t MfxC2Component::queue_nb(std::list<std::unique_ptr<C2Work>>* const i
 
     std::unique_lock<std::mutex> lock = AcquireRunningStateLock(true/*may_block*/);
     if (lock) {
+        const int64_t count = items->size();
+        // counted before queueing as works might complete before Queue returns
+        AddWorksInFlight(count);
         res = Queue(items);
+        if (C2_OK == res) {
+            m_metrics.frames_in->Add(count);
+        } else {
+            AddWorksInFlight(-count);
+        }
     } else {
         res = C2_BAD_STATE;
     }
@@ -249,6 +361,21 @@ c2_status_t MfxC2Component::flush_sm(flush_mode_t mode, std::list<std::unique_pt
     std::unique_lock<std::mutex> lock = AcquireRunningStateLock(true/*may_block*/);
     if (lock) {
         res = Flush(flushedWork);
+        m_metrics.flushes->Add();
+        if (nullptr != flushedWork) {
+            AddWorksInFlight(-(int64_t)flushedWork->size());
+            // works came through tunnel go back to the source listener
+            for (auto it = flushedWork->begin(); it != flushedWork->end(); ) {
+                std::shared_ptr<MfxC2Component> source;
+                if (RestoreTunnelledWork(it->get(), &source)) {
+                    (*it)->result = C2_NOT_FOUND;
+                    if (source) source->ReportWorkDone(std::move(*it));
+                    it = flushedWork->erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
     } else {
         res = C2_BAD_STATE;
     }
@@ -306,7 +433,18 @@ c2_status_t MfxC2Component::start()
             switch (m_state) {
                 case State::STOPPED:
                     m_nextState = State::RUNNING;
-                    action = [this] () { return DoStart(); };
+                    action = [this] () {
+                        // admitted with the configuration it starts with
+                        if (m_createConfig.admission) {
+                            c2_status_t admit_res = m_createConfig.admission->Admit(this);
+                            if (C2_OK != admit_res) return admit_res;
+                        }
+                        c2_status_t start_res = DoStart();
+                        if (C2_OK != start_res && m_createConfig.admission) {
+                            m_createConfig.admission->Leave(this);
+                        }
+                        return start_res;
+                    };
                     break;
                 case State::TRIPPED:
                     m_nextState = State::RUNNING;
@@ -378,6 +516,13 @@ c2_status_t MfxC2Component::stop()
         c2_status_t stop_res = DoStop(abort);
         MFX_DEBUG_TRACE__android_c2_status_t(stop_res);
 
+        // works left in the component are abandoned
+        m_metrics.queue_depth->Add(-m_worksInFlight.exchange(0));
+
+        if (m_createConfig.admission) {
+            m_createConfig.admission->Leave(this);
+        }
+
         std::lock_guard<std::mutex> lock(m_stateMutex);
         m_state = m_nextState; // may not be STOPPED
         m_condStateStable.notify_all();
@@ -424,6 +569,9 @@ c2_status_t MfxC2Component::release()
         if (do_stop) {
             stop_res = DoStop(true/*abort*/);
             res = stop_res;
+            if (m_createConfig.admission) {
+                m_createConfig.admission->Leave(this);
+            }
         }
         if (C2_OK == res) {
             res = Release();
@@ -488,12 +636,37 @@ void MfxC2Component::NotifyWorkDone(std::unique_ptr<C2Work>&& work, c2_status_t
 
     MFX_DEBUG_TRACE__android_c2_status_t(sts);
 
+    MFX_BINARY_TRACE_EVENT("work_done", work->input.ordinal.frameIndex.peeku());
+
     if(C2_OK == sts) {
-        work->workletsProcessed = 1;
+        if (!work->worklets.empty() && !work->worklets.front()->output.buffers.empty()) {
+            m_metrics.frames_out->Add();
+        }
+    } else {
+        m_metrics.drops->Add();
     }
+    AddWorksInFlight(-1);
 
     work->result = sts;
 
+    std::shared_ptr<MfxC2Component> tunnel_source;
+    bool tunnelled = RestoreTunnelledWork(work.get(), &tunnel_source);
+    if(C2_OK == sts) {
+        // restored work has worklets of the source counted
+        work->workletsProcessed = (tunnelled ? work->workletsProcessed : 0) + 1;
+    }
+
+    if (tunnelled) {
+        if (tunnel_source) tunnel_source->ReportWorkDone(std::move(work));
+    } else if (C2_OK != sts || !ForwardToTunnel(&work)) {
+        ReportWorkDone(std::move(work));
+    }
+}
+
+void MfxC2Component::ReportWorkDone(std::unique_ptr<C2Work>&& work)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
     std::weak_ptr<C2Component> weak_this = shared_from_this();
 
     NotifyListeners([weak_this, &work] (std::shared_ptr<Listener> listener)
@@ -504,6 +677,122 @@ void MfxC2Component::NotifyWorkDone(std::unique_ptr<C2Work>&& work, c2_status_t
     });
 }
 
+bool MfxC2Component::IsTunnelWorklet(const C2Worklet& worklet)
+{
+    std::lock_guard<std::mutex> lock(m_tunnelMutex);
+    return 0 != m_tunnelTargetId && worklet.component == m_tunnelTargetId;
+}
+
+bool MfxC2Component::ForwardToTunnel(std::unique_ptr<C2Work>* work)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    std::shared_ptr<MfxC2Component> target;
+    c2_node_id_t target_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_tunnelMutex);
+        target = m_tunnelTarget.lock();
+        target_id = m_tunnelTargetId;
+    }
+    if (nullptr == target) return false;
+
+    C2Work* c2_work = work->get();
+    if (c2_work->workletsProcessed == 0 || c2_work->worklets.size() <= c2_work->workletsProcessed) {
+        return false; // no worklet left for the target
+    }
+
+    auto target_worklet = std::next(c2_work->worklets.begin(), c2_work->workletsProcessed);
+    if ((*target_worklet)->component != target_id) return false;
+
+    const C2FrameData& output = (*std::prev(target_worklet))->output;
+    bool eos = ((c2_work->input.flags | output.flags) & C2FrameData::FLAG_END_OF_STREAM) != 0;
+    if (output.buffers.empty() && !eos) return false; // nothing to pass, like codec config
+
+    c2_status_t res = target->QueueTunnelled(shared_from_this(), work);
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+
+    if (C2_OK == res) return true;
+
+    if (nullptr == *work) return true; // lost in the target
+    (*work)->result = res;
+    return false;
+}
+
+c2_status_t MfxC2Component::QueueTunnelled(const std::shared_ptr<MfxC2Component>& source,
+    std::unique_ptr<C2Work>* work)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    std::unique_lock<std::mutex> lock = AcquireRunningStateLock(true/*may_block*/);
+    if (!lock) return C2_BAD_STATE;
+
+    C2Work* c2_work = work->get();
+
+    TunnelledWork tunnelled;
+    tunnelled.source = source;
+    tunnelled.input = std::move(c2_work->input);
+    auto target_worklet = std::next(c2_work->worklets.begin(), c2_work->workletsProcessed);
+    tunnelled.worklets.splice(tunnelled.worklets.end(), c2_work->worklets,
+        c2_work->worklets.begin(), target_worklet);
+
+    // output frame of the source is input of the target
+    C2FrameData& source_output = tunnelled.worklets.back()->output;
+    c2_work->input = C2FrameData();
+    c2_work->input.flags = C2FrameData::flags_t(source_output.flags |
+        (tunnelled.input.flags & C2FrameData::FLAG_END_OF_STREAM));
+    c2_work->input.ordinal = source_output.ordinal;
+    c2_work->input.buffers = std::move(source_output.buffers);
+    c2_work->workletsProcessed = 0;
+    c2_work->result = C2_OK;
+
+    {
+        // registered before queueing as the work might complete before Queue returns
+        std::lock_guard<std::mutex> tunnel_lock(m_tunnelMutex);
+        m_tunnelledWorks.emplace(c2_work, std::move(tunnelled));
+    }
+
+    std::list<std::unique_ptr<C2Work>> items;
+    items.push_back(std::move(*work));
+
+    AddWorksInFlight(1);
+    c2_status_t res = Queue(&items);
+    if (C2_OK == res) {
+        m_metrics.frames_in->Add();
+    } else {
+        AddWorksInFlight(-1);
+        std::shared_ptr<MfxC2Component> unused_source;
+        if (!items.empty() && items.front()) {
+            *work = std::move(items.front());
+            RestoreTunnelledWork(work->get(), &unused_source);
+        } else {
+            std::lock_guard<std::mutex> tunnel_lock(m_tunnelMutex);
+            m_tunnelledWorks.erase(c2_work);
+        }
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+bool MfxC2Component::RestoreTunnelledWork(C2Work* work, std::shared_ptr<MfxC2Component>* source)
+{
+    TunnelledWork tunnelled;
+    {
+        std::lock_guard<std::mutex> lock(m_tunnelMutex);
+        auto found = m_tunnelledWorks.find(work);
+        if (found == m_tunnelledWorks.end()) return false;
+
+        tunnelled = std::move(found->second);
+        m_tunnelledWorks.erase(found);
+    }
+
+    work->input = std::move(tunnelled.input);
+    work->workletsProcessed = tunnelled.worklets.size();
+    work->worklets.splice(work->worklets.begin(), tunnelled.worklets);
+    *source = tunnelled.source.lock();
+    return true;
+}
+
 void MfxC2Component::ConfigError(const std::vector<std::shared_ptr<C2SettingResult>>& setting_result)
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -25,12 +25,14 @@
 #include "mfx_c2_defs.h"
 #include "mfx_c2_debug.h"
 #include "mfx_c2_component.h"
+#include "mfx_binary_trace.h"
 
 #ifdef MOCK_COMPONENTS
 #include "mfx_c2_mock_component.h"
 #else
 #include "mfx_c2_decoder_component.h"
 #include "mfx_c2_encoder_component.h"
+#include "mfx_c2_vpp_component.h"
 #endif
 
 using namespace android;
@@ -47,6 +49,9 @@ extern "C" EXPORT MfxC2Component* MfxCreateC2Component(
 {
     MFX_DEBUG_TRACE_FUNC;
 
+    // cheap enough to pick up property changes made since the previous component
+    MfxBinaryTrace::UpdateFromProperty();
+
     MfxC2Component* component {};
     c2_status_t res =
         MfxC2ComponentsRegistry::getInstance().CreateMfxC2Component(name, config,
@@ -55,6 +60,23 @@ extern "C" EXPORT MfxC2Component* MfxCreateC2Component(
     return component;
 }
 
+extern "C" EXPORT void MfxDumpC2Metrics(std::ostream& os)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    MfxC2Metrics::GetInstance().Dump(os);
+}
+
+extern "C" EXPORT void MfxEnableC2BinaryTrace(bool enable)
+{
+    MfxBinaryTrace::Enable(enable);
+}
+
+extern "C" EXPORT bool MfxSaveC2BinaryTrace(const char* filename)
+{
+    return MfxBinaryTrace::Save(filename);
+}
+
 MfxC2ComponentsRegistry::MfxC2ComponentsRegistry()
 {
     // Here should be list of calls like this:
@@ -65,6 +87,7 @@ MfxC2ComponentsRegistry::MfxC2ComponentsRegistry()
 #else
     MfxC2DecoderComponent::RegisterClass(*this);
     MfxC2EncoderComponent::RegisterClass(*this);
+    MfxC2VppComponent::RegisterClass(*this);
 #endif
 }
 
@@ -21,10 +21,12 @@
 #include "mfx_c2_decoder_component.h"
 
 #include "mfx_debug.h"
+#include "mfx_binary_trace.h"
 #include "mfx_msdk_debug.h"
 #include "mfx_c2_debug.h"
 #include "mfx_c2_components_registry.h"
 #include "mfx_c2_utils.h"
+#include "mfx_c2_async_writer.h"
 #include "mfx_defaults.h"
 #include "mfx_c2_allocator_id.h"
 #include "mfx_c2_buffer_queue.h"
@@ -675,7 +677,7 @@ c2_status_t MfxC2DecoderComponent::Init()
     mfxStatus mfx_res = MfxDev::Create(MfxDev::Usage::Decoder, &m_device);
 
     if(mfx_res == MFX_ERR_NONE) {
-        mfx_res = ResetSettings(); // requires device_ initialized
+        mfx_res = ResetSettings(); // uses device_ to choose IOPattern
     }
 
     if(mfx_res == MFX_ERR_NONE) {
@@ -688,6 +690,16 @@ c2_status_t MfxC2DecoderComponent::Init()
     return MfxStatusToC2(mfx_res);
 }
 
+c2_status_t MfxC2DecoderComponent::InitInterface()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // Parameters defaults only, IOPattern is chosen when device is created.
+    mfxStatus mfx_res = ResetSettings();
+
+    return MfxStatusToC2(mfx_res);
+}
+
 c2_status_t MfxC2DecoderComponent::DoStart()
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -1023,6 +1035,7 @@ mfxStatus MfxC2DecoderComponent::ResetSettings()
 
     mfx_set_defaults_mfxVideoParam_dec(&m_mfxVideoParams);
 
+    // interface only instance has no device
     if (m_device)
     {
         // default pattern: video memory if allocator available
@@ -1030,10 +1043,8 @@ mfxStatus MfxC2DecoderComponent::ResetSettings()
         MFX_IOPATTERN_OUT_VIDEO_MEMORY : MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
 
     }
-    else
-    {
-        res = MFX_ERR_NULL_PTR;
-    }
+
+    PublishQueryParams();
 
     return res;
 }
@@ -1247,6 +1258,8 @@ mfxStatus MfxC2DecoderComponent::InitDecoder(std::shared_ptr<C2BlockPool> c2_all
         FreeDecoder();
     }
 
+    PublishQueryParams();
+
     MFX_DEBUG_TRACE__mfxStatus(mfx_res);
     return mfx_res;
 }
@@ -1314,63 +1327,78 @@ mfxStatus MfxC2DecoderComponent::HandleFormatChange()
     return mfx_res;
 }
 
-c2_status_t MfxC2DecoderComponent::UpdateC2Param(const mfxVideoParam* src, C2Param::Index index) const
+c2_status_t MfxC2DecoderComponent::UpdateC2Param(const QueryParams& src, C2Param* param) const
 {
     MFX_DEBUG_TRACE_FUNC;
     c2_status_t res = C2_OK;
 
-    if (C2PortSurfaceAllocatorTuning::output::PARAM_TYPE == index) {
-        m_surfaceAllocator->value = C2PlatformAllocatorStore::BUFFERQUEUE;
-        MFX_DEBUG_TRACE_PRINTF("Set output port surface alloctor to: %d", m_surfaceAllocator->value);
-    }
-
-    switch (index.typeIndex()) {
+    // From returns null for params of other ports
+    switch (C2Param::Type(param->type()).typeIndex()) {
+        case kParamIndexSurfaceAllocator: {
+            C2PortSurfaceAllocatorTuning::output* surface_allocator =
+                C2PortSurfaceAllocatorTuning::output::From(param);
+            if (surface_allocator) {
+                surface_allocator->value = C2PlatformAllocatorStore::BUFFERQUEUE;
+                MFX_DEBUG_TRACE_PRINTF("Set output port surface alloctor to: %d", surface_allocator->value);
+            }
+            break;
+        }
         case kParamIndexBlockPools: {
-            m_outputPoolIds->m.values[0] = m_outputPoolId;
+            C2PortBlockPoolsTuning::output* pool_ids = C2PortBlockPoolsTuning::output::From(param);
+            if (pool_ids && pool_ids->flexCount() >= 1) {
+                pool_ids->m.values[0] = src.output_pool_id;
+            }
             break;
         }
         case kParamIndexPictureSize: {
-            if (C2StreamPictureSizeInfo::output::PARAM_TYPE == index) {
+            C2StreamPictureSizeInfo::output* size = C2StreamPictureSizeInfo::output::From(param);
+            if (size) {
                 MFX_DEBUG_TRACE("GetPictureSize");
-                m_size->width = src->mfx.FrameInfo.CropW;
-                m_size->height = src->mfx.FrameInfo.CropH;
-                MFX_DEBUG_TRACE_STREAM(NAMED(m_size->width) << NAMED(m_size->height));
+                size->width = src.video_params.mfx.FrameInfo.CropW;
+                size->height = src.video_params.mfx.FrameInfo.CropH;
+                MFX_DEBUG_TRACE_STREAM(NAMED(size->width) << NAMED(size->height));
             }
             break;
         }
         case kParamIndexAllocators: {
-            if (C2PortAllocatorsTuning::output::PARAM_TYPE == index) {
-                if (m_mfxVideoParams.IOPattern == MFX_IOPATTERN_OUT_VIDEO_MEMORY)
+            C2PortAllocatorsTuning::output* allocators = C2PortAllocatorsTuning::output::From(param);
+            if (allocators && allocators->flexCount() >= 1) {
+                if (src.video_params.IOPattern == MFX_IOPATTERN_OUT_VIDEO_MEMORY)
 #ifdef MFX_BUFFER_QUEUE
-                    m_outputAllocators->m.values[0] = MFX_BUFFERQUEUE;
+                    allocators->m.values[0] = MFX_BUFFERQUEUE;
 #else
-                    m_outputAllocators->m.values[0] = C2PlatformAllocatorStore::GRALLOC;
+                    allocators->m.values[0] = C2PlatformAllocatorStore::GRALLOC;
 #endif
                 else
-                    m_outputAllocators->m.values[0] = C2PlatformAllocatorStore::GRALLOC;
-                MFX_DEBUG_TRACE_PRINTF("Set output port alloctor to: %d", m_outputAllocators->m.values[0]);
+                    allocators->m.values[0] = C2PlatformAllocatorStore::GRALLOC;
+                MFX_DEBUG_TRACE_PRINTF("Set output port alloctor to: %d", allocators->m.values[0]);
             }
             break;
         }
         case kParamIndexColorAspects: {
-            auto color = getColorAspects_l();
-            m_colorAspects->range = color->range;
-            m_colorAspects->primaries = color->primaries;
-            m_colorAspects->transfer = color->transfer;
-            m_colorAspects->matrix = color->matrix;
+            C2StreamColorAspectsInfo::output* color_aspects = C2StreamColorAspectsInfo::output::From(param);
+            auto color = src.color_aspects;
+            if (!color_aspects || !color) break;
+            color_aspects->range = color->range;
+            color_aspects->primaries = color->primaries;
+            color_aspects->transfer = color->transfer;
+            color_aspects->matrix = color->matrix;
             break;
         }
         case kParamIndexDefaultColorAspects: {
-            auto color = getColorAspects_l();
-            m_defaultColorAspects->range = color->range;
-            m_defaultColorAspects->primaries = color->primaries;
-            m_defaultColorAspects->transfer = color->transfer;
-            m_defaultColorAspects->matrix = color->matrix;
+            C2StreamColorAspectsTuning::output* default_color_aspects =
+                C2StreamColorAspectsTuning::output::From(param);
+            auto color = src.color_aspects;
+            if (!default_color_aspects || !color) break;
+            default_color_aspects->range = color->range;
+            default_color_aspects->primaries = color->primaries;
+            default_color_aspects->transfer = color->transfer;
+            default_color_aspects->matrix = color->matrix;
             break;
         }
         default:
             MFX_DEBUG_TRACE_STREAM("attempt to query "
-                            << index.typeIndex() << " type, but not found.");
+                            << C2Param::Type(param->type()).typeIndex() << " type, but not found.");
             break;
     }
 
@@ -1385,42 +1413,33 @@ c2_status_t MfxC2DecoderComponent::UpdateMfxParamToC2(
     std::vector<std::unique_ptr<C2Param>>* const heapParams) const
 {
     (void)state_lock;
+    (void)heapParamIndices;
     (void)mayBlock;
 
     MFX_DEBUG_TRACE_FUNC;
 
-    std::lock_guard<std::mutex> lock(m_initDecoderMutex);
-
     c2_status_t res = C2_OK;
     c2_status_t param_res = C2_OK;
 
-    // determine source, update it if needed
-    const mfxVideoParam* params_view = &m_mfxVideoParams;
+    // Doesn't wait for decoder initialization or parameters update,
+    // reads the parameters published last time.
+    std::shared_ptr<const QueryParams> params_view = m_queryParams.Load();
     if (nullptr != params_view) {
-        // 1st cycle on stack params
+        // 1st cycle on stack params, invalidated ones are not supported
         for (C2Param* param : stackParams) {
-            param_res = UpdateC2Param(params_view, param->index());
+            if (!*param) continue;
+            param_res = UpdateC2Param(*params_view, param);
             if (param_res != C2_OK) {
                 param->invalidate();
                 res = param_res;
             }
         }
-        param_res = C2_OK;
-        // 2nd cycle on heap params
-        for (C2Param::Index param_index : heapParamIndices) {
-            // allocate in UpdateC2Param
-            C2Param* param = nullptr;
-            param_res = UpdateC2Param(params_view, param_index);
-            if (param_res == C2_OK) {
-                if(nullptr != heapParams) {
-                    heapParams->push_back(std::unique_ptr<C2Param>(param));
-                } else {
-                    MFX_DEBUG_TRACE_MSG("heapParams is null");
-                    res = C2_BAD_VALUE;
-                }
-            } else {
-                delete param;
-                res = param_res;
+        // 2nd cycle on heap params allocated by query
+        if (nullptr != heapParams) {
+            for (std::unique_ptr<C2Param>& param : *heapParams) {
+                if (!param) continue;
+                param_res = UpdateC2Param(*params_view, param.get());
+                if (param_res != C2_OK) res = param_res;
             }
         }
     } else {
@@ -1516,6 +1535,8 @@ void MfxC2DecoderComponent::DoUpdateMfxParam(const std::vector<C2Param*> &params
                 break;
         }
     }
+
+    PublishQueryParams();
 }
 
 c2_status_t MfxC2DecoderComponent::UpdateC2ParamToMfx(std::unique_lock<std::mutex> state_lock,
@@ -1596,6 +1617,8 @@ mfxStatus MfxC2DecoderComponent::DecodeFrameAsync(
                 break;
             }
 
+            m_metrics.device_busy->Add();
+
             std::unique_lock<std::mutex> lock(m_devBusyMutex);
             unsigned int synced_points_count = m_uSyncedPointsCount;
             // wait for change of m_uSyncedPointsCount
@@ -1694,8 +1717,20 @@ mfxStatus MfxC2DecoderComponent::DecodeFrame(mfxBitstream *bs, MfxC2FrameOut&& f
                     }
                     lock.unlock(); // unlock the mutex asap
 
+                    // Output timestamp is known before sync, so the waiting thread
+                    // could trace which frame it waits for.
+                    uint64_t frame_index = MfxBinaryTrace::NO_FRAME;
+                    if (MfxBinaryTrace::IsEnabled()) {
+                        std::lock_guard<std::mutex> pending_lock(m_pendingWorksMutex);
+                        auto it = find_if(m_pendingWorks.begin(), m_pendingWorks.end(), [surface_out] (const auto &item) {
+                            return item.second->input.ordinal.timestamp == surface_out->Data.TimeStamp;
+                        });
+                        if (it != m_pendingWorks.end()) frame_index = it->first.peeku();
+                    }
+
                     m_waitingQueue.Push(
-                        [ frame = std::move(frame_out), sync_point, this ] () mutable {
+                        [ frame = std::move(frame_out), sync_point, frame_index, this ] () mutable {
+                        MFX_BINARY_TRACE_FRAME(frame_index);
                         WaitWork(std::move(frame), sync_point);
                     } );
                     {
@@ -1756,6 +1791,7 @@ c2_status_t MfxC2DecoderComponent::AllocateC2Block(uint32_t width, uint32_t heig
                 c2_status_t sts = m_grallocAllocator->GetBackingStore(hndl.get(), &id);
                 if (m_allocator && !m_allocator->InCache(id)) {
                     res = C2_BLOCKING;
+                    m_metrics.allocation_stalls->Add();
                     usleep(1000);
                     // If always fetch a nocached block, check if width or height have changed
                     // compare to when it was initialized.
@@ -1831,6 +1867,7 @@ c2_status_t MfxC2DecoderComponent::AllocateFrame(MfxC2FrameOut* frame_out)
                 if (it->second->Data.Locked) {
                     /* Buffer locked, try next block. */
                     MFX_DEBUG_TRACE_PRINTF("Buffer still locked, try next block");
+                    m_metrics.allocation_stalls->Add();
                     res = C2_TIMED_OUT;
                 } else {
                     *frame_out = MfxC2FrameOut(std::move(out_block), it->second);
@@ -1964,6 +2001,7 @@ void MfxC2DecoderComponent::ReleaseReadViews(uint64_t incoming_frame_index)
 void MfxC2DecoderComponent::DoWork(std::unique_ptr<C2Work>&& work)
 {
     MFX_DEBUG_TRACE_FUNC;
+    MFX_BINARY_TRACE_FUNC;
 
     if (m_bFlushing) {
         m_flushedWorks.push_back(std::move(work));
@@ -2018,6 +2056,7 @@ void MfxC2DecoderComponent::DoWork(std::unique_ptr<C2Work>&& work)
 #ifdef MFX_BUFFER_QUEUE
             bool hasSurface = std::static_pointer_cast<MfxC2BufferQueueBlockPool>(m_c2Allocator)->outputSurfaceSet();
             m_mfxVideoParams.IOPattern = hasSurface ? MFX_IOPATTERN_OUT_VIDEO_MEMORY : MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+            PublishQueryParams();
 #endif
             if (m_mfxVideoParams.IOPattern == MFX_IOPATTERN_OUT_SYSTEM_MEMORY) {
                 m_allocator = nullptr;
@@ -2251,15 +2290,20 @@ void MfxC2DecoderComponent::Drain(std::unique_ptr<C2Work>&& work)
 void MfxC2DecoderComponent::WaitWork(MfxC2FrameOut&& frame_out, mfxSyncPoint sync_point)
 {
     MFX_DEBUG_TRACE_FUNC;
+    MFX_BINARY_TRACE_FUNC;
 
     c2_status_t res = C2_OK;
 
     {
+        MFX_BINARY_TRACE_SCOPE("SyncOperation");
+        auto sync_start = std::chrono::steady_clock::now();
 #ifdef USE_ONEVPL
         mfxStatus mfx_res = MFXVideoCORE_SyncOperation(m_mfxSession, sync_point, MFX_TIMEOUT_INFINITE);
 #else
         mfxStatus mfx_res = m_mfxSession.SyncOperation(sync_point, MFX_TIMEOUT_INFINITE);
 #endif
+        m_metrics.sync_latency_us->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - sync_start).count());
         if (MFX_ERR_NONE != mfx_res) {
             MFX_DEBUG_TRACE_MSG("SyncOperation failed");
             MFX_DEBUG_TRACE__mfxStatus(mfx_res);
@@ -2278,10 +2322,11 @@ void MfxC2DecoderComponent::WaitWork(MfxC2FrameOut&& frame_out, mfxSyncPoint syn
     MFX_DEBUG_TRACE_I32(m_mfxVideoParams.mfx.FrameInfo.CropH);
 
 #if MFX_DEBUG_DUMP_FRAME == MFX_DEBUG_YES
-    static int frameIndex = 0;
-    uint8_t stride = frame_out.GetC2GraphicView()->layout().planes[C2PlanarLayout::PLANE_Y].rowInc;
-    static YUVWriter writer("/data/local/tmp",std::vector<std::string>({}),"decoder_frame.log");
-    writer.Write(mfx_surface->Data.Y, stride, frame_out.GetC2GraphicBlock()->height(), frameIndex++);
+    if (mfx_surface->Data.Y && mfx_surface->Data.UV) {
+        static MfxC2AsyncWriter writer(MFX_C2_DUMP_DIR, std::vector<std::string>({}), "decoder_frame.nv12");
+        writer.WriteNV12(mfx_surface->Data.Y, mfx_surface->Data.UV, mfx_surface->Data.Pitch,
+            mfx_surface->Info.Width, mfx_surface->Info.Height);
+    }
 #endif
 
     decltype(C2WorkOrdinalStruct::timestamp) ready_timestamp{mfx_surface->Data.TimeStamp};
@@ -2331,7 +2376,10 @@ void MfxC2DecoderComponent::WaitWork(MfxC2FrameOut&& frame_out, mfxSyncPoint syn
             // then it becomes not synchronized with output and input,
             // looks random from client side and cannot be tested.
             std::lock_guard<std::mutex> lock(m_initDecoderMutex);
-            m_mfxVideoParams.mfx.FrameInfo = mfx_surface->Info;
+            if (memcmp(&m_mfxVideoParams.mfx.FrameInfo, &mfx_surface->Info, sizeof(mfxFrameInfo))) {
+                m_mfxVideoParams.mfx.FrameInfo = mfx_surface->Info;
+                PublishQueryParams();
+            }
         }
 
         std::shared_ptr<C2GraphicBlock> block = frame_out.GetC2GraphicBlock();
@@ -2442,7 +2490,9 @@ c2_status_t MfxC2DecoderComponent::ValidateWork(const std::unique_ptr<C2Work>& w
 
     do {
 
-        if(work->worklets.size() != 1) {
+        // 2nd worklet is allowed for the tunnel target only, see ForwardToTunnel
+        if(work->worklets.empty() || work->worklets.size() > 2 ||
+            (work->worklets.size() == 2 && (!work->worklets.back() || !IsTunnelWorklet(*work->worklets.back())))) {
             MFX_DEBUG_TRACE_MSG("Cannot handle multiple worklets");
             res = C2_BAD_VALUE;
             break;
@@ -2492,6 +2542,7 @@ c2_status_t MfxC2DecoderComponent::Queue(std::list<std::unique_ptr<C2Work>>* con
                     });
                 } else {
                     m_workingQueue.Push( [ work = std::move(item), this ] () mutable {
+                        MFX_BINARY_TRACE_FRAME(work->input.ordinal.frameIndex.peeku());
                         DoWork(std::move(work));
                     } );
                     if (eos) {
@@ -2608,6 +2659,21 @@ void MfxC2DecoderComponent::UpdateHdrStaticInfo()
     MFX_DEBUG_TRACE__hdrStaticInfo(m_hdrStaticInfo);
 }
 
+void MfxC2DecoderComponent::PublishQueryParams()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    QueryParams params;
+    params.video_params = m_mfxVideoParams;
+    // ext buffers are owned by the component, not a part of the snapshot
+    params.video_params.NumExtParam = 0;
+    params.video_params.ExtParam = nullptr;
+    params.output_pool_id = m_outputPoolId;
+    params.color_aspects = getColorAspects_l();
+
+    m_queryParams.Store(std::move(params));
+}
+
 std::shared_ptr<C2StreamColorAspectsInfo::output> MfxC2DecoderComponent::getColorAspects_l() const {
     MFX_DEBUG_TRACE_FUNC;
     android::ColorAspects sfAspects;
@@ -29,6 +29,7 @@
 #include "C2PlatformSupport.h"
 #include "mfx_gralloc_allocator.h"
 
+#include <algorithm>
 #include <limits>
 #include <thread>
 #include <chrono>
@@ -46,6 +47,15 @@ const c2_nsecs_t TIMEOUT_NS = MFX_SECOND_NS;
 const mfxU32 MFX_MAX_H264_FRAMERATE = 172;
 const mfxU32 MFX_MAX_H265_FRAMERATE = 300;
 const mfxU32 MFX_MAX_SURFACE_NUM = 10;
+const size_t MFX_MAX_RENDITIONS = 4;
+const uint32_t MFX_MAX_TEMPORAL_LAYERS = 4;
+const uint32_t MFX_MIN_BITRATE = 4096;
+const uint32_t MFX_MAX_BITRATE = 40000000;
+const int32_t MFX_MIN_QP = 1;
+const int32_t MFX_MAX_QP = 51;
+// LookAheadDepth range supported by MediaSDK lookahead BRC
+const uint32_t MFX_MIN_LOOKAHEAD_DEPTH = 10;
+const uint32_t MFX_MAX_LOOKAHEAD_DEPTH = 100;
 
 #define MAX_B_FRAMES 1
 
@@ -99,12 +109,70 @@ C2R MfxC2EncoderComponent::VP9_ProfileLevelSetter(bool mayBlock, C2P<C2StreamPro
 C2R MfxC2EncoderComponent::BitrateSetter(bool mayBlock, C2P<C2StreamBitrateInfo::output> &me) {
     (void)mayBlock;
     C2R res = C2R::Ok();
-    if (me.v.value <= 4096) {
-        me.set().value = 4096;
+    if (me.v.value <= MFX_MIN_BITRATE) {
+        me.set().value = MFX_MIN_BITRATE;
     }
     return res;
 }
 
+#if MFX_ANDROID_VERSION > MFX_R
+C2R MfxC2EncoderComponent::PictureQuantizationSetter(bool mayBlock,
+    C2P<C2StreamPictureQuantizationTuning::output> &me) {
+    (void)mayBlock;
+    for (size_t i = 0; i < me.v.flexCount(); ++i) {
+        const C2PictureQuantizationStruct &layer = me.v.m.values[i];
+        // INT32_MIN and INT32_MAX mean the bound is not specified
+        if (layer.min != INT32_MIN && (layer.min < MFX_MIN_QP || layer.min > MFX_MAX_QP)) {
+            me.set().m.values[i].min = c2_clamp(MFX_MIN_QP, layer.min, MFX_MAX_QP);
+        }
+        if (layer.max != INT32_MAX && (layer.max < MFX_MIN_QP || layer.max > MFX_MAX_QP)) {
+            me.set().m.values[i].max = c2_clamp(MFX_MIN_QP, layer.max, MFX_MAX_QP);
+        }
+    }
+    return C2R::Ok();
+}
+
+// Zero bound means the bound is not set.
+static mfxU16 ClampQp(mfxU16 qp, mfxU8 min_qp, mfxU8 max_qp)
+{
+    if (min_qp && qp < min_qp) qp = min_qp;
+    if (max_qp && qp > max_qp) qp = max_qp;
+    return qp;
+}
+
+static void SetQpBounds(const C2PictureQuantizationStruct& bounds, mfxExtCodingOption2* co2)
+{
+    mfxU8 min_qp = (bounds.min == INT32_MIN) ? 0 : ClampCast<mfxU8>(bounds.min);
+    mfxU8 max_qp = (bounds.max == INT32_MAX) ? 0 : ClampCast<mfxU8>(bounds.max);
+
+    if (bounds.type_ & C2Config::I_FRAME) {
+        co2->MinQPI = min_qp;
+        co2->MaxQPI = max_qp;
+    }
+    if (bounds.type_ & C2Config::P_FRAME) {
+        co2->MinQPP = min_qp;
+        co2->MaxQPP = max_qp;
+    }
+    if (bounds.type_ & C2Config::B_FRAME) {
+        co2->MinQPB = min_qp;
+        co2->MaxQPB = max_qp;
+    }
+}
+#endif
+
+// Target bitrate is given in units of BRCParamMultiplier kbps.
+static void SetTargetKbps(uint32_t target_kbps, mfxInfoMFX* info)
+{
+    info->TargetKbps = ClampCast<mfxU16>(target_kbps / std::max<mfxU16>(info->BRCParamMultiplier, 1));
+}
+
+static bool IsTargetKbps(uint32_t target_kbps, const mfxInfoMFX& info)
+{
+    mfxInfoMFX target = info;
+    SetTargetKbps(target_kbps, &target);
+    return target.TargetKbps == info.TargetKbps;
+}
+
 C2R MfxC2EncoderComponent::GopSetter(bool mayBlock, C2P<C2StreamGopTuning::output> &me) {
     (void)mayBlock;
     for (size_t i = 0; i < me.v.flexCount(); ++i) {
@@ -147,6 +215,65 @@ C2R MfxC2EncoderComponent::ColorAspectsSetter(bool mayBlock, C2P<C2StreamColorAs
     return C2R::Ok();
 }
 
+C2R MfxC2EncoderComponent::TemporalLayeringSetter(bool mayBlock, C2P<C2StreamTemporalLayeringTuning::output> &me) {
+    (void)mayBlock;
+    C2R res = C2R::Ok();
+    if (me.v.m.layerCount > MFX_MAX_TEMPORAL_LAYERS) {
+        res = res.plus(C2SettingResultBuilder::BadValue(me.F(me.v.m.layerCount)));
+        me.set().m.layerCount = MFX_MAX_TEMPORAL_LAYERS;
+    }
+    // only P-frame layers are supported
+    if (me.v.m.bLayerCount > 0) {
+        res = res.plus(C2SettingResultBuilder::BadValue(me.F(me.v.m.bLayerCount)));
+        me.set().m.bLayerCount = 0;
+    }
+    return res;
+}
+
+C2R MfxC2EncoderComponent::RenditionsSetter(bool mayBlock, C2P<C2StreamRenditionsTuning::output> &me) {
+    (void)mayBlock;
+    for (size_t i = 0; i < me.v.flexCount(); ++i) {
+        // VPP scaling and encoders work with even sizes only
+        if ((me.v.m.values[i].width & 1) || (me.v.m.values[i].height & 1)) {
+            me.set().m.values[i].width = me.v.m.values[i].width & ~1u;
+            me.set().m.values[i].height = me.v.m.values[i].height & ~1u;
+        }
+    }
+    return C2R::Ok();
+}
+
+C2R MfxC2EncoderComponent::LookAheadDepthSetter(bool mayBlock, C2P<C2StreamLookAheadDepthTuning::output> &me) {
+    (void)mayBlock;
+    if (me.v.value != 0 && (me.v.value < MFX_MIN_LOOKAHEAD_DEPTH || me.v.value > MFX_MAX_LOOKAHEAD_DEPTH)) {
+        me.set().value = c2_clamp(MFX_MIN_LOOKAHEAD_DEPTH, me.v.value, MFX_MAX_LOOKAHEAD_DEPTH);
+    }
+    return C2R::Ok();
+}
+
+C2R MfxC2EncoderComponent::InputDelaySetter(bool mayBlock, C2P<C2PortActualDelayTuning::input> &me,
+                                const C2P<C2StreamLookAheadDepthTuning::output> &lookAheadDepth,
+                                const C2P<C2StreamBitrateModeTuning::output> &bitrateMode) {
+    (void)mayBlock;
+    // frames analyzed ahead are kept by encoder, lookahead works with VBR and CBR only
+    bool lookahead = bitrateMode.v.value == C2Config::BITRATE_VARIABLE ||
+        bitrateMode.v.value == C2Config::BITRATE_CONST;
+    me.set().value = lookahead ? lookAheadDepth.v.value : 0;
+    return C2R::Ok();
+}
+
+// AVC encoder has dedicated rate control methods for lookahead.
+static void SetLookAheadRateControl(uint32_t lookahead_depth, mfxVideoParam* params)
+{
+    mfxU16& method = params->mfx.RateControlMethod;
+    if (lookahead_depth > 0) {
+        if (MFX_RATECONTROL_VBR == method) method = MFX_RATECONTROL_LA;
+        else if (MFX_RATECONTROL_CBR == method) method = MFX_RATECONTROL_LA_HRD;
+    } else {
+        if (MFX_RATECONTROL_LA == method) method = MFX_RATECONTROL_VBR;
+        else if (MFX_RATECONTROL_LA_HRD == method) method = MFX_RATECONTROL_CBR;
+    }
+}
+
 C2R MfxC2EncoderComponent::CodedColorAspectsSetter(bool mayBlock, C2P<C2StreamColorAspectsInfo::output> &me,
                                     const C2P<C2StreamColorAspectsInfo::input> &coded) {
     (void)mayBlock;
@@ -263,7 +390,7 @@ MfxC2EncoderComponent::MfxC2EncoderComponent(const C2String name, const CreateCo
     addParameter(
         DefineParam(m_bitrate, C2_PARAMKEY_BITRATE)
         .withDefault(new C2StreamBitrateInfo::output(SINGLE_STREAM_ID, 64000))
-        .withFields({C2F(m_bitrate, value).inRange(4096, 40000000)})
+        .withFields({C2F(m_bitrate, value).inRange(MFX_MIN_BITRATE, MFX_MAX_BITRATE)})
         .withSetter(BitrateSetter)
         .build());
 
@@ -328,6 +455,47 @@ MfxC2EncoderComponent::MfxC2EncoderComponent(const C2String name, const CreateCo
                         }),})
                 .withSetter(AVC_ProfileLevelSetter)
                 .build());
+
+            addParameter(
+                DefineParam(m_lookAheadDepth, C2_PARAMKEY_LOOKAHEAD_DEPTH)
+                .withDefault(new C2StreamLookAheadDepthTuning::output(SINGLE_STREAM_ID, 0u))
+                .withFields({C2F(m_lookAheadDepth, value).inRange(0, MFX_MAX_LOOKAHEAD_DEPTH)})
+                .withSetter(LookAheadDepthSetter)
+                .build());
+
+            addParameter(
+                DefineParam(m_actualInputDelay, C2_PARAMKEY_INPUT_DELAY)
+                .withDefault(new C2PortActualDelayTuning::input(0u))
+                .withFields({C2F(m_actualInputDelay, value).inRange(0, MFX_MAX_LOOKAHEAD_DEPTH)})
+                .withSetter(InputDelaySetter, m_lookAheadDepth, m_bitrateMode)
+                .build());
+
+            addParameter(
+                DefineParam(m_temporalLayering, C2_PARAMKEY_TEMPORAL_LAYERING)
+                .withDefault(C2StreamTemporalLayeringTuning::output::AllocShared(
+                        0u /* flexCount */, SINGLE_STREAM_ID, 0u /* layerCount */, 0u /* bLayerCount */))
+                .withFields({
+                    C2F(m_temporalLayering, m.layerCount).inRange(0, MFX_MAX_TEMPORAL_LAYERS),
+                    C2F(m_temporalLayering, m.bLayerCount).inRange(0, 0),
+                    C2F(m_temporalLayering, m.bitrateRatios).inRange(0., 1.)
+                })
+                .withSetter(TemporalLayeringSetter)
+                .build());
+
+#if MFX_ANDROID_VERSION > MFX_R
+            addParameter(
+                DefineParam(m_pictureQuantization, C2_PARAMKEY_PICTURE_QUANTIZATION)
+                .withDefault(C2StreamPictureQuantizationTuning::output::AllocShared(
+                        0 /* flexCount */, SINGLE_STREAM_ID /* stream */))
+                .withFields({
+                    C2F(m_pictureQuantization, m.values[0].type_).oneOf(
+                        {C2Config::I_FRAME, C2Config::P_FRAME, C2Config::B_FRAME}),
+                    C2F(m_pictureQuantization, m.values[0].min).any(),
+                    C2F(m_pictureQuantization, m.values[0].max).any()
+                })
+                .withSetter(PictureQuantizationSetter)
+                .build());
+#endif
             break;
         };
         case ENCODER_H265: {
@@ -361,6 +529,33 @@ MfxC2EncoderComponent::MfxC2EncoderComponent(const C2String name, const CreateCo
                         }),})
                 .withSetter(HEVC_ProfileLevelSetter)
                 .build());
+
+            addParameter(
+                DefineParam(m_temporalLayering, C2_PARAMKEY_TEMPORAL_LAYERING)
+                .withDefault(C2StreamTemporalLayeringTuning::output::AllocShared(
+                        0u /* flexCount */, SINGLE_STREAM_ID, 0u /* layerCount */, 0u /* bLayerCount */))
+                .withFields({
+                    C2F(m_temporalLayering, m.layerCount).inRange(0, MFX_MAX_TEMPORAL_LAYERS),
+                    C2F(m_temporalLayering, m.bLayerCount).inRange(0, 0),
+                    C2F(m_temporalLayering, m.bitrateRatios).inRange(0., 1.)
+                })
+                .withSetter(TemporalLayeringSetter)
+                .build());
+
+#if MFX_ANDROID_VERSION > MFX_R
+            addParameter(
+                DefineParam(m_pictureQuantization, C2_PARAMKEY_PICTURE_QUANTIZATION)
+                .withDefault(C2StreamPictureQuantizationTuning::output::AllocShared(
+                        0 /* flexCount */, SINGLE_STREAM_ID /* stream */))
+                .withFields({
+                    C2F(m_pictureQuantization, m.values[0].type_).oneOf(
+                        {C2Config::I_FRAME, C2Config::P_FRAME, C2Config::B_FRAME}),
+                    C2F(m_pictureQuantization, m.values[0].min).any(),
+                    C2F(m_pictureQuantization, m.values[0].max).any()
+                })
+                .withSetter(PictureQuantizationSetter)
+                .build());
+#endif
             break;
         };
         case ENCODER_VP9: {
@@ -444,6 +639,23 @@ MfxC2EncoderComponent::MfxC2EncoderComponent(const C2String name, const CreateCo
         })
         .withSetter(IntraRefreshSetter)
         .build());
+
+    addParameter(
+        DefineParam(m_renditions, C2_PARAMKEY_RENDITIONS)
+        .withDefault(C2StreamRenditionsTuning::output::AllocShared(
+                0 /* flexCount */, SINGLE_STREAM_ID /* stream */))
+        .withFields({C2F(m_renditions, m.values[0].width).inRange(0, MAX_W),
+                        C2F(m_renditions, m.values[0].height).inRange(0, MAX_H),
+                        C2F(m_renditions, m.values[0].bitrate).any()})
+        .withSetter(RenditionsSetter)
+        .build());
+
+    addParameter(
+        DefineParam(m_sceneChangeDetection, C2_PARAMKEY_SCENE_CHANGE_DETECTION)
+        .withDefault(new C2StreamSceneChangeDetectionTuning::output(SINGLE_STREAM_ID, C2_FALSE))
+        .withFields({C2F(m_sceneChangeDetection, value).oneOf({ C2_FALSE, C2_TRUE })})
+        .withSetter(Setter<decltype(*m_sceneChangeDetection)>::NonStrictValueWithNoDeps)
+        .build());
     // Color aspects
     //pr.RegisterParam<C2StreamColorAspectsInfo::input>(C2_PARAMKEY_COLOR_ASPECTS);
     //pr.RegisterParam<C2StreamColorAspectsInfo::output>(C2_PARAMKEY_VUI_COLOR_ASPECTS);
@@ -518,13 +730,23 @@ c2_status_t MfxC2EncoderComponent::Init()
 
     mfxStatus mfx_res = MfxDev::Create(MfxDev::Usage::Encoder, &m_device);
 
-    if(mfx_res == MFX_ERR_NONE) mfx_res = ResetSettings(); // requires device_ initialized
+    if(mfx_res == MFX_ERR_NONE) mfx_res = ResetSettings(); // uses device_ to choose IOPattern
 
     if(mfx_res == MFX_ERR_NONE) mfx_res = InitSession();
 
     return MfxStatusToC2(mfx_res);
 }
 
+c2_status_t MfxC2EncoderComponent::InitInterface()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // Parameters defaults only, IOPattern is chosen when device is created.
+    mfxStatus mfx_res = ResetSettings();
+
+    return MfxStatusToC2(mfx_res);
+}
+
 c2_status_t MfxC2EncoderComponent::DoStart()
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -591,7 +813,7 @@ c2_status_t MfxC2EncoderComponent::DoStart()
                 MFX_C2_DUMP_DIR << "/" << MFX_C2_DUMP_OUTPUT_SUB_DIR << "/" <<
                 oss.str());
 
-            m_outputWriter = std::make_unique<BinaryWriter>(MFX_C2_DUMP_DIR,
+            m_outputWriter = std::make_unique<MfxC2AsyncWriter>(MFX_C2_DUMP_DIR,
                 std::vector<std::string>({MFX_C2_DUMP_OUTPUT_SUB_DIR}), oss.str());
         }
 
@@ -800,6 +1022,10 @@ mfxStatus MfxC2EncoderComponent::ResetSettings()
 
     mfxStatus mfx_res = MFX_ERR_NONE;
 
+    MFX_ZERO_MEMORY(m_codingOption2);
+    m_codingOption2.Header.BufferId = MFX_EXTBUFF_CODING_OPTION2;
+    m_codingOption2.Header.BufferSz = sizeof(mfxExtCodingOption2);
+
     MFX_ZERO_MEMORY(m_signalInfo);
     m_signalInfo.Header.BufferId = MFX_EXTBUFF_VIDEO_SIGNAL_INFO;
     m_signalInfo.Header.BufferSz = sizeof(mfxExtVideoSignalInfo);
@@ -828,18 +1054,19 @@ mfxStatus MfxC2EncoderComponent::ResetSettings()
 
     mfx_res = mfx_set_defaults_mfxVideoParam_enc(&m_mfxVideoParamsConfig);
 
+    // interface only instance has no device
     if (m_device) {
         // default pattern: video memory if allocator available
         m_mfxVideoParamsConfig.IOPattern = m_device->GetFrameAllocator() ?
             MFX_IOPATTERN_IN_VIDEO_MEMORY : MFX_IOPATTERN_IN_SYSTEM_MEMORY;
-    } else {
-        mfx_res = MFX_ERR_NULL_PTR;
     }
 
     // reset ExtParam
     m_mfxVideoParamsConfig.NumExtParam = 0;
     m_mfxVideoParamsConfig.ExtParam = nullptr;
 
+    m_mfxInfoSnapshot.Store(m_mfxVideoParamsConfig.mfx);
+
     MFX_DEBUG_TRACE__mfxStatus(mfx_res);
     return mfx_res;
 }
@@ -852,9 +1079,30 @@ void MfxC2EncoderComponent::AttachExtBuffer()
         mfxExtCodingOption* codingOption = m_mfxVideoParamsConfig.AddExtBuffer<mfxExtCodingOption>();
         codingOption->NalHrdConformance = MFX_CODINGOPTION_OFF;
 
+        mfxExtCodingOption2* codingOption2 = m_mfxVideoParamsConfig.AddExtBuffer<mfxExtCodingOption2>();
+        memcpy(codingOption2, &m_codingOption2, sizeof(mfxExtCodingOption2));
+        if (m_mfxVideoParamsConfig.mfx.RateControlMethod != MFX_RATECONTROL_CQP) {
+            codingOption2->LookAheadDepth = m_uLookAheadDepth;
+        }
+
         mfxExtVideoSignalInfo *vsi = m_mfxVideoParamsConfig.AddExtBuffer<mfxExtVideoSignalInfo>();
         memcpy(vsi, &m_signalInfo, sizeof(mfxExtVideoSignalInfo));
 
+        if (m_uTemporalLayersConfig > 1) {
+            // HEVC encoder accepts AVC temporal layers buffer too.
+            mfxExtAvcTemporalLayers* temporalLayers = m_mfxVideoParamsConfig.AddExtBuffer<mfxExtAvcTemporalLayers>();
+            temporalLayers->BaseLayerPID = 0;
+            for (uint32_t i = 0; i < m_uTemporalLayersConfig; ++i) {
+                temporalLayers->Layer[i].Scale = 1 << i;
+            }
+            // layers are built of P-frames referencing lower layers only,
+            // set on init so GOP tunings configured later don't enable B-frames
+            m_mfxVideoParamsConfig.mfx.GopRefDist = 1;
+            MFX_DEBUG_TRACE_U32(m_uTemporalLayersConfig);
+        } else {
+            m_mfxVideoParamsConfig.RemoveExtBuffer<mfxExtAvcTemporalLayers>();
+        }
+
         MFX_DEBUG_TRACE_U32(vsi->VideoFormat);
         MFX_DEBUG_TRACE_U32(vsi->VideoFullRange);
         MFX_DEBUG_TRACE_U32(vsi->ColourPrimaries);
@@ -889,10 +1137,16 @@ mfxStatus MfxC2EncoderComponent::InitEncoder()
 
             AttachExtBuffer();
 
+            // Lookahead rate control is set on the copy to keep configured method visible to client.
+            MfxVideoParamsWrapper init_params = m_mfxVideoParamsConfig;
+            if (m_encoderType == ENCODER_H264) {
+                SetLookAheadRateControl(m_uLookAheadDepth, &init_params);
+            }
+
             MFX_DEBUG_TRACE_MSG("Encoder initializing...");
-            MFX_DEBUG_TRACE__mfxVideoParam_enc(m_mfxVideoParamsConfig);
+            MFX_DEBUG_TRACE__mfxVideoParam_enc(init_params);
 
-            mfx_res = m_mfxEncoder->Init(&m_mfxVideoParamsConfig);
+            mfx_res = m_mfxEncoder->Init(&init_params);
 
             MFX_DEBUG_TRACE_MSG("Encoder initialized");
             MFX_DEBUG_TRACE__mfxStatus(mfx_res);
@@ -905,7 +1159,7 @@ mfxStatus MfxC2EncoderComponent::InitEncoder()
             if (MFX_ERR_NONE == mfx_res) {
                 // Query required surfaces number for encoder
                 mfxFrameAllocRequest encRequest = {};
-                mfx_res = m_mfxEncoder->QueryIOSurf(&m_mfxVideoParamsConfig, &encRequest);
+                mfx_res = m_mfxEncoder->QueryIOSurf(&init_params, &encRequest);
                 if (MFX_ERR_NONE == mfx_res) {
                    if (m_encSrfNum < encRequest.NumFrameSuggested) {
                         ALOGE("More buffer needed for encoder input! Actual: %d. Expected: %d",
@@ -924,6 +1178,16 @@ mfxStatus MfxC2EncoderComponent::InitEncoder()
             MFX_DEBUG_TRACE__mfxVideoParam_enc(m_mfxVideoParamsState);
         }
 
+        if (MFX_ERR_NONE == mfx_res) {
+            // Outputs of the new encoder are synced after this update in waiting thread.
+            m_waitingQueue.Push([this, layers = m_uTemporalLayersConfig] () {
+                m_uTemporalLayers = layers;
+                m_uTemporalFrameOrder = 0;
+            });
+
+            InitRenditions();
+        }
+
         if (MFX_ERR_NONE != mfx_res) {
             FreeEncoder();
         }
@@ -1005,6 +1269,9 @@ void MfxC2EncoderComponent::FreeEncoder()
 {
     MFX_DEBUG_TRACE_FUNC;
 
+    m_renditionEncoders.clear();
+    m_sceneChangeDetector.Reset();
+
     if(nullptr != m_mfxEncoder) {
         m_mfxEncoder->Close();
         m_mfxEncoder = nullptr;
@@ -1015,6 +1282,72 @@ void MfxC2EncoderComponent::FreeEncoder()
     m_mfxVideoParamsConfig.ExtParam = nullptr;
 }
 
+void MfxC2EncoderComponent::InitRenditions()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_renditionEncoders.clear();
+
+    for (size_t i = 0; i < m_renditionsConfig.size(); ++i) {
+
+        MfxC2EncoderRenditionParam param;
+#ifdef USE_ONEVPL
+        param.parent_session = m_mfxSession;
+#else
+        param.parent_session = &m_mfxSession;
+        param.implementation = m_mfxImplementation;
+#endif
+        param.device = m_device.get();
+        param.main_params = &m_mfxVideoParamsState;
+        param.rendition = m_renditionsConfig[i];
+
+        // rendition ids are 1-based, 0 is reserved for the main stream
+        std::shared_ptr<MfxC2EncoderRendition> rendition =
+            std::make_shared<MfxC2EncoderRendition>(i + 1);
+
+        mfxStatus mfx_res = rendition->Init(&param);
+        if (MFX_ERR_NONE != mfx_res) {
+            // main stream is still encoded
+            MFX_LOG_ERROR("Failed to init rendition %ux%u (%d), renditions are disabled",
+                param.rendition.width, param.rendition.height, mfx_res);
+            m_renditionEncoders.clear();
+            break;
+        }
+        m_renditionEncoders.push_back(std::move(rendition));
+    }
+
+    MFX_DEBUG_TRACE_U32(m_renditionEncoders.size());
+}
+
+void MfxC2EncoderComponent::EncodeRenditions(const mfxEncodeCtrl* ctrl, mfxFrameSurface1* surface)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    for (auto& rendition : m_renditionEncoders) {
+        // Same encode control is passed to keep key frames aligned between renditions.
+        mfxStatus mfx_sts = rendition->EncodeFrame(ctrl, surface, m_c2Allocator);
+        if (MFX_ERR_NONE != mfx_sts && MFX_ERR_MORE_DATA != mfx_sts) {
+            // not fatal for the main stream, the rendition just misses a frame
+            MFX_DEBUG_TRACE__mfxStatus(mfx_sts);
+        }
+    }
+}
+
+MfxC2EncoderComponent::RenditionOutputs MfxC2EncoderComponent::PopRenditionOutputs()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    RenditionOutputs outputs;
+
+    for (auto& rendition : m_renditionEncoders) {
+        MfxC2EncoderRendition::Output output;
+        if (rendition->PopOutput(&output)) {
+            outputs.emplace_back(rendition, std::move(output));
+        }
+    }
+    return outputs;
+}
+
 void MfxC2EncoderComponent::RetainLockedFrame(MfxC2FrameIn&& input)
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -1048,6 +1381,8 @@ mfxStatus MfxC2EncoderComponent::EncodeFrameAsync(
             break;
         }
 
+        m_metrics.device_busy->Add();
+
         MFX_DEBUG_TRACE_STREAM("received MFX_WRN_DEVICE_BUSY [trying_count = " << trying_count << ", m_uSyncedPointsCount = " <<
             m_uSyncedPointsCount.load() << "]");
         std::unique_lock<std::mutex> lock(m_devBusyMutex);
@@ -1073,6 +1408,10 @@ mfxStatus MfxC2EncoderComponent::AllocateSurfacePool()
 
     const mfxFrameInfo frame_info = m_mfxVideoParamsConfig.mfx.FrameInfo;
 
+    // Lookahead keeps that many more frames inside the encoder.
+    m_encSrfNum = MFX_MAX_SURFACE_NUM + m_uLookAheadDepth;
+    MFX_DEBUG_TRACE_U32(m_encSrfNum);
+
     // External (application) allocation of encoder surfaces
     m_encSrfPool =
         (mfxFrameSurface1 *)calloc(sizeof(mfxFrameSurface1), m_encSrfNum);
@@ -1165,25 +1504,82 @@ c2_status_t MfxC2EncoderComponent::ApplyWorkTunings(C2Work& work)
         }
 
         if (worklet->tunings.size() != 0) {
-            // need this temp vector as cannot init vector<smth const> in one step
-            std::vector<C2Param*> temp;
-            std::transform(worklet->tunings.begin(), worklet->tunings.end(), std::back_inserter(temp),
-                [] (const std::unique_ptr<C2Tuning>& p) { return p.get(); } );
+            // Per-frame tunings go to the control of this frame right away, without config pass
+            // and state lock: the working thread is the only one driving the encoder.
+            // Encoder mode is read from the published snapshot.
+            std::shared_ptr<const mfxInfoMFX> mfx_info = m_mfxInfoSnapshot.Load();
+            std::vector<C2Param*> params;
+#if MFX_ANDROID_VERSION > MFX_R
+            const C2StreamPictureQuantizationTuning::output* frame_qp = nullptr;
+#endif
+            for (const std::unique_ptr<C2Tuning>& tuning : worklet->tunings) {
+                bool applied = false;
+
+                switch (C2Param::Type(tuning->type()).typeIndex()) {
+                    case kParamIndexRequestSyncFrame: {
+                        const C2StreamRequestSyncFrameTuning::output* request_sync =
+                            C2StreamRequestSyncFrameTuning::output::From(tuning.get());
+                        if (request_sync) {
+                            if (request_sync->value) RequestSyncFrame();
+                            applied = true;
+                        }
+                        break;
+                    }
+                    case kParamIndexBitrate: {
+                        // Bitrate repeated in every work is skipped here, its change resets
+                        // the encoder and goes through config to be validated.
+                        const C2StreamBitrateInfo::output* bitrate =
+                            C2StreamBitrateInfo::output::From(tuning.get());
+                        if (bitrate) {
+                            applied = (mfx_info->RateControlMethod == MFX_RATECONTROL_CQP) ||
+                                IsTargetKbps(bitrate->value / 1000, *mfx_info);
+                        }
+                        break;
+                    }
+#if MFX_ANDROID_VERSION > MFX_R
+                    case kParamIndexPictureQuantization: {
+                        // QP of a single frame can be set in CQP mode only,
+                        // BRC modes get QP bounds on encoder initialization.
+                        if (mfx_info->RateControlMethod == MFX_RATECONTROL_CQP) {
+                            frame_qp = C2StreamPictureQuantizationTuning::output::From(tuning.get());
+                            applied = (nullptr != frame_qp);
+                        }
+                        break;
+                    }
+#endif
+                    default:
+                        break;
+                }
 
-            std::vector<C2Param*> params(temp.begin(), temp.end());
+                if (!applied) params.push_back(tuning.get());
+            }
 
-            std::vector<std::unique_ptr<C2SettingResult>> failures;
-            {
-                // These parameters update comes with C2Work from work queue,
-                // there is no guarantee that state is not changed meanwhile
-                // in contrast to Config method protected with state mutex.
-                // So AcquireStableStateLock is needed here.
-                std::unique_lock<std::mutex> lock = AcquireStableStateLock(true);
-                res = config(params, C2_DONT_BLOCK, &failures);
-                DoUpdateMfxParam(params, &failures, false);
+#if MFX_ANDROID_VERSION > MFX_R
+            if (frame_qp) {
+                // applied after sync frame request to know the frame type
+                SetFrameQp(*frame_qp, *mfx_info);
+                // interface params get the value on next config_vb
+                std::lock_guard<std::mutex> lock(m_workTuningsMutex);
+                auto emplaced = m_workTunings.Emplace(frame_qp->index(), C2Param::Copy(*frame_qp));
+                if (!emplaced.second) *emplaced.first = C2Param::Copy(*frame_qp);
             }
-            for(auto& failure : failures) {
-                worklet->failures.push_back(std::move(failure));
+#endif
+
+            if (!params.empty()) {
+                std::vector<std::unique_ptr<C2SettingResult>> failures;
+                {
+                    // These parameters update comes with C2Work from work queue,
+                    // there is no guarantee that state is not changed meanwhile
+                    // in contrast to Config method protected with state mutex.
+                    // So AcquireStableStateLock is needed here.
+                    std::unique_lock<std::mutex> lock = AcquireStableStateLock(true);
+                    res = config(params, C2_DONT_BLOCK, &failures);
+                    // Applied to the running encoder right away as working thread is the caller.
+                    DoUpdateMfxParam(params, &failures, false);
+                }
+                for(auto& failure : failures) {
+                    worklet->failures.push_back(std::move(failure));
+                }
             }
         }
     } while(false);
@@ -1192,9 +1588,113 @@ c2_status_t MfxC2EncoderComponent::ApplyWorkTunings(C2Work& work)
     return res;
 }
 
+void MfxC2EncoderComponent::RequestSyncFrame()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    EncoderControl::ModifyFunction modify = [this] (mfxEncodeCtrl* ctrl) {
+        if (m_encoderType == ENCODER_H264 || m_encoderType == ENCODER_H265)
+            ctrl->FrameType = MFX_FRAMETYPE_IDR | MFX_FRAMETYPE_I;
+        else
+            ctrl->FrameType = MFX_FRAMETYPE_I;
+    };
+    m_encoderControl.Modify(modify);
+}
+
+void MfxC2EncoderComponent::DoUpdateBitrate(uint32_t bitrate_value, bool queue_update)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (m_state == State::STOPPED) {
+        SetTargetKbps(bitrate_value / 1000, &m_mfxVideoParamsConfig.mfx); // Convert from bps to Kbps
+        m_mfxInfoSnapshot.Store(m_mfxVideoParamsConfig.mfx);
+    } else {
+        auto update_bitrate_value = [this, bitrate_value] () {
+            MFX_DEBUG_TRACE_FUNC;
+            // MDSK strongly recommended to retrieve the actual working parameters by MFXVideoENCODE_GetVideoParam
+            // function before making any changes to bitrate settings.
+            // They are kept apart from the configuration, as they may differ from it (like lookahead rate control).
+            MfxVideoParamsWrapper reset_params = m_mfxVideoParamsConfig;
+            if (nullptr != m_mfxEncoder) {
+                mfxStatus mfx_res = m_mfxEncoder->GetVideoParam(&reset_params);
+                if (MFX_ERR_NONE != mfx_res) {
+                    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+                    return;
+                }
+            }
+            SetTargetKbps(bitrate_value / 1000, &m_mfxVideoParamsConfig.mfx); // Convert from bps to Kbps
+            // actual parameters may have other multiplier
+            SetTargetKbps(bitrate_value / 1000, &reset_params.mfx);
+            m_mfxInfoSnapshot.Store(m_mfxVideoParamsConfig.mfx);
+            // If application sets NalHrdConformance option in mfxExtCodingOption structure to ON, the only allowed bitrate control mode is VBR.
+            // If OFF, all bitrate control modes are available.In CBR and AVBR modes the application can
+            // change TargetKbps, in VBR mode the application can change TargetKbps and MaxKbps values.
+            // Such change in bitrate will not result in generation of a new key-frame or sequence header.
+            if (m_encoderType == ENCODER_H265 && reset_params.mfx.RateControlMethod == MFX_RATECONTROL_CBR) {
+                mfxExtEncoderResetOption* resetOption = reset_params.AddExtBuffer<mfxExtEncoderResetOption>();
+                resetOption->StartNewSequence = MFX_CODINGOPTION_ON;
+            }
+            if (nullptr != m_mfxEncoder) {
+                {   // waiting for encoding completion of all enqueued frames
+                    std::unique_lock<std::mutex> lock(m_devBusyMutex);
+                    // set big enough value to not hang if something unexpected happens
+                    const auto timeout = std::chrono::seconds(1);
+                    bool wait_res = m_devBusyCond.wait_for(lock, timeout, [this] { return m_uSyncedPointsCount == 0; } );
+                    if (!wait_res) {
+                        MFX_DEBUG_TRACE_MSG("WRN: Some encoded frames might skip during tunings change.");
+                    }
+                }
+                mfxStatus reset_sts = m_mfxEncoder->Reset(&reset_params);
+                MFX_DEBUG_TRACE__mfxStatus(reset_sts);
+                if (MFX_ERR_NONE != reset_sts) {
+                    if (!queue_update) {
+                        //failures->push_back(MakeC2SettingResult(C2ParamField(param),
+                        //    C2SettingResult::CONFLICT, MakeVector(MakeC2ParamField<C2RateControlSetting>())));
+                    }
+                }
+            }
+        };
+
+        MFX_DEBUG_TRACE_PRINTF("updating bitrate from %d to %d.",
+                m_mfxVideoParamsConfig.mfx.TargetKbps, bitrate_value / 1000);
+        Drain(nullptr);
+
+        if (queue_update) {
+            m_workingQueue.Push(std::move(update_bitrate_value));
+        } else {
+            update_bitrate_value();
+        }
+    }
+}
+
+#if MFX_ANDROID_VERSION > MFX_R
+void MfxC2EncoderComponent::SetFrameQp(const C2StreamPictureQuantizationTuning::output& frame_qp,
+    const mfxInfoMFX& mfx_info)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxExtCodingOption2 bounds;
+    MFX_ZERO_MEMORY(bounds);
+    for (size_t i = 0; i < frame_qp.flexCount(); ++i) {
+        SetQpBounds(frame_qp.m.values[i], &bounds);
+    }
+
+    mfxU16 qp_i = ClampQp(mfx_info.QPI, bounds.MinQPI, bounds.MaxQPI);
+    mfxU16 qp_p = ClampQp(mfx_info.QPP, bounds.MinQPP, bounds.MaxQPP);
+    MFX_DEBUG_TRACE_STREAM(NAMED(qp_i) << NAMED(qp_p));
+
+    EncoderControl::ModifyFunction modify = [qp_i, qp_p] (mfxEncodeCtrl* ctrl) {
+        // frame type is known only if it is forced, P-frame QP is used otherwise
+        ctrl->QP = (ctrl->FrameType & MFX_FRAMETYPE_I) ? qp_i : qp_p;
+    };
+    m_encoderControl.Modify(modify);
+}
+#endif
+
 void MfxC2EncoderComponent::DoWork(std::unique_ptr<C2Work>&& work)
 {
     MFX_DEBUG_TRACE_FUNC;
+    MFX_BINARY_TRACE_FUNC;
 
     MFX_DEBUG_TRACE_P(work.get());
 
@@ -1286,6 +1786,15 @@ void MfxC2EncoderComponent::DoWork(std::unique_ptr<C2Work>&& work)
         res = ApplyWorkTunings(*work);
         if(C2_OK != res) break;
 
+        if (m_bSceneChangeDetection && m_mfxVideoParamsConfig.IOPattern == MFX_IOPATTERN_IN_SYSTEM_MEMORY) {
+            mfxFrameSurface1* surface = mfx_frame_in.GetMfxFrameSurface();
+            if (m_sceneChangeDetector.DetectSceneChange(surface->Data.Y,
+                    surface->Info.CropW, surface->Info.CropH, surface->Data.Pitch)) {
+                MFX_DEBUG_TRACE_MSG("Scene change detected");
+                RequestSyncFrame();
+            }
+        }
+
         std::unique_ptr<mfxEncodeCtrl> encode_ctrl = m_encoderControl.AcquireEncodeCtrl();
 
         mfxStatus mfx_sts = EncodeFrameAsync(encode_ctrl.get(),
@@ -1299,6 +1808,8 @@ void MfxC2EncoderComponent::DoWork(std::unique_ptr<C2Work>&& work)
             break;
         }
 
+        EncodeRenditions(encode_ctrl.get(), mfx_frame_in.GetMfxFrameSurface());
+
         m_waitingQueue.Push( [ mfx_frame = std::move(mfx_frame_in), this ] () mutable {
             RetainLockedFrame(std::move(mfx_frame));
         } );
@@ -1311,9 +1822,13 @@ void MfxC2EncoderComponent::DoWork(std::unique_ptr<C2Work>&& work)
 
             m_pendingWorks.pop();
 
+            RenditionOutputs rendition_outputs = PopRenditionOutputs();
+
             m_waitingQueue.Push(
-                [ work = std::move(work), ec = std::move(encode_ctrl), bs = std::move(mfx_bitstream), sync_point, this ] () mutable {
-                WaitWork(std::move(work), std::move(ec), std::move(bs), sync_point);
+                [ work = std::move(work), ec = std::move(encode_ctrl), bs = std::move(mfx_bitstream), sync_point,
+                  ro = std::move(rendition_outputs), this ] () mutable {
+                MFX_BINARY_TRACE_FRAME(work->input.ordinal.frameIndex.peeku());
+                WaitWork(std::move(work), std::move(ec), std::move(bs), sync_point, std::move(ro));
             } );
 
             {
@@ -1350,15 +1865,21 @@ void MfxC2EncoderComponent::Drain(std::unique_ptr<C2Work>&& work)
         mfxStatus mfx_sts = EncodeFrameAsync(encode_ctrl.get(),
             nullptr/*input surface*/, mfx_bitstream.GetMfxBitstream(), &sync_point);
 
+        EncodeRenditions(nullptr, nullptr);
+
         if (MFX_ERR_NONE == mfx_sts) {
 
             std::unique_ptr<C2Work> work = std::move(m_pendingWorks.front());
 
             m_pendingWorks.pop();
 
+            RenditionOutputs rendition_outputs = PopRenditionOutputs();
+
             m_waitingQueue.Push(
-                [ work = std::move(work), ec = std::move(encode_ctrl), bs = std::move(mfx_bitstream), sync_point, this ] () mutable {
-                WaitWork(std::move(work), std::move(ec), std::move(bs), sync_point);
+                [ work = std::move(work), ec = std::move(encode_ctrl), bs = std::move(mfx_bitstream), sync_point,
+                  ro = std::move(rendition_outputs), this ] () mutable {
+                MFX_BINARY_TRACE_FRAME(work->input.ordinal.frameIndex.peeku());
+                WaitWork(std::move(work), std::move(ec), std::move(bs), sync_point, std::move(ro));
             } );
 
             {
@@ -1417,17 +1938,25 @@ void MfxC2EncoderComponent::ReturnEmptyWork(std::unique_ptr<C2Work>&& work, c2_s
 
 void MfxC2EncoderComponent::WaitWork(std::unique_ptr<C2Work>&& work,
     std::unique_ptr<mfxEncodeCtrl>&& encode_ctrl,
-    MfxC2BitstreamOut&& bit_stream, mfxSyncPoint sync_point)
+    MfxC2BitstreamOut&& bit_stream, mfxSyncPoint sync_point,
+    RenditionOutputs&& rendition_outputs)
 {
     MFX_DEBUG_TRACE_FUNC;
+    MFX_BINARY_TRACE_FUNC;
 
     mfxStatus mfx_res = MFX_ERR_NONE;
 
+    {
+        MFX_BINARY_TRACE_SCOPE("SyncOperation");
+        auto sync_start = std::chrono::steady_clock::now();
 #ifdef USE_ONEVPL
-    mfx_res = MFXVideoCORE_SyncOperation(m_mfxSession, sync_point, MFX_TIMEOUT_INFINITE);
+        mfx_res = MFXVideoCORE_SyncOperation(m_mfxSession, sync_point, MFX_TIMEOUT_INFINITE);
 #else
-    mfx_res = m_mfxSession.SyncOperation(sync_point, MFX_TIMEOUT_INFINITE);
+        mfx_res = m_mfxSession.SyncOperation(sync_point, MFX_TIMEOUT_INFINITE);
 #endif
+        m_metrics.sync_latency_us->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - sync_start).count());
+    }
 
     if (MFX_ERR_NONE != mfx_res) {
         MFX_DEBUG_TRACE_MSG("SyncOperation failed");
@@ -1466,6 +1995,15 @@ void MfxC2EncoderComponent::WaitWork(std::unique_ptr<C2Work>&& work,
                 out_buffer.setInfo(std::make_shared<C2StreamPictureTypeMaskInfo::output>(0u/*stream id*/, C2Config::SYNC_FRAME));
             }
 
+            if (m_uTemporalLayers > 1) {
+                // Encoder restarts layers pattern from IDR frames.
+                if ((mfx_bitstream->FrameType & MFX_FRAMETYPE_IDR) != 0) m_uTemporalFrameOrder = 0;
+
+                uint32_t layer_id = GetTemporalLayerId(m_uTemporalFrameOrder++, m_uTemporalLayers);
+                MFX_DEBUG_TRACE_U32(layer_id);
+                out_buffer.setInfo(std::make_shared<C2StreamLayerIndexInfo::output>(0u/*stream id*/, layer_id));
+            }
+
             std::unique_ptr<C2Worklet>& worklet = work->worklets.front();
 
             worklet->output.flags = work->input.flags;
@@ -1553,6 +2091,17 @@ void MfxC2EncoderComponent::WaitWork(std::unique_ptr<C2Work>&& work,
         }
     }
 
+    // Renditions are synced even if the main stream failed,
+    // their bitstreams can't be released while encoding is in progress.
+    for (auto& rendition_output : rendition_outputs) {
+        std::shared_ptr<C2Buffer> rendition_buffer;
+        mfxStatus rendition_res = rendition_output.first->WaitOutput(
+            std::move(rendition_output.second), &rendition_buffer);
+        if (MFX_ERR_NONE == mfx_res && MFX_ERR_NONE == rendition_res) {
+            work->worklets.front()->output.buffers.push_back(std::move(rendition_buffer));
+        }
+    }
+
     // By resetting bit_stream we dispose of the bitrstream mapping here.
     bit_stream = MfxC2BitstreamOut();
     NotifyWorkDone(std::move(work), MfxStatusToC2(mfx_res));
@@ -1598,46 +2147,53 @@ std::unique_ptr<mfxVideoParam> MfxC2EncoderComponent::GetParamsView() const
     return res;
 }
 
-c2_status_t MfxC2EncoderComponent::UpdateC2Param(C2Param::Index index) const
+c2_status_t MfxC2EncoderComponent::UpdateC2Param(const mfxInfoMFX& src, C2Param* param) const
 {
     MFX_DEBUG_TRACE_FUNC;
 
     c2_status_t res = C2_OK;
 
-    switch (index.typeIndex()) {
+    // From returns null for params of other ports
+    switch (C2Param::Type(param->type()).typeIndex()) {
         case kParamIndexFrameRate: {
-            m_frameRate->value = (float)m_mfxVideoParamsConfig.mfx.FrameInfo.FrameRateExtN / 
-                            m_mfxVideoParamsConfig.mfx.FrameInfo.FrameRateExtD;
+            C2StreamFrameRateInfo::output* frame_rate = C2StreamFrameRateInfo::output::From(param);
+            if (frame_rate) frame_rate->value = (float)src.FrameInfo.FrameRateExtN / src.FrameInfo.FrameRateExtD;
             break;
         }
         case kParamIndexBitrate: {
-            m_bitrate->value = m_mfxVideoParamsConfig.mfx.TargetKbps * 1000; // Convert from Kbps to bps
+            C2StreamBitrateInfo::output* bitrate = C2StreamBitrateInfo::output::From(param);
+            // Convert from Kbps to bps
+            if (bitrate) bitrate->value = src.TargetKbps * std::max<mfxU16>(src.BRCParamMultiplier, 1) * 1000;
             break;
         }
         case kParamIndexProfileLevel: {
+            C2StreamProfileLevelInfo::output* profile_level = C2StreamProfileLevelInfo::output::From(param);
+            if (!profile_level) break;
             switch (m_encoderType) {
                 case ENCODER_H264:
-                    AvcProfileMfxToAndroid(m_mfxVideoParamsConfig.mfx.CodecProfile, &m_profileLevel->profile);
-                    AvcLevelMfxToAndroid(m_mfxVideoParamsConfig.mfx.CodecLevel, &m_profileLevel->level);
+                    AvcProfileMfxToAndroid(src.CodecProfile, &profile_level->profile);
+                    AvcLevelMfxToAndroid(src.CodecLevel, &profile_level->level);
                     break;
                 case ENCODER_H265:
-                    HevcProfileMfxToAndroid(m_mfxVideoParamsConfig.mfx.CodecProfile, &m_profileLevel->profile);
-                    HevcLevelMfxToAndroid(m_mfxVideoParamsConfig.mfx.CodecLevel, &m_profileLevel->level);
+                    HevcProfileMfxToAndroid(src.CodecProfile, &profile_level->profile);
+                    HevcLevelMfxToAndroid(src.CodecLevel, &profile_level->level);
                     break;
                 case ENCODER_VP9:
-                    Vp9ProfileMfxToAndroid(m_mfxVideoParamsConfig.mfx.CodecProfile, &m_profileLevel->profile);
+                    Vp9ProfileMfxToAndroid(src.CodecProfile, &profile_level->profile);
                     break;
                 default:
                     MFX_DEBUG_TRACE_STREAM("cannot find the type " << m_encoderType );
                     break;
             }
-            MFX_DEBUG_TRACE_STREAM("m_profileLevel->profile = " << m_profileLevel->profile << ", m_profileLevel->level = "
-                            << m_profileLevel->level << ", mfx.CodecProfile = " << m_mfxVideoParamsConfig.mfx.CodecProfile
-                            << ", mfx.CodecLevel = " << m_mfxVideoParamsConfig.mfx.CodecLevel);
+            MFX_DEBUG_TRACE_STREAM("profile = " << profile_level->profile << ", level = "
+                            << profile_level->level << ", mfx.CodecProfile = " << src.CodecProfile
+                            << ", mfx.CodecLevel = " << src.CodecLevel);
             break;
         }
         case kParamIndexSyncFrameInterval: {
-            m_syncFramePeriod->value = m_mfxVideoParamsConfig.mfx.GopPicSize;
+            C2StreamSyncFrameIntervalTuning::output* sync_frame_period =
+                C2StreamSyncFrameIntervalTuning::output::From(param);
+            if (sync_frame_period) sync_frame_period->value = src.GopPicSize;
             break;
         }
         default:
@@ -1656,22 +2212,41 @@ c2_status_t MfxC2EncoderComponent::UpdateMfxParamToC2(
     std::vector<std::unique_ptr<C2Param>>* const heapParams) const
 {
     (void)m_statelock;
+    (void)heapParamIndices;
     (void)mayBlock;
-    (void)heapParams;
 
     MFX_DEBUG_TRACE_FUNC;
 
-    std::lock_guard<std::mutex> lock(m_initEncoderMutex);
+    // Doesn't wait for encoder initialization or parameters update,
+    // reads the parameters published last time.
+    std::shared_ptr<const mfxInfoMFX> mfx_info = m_mfxInfoSnapshot.Load();
 
     c2_status_t res = C2_OK;
 
-    // 1st cycle on stack params
+    // values from work tunings are not synced into interface params yet
+    std::lock_guard<std::mutex> lock(m_workTuningsMutex);
+
+    // 1st cycle on stack params, invalidated ones are not supported
     for (C2Param* param : stackParams) {
-        UpdateC2Param(param->index());
+        if (!*param) continue;
+        const std::unique_ptr<C2Param>* tuning = m_workTunings.Find(param->index());
+        if (tuning) {
+            param->updateFrom(**tuning);
+        } else {
+            UpdateC2Param(*mfx_info, param);
+        }
     }
-    // 2nd cycle on heap params
-    for (C2Param::Index param_index : heapParamIndices) {
-        UpdateC2Param(param_index);
+    // 2nd cycle on heap params allocated by query
+    if (nullptr != heapParams) {
+        for (std::unique_ptr<C2Param>& param : *heapParams) {
+            if (!param) continue;
+            const std::unique_ptr<C2Param>* tuning = m_workTunings.Find(param->index());
+            if (tuning) {
+                param = C2Param::Copy(**tuning);
+            } else {
+                UpdateC2Param(*mfx_info, param.get());
+            }
+        }
     }
 
     MFX_DEBUG_TRACE__android_c2_status_t(res);
@@ -1718,60 +2293,9 @@ void MfxC2EncoderComponent::DoUpdateMfxParam(const std::vector<C2Param*> &params
             case kParamIndexBitrate: {
                 // MFX_RATECONTROL_CQP parameter is valid only during initialization.
                 if (m_mfxVideoParamsConfig.mfx.RateControlMethod != MFX_RATECONTROL_CQP) {
-                    uint32_t bitrate_value = m_bitrate->value;
-                    if (m_state == State::STOPPED) {
-                        m_mfxVideoParamsConfig.mfx.TargetKbps = bitrate_value / 1000; // Convert from bps to Kbps
-                    } else {
-                        auto update_bitrate_value = [this, bitrate_value, queue_update, failures, param] () {
-                            MFX_DEBUG_TRACE_FUNC;
-                            // MDSK strongly recommended to retrieve the actual working parameters by MFXVideoENCODE_GetVideoParam
-                            // function before making any changes to bitrate settings.
-                            if (nullptr != m_mfxEncoder) {
-                                mfxStatus mfx_res = m_mfxEncoder->GetVideoParam(&m_mfxVideoParamsConfig);
-                                if (MFX_ERR_NONE != mfx_res) {
-                                    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
-                                    return;
-                                }
-                            }
-                            m_mfxVideoParamsConfig.mfx.TargetKbps = bitrate_value / 1000; // Convert from bps to Kbps
-                            // If application sets NalHrdConformance option in mfxExtCodingOption structure to ON, the only allowed bitrate control mode is VBR.
-                            // If OFF, all bitrate control modes are available.In CBR and AVBR modes the application can
-                            // change TargetKbps, in VBR mode the application can change TargetKbps and MaxKbps values.
-                            // Such change in bitrate will not result in generation of a new key-frame or sequence header.
-                            if (m_encoderType == ENCODER_H265 && m_mfxVideoParamsConfig.mfx.RateControlMethod == MFX_RATECONTROL_CBR) {
-                                mfxExtEncoderResetOption* resetOption = m_mfxVideoParamsConfig.AddExtBuffer<mfxExtEncoderResetOption>();
-                                resetOption->StartNewSequence = MFX_CODINGOPTION_ON;
-                            }
-                            if (nullptr != m_mfxEncoder) {
-                                {   // waiting for encoding completion of all enqueued frames
-                                    std::unique_lock<std::mutex> lock(m_devBusyMutex);
-                                    // set big enough value to not hang if something unexpected happens
-                                    const auto timeout = std::chrono::seconds(1);
-                                    bool wait_res = m_devBusyCond.wait_for(lock, timeout, [this] { return m_uSyncedPointsCount == 0; } );
-                                    if (!wait_res) {
-                                        MFX_DEBUG_TRACE_MSG("WRN: Some encoded frames might skip during tunings change.");
-                                    }
-                                }
-                                mfxStatus reset_sts = m_mfxEncoder->Reset(&m_mfxVideoParamsConfig);
-                                MFX_DEBUG_TRACE__mfxStatus(reset_sts);
-                                if (MFX_ERR_NONE != reset_sts) {
-                                    if (!queue_update) {
-                                        //failures->push_back(MakeC2SettingResult(C2ParamField(param),
-                                        //    C2SettingResult::CONFLICT, MakeVector(MakeC2ParamField<C2RateControlSetting>())));
-                                    }
-                                }
-                            }
-                        };
-
-                        MFX_DEBUG_TRACE_PRINTF("updating bitrate from %d to %d.",
-                                m_mfxVideoParamsConfig.mfx.TargetKbps, bitrate_value / 1000);
-                        Drain(nullptr);
-
-                        if (queue_update) {
-                            m_workingQueue.Push(std::move(update_bitrate_value));
-                        } else {
-                            update_bitrate_value();
-                        }
+                    // bitrate repeated in every work tunings doesn't reset the encoder
+                    if (!IsTargetKbps(m_bitrate->value / 1000, m_mfxVideoParamsConfig.mfx)) {
+                        DoUpdateBitrate(m_bitrate->value, queue_update);
                     }
                 } else {
                     //failures->push_back(MakeC2SettingResult(C2ParamField(param),
@@ -1843,13 +2367,7 @@ void MfxC2EncoderComponent::DoUpdateMfxParam(const std::vector<C2Param*> &params
                 if (m_requestSync->value) {
                     MFX_DEBUG_TRACE_MSG("Got sync request");
                     auto update = [this] () {
-                        EncoderControl::ModifyFunction modify = [this] (mfxEncodeCtrl* ctrl) {
-                            if (m_encoderType == ENCODER_H264 || m_encoderType == ENCODER_H265)
-                                ctrl->FrameType = MFX_FRAMETYPE_IDR | MFX_FRAMETYPE_I;
-                            else
-                                ctrl->FrameType = MFX_FRAMETYPE_I;
-                        };
-                        m_encoderControl.Modify(modify);
+                        RequestSyncFrame();
                     };
 
                     if (queue_update) {
@@ -1869,6 +2387,64 @@ void MfxC2EncoderComponent::DoUpdateMfxParam(const std::vector<C2Param*> &params
                 }
                 break;
             }
+#if MFX_ANDROID_VERSION > MFX_R
+            case kParamIndexPictureQuantization: {
+                // BRC modes get the bounds on next encoder initialization
+                for (size_t i = 0; i < m_pictureQuantization->flexCount(); ++i) {
+                    SetQpBounds(m_pictureQuantization->m.values[i], &m_codingOption2);
+                }
+                if (m_mfxVideoParamsConfig.mfx.RateControlMethod == MFX_RATECONTROL_CQP) {
+                    m_mfxVideoParamsConfig.mfx.QPI = ClampQp(m_mfxVideoParamsConfig.mfx.QPI,
+                        m_codingOption2.MinQPI, m_codingOption2.MaxQPI);
+                    m_mfxVideoParamsConfig.mfx.QPP = ClampQp(m_mfxVideoParamsConfig.mfx.QPP,
+                        m_codingOption2.MinQPP, m_codingOption2.MaxQPP);
+                    m_mfxVideoParamsConfig.mfx.QPB = ClampQp(m_mfxVideoParamsConfig.mfx.QPB,
+                        m_codingOption2.MinQPB, m_codingOption2.MaxQPB);
+                }
+                break;
+            }
+#endif
+            case kParamIndexTemporalLayering: {
+                // takes effect on next encoder initialization
+                m_uTemporalLayersConfig = std::max(m_temporalLayering->m.layerCount, 1u);
+                MFX_DEBUG_TRACE_U32(m_uTemporalLayersConfig);
+                break;
+            }
+            case kParamIndexLookAheadDepth: {
+                // Takes effect on next encoder initialization. Input surface pool is
+                // allocated once with the first frame, so later increase can't be applied.
+                if (nullptr != m_encSrfPool && m_lookAheadDepth->value > m_uLookAheadDepth) {
+                    // keep queried values matching the depth in use
+                    m_lookAheadDepth->value = m_uLookAheadDepth;
+                    if (m_actualInputDelay && m_mfxVideoParamsConfig.mfx.RateControlMethod != MFX_RATECONTROL_CQP) {
+                        m_actualInputDelay->value = m_uLookAheadDepth;
+                    }
+                    failures->push_back(MakeC2SettingResult(C2ParamField(param), C2SettingResult::READ_ONLY));
+                    break;
+                }
+                m_uLookAheadDepth = m_lookAheadDepth->value;
+                MFX_DEBUG_TRACE_U32(m_uLookAheadDepth);
+                break;
+            }
+            case kParamIndexSceneChangeDetection: {
+                m_bSceneChangeDetection = m_sceneChangeDetection->value;
+                MFX_DEBUG_TRACE_I32(m_bSceneChangeDetection);
+                break;
+            }
+            case kParamIndexRenditions: {
+                // takes effect on next encoder initialization
+                m_renditionsConfig.clear();
+                for (size_t i = 0; i < m_renditions->flexCount(); ++i) {
+                    const C2RenditionStruct& rendition = m_renditions->m.values[i];
+                    if (i >= MFX_MAX_RENDITIONS || 0 == rendition.width || 0 == rendition.height) {
+                        failures->push_back(MakeC2SettingResult(C2ParamField(param), C2SettingResult::BAD_VALUE));
+                        continue;
+                    }
+                    m_renditionsConfig.push_back(rendition);
+                }
+                MFX_DEBUG_TRACE_U32(m_renditionsConfig.size());
+                break;
+            }
             case kParamIndexColorAspects: {
                 if (C2StreamColorAspectsInfo::input::PARAM_TYPE == param->index()) {
                     m_colorAspects->range = m_colorAspects->range;
@@ -1900,6 +2476,34 @@ void MfxC2EncoderComponent::DoUpdateMfxParam(const std::vector<C2Param*> &params
                 break;
         }
     }
+
+    m_mfxInfoSnapshot.Store(m_mfxVideoParamsConfig.mfx);
+}
+
+void MfxC2EncoderComponent::SyncWorkTunings(const std::vector<C2Param*> &params)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    MfxC2FlatIndexMap<std::unique_ptr<C2Param>> tunings;
+    {
+        std::lock_guard<std::mutex> lock(m_workTuningsMutex);
+        tunings = std::move(m_workTunings);
+        m_workTunings.Clear();
+    }
+
+    std::vector<C2Param*> sync_params;
+    for (size_t i = 0; i < tunings.Size(); ++i) {
+        // value configured now replaces the one from work tunings
+        bool configured = std::any_of(params.begin(), params.end(), [&tunings, i] (const C2Param* param) {
+            return (uint32_t)param->index() == tunings.KeyAt(i);
+        });
+        if (!configured) sync_params.push_back(tunings.ValueAt(i).get());
+    }
+    if (!sync_params.empty()) {
+        std::vector<std::unique_ptr<C2SettingResult>> failures;
+        c2_status_t res = config(sync_params, C2_DONT_BLOCK, &failures);
+        MFX_DEBUG_TRACE__android_c2_status_t(res);
+    }
 }
 
 c2_status_t MfxC2EncoderComponent::UpdateC2ParamToMfx(std::unique_lock<std::mutex> m_statelock,
@@ -1921,6 +2525,8 @@ c2_status_t MfxC2EncoderComponent::UpdateC2ParamToMfx(std::unique_lock<std::mute
 
         failures->clear();
 
+        SyncWorkTunings(params);
+
         std::lock_guard<std::mutex> lock(m_initEncoderMutex);
 
         DoUpdateMfxParam(params, failures, true);
@@ -1954,6 +2560,7 @@ c2_status_t MfxC2EncoderComponent::Queue(std::list<std::unique_ptr<C2Work>>* con
             }
         } else {
             m_workingQueue.Push( [ work = std::move(work), this ] () mutable {
+                MFX_BINARY_TRACE_FRAME(work->input.ordinal.frameIndex.peeku());
                 DoWork(std::move(work));
             } );
 
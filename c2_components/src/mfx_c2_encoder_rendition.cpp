@@ -0,0 +1,400 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_c2_encoder_rendition.h"
+
+#include "mfx_debug.h"
+#include "mfx_msdk_debug.h"
+#include "mfx_c2_debug.h"
+
+#include <thread>
+#include <chrono>
+
+using namespace android;
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_c2_encoder_rendition"
+
+MfxC2EncoderRendition::MfxC2EncoderRendition(uint32_t id):
+    m_id(id)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_DEBUG_TRACE_U32(m_id);
+}
+
+MfxC2EncoderRendition::~MfxC2EncoderRendition()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    Close();
+}
+
+#ifdef USE_ONEVPL
+mfxStatus MfxC2EncoderRendition::InitSession(MfxC2EncoderRenditionParam* param)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+
+    do {
+        // clone keeps implementation and device handle of the main session
+        mfx_res = MFXCloneSession(param->parent_session, &m_mfxSession);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        mfx_res = param->device->InitMfxSession(m_mfxSession);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        mfx_res = MFXVideoCORE_SetFrameAllocator(m_mfxSession,
+            &param->device->GetFrameAllocator()->GetMfxAllocator());
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        mfx_res = MFXJoinSession(param->parent_session, m_mfxSession);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        m_bJoined = true;
+    } while (false);
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+#else
+mfxStatus MfxC2EncoderRendition::InitSession(MfxC2EncoderRenditionParam* param)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+
+    do {
+        mfx_res = m_mfxSession.Init(param->implementation, &g_required_mfx_version);
+        if (MFX_ERR_NONE != mfx_res) {
+            MFX_DEBUG_TRACE_MSG("MFXVideoSession::Init failed");
+            break;
+        }
+        m_bSessionInitialized = true;
+
+        mfx_res = param->device->InitMfxSession(&m_mfxSession);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        mfx_res = m_mfxSession.SetFrameAllocator(&param->device->GetFrameAllocator()->GetMfxAllocator());
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        mfx_res = param->parent_session->JoinSession(m_mfxSession);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        m_bJoined = true;
+    } while (false);
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+#endif
+
+mfxStatus MfxC2EncoderRendition::Init(MfxC2EncoderRenditionParam* param)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+
+    do {
+        if (!param || !param->device || !param->main_params) {
+            mfx_res = MFX_ERR_NULL_PTR;
+            break;
+        }
+
+        MFX_DEBUG_TRACE_STREAM(NAMED(param->rendition.width) << NAMED(param->rendition.height) <<
+            NAMED(param->rendition.bitrate));
+
+        // scaling is done by VPP on video memory surfaces only
+        std::shared_ptr<MfxFrameAllocator> allocator = param->device->GetFrameAllocator();
+        if (!allocator || param->main_params->IOPattern != MFX_IOPATTERN_IN_VIDEO_MEMORY) {
+            MFX_DEBUG_TRACE_MSG("Renditions require video memory input");
+            mfx_res = MFX_ERR_UNSUPPORTED;
+            break;
+        }
+
+        mfx_res = InitSession(param);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        const mfxFrameInfo& main_info = param->main_params->mfx.FrameInfo;
+
+        m_mfxVideoParams.mfx = param->main_params->mfx;
+        m_mfxVideoParams.IOPattern = MFX_IOPATTERN_IN_VIDEO_MEMORY;
+        m_mfxVideoParams.AsyncDepth = param->main_params->AsyncDepth;
+
+        mfxFrameInfo& frame_info = m_mfxVideoParams.mfx.FrameInfo;
+        frame_info.Width = MFX_MEM_ALIGN(param->rendition.width, 16);
+        frame_info.Height = MFX_MEM_ALIGN(param->rendition.height, 16);
+        frame_info.CropX = 0;
+        frame_info.CropY = 0;
+        frame_info.CropW = param->rendition.width;
+        frame_info.CropH = param->rendition.height;
+        // let encoder choose level matching the rendition size
+        m_mfxVideoParams.mfx.CodecLevel = 0;
+
+        if (m_mfxVideoParams.mfx.RateControlMethod != MFX_RATECONTROL_CQP) {
+            if (param->rendition.bitrate > 0) {
+                uint32_t target_kbps = param->rendition.bitrate / 1000;
+                // bitrates beyond mfxU16 range are given in units of BRCParamMultiplier kbps
+                const uint32_t max_kbps = std::numeric_limits<mfxU16>::max();
+                mfxU16 multiplier = ClampCast<mfxU16>(std::max<uint32_t>(1, (target_kbps + max_kbps - 1) / max_kbps));
+                m_mfxVideoParams.mfx.BRCParamMultiplier = multiplier;
+                m_mfxVideoParams.mfx.TargetKbps = ClampCast<mfxU16>(target_kbps / multiplier);
+            } else if (main_info.CropW > 0 && main_info.CropH > 0) {
+                // keep bits per pixel of the main stream
+                uint64_t target_kbps = uint64_t(param->main_params->mfx.TargetKbps) *
+                    frame_info.CropW * frame_info.CropH / (main_info.CropW * main_info.CropH);
+                m_mfxVideoParams.mfx.TargetKbps = ClampCast<mfxU16>(target_kbps);
+            }
+            // buffering is derived by encoder from the new bitrate
+            m_mfxVideoParams.mfx.MaxKbps = 0;
+            m_mfxVideoParams.mfx.BufferSizeInKB = 0;
+            m_mfxVideoParams.mfx.InitialDelayInKB = 0;
+        }
+
+        try {
+            if (m_mfxVideoParams.mfx.CodecId == MFX_CODEC_AVC || m_mfxVideoParams.mfx.CodecId == MFX_CODEC_HEVC) {
+                mfxExtCodingOption* codingOption = m_mfxVideoParams.AddExtBuffer<mfxExtCodingOption>();
+                codingOption->NalHrdConformance = MFX_CODINGOPTION_OFF;
+            } else if (m_mfxVideoParams.mfx.CodecId == MFX_CODEC_VP9) {
+                mfxExtVP9Param* vp9param = m_mfxVideoParams.AddExtBuffer<mfxExtVP9Param>();
+                vp9param->WriteIVFHeaders = MFX_CODINGOPTION_OFF;
+            }
+        } catch(std::exception err) {
+            MFX_DEBUG_TRACE_STREAM("Error:" << err.what());
+            mfx_res = MFX_ERR_MEMORY_ALLOC;
+            break;
+        }
+
+        mfxFrameInfo vpp_in_info = main_info;
+        MfxC2VppWrappParam vpp_param;
+#ifdef USE_ONEVPL
+        vpp_param.session = m_mfxSession;
+#else
+        vpp_param.session = &m_mfxSession;
+#endif
+        vpp_param.frame_info = &vpp_in_info;
+        vpp_param.out_frame_info = &frame_info;
+        vpp_param.allocator = allocator;
+        vpp_param.conversion = CONVERT_NONE;
+
+        mfx_res = m_vpp.Init(&vpp_param);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        m_mfxEncoder.reset(MFX_NEW_NO_THROW(MFXVideoENCODE(m_mfxSession)));
+        if (nullptr == m_mfxEncoder) {
+            mfx_res = MFX_ERR_MEMORY_ALLOC;
+            break;
+        }
+
+        MFX_DEBUG_TRACE__mfxVideoParam_enc(m_mfxVideoParams);
+        mfx_res = m_mfxEncoder->Init(&m_mfxVideoParams);
+        if (MFX_WRN_PARTIAL_ACCELERATION == mfx_res) mfx_res = MFX_ERR_NONE;
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        mfxVideoParam state {};
+        mfx_res = m_mfxEncoder->GetVideoParam(&state);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        MFX_DEBUG_TRACE__mfxVideoParam_enc(state);
+        m_uBitstreamSize = state.mfx.BufferSizeInKB * 1000 * std::max<mfxU16>(state.mfx.BRCParamMultiplier, 1);
+
+    } while (false);
+
+    if (MFX_ERR_NONE != mfx_res) Close();
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+
+void MfxC2EncoderRendition::Close()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // Outputs not fetched by the component are synced before their bitstreams are freed,
+    // encoder may still write into them.
+    while (!m_outputs.empty()) {
+        mfxStatus mfx_res = MFX_ERR_NONE;
+#ifdef USE_ONEVPL
+        mfx_res = MFXVideoCORE_SyncOperation(m_mfxSession, m_outputs.front().sync_point, MFX_TIMEOUT_INFINITE);
+#else
+        mfx_res = m_mfxSession.SyncOperation(m_outputs.front().sync_point, MFX_TIMEOUT_INFINITE);
+#endif
+        MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+        m_outputs.pop();
+    }
+
+    if (m_mfxEncoder) {
+        m_mfxEncoder->Close();
+        m_mfxEncoder = nullptr;
+    }
+    m_vpp.Close();
+
+    m_pendingCtrls.clear();
+    m_mfxVideoParams = MfxVideoParamsWrapper();
+
+#ifdef USE_ONEVPL
+    if (m_mfxSession) {
+        if (m_bJoined) MFXDisjoinSession(m_mfxSession);
+        MFXClose(m_mfxSession);
+        m_mfxSession = nullptr;
+    }
+#else
+    if (m_bSessionInitialized) {
+        if (m_bJoined) m_mfxSession.DisjoinSession();
+        m_mfxSession.Close();
+        m_bSessionInitialized = false;
+    }
+#endif
+    m_bJoined = false;
+}
+
+mfxStatus MfxC2EncoderRendition::AllocateBitstream(const std::shared_ptr<C2BlockPool>& c2_allocator,
+    MfxC2BitstreamOut* mfx_bitstream)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    C2MemoryUsage mem_usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+    std::shared_ptr<C2LinearBlock> out_block;
+
+    c2_status_t res = c2_allocator->fetchLinearBlock(m_uBitstreamSize, mem_usage, &out_block);
+    if (C2_OK == res) res = MfxC2BitstreamOut::Create(out_block, MFX_SECOND_NS, mfx_bitstream);
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return (C2_OK == res) ? MFX_ERR_NONE : MFX_ERR_MEMORY_ALLOC;
+}
+
+mfxStatus MfxC2EncoderRendition::EncodeFrame(const mfxEncodeCtrl* ctrl, mfxFrameSurface1* surface,
+    const std::shared_ptr<C2BlockPool>& c2_allocator)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+    mfxFrameSurface1* scaled_surface = nullptr;
+    Output output;
+
+    do {
+        if (nullptr == m_mfxEncoder) {
+            mfx_res = MFX_ERR_NOT_INITIALIZED;
+            break;
+        }
+
+        if (surface) {
+            mfx_res = m_vpp.ProcessFrameVpp(surface, &scaled_surface);
+            if (MFX_ERR_NONE != mfx_res) break;
+
+            scaled_surface->Data.TimeStamp = surface->Data.TimeStamp;
+            scaled_surface->Data.FrameOrder = surface->Data.FrameOrder;
+        }
+
+        mfx_res = AllocateBitstream(c2_allocator, &output.bitstream);
+        if (MFX_ERR_NONE != mfx_res) break;
+
+        std::unique_ptr<mfxEncodeCtrl> encode_ctrl;
+        if (ctrl) encode_ctrl = std::make_unique<mfxEncodeCtrl>(*ctrl);
+
+        int trying_count = 0;
+        const int MAX_TRYING_COUNT = 200;
+        const auto timeout = std::chrono::milliseconds(5);
+
+        do {
+            mfx_res = m_mfxEncoder->EncodeFrameAsync(encode_ctrl.get(), scaled_surface,
+                output.bitstream.GetMfxBitstream(), &output.sync_point);
+
+            if (MFX_WRN_DEVICE_BUSY == mfx_res) {
+                if (++trying_count >= MAX_TRYING_COUNT) {
+                    MFX_DEBUG_TRACE_MSG("Too many MFX_WRN_DEVICE_BUSY from EncodeFrameAsync");
+                    mfx_res = MFX_ERR_DEVICE_FAILED;
+                    break;
+                }
+                std::this_thread::sleep_for(timeout);
+            }
+        } while (MFX_WRN_DEVICE_BUSY == mfx_res);
+
+        if (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == mfx_res) mfx_res = MFX_ERR_NONE;
+
+        if (MFX_ERR_NONE != mfx_res && MFX_ERR_MORE_DATA != mfx_res) break;
+
+        if (encode_ctrl) m_pendingCtrls.push_back(std::move(encode_ctrl));
+
+        if (MFX_ERR_NONE == mfx_res) {
+            output.encode_ctrls = std::move(m_pendingCtrls);
+            m_pendingCtrls.clear();
+            m_outputs.push(std::move(output));
+        }
+    } while (false);
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+
+bool MfxC2EncoderRendition::PopOutput(Output* output)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    bool res = !m_outputs.empty();
+    if (res) {
+        *output = std::move(m_outputs.front());
+        m_outputs.pop();
+    }
+    return res;
+}
+
+mfxStatus MfxC2EncoderRendition::WaitOutput(Output&& output, std::shared_ptr<C2Buffer>* buffer)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+
+#ifdef USE_ONEVPL
+    mfx_res = MFXVideoCORE_SyncOperation(m_mfxSession, output.sync_point, MFX_TIMEOUT_INFINITE);
+#else
+    mfx_res = m_mfxSession.SyncOperation(output.sync_point, MFX_TIMEOUT_INFINITE);
+#endif
+
+    output.encode_ctrls.clear();
+
+    if (MFX_ERR_NONE == mfx_res) {
+        mfxBitstream* mfx_bitstream = output.bitstream.GetMfxBitstream();
+
+        if (!mfx_bitstream) mfx_res = MFX_ERR_NULL_PTR;
+        else {
+            MFX_DEBUG_TRACE_STREAM(NAMED(m_id) << NAMED(mfx_bitstream->DataOffset) <<
+                NAMED(mfx_bitstream->DataLength));
+
+            // AVC/HEVC headers are written in-band with IDR frames,
+            // so each rendition output is decodable on its own.
+            C2ConstLinearBlock const_linear = output.bitstream.GetC2LinearBlock()->share(
+                mfx_bitstream->DataOffset, mfx_bitstream->DataLength, C2Fence());
+            C2Buffer out_buffer = MakeC2Buffer( { const_linear } );
+            if ((mfx_bitstream->FrameType & MFX_FRAMETYPE_IDR) != 0 || (mfx_bitstream->FrameType & MFX_FRAMETYPE_I) != 0) {
+                out_buffer.setInfo(std::make_shared<C2StreamPictureTypeMaskInfo::output>(0u/*stream id*/, C2Config::SYNC_FRAME));
+            }
+            out_buffer.setInfo(std::make_shared<C2StreamRenditionIdInfo::output>(0u/*stream id*/, m_id));
+
+            *buffer = std::make_shared<C2Buffer>(out_buffer);
+        }
+    }
+
+    // dispose of the bitstream mapping here
+    output.bitstream = MfxC2BitstreamOut();
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
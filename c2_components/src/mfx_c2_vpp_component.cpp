@@ -0,0 +1,966 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_c2_vpp_component.h"
+
+#include "mfx_debug.h"
+#include "mfx_msdk_debug.h"
+#include "mfx_c2_debug.h"
+#include "mfx_c2_components_registry.h"
+#include "mfx_c2_utils.h"
+#include "C2PlatformSupport.h"
+
+#include <algorithm>
+#include <tuple>
+#include <C2AllocatorGralloc.h>
+#include <C2Config.h>
+
+using namespace android;
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_c2_vpp_component"
+
+const c2_nsecs_t TIMEOUT_NS = MFX_SECOND_NS;
+const uint32_t MFX_VPP_MAX_SIZE = 8192;
+// VPP demands frame rate set, it doesn't matter for the operations done here.
+const mfxU32 MFX_VPP_FRAME_RATE = 30;
+
+static mfxU16 MatrixC2ToMfx(C2Color::matrix_t matrix)
+{
+    switch (matrix) {
+        case C2Color::MATRIX_BT601: return MFX_TRANSFERMATRIX_BT601;
+        case C2Color::MATRIX_BT709: return MFX_TRANSFERMATRIX_BT709;
+        default: return MFX_TRANSFERMATRIX_UNKNOWN;
+    }
+}
+
+static mfxU16 RangeC2ToMfx(C2Color::range_t range)
+{
+    switch (range) {
+        case C2Color::RANGE_FULL: return MFX_NOMINALRANGE_0_255;
+        case C2Color::RANGE_LIMITED: return MFX_NOMINALRANGE_16_235;
+        default: return MFX_NOMINALRANGE_UNKNOWN;
+    }
+}
+
+// Fills format fields of frame info for the fourcc, size fields are kept.
+static void SetFrameFormat(mfxU32 fourcc, mfxFrameInfo* info)
+{
+    info->FourCC = fourcc;
+    info->ChromaFormat = (MFX_FOURCC_RGB4 == fourcc) ?
+        MFX_CHROMAFORMAT_YUV444 : MFX_CHROMAFORMAT_YUV420;
+    if (MFX_FOURCC_P010 == fourcc) {
+        info->BitDepthLuma = 10;
+        info->BitDepthChroma = 10;
+        info->Shift = 1;
+    } else {
+        info->BitDepthLuma = 8;
+        info->BitDepthChroma = 8;
+        info->Shift = 0;
+    }
+}
+
+bool MfxC2VppComponent::VppConfig::operator==(const VppConfig& other) const
+{
+    auto tie = [] (const VppConfig& c) {
+        return std::tie(c.width, c.height, c.fourcc, c.in_matrix, c.in_range,
+            c.out_matrix, c.out_range, c.deinterlace, c.bottom_field_first, c.output_pool_id);
+    };
+    return tie(*this) == tie(other);
+}
+
+C2R MfxC2VppComponent::SizeSetter(bool mayBlock, const C2P<C2StreamPictureSizeInfo::output> &oldMe,
+                        C2P<C2StreamPictureSizeInfo::output> &me) {
+
+    MFX_DEBUG_TRACE_FUNC;
+    (void)mayBlock;
+    C2R res = C2R::Ok();
+    if (!me.F(me.v.width).supportsAtAll(me.v.width)) {
+        res = res.plus(C2SettingResultBuilder::BadValue(me.F(me.v.width)));
+        me.set().width = oldMe.v.width;
+    }
+    if (!me.F(me.v.height).supportsAtAll(me.v.height)) {
+        res = res.plus(C2SettingResultBuilder::BadValue(me.F(me.v.height)));
+        me.set().height = oldMe.v.height;
+    }
+
+    return res;
+}
+
+template<typename ColorAspects>
+C2R MfxC2VppComponent::ColorAspectsSetter(bool mayBlock, C2P<ColorAspects> &me) {
+    (void)mayBlock;
+    if (me.v.range > C2Color::RANGE_OTHER) {
+            me.set().range = C2Color::RANGE_OTHER;
+    }
+    if (me.v.primaries > C2Color::PRIMARIES_OTHER) {
+            me.set().primaries = C2Color::PRIMARIES_OTHER;
+    }
+    if (me.v.transfer > C2Color::TRANSFER_OTHER) {
+            me.set().transfer = C2Color::TRANSFER_OTHER;
+    }
+    if (me.v.matrix > C2Color::MATRIX_OTHER) {
+            me.set().matrix = C2Color::MATRIX_OTHER;
+    }
+    return C2R::Ok();
+}
+
+MfxC2VppComponent::MfxC2VppComponent(const C2String name, const CreateConfig& config,
+    std::shared_ptr<C2ReflectorHelper> reflector) :
+        MfxC2Component(name, config, std::move(reflector))
+#ifdef USE_ONEVPL
+        , m_mfxSession(nullptr),
+        m_mfxLoader(nullptr)
+#endif
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    MFX_ZERO_MEMORY(m_vppInInfo);
+    MFX_ZERO_MEMORY(m_vppOutInfo);
+    MFX_ZERO_MEMORY(m_signalInfo);
+    MFX_ZERO_MEMORY(m_deinterlacing);
+
+    const unsigned int SINGLE_STREAM_ID = 0u;
+
+    addParameter(
+        DefineParam(m_kind, C2_PARAMKEY_COMPONENT_KIND)
+        .withConstValue(new C2ComponentKindSetting(C2Component::KIND_OTHER))
+        .build());
+
+    addParameter(
+        DefineParam(m_domain, C2_PARAMKEY_COMPONENT_DOMAIN)
+        .withConstValue(new C2ComponentDomainSetting(C2Component::DOMAIN_VIDEO))
+        .build());
+
+    addParameter(
+        DefineParam(m_name, C2_PARAMKEY_COMPONENT_NAME)
+        .withConstValue(AllocSharedString<C2ComponentNameSetting>(name.c_str()))
+        .build());
+
+    addParameter(
+        DefineParam(m_inputMediaType, C2_PARAMKEY_INPUT_MEDIA_TYPE)
+        .withConstValue(AllocSharedString<C2PortMediaTypeSetting::input>("video/raw"))
+        .build());
+
+    addParameter(
+        DefineParam(m_outputMediaType, C2_PARAMKEY_OUTPUT_MEDIA_TYPE)
+        .withConstValue(AllocSharedString<C2PortMediaTypeSetting::output>("video/raw"))
+        .build());
+
+    addParameter(
+        DefineParam(m_inputFormat, C2_PARAMKEY_INPUT_STREAM_BUFFER_TYPE)
+        .withConstValue(new C2StreamBufferTypeSetting::input(
+                SINGLE_STREAM_ID, C2BufferData::GRAPHIC))
+        .build());
+
+    addParameter(
+        DefineParam(m_outputFormat, C2_PARAMKEY_OUTPUT_STREAM_BUFFER_TYPE)
+        .withConstValue(new C2StreamBufferTypeSetting::output(
+                SINGLE_STREAM_ID, C2BufferData::GRAPHIC))
+        .build());
+
+    // Output size, zeros keep the input size.
+    addParameter(
+        DefineParam(m_size, C2_PARAMKEY_PICTURE_SIZE)
+        .withDefault(new C2StreamPictureSizeInfo::output(SINGLE_STREAM_ID, 0u, 0u))
+        .withFields({
+            C2F(m_size, width).inRange(0, MFX_VPP_MAX_SIZE, 2),
+            C2F(m_size, height).inRange(0, MFX_VPP_MAX_SIZE, 2),
+        })
+        .withSetter(SizeSetter)
+        .build());
+
+    addParameter(
+        DefineParam(m_pixelFormat, C2_PARAMKEY_PIXEL_FORMAT)
+        .withDefault(new C2StreamPixelFormatInfo::output(
+                SINGLE_STREAM_ID, HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL))
+        .withFields({C2F(m_pixelFormat, value).oneOf({
+                HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL,
+                HAL_PIXEL_FORMAT_P010_INTEL,
+                HAL_PIXEL_FORMAT_RGBA_8888,
+            })
+        })
+        .withSetter(Setter<decltype(*m_pixelFormat)>::StrictValueWithNoDeps)
+        .build());
+
+    addParameter(
+        DefineParam(m_colorAspects, C2_PARAMKEY_COLOR_ASPECTS)
+        .withDefault(new C2StreamColorAspectsInfo::input(
+                SINGLE_STREAM_ID, C2Color::RANGE_UNSPECIFIED, C2Color::PRIMARIES_UNSPECIFIED,
+                C2Color::TRANSFER_UNSPECIFIED, C2Color::MATRIX_UNSPECIFIED))
+        .withFields({
+            C2F(m_colorAspects, range).inRange(
+                        C2Color::RANGE_UNSPECIFIED,     C2Color::RANGE_OTHER),
+            C2F(m_colorAspects, primaries).inRange(
+                        C2Color::PRIMARIES_UNSPECIFIED, C2Color::PRIMARIES_OTHER),
+            C2F(m_colorAspects, transfer).inRange(
+                        C2Color::TRANSFER_UNSPECIFIED,  C2Color::TRANSFER_OTHER),
+            C2F(m_colorAspects, matrix).inRange(
+                        C2Color::MATRIX_UNSPECIFIED,    C2Color::MATRIX_OTHER)
+        })
+        .withSetter(ColorAspectsSetter<C2StreamColorAspectsInfo::input>)
+        .build());
+
+    addParameter(
+        DefineParam(m_outColorAspects, C2_PARAMKEY_VUI_COLOR_ASPECTS)
+        .withDefault(new C2StreamColorAspectsInfo::output(
+                SINGLE_STREAM_ID, C2Color::RANGE_UNSPECIFIED, C2Color::PRIMARIES_UNSPECIFIED,
+                C2Color::TRANSFER_UNSPECIFIED, C2Color::MATRIX_UNSPECIFIED))
+        .withFields({
+            C2F(m_outColorAspects, range).inRange(
+                        C2Color::RANGE_UNSPECIFIED,     C2Color::RANGE_OTHER),
+            C2F(m_outColorAspects, primaries).inRange(
+                        C2Color::PRIMARIES_UNSPECIFIED, C2Color::PRIMARIES_OTHER),
+            C2F(m_outColorAspects, transfer).inRange(
+                        C2Color::TRANSFER_UNSPECIFIED,  C2Color::TRANSFER_OTHER),
+            C2F(m_outColorAspects, matrix).inRange(
+                        C2Color::MATRIX_UNSPECIFIED,    C2Color::MATRIX_OTHER)
+        })
+        .withSetter(ColorAspectsSetter<C2StreamColorAspectsInfo::output>)
+        .build());
+
+    addParameter(
+        DefineParam(m_deinterlace, C2_PARAMKEY_DEINTERLACE)
+        .withDefault(new C2StreamDeinterlaceTuning::output(SINGLE_STREAM_ID, C2_FALSE))
+        .withFields({C2F(m_deinterlace, value).oneOf({ C2_FALSE, C2_TRUE })})
+        .withSetter(Setter<decltype(*m_deinterlace)>::NonStrictValueWithNoDeps)
+        .build());
+
+    addParameter(
+        DefineParam(m_bottomFieldFirst, C2_PARAMKEY_BOTTOM_FIELD_FIRST)
+        .withDefault(new C2StreamBottomFieldFirstTuning::input(SINGLE_STREAM_ID, C2_FALSE))
+        .withFields({C2F(m_bottomFieldFirst, value).oneOf({ C2_FALSE, C2_TRUE })})
+        .withSetter(Setter<decltype(*m_bottomFieldFirst)>::NonStrictValueWithNoDeps)
+        .build());
+
+    C2BlockPool::local_id_t outputPoolIds[1] = { C2BlockPool::BASIC_GRAPHIC };
+    addParameter(
+        DefineParam(m_outputPoolIds, C2_PARAMKEY_OUTPUT_BLOCK_POOLS)
+        .withDefault(C2PortBlockPoolsTuning::output::AllocShared(outputPoolIds))
+        .withFields({ C2F(m_outputPoolIds, m.values[0]).any(),
+                        C2F(m_outputPoolIds, m.values).inRange(0, 1) })
+        .withSetter(Setter<C2PortBlockPoolsTuning::output>::NonStrictValuesWithNoDeps)
+        .build());
+}
+
+MfxC2VppComponent::~MfxC2VppComponent()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    Release();
+}
+
+void MfxC2VppComponent::RegisterClass(MfxC2ComponentsRegistry& registry)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    registry.RegisterMfxC2Component("c2.intel.vpp",
+        &MfxC2Component::Factory<MfxC2VppComponent>::Create<>);
+}
+
+c2_status_t MfxC2VppComponent::Init()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MfxDev::Create(MfxDev::Usage::Encoder, &m_device);
+
+    // Buffers are processed in video memory only.
+    if (MFX_ERR_NONE == mfx_res && !m_device->GetFrameConverter()) mfx_res = MFX_ERR_UNSUPPORTED;
+
+    if (MFX_ERR_NONE == mfx_res) mfx_res = InitSession();
+
+    if (MFX_ERR_NONE == mfx_res) {
+        std::shared_ptr<MfxFrameAllocator> allocator = m_device->GetFrameAllocator();
+        if (allocator) {
+#ifdef USE_ONEVPL
+            mfx_res = MFXVideoCORE_SetFrameAllocator(m_mfxSession, &allocator->GetMfxAllocator());
+#else
+            mfx_res = m_mfxSession.SetFrameAllocator(&allocator->GetMfxAllocator());
+#endif
+        } else {
+            mfx_res = MFX_ERR_NOT_INITIALIZED;
+        }
+    }
+
+    return MfxStatusToC2(mfx_res);
+}
+
+c2_status_t MfxC2VppComponent::InitInterface()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // Parameters defaults only, no device is needed.
+    return C2_OK;
+}
+
+c2_status_t MfxC2VppComponent::DoStart()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_workingQueue.Start();
+
+    return C2_OK;
+}
+
+c2_status_t MfxC2VppComponent::DoStop(bool abort)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (abort) {
+        m_workingQueue.Abort();
+    } else {
+        m_workingQueue.Stop();
+    }
+
+    FreeVpp();
+    m_vppInputs.clear();
+    m_pendingWorks.clear();
+
+    m_c2Allocator.reset();
+
+    if (m_device) {
+        std::shared_ptr<MfxFrameConverter> frame_converter = m_device->GetFrameConverter();
+        if (frame_converter) frame_converter->FreeAllMappings();
+    }
+
+    return C2_OK;
+}
+
+c2_status_t MfxC2VppComponent::Release()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t res = C2_OK;
+    mfxStatus sts = MFX_ERR_NONE;
+
+    FreeVpp();
+
+#ifdef USE_ONEVPL
+    if (m_mfxSession) {
+        sts = MFXClose(m_mfxSession);
+        m_mfxSession = nullptr;
+    }
+#else
+    sts = m_mfxSession.Close();
+#endif
+
+    if (MFX_ERR_NONE != sts) res = MfxStatusToC2(sts);
+
+    if (m_device) {
+        m_device->Close();
+        m_device = nullptr;
+    }
+
+#ifdef USE_ONEVPL
+    if (m_mfxLoader) {
+        MFXUnload(m_mfxLoader);
+        m_mfxLoader = nullptr;
+    }
+#endif
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+#ifdef USE_ONEVPL
+mfxStatus MfxC2VppComponent::InitSession()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+    mfxConfig cfg[2];
+    mfxVariant cfgVal[2];
+
+    if (nullptr == m_mfxLoader)
+        m_mfxLoader = MFXLoad();
+
+    if (nullptr == m_mfxLoader) {
+        ALOGE("MFXLoad failed...is implementation in path?");
+        return MFX_ERR_UNKNOWN;
+    }
+
+    /* Create configurations for implementation */
+    cfg[0] = MFXCreateConfig(m_mfxLoader);
+    if (!cfg[0]) {
+        ALOGE("Failed to create a MFX configuration");
+        return MFX_ERR_UNKNOWN;
+    }
+
+    cfgVal[0].Type = MFX_VARIANT_TYPE_U32;
+    cfgVal[0].Data.U32 = (m_mfxImplementation == MFX_IMPL_SOFTWARE) ? MFX_IMPL_TYPE_SOFTWARE : MFX_IMPL_TYPE_HARDWARE;
+    mfx_res = MFXSetConfigFilterProperty(cfg[0], (const mfxU8 *) "mfxImplDescription.Impl", cfgVal[0]);
+    if (MFX_ERR_NONE != mfx_res) {
+        ALOGE("Failed to add an additional MFX configuration (%d)", mfx_res);
+        return MFX_ERR_UNKNOWN;
+    }
+
+    cfg[1] = MFXCreateConfig(m_mfxLoader);
+    if (!cfg[1]) {
+        ALOGE("Failed to create a MFX configuration");
+        return MFX_ERR_UNKNOWN;
+    }
+
+    cfgVal[1].Type = MFX_VARIANT_TYPE_U32;
+    cfgVal[1].Data.U32 = MFX_VERSION;
+    mfx_res = MFXSetConfigFilterProperty(cfg[1], (const mfxU8 *) "mfxImplDescription.ApiVersion.Version", cfgVal[1]);
+    if (MFX_ERR_NONE != mfx_res) {
+        ALOGE("Failed to add an additional MFX configuration (%d)", mfx_res);
+        return MFX_ERR_UNKNOWN;
+    }
+
+    for (uint32_t idx = 0; ; ++idx) {
+        /* Enumerate all implementations */
+        mfxImplDescription *idesc;
+        mfx_res = MFXEnumImplementations(m_mfxLoader, idx, MFX_IMPLCAPS_IMPLDESCSTRUCTURE, (mfxHDL *)&idesc);
+
+        if (MFX_ERR_NOT_FOUND == mfx_res) {
+            /* Failed to find an available implementation */
+            break;
+        }
+        else if (MFX_ERR_NONE != mfx_res) {
+            /*implementation found, but requested query format is not supported*/
+            continue;
+        }
+
+        mfx_res = MFXCreateSession(m_mfxLoader, idx, &m_mfxSession);
+
+        MFXDispReleaseImplDescription(m_mfxLoader, idesc);
+
+        if (MFX_ERR_NONE == mfx_res)
+            break;
+    }
+
+    if (MFX_ERR_NONE != mfx_res) {
+        MFX_LOG_ERROR("Failed to create a MFX session (%d)", mfx_res);
+        return mfx_res;
+    }
+
+    mfx_res = m_device->InitMfxSession(m_mfxSession);
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+
+#else
+mfxStatus MfxC2VppComponent::InitSession()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    mfxStatus mfx_res = MFX_ERR_NONE;
+
+    do {
+        mfx_res = m_mfxSession.Init(m_mfxImplementation, &g_required_mfx_version);
+        if (MFX_ERR_NONE != mfx_res) {
+            MFX_DEBUG_TRACE_MSG("MFXVideoSession::Init failed");
+            break;
+        }
+
+        mfx_res = m_mfxSession.QueryIMPL(&m_mfxImplementation);
+        if (MFX_ERR_NONE != mfx_res) break;
+        MFX_DEBUG_TRACE_I32(m_mfxImplementation);
+
+        mfx_res = m_device->InitMfxSession(&m_mfxSession);
+
+    } while (false);
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+#endif
+
+mfxStatus MfxC2VppComponent::InitVpp(const mfxFrameInfo& in_info, const VppConfig& config)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_vppInInfo = in_info;
+
+    uint32_t out_width = config.width ? config.width : in_info.CropW;
+    uint32_t out_height = config.height ? config.height : in_info.CropH;
+
+    MFX_ZERO_MEMORY(m_vppOutInfo);
+    m_vppOutInfo.Width = MFX_ALIGN_16(out_width);
+    m_vppOutInfo.Height = MFX_ALIGN_16(out_height);
+    m_vppOutInfo.CropW = out_width;
+    m_vppOutInfo.CropH = out_height;
+    m_vppOutInfo.PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+    SetFrameFormat(config.fourcc, &m_vppOutInfo);
+
+    m_extBuffers.clear();
+
+    bool signal_info_set = config.in_matrix != MFX_TRANSFERMATRIX_UNKNOWN ||
+        config.in_range != MFX_NOMINALRANGE_UNKNOWN ||
+        config.out_matrix != MFX_TRANSFERMATRIX_UNKNOWN ||
+        config.out_range != MFX_NOMINALRANGE_UNKNOWN;
+    if (signal_info_set) {
+        MFX_ZERO_MEMORY(m_signalInfo);
+        m_signalInfo.Header.BufferId = MFX_EXTBUFF_VPP_VIDEO_SIGNAL_INFO;
+        m_signalInfo.Header.BufferSz = sizeof(m_signalInfo);
+        m_signalInfo.In.TransferMatrix = config.in_matrix;
+        m_signalInfo.In.NominalRange = config.in_range;
+        m_signalInfo.Out.TransferMatrix = config.out_matrix;
+        m_signalInfo.Out.NominalRange = config.out_range;
+        m_extBuffers.push_back(&m_signalInfo.Header);
+    }
+
+    if (config.deinterlace) {
+        MFX_ZERO_MEMORY(m_deinterlacing);
+        m_deinterlacing.Header.BufferId = MFX_EXTBUFF_VPP_DEINTERLACING;
+        m_deinterlacing.Header.BufferSz = sizeof(m_deinterlacing);
+        m_deinterlacing.Mode = MFX_DEINTERLACING_ADVANCED;
+        m_extBuffers.push_back(&m_deinterlacing.Header);
+    }
+
+    MfxC2VppWrappParam param;
+#ifdef USE_ONEVPL
+    param.session = m_mfxSession;
+#else
+    param.session = &m_mfxSession;
+#endif
+    param.frame_info = &m_vppInInfo;
+    param.out_frame_info = &m_vppOutInfo;
+    param.allocator = m_device->GetFrameAllocator();
+    param.conversion = CONVERT_NONE;
+    param.ext_buffers = m_extBuffers.empty() ? nullptr : m_extBuffers.data();
+    param.num_ext_buffers = m_extBuffers.size();
+    param.external_out_surfaces = true;
+
+    mfxStatus mfx_res = m_vpp.Init(&param);
+    m_bVppInitialized = (MFX_ERR_NONE == mfx_res);
+    if (m_bVppInitialized) m_vppActiveConfig = config;
+
+    MFX_DEBUG_TRACE__mfxStatus(mfx_res);
+    return mfx_res;
+}
+
+void MfxC2VppComponent::FreeVpp()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (m_bVppInitialized) {
+        m_vpp.Close();
+        m_bVppInitialized = false;
+    }
+}
+
+c2_status_t MfxC2VppComponent::ImportGraphicBlock(const C2Handle* handle, mfxMemId* mem_id)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    native_handle_t *gralloc_handle = android::UnwrapNativeCodec2GrallocHandle(handle);
+    if (!gralloc_handle) return C2_CORRUPTED;
+
+    // Mappings are cached by allocator and freed on stop.
+    mfxStatus mfx_sts = m_device->GetFrameConverter()->ConvertGrallocToVa(gralloc_handle,
+        false/*decode_target*/, mem_id);
+
+    native_handle_delete(gralloc_handle);
+
+    return MfxStatusToC2(mfx_sts);
+}
+
+c2_status_t MfxC2VppComponent::AllocateOutput(const VppConfig& config,
+    std::shared_ptr<C2GraphicBlock>* block)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t res = C2_OK;
+
+    do {
+        if (!m_c2Allocator) {
+            res = GetCodec2BlockPool(config.output_pool_id, shared_from_this(), &m_c2Allocator);
+            if (C2_OK != res) break;
+        }
+
+        C2MemoryUsage mem_usage = {
+            C2AndroidMemoryUsage::HW_CODEC_READ, C2AndroidMemoryUsage::HW_CODEC_WRITE };
+
+        res = m_c2Allocator->fetchGraphicBlock(m_vppOutInfo.CropW, m_vppOutInfo.CropH,
+            MfxFourCCToGralloc(m_vppOutInfo.FourCC), mem_usage, block);
+    } while (false);
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+void MfxC2VppComponent::DoWork(std::unique_ptr<C2Work>&& work)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_BINARY_TRACE_FUNC;
+    MFX_DEBUG_TRACE_P(work.get());
+
+    c2_status_t res = C2_OK;
+    bool eos = (work->input.flags & C2FrameData::FLAG_END_OF_STREAM) != 0;
+
+    do {
+        if (work->worklets.empty()) {
+            res = C2_BAD_VALUE;
+            break;
+        }
+
+        const C2FrameData& input = work->input;
+
+        std::unique_ptr<C2ConstGraphicBlock> in_block;
+        res = GetC2ConstGraphicBlock(input, &in_block);
+        if (C2_OK != res) break;
+
+        uint32_t width, height, format, stride, igbp_slot, generation;
+        uint64_t usage, igbp_id;
+        android::_UnwrapNativeCodec2GrallocMetadata(in_block->handle(), &width, &height, &format, &usage,
+                                                &stride, &generation, &igbp_id, &igbp_slot);
+
+        mfxU32 in_fourcc = GrallocToMfxFourCC(format);
+        if (!in_fourcc) {
+            MFX_DEBUG_TRACE_U32(format);
+            res = C2_BAD_VALUE;
+            break;
+        }
+
+        VppConfig config;
+        uint32_t config_generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_configMutex);
+            config = m_vppConfig;
+            config_generation = m_uConfigGeneration;
+        }
+
+        mfxFrameInfo in_info;
+        MFX_ZERO_MEMORY(in_info);
+        in_info.Width = MFX_ALIGN_16(in_block->width());
+        in_info.Height = config.deinterlace ?
+            MFX_ALIGN_32(in_block->height()) : MFX_ALIGN_16(in_block->height());
+        in_info.CropW = in_block->width();
+        in_info.CropH = in_block->height();
+        in_info.FrameRateExtN = MFX_VPP_FRAME_RATE;
+        in_info.FrameRateExtD = 1;
+        if (config.deinterlace) {
+            in_info.PicStruct = config.bottom_field_first ? MFX_PICSTRUCT_FIELD_BFF : MFX_PICSTRUCT_FIELD_TFF;
+        } else {
+            in_info.PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+        }
+        SetFrameFormat(in_fourcc, &in_info);
+
+        bool reinit = !m_bVppInitialized || config_generation != m_uVppGeneration ||
+            memcmp(&in_info, &m_vppInInfo, sizeof(mfxFrameInfo));
+        if (reinit) {
+            // frames buffered with previous parameters go out first
+            DrainVpp();
+
+            if (config.output_pool_id != m_vppActiveConfig.output_pool_id) m_c2Allocator.reset();
+
+            mfxStatus mfx_sts = InitVpp(in_info, config);
+            if (MFX_ERR_NONE != mfx_sts) {
+                res = MfxStatusToC2(mfx_sts);
+                break;
+            }
+            m_uVppGeneration = config_generation;
+        }
+
+        mfxMemId in_mem_id = nullptr;
+        res = ImportGraphicBlock(in_block->handle(), &in_mem_id);
+        if (C2_OK != res) break;
+
+        m_vppInputs.emplace_back();
+        VppInput& vpp_input = m_vppInputs.back();
+        vpp_input.block = std::move(in_block);
+
+        InitMfxFrameHW(input.ordinal.timestamp.peeku(), input.ordinal.frameIndex.peeku(),
+            in_mem_id, in_info.CropW, in_info.CropH, in_fourcc, m_vppInInfo, &vpp_input.surface);
+        // InitMfxFrameHW resets surface data, VPP passes timestamp on to the output.
+        vpp_input.surface.Data.TimeStamp = TimestampC2ToMfx(input.ordinal.timestamp.peeku());
+        vpp_input.surface.Data.FrameOrder = input.ordinal.frameIndex.peeku();
+
+        m_pendingWorks.push_back(std::move(work));
+
+        bool output_ready = false;
+        res = ProcessFrame(&vpp_input.surface, &output_ready);
+        if (C2_OK != res) {
+            // no output for failed frame, it is the last pending one
+            work = std::move(m_pendingWorks.back());
+            m_pendingWorks.pop_back();
+        }
+    } while (false);
+
+    m_vppInputs.remove_if([] (const VppInput& vpp_input) {
+        return 0 == vpp_input.surface.Data.Locked;
+    });
+
+    if (eos) DrainVpp();
+
+    if (work) ReturnEmptyWork(std::move(work), res);
+}
+
+c2_status_t MfxC2VppComponent::ProcessFrame(mfxFrameSurface1* in_surface, bool* output_ready)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t res = C2_OK;
+    *output_ready = false;
+
+    do {
+        std::shared_ptr<C2GraphicBlock> out_block;
+        res = AllocateOutput(m_vppActiveConfig, &out_block);
+        if (C2_OK != res) break;
+
+        mfxMemId out_mem_id = nullptr;
+        res = ImportGraphicBlock(out_block->handle(), &out_mem_id);
+        if (C2_OK != res) break;
+
+        // Output timestamp is set by VPP.
+        mfxFrameSurface1 out_surface {};
+        InitMfxFrameHW(0, 0, out_mem_id, m_vppOutInfo.CropW, m_vppOutInfo.CropH, m_vppOutInfo.FourCC,
+            m_vppOutInfo, &out_surface);
+
+        mfxStatus mfx_sts = MFX_ERR_NONE;
+        {
+            MFX_BINARY_TRACE_SCOPE("RunFrameVPP");
+            mfx_sts = m_vpp.ProcessFrameVpp(in_surface, &out_surface);
+        }
+        // deinterlacer may need the next frame before the output, or has nothing left to drain
+        if (MFX_ERR_MORE_DATA == mfx_sts) break;
+        if (MFX_ERR_NONE != mfx_sts) {
+            MFX_DEBUG_TRACE__mfxStatus(mfx_sts);
+            res = MfxStatusToC2(mfx_sts);
+            break;
+        }
+
+        *output_ready = true;
+        ReturnOutput(std::move(out_block), out_surface.Data.TimeStamp);
+    } while (false);
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+void MfxC2VppComponent::ReturnOutput(std::shared_ptr<C2GraphicBlock>&& out_block, mfxU64 timestamp)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_DEBUG_TRACE_I64(timestamp);
+
+    auto it = std::find_if(m_pendingWorks.begin(), m_pendingWorks.end(),
+        [timestamp] (const std::unique_ptr<C2Work>& work) {
+            return TimestampC2ToMfx(work->input.ordinal.timestamp.peeku()) == timestamp;
+        });
+    // VPP keeps frames order, the oldest work is taken if timestamp is not found
+    if (it == m_pendingWorks.end()) it = m_pendingWorks.begin();
+    if (it == m_pendingWorks.end()) {
+        MFX_DEBUG_TRACE_MSG("no pending work for output");
+        return;
+    }
+
+    std::unique_ptr<C2Work> work = std::move(*it);
+    m_pendingWorks.erase(it);
+
+    std::unique_ptr<C2Worklet>& worklet = work->worklets.front();
+    // Pass end of stream flag only.
+    worklet->output.flags = (C2FrameData::flags_t)(work->input.flags & C2FrameData::FLAG_END_OF_STREAM);
+    worklet->output.ordinal = work->input.ordinal;
+    worklet->output.buffers.push_back(CreateGraphicBuffer(std::move(out_block),
+        C2Rect(m_vppOutInfo.CropW, m_vppOutInfo.CropH)));
+
+    NotifyWorkDone(std::move(work), C2_OK);
+}
+
+void MfxC2VppComponent::DrainVpp()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    bool output_ready = m_bVppInitialized;
+    while (output_ready) {
+        if (C2_OK != ProcessFrame(nullptr, &output_ready)) break;
+    }
+
+    // works VPP produced no output for
+    for (std::unique_ptr<C2Work>& work : m_pendingWorks) {
+        ReturnEmptyWork(std::move(work), C2_OK);
+    }
+    m_pendingWorks.clear();
+
+    // Next frame starts VPP over, inputs are unlocked on close.
+    FreeVpp();
+    m_vppInputs.clear();
+}
+
+void MfxC2VppComponent::ReturnEmptyWork(std::unique_ptr<C2Work>&& work, c2_status_t res)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (work->worklets.size() > 0) {
+        std::unique_ptr<C2Worklet>& worklet = work->worklets.front();
+        // Pass end of stream flag only
+        worklet->output.flags = (C2FrameData::flags_t)(work->input.flags & C2FrameData::FLAG_END_OF_STREAM);
+        worklet->output.buffers.clear();
+        worklet->output.ordinal = work->input.ordinal;
+    }
+
+    NotifyWorkDone(std::move(work), res);
+}
+
+c2_status_t MfxC2VppComponent::UpdateMfxParamToC2(
+    std::unique_lock<std::mutex> state_lock,
+    const std::vector<C2Param*> &stackParams,
+    const std::vector<C2Param::Index> &heapParamIndices,
+    c2_blocking_t mayBlock,
+    std::vector<std::unique_ptr<C2Param>>* const heapParams) const
+{
+    (void)state_lock;
+    (void)stackParams;
+    (void)heapParamIndices;
+    (void)mayBlock;
+    (void)heapParams;
+
+    MFX_DEBUG_TRACE_FUNC;
+
+    // VPP doesn't change its parameters, they are served as configured.
+    return C2_OK;
+}
+
+c2_status_t MfxC2VppComponent::UpdateC2ParamToMfx(std::unique_lock<std::mutex> state_lock,
+    const std::vector<C2Param*> &params,
+    c2_blocking_t mayBlock,
+    std::vector<std::unique_ptr<C2SettingResult>>* const failures)
+{
+    (void)state_lock;
+    (void)mayBlock;
+
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (nullptr == failures) return C2_CORRUPTED;
+
+    // failures keep the results of parameters validation done by interface helper
+    std::lock_guard<std::mutex> lock(m_configMutex);
+
+    VppConfig config = m_vppConfig;
+
+    for (const C2Param* param : params) {
+        switch (C2Param::Type(param->type()).typeIndex()) {
+            case kParamIndexPictureSize: {
+                config.width = m_size->width;
+                config.height = m_size->height;
+                MFX_DEBUG_TRACE_STREAM(NAMED(config.width) << NAMED(config.height));
+                break;
+            }
+            case kParamIndexPixelFormat: {
+                config.fourcc = GrallocToMfxFourCC(m_pixelFormat->value);
+                MFX_DEBUG_TRACE_U32(config.fourcc);
+                break;
+            }
+            case kParamIndexColorAspects: {
+                if (C2StreamColorAspectsInfo::input::PARAM_TYPE == param->index()) {
+                    config.in_matrix = MatrixC2ToMfx(m_colorAspects->matrix);
+                    config.in_range = RangeC2ToMfx(m_colorAspects->range);
+                } else {
+                    config.out_matrix = MatrixC2ToMfx(m_outColorAspects->matrix);
+                    config.out_range = RangeC2ToMfx(m_outColorAspects->range);
+                }
+                break;
+            }
+            case kParamIndexDeinterlace: {
+                config.deinterlace = m_deinterlace->value;
+                MFX_DEBUG_TRACE_I32(config.deinterlace);
+                break;
+            }
+            case kParamIndexBottomFieldFirst: {
+                config.bottom_field_first = m_bottomFieldFirst->value;
+                MFX_DEBUG_TRACE_I32(config.bottom_field_first);
+                break;
+            }
+            case kParamIndexBlockPools: {
+                if (m_outputPoolIds && m_outputPoolIds->flexCount() >= 1) {
+                    config.output_pool_id = m_outputPoolIds->m.values[0];
+                } else {
+                    failures->push_back(MakeC2SettingResult(C2ParamField(param), C2SettingResult::BAD_VALUE));
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    if (config != m_vppConfig) {
+        // takes effect on the next frame
+        m_vppConfig = config;
+        ++m_uConfigGeneration;
+    }
+
+    c2_status_t res = GetAggregateStatus(failures);
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+c2_status_t MfxC2VppComponent::Queue(std::list<std::unique_ptr<C2Work>>* const items)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    for (auto& work : *items) {
+
+        bool empty = (work->input.buffers.size() == 0);
+        MFX_DEBUG_TRACE_STREAM(NAMED(empty));
+
+        // Empty works go through the queue too to keep output order.
+        m_workingQueue.Push( [ work = std::move(work), empty, this ] () mutable {
+            if (m_bFlushing) {
+                m_flushedWorks.push_back(std::move(work));
+            } else if (empty) {
+                // frames buffered by VPP go out before end of stream
+                if (work->input.flags & C2FrameData::FLAG_END_OF_STREAM) DrainVpp();
+                ReturnEmptyWork(std::move(work), C2_OK);
+            } else {
+                MFX_BINARY_TRACE_FRAME(work->input.ordinal.frameIndex.peeku());
+                DoWork(std::move(work));
+            }
+        } );
+    }
+
+    return C2_OK;
+}
+
+c2_status_t MfxC2VppComponent::Flush(std::list<std::unique_ptr<C2Work>>* const flushedWork)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_bFlushing = true;
+
+    m_workingQueue.Push([this] () {
+        MFX_DEBUG_TRACE("VppReset");
+        // Frames buffered by VPP belong to flushed works, VPP is reinitialized on the next frame.
+        FreeVpp();
+        m_vppInputs.clear();
+
+        for (std::unique_ptr<C2Work>& work : m_pendingWorks) {
+            m_flushedWorks.push_back(std::move(work));
+        }
+        m_pendingWorks.clear();
+    } );
+
+    // Wait to have no works queued between Queue and DoWork.
+    m_workingQueue.WaitForEmpty();
+    // queue_nb is not called simultaneously with flush_sm, so working thread is idle now
+    // and m_flushedWorks can be accessed without lock.
+    m_bFlushing = false;
+
+    if (flushedWork) {
+        *flushedWork = std::move(m_flushedWorks);
+    }
+    m_flushedWorks.clear();
+
+    return C2_OK;
+}
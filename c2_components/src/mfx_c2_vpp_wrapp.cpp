@@ -69,14 +69,14 @@ mfxStatus MfxC2VppWrapp::Init(MfxC2VppWrappParam *param)
 
         if(!m_pVpp) sts = MFX_ERR_UNKNOWN;
 
-        if (MFX_ERR_NONE == sts) sts = FillVppParams(param->frame_info, param->conversion);
+        if (MFX_ERR_NONE == sts) sts = FillVppParams(param);
         MFX_DEBUG_TRACE__mfxFrameInfo(m_vppParam.vpp.In);
         MFX_DEBUG_TRACE__mfxFrameInfo(m_vppParam.vpp.Out);
 
         if (MFX_ERR_NONE == sts) sts = m_pVpp->Init(&m_vppParam);
     }
 
-    if (MFX_ERR_NONE == sts) sts = AllocateOneSurface();
+    if (MFX_ERR_NONE == sts && !param->external_out_surfaces) sts = AllocateOneSurface();
 
     if (MFX_ERR_NONE != sts) Close();
 
@@ -119,11 +119,15 @@ mfxStatus MfxC2VppWrapp::Close(void)
     return sts;
 }
 
-mfxStatus MfxC2VppWrapp::FillVppParams(mfxFrameInfo *frame_info, MfxC2Conversion conversion)
+mfxStatus MfxC2VppWrapp::FillVppParams(MfxC2VppWrappParam *param)
 {
     MFX_DEBUG_TRACE_FUNC;
     mfxStatus sts = MFX_ERR_NONE;
 
+    mfxFrameInfo *frame_info = param->frame_info;
+    mfxFrameInfo *out_frame_info = param->out_frame_info;
+    MfxC2Conversion conversion = param->conversion;
+
     if (!frame_info) sts = MFX_ERR_NULL_PTR;
 
     if (MFX_ERR_NONE == sts)
@@ -133,6 +137,29 @@ mfxStatus MfxC2VppWrapp::FillVppParams(mfxFrameInfo *frame_info, MfxC2Conversion
         m_vppParam.IOPattern = MFX_IOPATTERN_IN_VIDEO_MEMORY | MFX_IOPATTERN_OUT_VIDEO_MEMORY;
         m_vppParam.vpp.In = *frame_info;
         m_vppParam.vpp.Out = *frame_info;
+        m_vppParam.ExtParam = param->ext_buffers;
+        m_vppParam.NumExtParam = param->num_ext_buffers;
+
+        if (out_frame_info)
+        {
+            m_vppParam.vpp.Out.Width = out_frame_info->Width;
+            m_vppParam.vpp.Out.Height = out_frame_info->Height;
+            m_vppParam.vpp.Out.CropX = out_frame_info->CropX;
+            m_vppParam.vpp.Out.CropY = out_frame_info->CropY;
+            m_vppParam.vpp.Out.CropW = out_frame_info->CropW;
+            m_vppParam.vpp.Out.CropH = out_frame_info->CropH;
+
+            if (out_frame_info->FourCC)
+            {
+                m_vppParam.vpp.Out.FourCC = out_frame_info->FourCC;
+                m_vppParam.vpp.Out.ChromaFormat = out_frame_info->ChromaFormat;
+                m_vppParam.vpp.Out.BitDepthLuma = out_frame_info->BitDepthLuma;
+                m_vppParam.vpp.Out.BitDepthChroma = out_frame_info->BitDepthChroma;
+                m_vppParam.vpp.Out.Shift = out_frame_info->Shift;
+            }
+            if (out_frame_info->PicStruct)
+                m_vppParam.vpp.Out.PicStruct = out_frame_info->PicStruct;
+        }
 
         switch (conversion)
         {
@@ -198,7 +225,6 @@ mfxStatus MfxC2VppWrapp::ProcessFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurfa
     MFX_DEBUG_TRACE_FUNC;
     mfxStatus sts = MFX_ERR_NONE;
     mfxFrameSurface1* outSurface = NULL;
-    mfxSyncPoint syncp;
 
     if (!in_srf || !out_srf) return MFX_ERR_UNKNOWN;
 
@@ -217,16 +243,7 @@ mfxStatus MfxC2VppWrapp::ProcessFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurfa
         if (MFX_ERR_NONE == sts) outSurface = &m_vppSrf[m_uVppSurfaceCount-1]; // just created outSurface
     }
 
-    if (outSurface)
-    {
-        sts = m_pVpp->RunFrameVPPAsync(in_srf, outSurface, NULL, &syncp);
-        if (MFX_ERR_NONE == sts)
-#ifdef USE_ONEVPL
-            sts = MFXVideoCORE_SyncOperation(m_mfxSession, syncp, MFX_TIMEOUT_INFINITE);
-#else
-            sts = m_pSession->SyncOperation(syncp, MFX_TIMEOUT_INFINITE);
-#endif
-    }
+    if (outSurface) sts = RunFrameVpp(in_srf, outSurface);
     else sts = MFX_ERR_MORE_SURFACE;
 
     if (MFX_ERR_NONE == sts)
@@ -236,4 +253,34 @@ mfxStatus MfxC2VppWrapp::ProcessFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurfa
 
     MFX_DEBUG_TRACE_I32(sts);
     return sts;
-}
\ No newline at end of file
+}
+
+mfxStatus MfxC2VppWrapp::ProcessFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurface1 *out_srf)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!out_srf) return MFX_ERR_UNKNOWN;
+    if (!m_pVpp) return MFX_ERR_NOT_INITIALIZED;
+
+    mfxStatus sts = RunFrameVpp(in_srf, out_srf);
+
+    MFX_DEBUG_TRACE_I32(sts);
+    return sts;
+}
+
+mfxStatus MfxC2VppWrapp::RunFrameVpp(mfxFrameSurface1 *in_srf, mfxFrameSurface1 *out_srf)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    mfxSyncPoint syncp;
+
+    mfxStatus sts = m_pVpp->RunFrameVPPAsync(in_srf, out_srf, NULL, &syncp);
+    if (MFX_ERR_NONE == sts)
+#ifdef USE_ONEVPL
+        sts = MFXVideoCORE_SyncOperation(m_mfxSession, syncp, MFX_TIMEOUT_INFINITE);
+#else
+        sts = m_pSession->SyncOperation(syncp, MFX_TIMEOUT_INFINITE);
+#endif
+
+    MFX_DEBUG_TRACE_I32(sts);
+    return sts;
+}
@@ -24,9 +24,11 @@
 #include "mfx_c2_xml_parser.h"
 
 #include <map>
+#include <mutex>
 
 #include "mfx_c2_component.h"
 #include "mfx_c2_param_reflector.h"
+#include "mfx_c2_store_capacity.h"
 
 using namespace android;
 
@@ -34,6 +36,19 @@ class MfxC2ComponentStore : public C2ComponentStore {
 public:
     static MfxC2ComponentStore* Create(c2_status_t* status);
 
+    // Prints runtime metrics of all loaded components modules.
+    void DumpMetrics(std::ostream& os);
+
+    // Switches binary trace of the store and all loaded components modules.
+    void EnableBinaryTrace(bool enable);
+
+    // Saves binary traces into MFX_C2_DUMP_DIR, one file per module, prints file names.
+    // Traces are saved as Chrome trace-event JSON if json is set.
+    void SaveBinaryTrace(std::ostream& os, bool json);
+
+private:
+    MfxC2ComponentStore();
+
 private: // C2ComponentStore overrides
     C2String getName() const override;
 
@@ -66,6 +81,24 @@ private: // C2ComponentStore overrides
 private: // implementation methods
     c2_status_t readConfigFile();
     c2_status_t readXmlConfigFile();
+    // Fills registry from the table built in from c2_store/data.
+    c2_status_t readBuiltinConfig();
+    // Merges configuration files into registry once, on the first lookup or listing.
+    void loadConfigFiles();
+
+    c2_status_t createMfxComponent(const C2String& name, bool interface_only,
+        std::shared_ptr<MfxC2Component>* const component);
+
+    struct ModuleDesc {
+        // closes the module when neither store nor its components need it
+        std::shared_ptr<void> dso_;
+        CreateMfxC2ComponentFunc* create_func_ { nullptr };
+        DumpMfxC2MetricsFunc* dump_metrics_func_ { nullptr }; // optional
+        EnableMfxC2BinaryTraceFunc* enable_trace_func_ { nullptr }; // optional
+        SaveMfxC2BinaryTraceFunc* save_trace_func_ { nullptr }; // optional
+    };
+    // Loads module once, then returns cached handle and factory function.
+    c2_status_t getModule(const std::string& name, ModuleDesc* module);
 
     void* loadModule(const std::string& name);
 private: // data
@@ -85,11 +118,31 @@ private: // data
     };
     // this is a map between component names and component descriptions:
     //   (component's config, dso name, etc.)
-    // no mutexed access needed as written only once before any read access
+    // no mutexed access needed as written only on creation and within m_configFilesOnce,
+    // which every read access passes first
     std::map<std::string, ComponentDesc> m_componentsRegistry_;
+    std::once_flag m_configFilesOnce;
 
     MfxXmlParser m_xmlParser;
 
+    // vendor.intel.video.codec property is "software", read once on store creation
+    bool m_bSoftwareCodecOnly { false };
+
+    enum class AdmissionMode {
+        OFF,
+        FLAG, // overcommit is only logged
+        REJECT, // components exceeding capacity are not created
+    };
+    // vendor.intel.video.c2.admission property: "off", "flag" (default) or "reject"
+    AdmissionMode m_admissionMode { AdmissionMode::FLAG };
+
+    // Passed to created components, null if admission is off or no performance data.
+    std::shared_ptr<MfxC2StoreAdmission> m_admission;
+
+    // modules loaded by dso name, kept for the store lifetime
+    std::map<std::string, ModuleDesc> m_modules;
+    std::mutex m_modulesMutex;
+
     std::shared_ptr<C2ReflectorHelper> m_reflector = std::make_shared<C2ReflectorHelper>();
     mutable std::mutex m_reflectorMutex;
 };
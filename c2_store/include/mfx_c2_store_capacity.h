@@ -0,0 +1,72 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <C2Component.h>
+#include "mfx_c2_component.h"
+#include "mfx_c2_xml_parser.h"
+
+#include <map>
+#include <mutex>
+
+// Estimates share of the hardware taken by components from frame rates
+// measured for them, see media_codecs_performance xml.
+// Load of 1.0 means the component at given resolution and frame rate
+// runs as fast as the measured one. All components share the same GPU,
+// so loads of decoders and encoders are summed up to get the total.
+class MfxC2StoreCapacity
+{
+public:
+    c2_status_t ReadConfig(const char* path);
+
+    bool IsEnabled() const { return m_bEnabled; }
+
+    // Returns 0 if nothing is known about the component.
+    float GetLoad(const char* name, uint32_t width, uint32_t height, float frame_rate);
+
+    // Gets resolution and frame rate the component is configured with, then its load.
+    float GetLoad(const char* name, C2ComponentInterface* component);
+
+private:
+    MfxXmlParser m_xmlParser;
+    bool m_bEnabled { false };
+};
+
+// Admits components on start while total load of started ones fits into capacity.
+// Components keep it by shared_ptr, so it may outlive the store.
+class MfxC2StoreAdmission : public MfxC2Component::Admission
+{
+public:
+    // Overcommit is only logged unless reject is set.
+    MfxC2StoreAdmission(std::unique_ptr<MfxC2StoreCapacity>&& capacity, bool reject):
+        m_capacity(std::move(capacity)), m_bReject(reject) {}
+
+    c2_status_t Admit(MfxC2Component* component) override;
+
+    void Leave(MfxC2Component* component) override;
+
+private:
+    std::unique_ptr<MfxC2StoreCapacity> m_capacity;
+    bool m_bReject { false };
+    // Loads of started components, evaluated on their start.
+    std::map<const MfxC2Component*, float> m_startedLoads;
+    std::mutex m_startedLoadsMutex;
+};
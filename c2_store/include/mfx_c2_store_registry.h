@@ -0,0 +1,42 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <C2Component.h>
+
+#include "mfx_defs.h"
+
+// Component description as it is read from mfx_c2_store.conf and media codecs xml.
+struct MfxC2StoreComponentEntry
+{
+    const char* name;
+    const char* dso_name;
+    const char* media_type;
+    C2Component::kind_t kind;
+    int flags;
+    bool dump_output;
+};
+
+// Built-in components table generated from c2_store/data by _tools/store_conf_to_cpp.py.
+// The store always starts from it, configuration files found on the device override its entries.
+extern const MfxC2StoreComponentEntry g_mfxC2StoreComponents[];
+extern const size_t g_mfxC2StoreComponentsCount;
@@ -52,6 +52,9 @@
 
 #include <C2Component.h>
 
+#include <sstream>
+#include <unistd.h>
+
 // This is created by module "codec2.vendor.base.policy". This can be modified.
 static constexpr char kBaseSeccompPolicyPath[] =
         "/vendor/etc/seccomp_policy/android.hardware.media.c2@1.0-vendor.policy";
@@ -60,18 +63,60 @@ static constexpr char kBaseSeccompPolicyPath[] =
 static constexpr char kExtSeccompPolicyPath[] =
         "/vendor/etc/seccomp_policy/android.hardware.media.c2@1.0-vendor.ext.policy";
 
+using namespace ::android::hardware::media::c2::V1_0;
+
+// Appends runtime metrics of the components to the store dump printed by
+// lshal debug android.hardware.media.c2@1.0::IComponentStore/default
+// Arguments trace-on, trace-off and trace-save switch and save binary trace,
+// trace-save-json saves it as Chrome trace-event JSON, see mfx_binary_trace.h.
+class MfxComponentStore : public utils::ComponentStore
+{
+public:
+    explicit MfxComponentStore(std::shared_ptr<MfxC2ComponentStore> store)
+        : utils::ComponentStore(store), m_store(std::move(store)) {}
+
+    ::android::hardware::Return<void> debug(const ::android::hardware::hidl_handle& handle,
+        const ::android::hardware::hidl_vec<::android::hardware::hidl_string>& args) override
+    {
+        ::android::hardware::Return<void> res = utils::ComponentStore::debug(handle, args);
+
+        if (handle != nullptr && handle->numFds >= 1) {
+            std::ostringstream ss;
+            for (const auto& arg : args) {
+                if (arg == "trace-on" || arg == "trace-off") {
+                    m_store->EnableBinaryTrace(arg == "trace-on");
+                    ss << std::endl << "MFX C2 binary " << arg.c_str() << std::endl;
+                } else if (arg == "trace-save" || arg == "trace-save-json") {
+                    ss << std::endl << "MFX C2 binary traces:" << std::endl;
+                    m_store->SaveBinaryTrace(ss, arg == "trace-save-json");
+                }
+            }
+            ss << std::endl << "MFX C2 metrics:" << std::endl;
+            m_store->DumpMetrics(ss);
+
+            const std::string dump = ss.str();
+            if (write(handle->data[0], dump.c_str(), dump.size()) < 0) {
+                ALOGE("Cannot write metrics dump");
+            }
+        }
+        return res;
+    }
+
+private:
+    std::shared_ptr<MfxC2ComponentStore> m_store;
+};
+
 // Create and register IComponentStore service.
 void RegisterC2Service()
 {
-    using namespace ::android::hardware::media::c2::V1_0;
     android::sp<IComponentStore> store;
 
     ALOGD("Instantiating MFX IComponentStore service...");
 
     c2_status_t status = C2_OK;
-    std::shared_ptr<C2ComponentStore> c2_store(MfxC2ComponentStore::Create(&status));
+    std::shared_ptr<MfxC2ComponentStore> c2_store(MfxC2ComponentStore::Create(&status));
     if (c2_store) {
-        store = new utils::ComponentStore(c2_store);
+        store = new MfxComponentStore(c2_store);
     } else {
         ALOGD("Creation MFX IComponentStore failed with status: %d", (int)status);
     }
@@ -19,15 +19,18 @@
 // SOFTWARE.
 
 #include "mfx_c2_store.h"
+#include "mfx_c2_store_registry.h"
 #include "mfx_defs.h"
 #include "mfx_c2_defs.h"
 #include "mfx_debug.h"
 #include "mfx_c2_debug.h"
 #include "mfx_c2_component.h"
+#include "mfx_binary_trace.h"
 #include <cutils/properties.h>
 
 #include <dlfcn.h>
 #include <fstream>
+#include <unistd.h>
 
 static const std::string FIELD_SEP = " : ";
 
@@ -36,18 +39,48 @@ using namespace android;
 #undef MFX_DEBUG_MODULE_NAME
 #define MFX_DEBUG_MODULE_NAME "MfxC2ComponentStore"
 
+MfxC2ComponentStore::MfxC2ComponentStore()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    char szVendorIntelVideoCodec[PROPERTY_VALUE_MAX] = {'\0'};
+    if(property_get("vendor.intel.video.codec", szVendorIntelVideoCodec, NULL) > 0 ) {
+        if (strncmp(szVendorIntelVideoCodec, "software", PROPERTY_VALUE_MAX) == 0 ) {
+            m_bSoftwareCodecOnly = true;
+        }
+    }
+    MFX_DEBUG_TRACE_I32(m_bSoftwareCodecOnly);
+
+    char szAdmission[PROPERTY_VALUE_MAX] = {'\0'};
+    if(property_get("vendor.intel.video.c2.admission", szAdmission, NULL) > 0 ) {
+        if (strncmp(szAdmission, "off", PROPERTY_VALUE_MAX) == 0) {
+            m_admissionMode = AdmissionMode::OFF;
+        } else if (strncmp(szAdmission, "reject", PROPERTY_VALUE_MAX) == 0) {
+            m_admissionMode = AdmissionMode::REJECT;
+        }
+    }
+    MFX_DEBUG_TRACE_I32((int)m_admissionMode);
+
+    MfxBinaryTrace::UpdateFromProperty();
+}
+
 MfxC2ComponentStore* MfxC2ComponentStore::Create(c2_status_t* status) {
 
     MFX_DEBUG_TRACE_FUNC;
 
     MfxC2ComponentStore* store = new (std::nothrow)MfxC2ComponentStore();
     if (store != nullptr) {
-        c2_status_t read_xml_cfg_res = store->readXmlConfigFile();
-        c2_status_t read_cfg_res = store->readConfigFile();
-        if (read_cfg_res != C2_OK || read_xml_cfg_res != C2_OK) {
-            *status = (read_cfg_res != C2_OK) ? read_cfg_res : read_xml_cfg_res;
-            delete store;
-            store = nullptr;
+        // Configuration files are merged on the first registry access, only built-in table
+        // is loaded on the startup path.
+        store->readBuiltinConfig();
+
+        // No performance data - no admission control.
+        if (store->m_admissionMode != AdmissionMode::OFF) {
+            std::unique_ptr<MfxC2StoreCapacity> capacity = std::make_unique<MfxC2StoreCapacity>();
+            if (C2_OK == capacity->ReadConfig(MFX_C2_PERFORMANCE_XML_FILE_PATH "/" MFX_C2_PERFORMANCE_XML_FILE_NAME)) {
+                store->m_admission = std::make_shared<MfxC2StoreAdmission>(std::move(capacity),
+                    store->m_admissionMode == AdmissionMode::REJECT);
+            }
         }
     } else {
         *status = C2_NO_MEMORY;
@@ -72,57 +105,38 @@ c2_status_t MfxC2ComponentStore::createComponent(C2String name, std::shared_ptr<
 
     c2_status_t result = C2_OK;
 
-    char szVendorIntelVideoCodec[PROPERTY_VALUE_MAX] = {'\0'};
-    if(property_get("vendor.intel.video.codec", szVendorIntelVideoCodec, NULL) > 0 ) {
-        if (strncmp(szVendorIntelVideoCodec, "software", PROPERTY_VALUE_MAX) == 0 ) {
-            ALOGI("Property vendor.intel.video.codec is %s in auto_hal.in and will not load hardware codec plugin", szVendorIntelVideoCodec);
-            return C2_NOT_FOUND;
+    if(component != nullptr) {
+        std::shared_ptr<MfxC2Component> mfx_component;
+        result = createMfxComponent(name, false/*interface_only*/, &mfx_component);
+        if(result == C2_OK) {
+            *component = std::move(mfx_component);
         }
     }
+    else {
+        MFX_LOG_ERROR("output component ptr is null");
+        result = C2_BAD_VALUE;
+    }
 
-    if(component != nullptr) {
+    MFX_DEBUG_TRACE__android_c2_status_t(result);
+    return result;
+}
 
-        auto it = m_componentsRegistry_.find(name);
-        if(it != m_componentsRegistry_.end()) {
-
-            auto dso_deleter = [] (void* handle) { dlclose(handle); };
-            std::unique_ptr<void, decltype(dso_deleter)> dso(loadModule(it->second.dso_name_), dso_deleter);
-            if(dso != nullptr) {
-
-                CreateMfxC2ComponentFunc* create_func =
-                    reinterpret_cast<CreateMfxC2ComponentFunc*>(dlsym(dso.get(), CREATE_MFX_C2_COMPONENT_FUNC_NAME));
-                if(create_func != nullptr) {
-
-                    std::shared_ptr<C2ReflectorHelper> reflector;
-                    {
-                        std::lock_guard<std::mutex> lock(m_reflectorMutex);
-                        reflector = m_reflector; // safe copy
-                    }
-
-                    MfxC2Component* mfx_component = (*create_func)(name.c_str(), it->second.config_, std::move(reflector), &result);
-                    if(result == C2_OK) {
-                        void* dso_handle = dso.release(); // release handle to be captured into lambda deleter
-                        auto component_deleter = [dso_handle] (MfxC2Component* p) { delete p; dlclose(dso_handle); };
-                        *component = std::shared_ptr<MfxC2Component>(mfx_component, component_deleter);
-                    }
-                }
-                else {
-                    MFX_LOG_ERROR("Module %s is invalid", it->second.dso_name_.c_str());
-                    result = C2_NOT_FOUND;
-                }
-            }
-            else {
-                MFX_LOG_ERROR("Cannot load module %s", it->second.dso_name_.c_str());
-                result = C2_NOT_FOUND;
-            }
-        }
-        else {
-            MFX_LOG_ERROR("Cannot find component %s", name.c_str());
-            result = C2_NOT_FOUND;
+c2_status_t MfxC2ComponentStore::createInterface(C2String name, std::shared_ptr<C2ComponentInterface>* const interface) {
+
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t result = C2_OK;
+
+    if(interface != nullptr) {
+        // Parameters only instance, no device, session or threads are created.
+        std::shared_ptr<MfxC2Component> mfx_component;
+        result = createMfxComponent(name, true/*interface_only*/, &mfx_component);
+        if(result == C2_OK) {
+            *interface = std::move(mfx_component);
         }
     }
     else {
-        MFX_LOG_ERROR("output component ptr is null");
+        MFX_LOG_ERROR("output interface ptr is null");
         result = C2_BAD_VALUE;
     }
 
@@ -130,16 +144,53 @@ c2_status_t MfxC2ComponentStore::createComponent(C2String name, std::shared_ptr<
     return result;
 }
 
-c2_status_t MfxC2ComponentStore::createInterface(C2String name, std::shared_ptr<C2ComponentInterface>* const interface) {
+c2_status_t MfxC2ComponentStore::createMfxComponent(const C2String& name, bool interface_only,
+    std::shared_ptr<MfxC2Component>* const component) {
 
     MFX_DEBUG_TRACE_FUNC;
 
-    std::shared_ptr<C2Component> component;
-    c2_status_t result = createComponent(name, &component);
+    c2_status_t result = C2_OK;
 
-    if(result == C2_OK) {
-        *interface = component->intf();
+    if (m_bSoftwareCodecOnly) {
+        ALOGI("Property vendor.intel.video.codec is software in auto_hal.in and will not load hardware codec plugin");
+        return C2_NOT_FOUND;
     }
+
+    loadConfigFiles();
+
+    auto it = m_componentsRegistry_.find(name);
+    if(it != m_componentsRegistry_.end()) {
+
+        ModuleDesc module;
+        result = getModule(it->second.dso_name_, &module);
+        if(result == C2_OK) {
+
+            std::shared_ptr<C2ReflectorHelper> reflector;
+            {
+                std::lock_guard<std::mutex> lock(m_reflectorMutex);
+                reflector = m_reflector; // safe copy
+            }
+
+            MfxC2Component::CreateConfig config = it->second.config_;
+            config.interface_only = interface_only;
+            if (!interface_only) {
+                config.admission = m_admission; // components are admitted on start
+            }
+
+            MfxC2Component* mfx_component = (*module.create_func_)(name.c_str(), config, std::move(reflector), &result);
+            if(result == C2_OK) {
+                // component keeps the module loaded
+                auto component_deleter = [dso = std::move(module.dso_)] (MfxC2Component* p) { delete p; };
+                *component = std::shared_ptr<MfxC2Component>(mfx_component, component_deleter);
+            }
+        }
+    }
+    else {
+        MFX_LOG_ERROR("Cannot find component %s", name.c_str());
+        result = C2_NOT_FOUND;
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(result);
     return result;
 }
 
@@ -148,6 +199,8 @@ std::vector<std::shared_ptr<const C2Component::Traits>> MfxC2ComponentStore::lis
     MFX_DEBUG_TRACE_FUNC;
     std::vector<std::shared_ptr<const C2Component::Traits>> result;
 
+    loadConfigFiles();
+
     try {
         for(const auto& it_pair : m_componentsRegistry_ ) {
             std::unique_ptr<C2Component::Traits> traits = std::make_unique<C2Component::Traits>();
@@ -172,11 +225,18 @@ std::vector<std::shared_ptr<const C2Component::Traits>> MfxC2ComponentStore::lis
 c2_status_t MfxC2ComponentStore::copyBuffer(std::shared_ptr<C2GraphicBuffer> src, std::shared_ptr<C2GraphicBuffer> dst) {
 
     MFX_DEBUG_TRACE_FUNC;
-    MFX_DEBUG_TRACE_MSG("Unimplemented method is called");
 
-    (void)src;
-    (void)dst;
-    return C2_OMITTED;
+    c2_status_t res = C2_OK;
+    if (!src || !dst) {
+        res = C2_BAD_VALUE;
+    } else {
+        // C2GraphicBuffer is only declared by codec2 framework, it gives no access
+        // to graphic blocks, so mapped blocks are copied by components with CopyGraphicView.
+        res = C2_OMITTED;
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
 }
 
 c2_status_t MfxC2ComponentStore::query_sm(
@@ -315,7 +375,8 @@ c2_status_t MfxC2ComponentStore::readConfigFile()
             config.flags = flags;
             config.dump_output = m_xmlParser.dumpOutputEnabled(name.c_str());
 
-            m_componentsRegistry_.emplace(name, ComponentDesc(module.c_str(), media_type.c_str(), kind, config));
+            // replaces built-in entry of the same name
+            m_componentsRegistry_.insert_or_assign(name, ComponentDesc(module.c_str(), media_type.c_str(), kind, config));
         }
         config_file.close();
     }
@@ -324,6 +385,99 @@ c2_status_t MfxC2ComponentStore::readConfigFile()
     return c2_res;
 }
 
+c2_status_t MfxC2ComponentStore::readBuiltinConfig()
+{
+    MFX_DEBUG_TRACE_FUNC;
+    c2_status_t c2_res = C2_OK;
+
+    for (size_t i = 0; i < g_mfxC2StoreComponentsCount; ++i) {
+        const MfxC2StoreComponentEntry& entry = g_mfxC2StoreComponents[i];
+        MFX_DEBUG_TRACE_S(entry.name);
+
+        MfxC2Component::CreateConfig config;
+        config.flags = entry.flags;
+        config.dump_output = entry.dump_output;
+
+        m_componentsRegistry_.emplace(entry.name, ComponentDesc(entry.dso_name, entry.media_type, entry.kind, config));
+    }
+    MFX_DEBUG_TRACE_I32(m_componentsRegistry_.size());
+    MFX_DEBUG_TRACE__android_c2_status_t(c2_res);
+    return c2_res;
+}
+
+void MfxC2ComponentStore::loadConfigFiles()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    std::call_once(m_configFilesOnce, [this] () {
+        std::string config_filename = MFX_C2_CONFIG_FILE_PATH "/" MFX_C2_CONFIG_FILE_NAME;
+        // Configuration files found on the device override entries of built-in table,
+        // parsing is needed only if the image installs them.
+        if (access(config_filename.c_str(), F_OK) == 0) {
+            c2_status_t read_xml_cfg_res = readXmlConfigFile();
+            c2_status_t read_cfg_res = readConfigFile();
+            if (read_cfg_res != C2_OK || read_xml_cfg_res != C2_OK) {
+                // built-in table stays in use
+                MFX_LOG_ERROR("Cannot read configuration files: %d, %d", read_xml_cfg_res, read_cfg_res);
+            }
+        }
+    });
+}
+
+void MfxC2ComponentStore::DumpMetrics(std::ostream& os)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    std::lock_guard<std::mutex> lock(m_modulesMutex);
+
+    for (const auto& module : m_modules) {
+        if (module.second.dump_metrics_func_) {
+            os << "module " << module.first << std::endl;
+            (*module.second.dump_metrics_func_)(os);
+        }
+    }
+}
+
+void MfxC2ComponentStore::EnableBinaryTrace(bool enable)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    MfxBinaryTrace::Enable(enable);
+
+    std::lock_guard<std::mutex> lock(m_modulesMutex);
+
+    for (const auto& module : m_modules) {
+        if (module.second.enable_trace_func_) {
+            (*module.second.enable_trace_func_)(enable);
+        }
+    }
+}
+
+void MfxC2ComponentStore::SaveBinaryTrace(std::ostream& os, bool json)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    auto save = [&os, json] (const std::string& module_name, SaveMfxC2BinaryTraceFunc* save_func) {
+        std::string filename = MFX_C2_DUMP_DIR "/" MFX_C2_BINARY_TRACE_FILE_PREFIX;
+        filename += module_name.substr(0, module_name.rfind('.')) + (json ? ".json" : ".bin");
+        if ((*save_func)(filename.c_str())) {
+            os << "trace " << filename << std::endl;
+        } else {
+            os << "trace " << filename << " failed" << std::endl;
+        }
+    };
+
+    save(MFX_C2_COMPONENT_STORE_NAME, [] (const char* filename) { return MfxBinaryTrace::Save(filename); });
+
+    std::lock_guard<std::mutex> lock(m_modulesMutex);
+
+    for (const auto& module : m_modules) {
+        if (module.second.save_trace_func_) {
+            save(module.first, module.second.save_trace_func_);
+        }
+    }
+}
+
 c2_status_t MfxC2ComponentStore::readXmlConfigFile()
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -338,6 +492,53 @@ c2_status_t MfxC2ComponentStore::readXmlConfigFile()
     return c2_res;
 }
 
+c2_status_t MfxC2ComponentStore::getModule(const std::string& name, ModuleDesc* module) {
+
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t result = C2_OK;
+
+    std::lock_guard<std::mutex> lock(m_modulesMutex);
+
+    auto it = m_modules.find(name);
+    if(it == m_modules.end()) {
+
+        std::shared_ptr<void> dso(loadModule(name), [] (void* handle) { if (handle) dlclose(handle); });
+        if(dso != nullptr) {
+
+            CreateMfxC2ComponentFunc* create_func =
+                reinterpret_cast<CreateMfxC2ComponentFunc*>(dlsym(dso.get(), CREATE_MFX_C2_COMPONENT_FUNC_NAME));
+            if(create_func != nullptr) {
+                ModuleDesc desc;
+                desc.create_func_ = create_func;
+                desc.dump_metrics_func_ =
+                    reinterpret_cast<DumpMfxC2MetricsFunc*>(dlsym(dso.get(), DUMP_MFX_C2_METRICS_FUNC_NAME));
+                desc.enable_trace_func_ =
+                    reinterpret_cast<EnableMfxC2BinaryTraceFunc*>(dlsym(dso.get(), ENABLE_MFX_C2_BINARY_TRACE_FUNC_NAME));
+                desc.save_trace_func_ =
+                    reinterpret_cast<SaveMfxC2BinaryTraceFunc*>(dlsym(dso.get(), SAVE_MFX_C2_BINARY_TRACE_FUNC_NAME));
+                desc.dso_ = std::move(dso);
+                it = m_modules.emplace(name, std::move(desc)).first;
+            }
+            else {
+                MFX_LOG_ERROR("Module %s is invalid", name.c_str());
+                result = C2_NOT_FOUND;
+            }
+        }
+        else {
+            MFX_LOG_ERROR("Cannot load module %s", name.c_str());
+            result = C2_NOT_FOUND;
+        }
+    }
+
+    if(result == C2_OK) {
+        *module = it->second;
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(result);
+    return result;
+}
+
 void* MfxC2ComponentStore::loadModule(const std::string& name) {
 
     MFX_DEBUG_TRACE_FUNC;
@@ -0,0 +1,153 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_c2_store_capacity.h"
+#include "mfx_debug.h"
+#include "mfx_c2_debug.h"
+
+using namespace android;
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_c2_store_capacity"
+
+// Frame rate assumed for components not reporting it, like decoders.
+const float MFX_C2_DEFAULT_FRAME_RATE = 30.0f;
+
+c2_status_t MfxC2StoreCapacity::ReadConfig(const char* path)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t res = m_xmlParser.parseConfig(path);
+    m_bEnabled = (C2_OK == res);
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+float MfxC2StoreCapacity::GetLoad(const char* name, uint32_t width, uint32_t height, float frame_rate)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    float load = 0.0f;
+
+    do {
+        std::vector<MfxC2MeasuredFrameRate> measured = m_xmlParser.getMeasuredFrameRates(name);
+        if (measured.empty() || width == 0 || height == 0) break;
+
+        if (frame_rate <= 0.0f) frame_rate = MFX_C2_DEFAULT_FRAME_RATE;
+
+        // Take the smallest measured resolution not less than the requested one,
+        // or the biggest measured if requested exceeds all of them.
+        const uint64_t pixels = (uint64_t)width * height;
+        const MfxC2MeasuredFrameRate* closest = nullptr;
+        for (const MfxC2MeasuredFrameRate& point : measured) {
+            const uint64_t point_pixels = (uint64_t)point.width * point.height;
+            if (nullptr == closest) {
+                closest = &point;
+                continue;
+            }
+            const uint64_t closest_pixels = (uint64_t)closest->width * closest->height;
+            if (closest_pixels < pixels ? point_pixels > closest_pixels :
+                (point_pixels >= pixels && point_pixels < closest_pixels)) {
+                closest = &point;
+            }
+        }
+
+        // Lower bound of the measured range is what the hardware surely sustains.
+        const double capacity = (double)closest->width * closest->height * closest->min_fps;
+        load = (float)(pixels * frame_rate / capacity);
+
+    } while (false);
+
+    MFX_DEBUG_TRACE_STREAM(name << " " << width << "x" << height << "@" << frame_rate << " " << NAMED(load));
+    return load;
+}
+
+float MfxC2StoreCapacity::GetLoad(const char* name, C2ComponentInterface* component)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // Encoders are configured with input size and output frame rate,
+    // decoders report output size, params not supported are invalidated by query.
+    C2StreamPictureSizeInfo::input input_size;
+    C2StreamPictureSizeInfo::output output_size;
+    C2StreamFrameRateInfo::output frame_rate;
+
+    c2_status_t res = component->query_vb({ &input_size, &output_size, &frame_rate },
+        {}, C2_DONT_BLOCK, nullptr);
+    if (C2_OK != res) {
+        MFX_DEBUG_TRACE__android_c2_status_t(res);
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    if (input_size) {
+        width = input_size.width;
+        height = input_size.height;
+    } else if (output_size) {
+        width = output_size.width;
+        height = output_size.height;
+    }
+
+    return GetLoad(name, width, height, frame_rate ? frame_rate.value : 0.0f);
+}
+
+c2_status_t MfxC2StoreAdmission::Admit(MfxC2Component* component)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    c2_status_t res = C2_OK;
+
+    // Component is queried out of the lock, the load depends on its configuration only.
+    const C2String name = component->getName();
+    const float load = m_capacity->GetLoad(name.c_str(), component);
+
+    std::lock_guard<std::mutex> lock(m_startedLoadsMutex);
+
+    float committed_load = 0.0f;
+    for (const auto& started : m_startedLoads) {
+        if (started.first != component) committed_load += started.second;
+    }
+
+    MFX_DEBUG_TRACE_STREAM(NAMED(committed_load) << NAMED(load));
+
+    if (committed_load + load > 1.0f) {
+        ALOGW("Hardware capacity exceeded starting %s: committed load %.2f, component load %.2f",
+            name.c_str(), committed_load, load);
+        if (m_bReject) {
+            res = C2_NO_MEMORY;
+        }
+    }
+
+    if (C2_OK == res) {
+        m_startedLoads[component] = load;
+    }
+
+    MFX_DEBUG_TRACE__android_c2_status_t(res);
+    return res;
+}
+
+void MfxC2StoreAdmission::Leave(MfxC2Component* component)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    std::lock_guard<std::mutex> lock(m_startedLoadsMutex);
+    m_startedLoads.erase(component);
+}
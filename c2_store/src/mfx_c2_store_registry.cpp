@@ -0,0 +1,38 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// This file is generated by _tools/store_conf_to_cpp.py, do not edit.
+
+#include "mfx_c2_store_registry.h"
+
+const MfxC2StoreComponentEntry g_mfxC2StoreComponents[] = {
+    { "c2.intel.avc.decoder", "libmfx_c2_components_hw.so", "video/avc", KIND_DECODER, 0x0, false },
+    { "c2.intel.avc.encoder", "libmfx_c2_components_hw.so", "video/avc", KIND_ENCODER, 0x0, false },
+    { "c2.intel.hevc.decoder", "libmfx_c2_components_hw.so", "video/hevc", KIND_DECODER, 0x0, false },
+    { "c2.intel.hevc.encoder", "libmfx_c2_components_hw.so", "video/hevc", KIND_ENCODER, 0x0, false },
+    { "c2.intel.vp9.encoder", "libmfx_c2_components_hw.so", "video/x-vnd.on2.vp9", KIND_ENCODER, 0x0, false },
+    { "c2.intel.vp9.decoder", "libmfx_c2_components_hw.so", "video/x-vnd.on2.vp9", KIND_DECODER, 0x0, false },
+    { "c2.intel.vp8.decoder", "libmfx_c2_components_hw.so", "video/x-vnd.on2.vp8", KIND_DECODER, 0x0, false },
+    { "c2.intel.mp2.decoder", "libmfx_c2_components_hw.so", "video/mpeg2", KIND_DECODER, 0x0, false },
+    { "c2.intel.av1.decoder", "libmfx_c2_components_hw.so", "video/av01", KIND_DECODER, 0x0, false },
+    { "c2.intel.vpp", "libmfx_c2_components_hw.so", "", KIND_OTHER, 0x0, false },
+};
+
+const size_t g_mfxC2StoreComponentsCount = MFX_GET_ARRAY_SIZE(g_mfxC2StoreComponents);
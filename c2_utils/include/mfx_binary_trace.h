@@ -0,0 +1,164 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+// Low-overhead binary trace for production builds.
+// Events of fixed size are written into a ring buffer owned by the calling thread,
+// so tracing takes no locks and formats nothing. Tracing is off by default and is
+// switched at runtime (see MfxBinaryTrace::UpdateFromProperty), when off every
+// trace point costs one relaxed atomic load.
+// Spans written while a frame is processed carry its index (see MFX_BINARY_TRACE_FRAME),
+// so pipeline stages of the same frame could be matched across threads.
+// Saved traces are decoded offline with _tools/binary_trace_to_text.py
+// or saved as Chrome trace-event JSON to be viewed on a timeline (chrome://tracing, Perfetto).
+
+struct MfxBinaryTraceEvent
+{
+    uint64_t time_ns; // steady clock
+    uint32_t name_id; // index in the name table
+    uint16_t type;    // MfxBinaryTrace::EventType
+    uint16_t flags;   // MfxBinaryTrace::EventFlags, tell what arg holds
+    uint64_t arg;
+};
+
+static_assert(sizeof(MfxBinaryTraceEvent) == 24, "binary trace event layout is a file format");
+
+class MfxBinaryTrace
+{
+public:
+    enum EventType : uint16_t {
+        EVENT_BEGIN = 1,
+        EVENT_END = 2,
+        EVENT_INSTANT = 3,
+    };
+
+    enum EventFlags : uint16_t {
+        FLAG_FRAME = 1, // arg is index of the frame being processed
+        FLAG_ARG = 2,   // arg is value passed to the instant event
+    };
+
+    enum Format {
+        FORMAT_BINARY,
+        FORMAT_JSON, // Chrome trace-event format
+    };
+
+    static constexpr uint64_t NO_FRAME = UINT64_MAX;
+
+    // Events kept per thread, older events are overwritten.
+    static constexpr uint32_t RING_SIZE = 8192;
+
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    static void Enable(bool enable);
+
+    // Enables tracing if vendor.intel.video.c2.trace property is set to 1, disables if 0.
+    // Keeps current state if the property is not set.
+    static void UpdateFromProperty();
+
+    // Returns id of "module:name" pair in the name table.
+    // Called once per trace point, result is cached by the macros below.
+    static uint32_t RegisterName(const char* module, const char* name);
+
+    // Begin and end events get index of the current frame of the thread,
+    // arg is stored for instant events only.
+    static void Write(EventType type, uint32_t name_id, uint64_t arg);
+
+    // Sets index of the frame processed by the calling thread, returns previous one.
+    static uint64_t SetFrame(uint64_t frame_index);
+
+    // Writes name table and contents of all rings, including rings of exited threads
+    // not reused yet. Threads might trace concurrently, events overwritten during
+    // the save are dropped. Binary format is described in mfx_binary_trace.cpp.
+    static bool Save(std::ostream& os, Format format = FORMAT_BINARY);
+
+    // Format is chosen by the file extension: .json or binary otherwise.
+    static bool Save(const char* filename);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class MfxBinaryTraceScope
+{
+public:
+    explicit MfxBinaryTraceScope(uint32_t name_id)
+        : m_nameId(name_id), m_bActive(MfxBinaryTrace::IsEnabled())
+    {
+        if (m_bActive) MfxBinaryTrace::Write(MfxBinaryTrace::EVENT_BEGIN, m_nameId, 0);
+    }
+
+    // END is written even if tracing got disabled meanwhile, so BEGIN/END stay paired.
+    ~MfxBinaryTraceScope()
+    {
+        if (m_bActive) MfxBinaryTrace::Write(MfxBinaryTrace::EVENT_END, m_nameId, 0);
+    }
+
+    MfxBinaryTraceScope(const MfxBinaryTraceScope&) = delete;
+    MfxBinaryTraceScope& operator=(const MfxBinaryTraceScope&) = delete;
+
+private:
+    uint32_t m_nameId;
+    bool m_bActive;
+};
+
+class MfxBinaryTraceFrame
+{
+public:
+    explicit MfxBinaryTraceFrame(uint64_t frame_index)
+        : m_prevFrame(MfxBinaryTrace::SetFrame(frame_index)) {}
+
+    ~MfxBinaryTraceFrame() { MfxBinaryTrace::SetFrame(m_prevFrame); }
+
+    MfxBinaryTraceFrame(const MfxBinaryTraceFrame&) = delete;
+    MfxBinaryTraceFrame& operator=(const MfxBinaryTraceFrame&) = delete;
+
+private:
+    uint64_t m_prevFrame;
+};
+
+#define MFX_BINARY_TRACE_CONCAT_(_a, _b) _a##_b
+#define MFX_BINARY_TRACE_CONCAT(_a, _b) MFX_BINARY_TRACE_CONCAT_(_a, _b)
+
+// Unique names let a function have nested spans.
+#define MFX_BINARY_TRACE_SCOPE(_name) \
+    static const uint32_t MFX_BINARY_TRACE_CONCAT(_mfx_binary_trace_id, __LINE__) = \
+        MfxBinaryTrace::RegisterName(MFX_DEBUG_MODULE_NAME, _name); \
+    MfxBinaryTraceScope MFX_BINARY_TRACE_CONCAT(_mfx_binary_trace_scope, __LINE__)( \
+        MFX_BINARY_TRACE_CONCAT(_mfx_binary_trace_id, __LINE__))
+
+#define MFX_BINARY_TRACE_FUNC \
+    MFX_BINARY_TRACE_SCOPE(__FUNCTION__)
+
+// Spans of the calling thread carry the frame index till the end of the scope.
+#define MFX_BINARY_TRACE_FRAME(_frame_index) \
+    MfxBinaryTraceFrame _mfx_binary_trace_frame(_frame_index)
+
+#define MFX_BINARY_TRACE_EVENT(_name, _arg) \
+{ \
+    if (MfxBinaryTrace::IsEnabled()) { \
+        static const uint32_t _mfx_binary_trace_event_id = MfxBinaryTrace::RegisterName(MFX_DEBUG_MODULE_NAME, _name); \
+        MfxBinaryTrace::Write(MfxBinaryTrace::EVENT_INSTANT, _mfx_binary_trace_event_id, (uint64_t)(_arg)); \
+    } \
+}
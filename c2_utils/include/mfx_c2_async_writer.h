@@ -0,0 +1,72 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mfx_defs.h"
+#include "mfx_cmd_queue.h"
+#include "mfx_c2_metrics.h"
+
+// Dumps binary data to file without stalling the caller: payload is copied
+// into a queue and written by a background thread. The queue is bounded by size,
+// dumps which don't fit are dropped rather than waited for, so dumping could stay
+// enabled while reproducing timing sensitive issues. Dropped dumps are counted
+// in "dump.dropped" metric.
+class MfxC2AsyncWriter
+{
+public:
+    static constexpr size_t DEFAULT_MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+    // File named <name> is created/overwritten in: dir/<sub_dirs[0]>/.../<sub_dirs[N-1]>
+    MfxC2AsyncWriter(const std::string& dir, const std::vector<std::string>& sub_dirs,
+        const std::string& name, size_t max_queued_bytes = DEFAULT_MAX_QUEUED_BYTES);
+
+    // Writes all queued dumps before closing the file.
+    ~MfxC2AsyncWriter();
+
+    // Returns false if the dump was dropped.
+    bool Write(const uint8_t* data, size_t length);
+
+    // Writes raw NV12 frame without pitch padding: width x height luma
+    // followed by width x height/2 interleaved chroma.
+    bool WriteNV12(const uint8_t* y, const uint8_t* uv, size_t pitch, uint32_t width, uint32_t height);
+
+    uint64_t GetDroppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    bool Reserve(size_t length);
+
+    void Queue(std::vector<uint8_t>&& payload);
+
+private:
+    std::ofstream m_stream; // used from the queue thread only
+    size_t m_maxQueuedBytes;
+    std::atomic<size_t> m_queuedBytes { 0 };
+    std::atomic<uint64_t> m_droppedCount { 0 };
+    MfxC2Counter* m_droppedMetric;
+    MfxCmdQueue m_queue;
+
+    MFX_CLASS_NO_COPY(MfxC2AsyncWriter)
+};
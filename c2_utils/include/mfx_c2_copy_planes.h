@@ -0,0 +1,33 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+// Plane copy depends on codec2 headers only, so it is built for host too.
+#include <C2Buffer.h>
+
+// Copies YUV image of width x height samples between planes described by layouts.
+// Layouts may differ in strides, plane offsets and chroma planes arrangement,
+// so NV12, I420 and YV12 (or P010 and its planar 16-bit form) convert to each other.
+// Returns C2_CANNOT_DO if sample formats of the layouts differ.
+c2_status_t CopyPlanes(uint32_t width, uint32_t height,
+    const C2PlanarLayout& src_layout, const uint8_t* const* src_data,
+    const C2PlanarLayout& dst_layout, uint8_t* const* dst_data);
@@ -28,14 +28,23 @@
 
 #define CREATE_MFX_C2_COMPONENT_FUNC_NAME "MfxCreateC2Component"
 
+#define DUMP_MFX_C2_METRICS_FUNC_NAME "MfxDumpC2Metrics"
+
+#define ENABLE_MFX_C2_BINARY_TRACE_FUNC_NAME "MfxEnableC2BinaryTrace"
+#define SAVE_MFX_C2_BINARY_TRACE_FUNC_NAME "MfxSaveC2BinaryTrace"
+
 #define MFX_C2_CONFIG_FILE_NAME "mfx_c2_store.conf"
 #define MFX_C2_CONFIG_FILE_PATH "/vendor/etc"
 
 #define MFX_C2_CONFIG_XML_FILE_NAME "media_codecs_intel_c2_video.xml"
 #define MFX_C2_CONFIG_XML_FILE_PATH "/vendor/etc"
 
+#define MFX_C2_PERFORMANCE_XML_FILE_NAME "media_codecs_performance.xml"
+#define MFX_C2_PERFORMANCE_XML_FILE_PATH "/vendor/etc"
+
 #define MFX_C2_DUMP_DIR "/data/local/tmp"
 #define MFX_C2_DUMP_OUTPUT_SUB_DIR "c2-output"
+#define MFX_C2_BINARY_TRACE_FILE_PREFIX "mfx_c2_trace_"
 
 const c2_nsecs_t MFX_SECOND_NS = 1000000000; // 1e9
 
@@ -0,0 +1,140 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "mfx_defs.h"
+
+// Map from 32-bit parameter index (C2Param::Index, C2Param::CoreIndex etc.)
+// to value, for lookups on per-frame paths.
+// Open addressing with linear probing: slots keep key and position of the value,
+// values are kept in insertion order in one contiguous array.
+// Elements are never removed one by one, only all together with Clear.
+// Pointers to values are invalidated by Emplace.
+template<typename T>
+class MfxC2FlatIndexMap
+{
+public:
+    MfxC2FlatIndexMap() = default;
+
+    MfxC2FlatIndexMap(MfxC2FlatIndexMap&&) = default;
+    MfxC2FlatIndexMap& operator=(MfxC2FlatIndexMap&&) = default;
+
+    MFX_CLASS_NO_COPY(MfxC2FlatIndexMap)
+
+public:
+    const T* Find(uint32_t key) const
+    {
+        if (m_slots.empty()) return nullptr;
+
+        const size_t mask = m_slots.size() - 1;
+        for (size_t pos = Hash(key) & mask; ; pos = (pos + 1) & mask) {
+            const Slot& slot = m_slots[pos];
+            if (slot.value_pos == EMPTY) return nullptr;
+            if (slot.key == key) return &m_values[slot.value_pos];
+        }
+    }
+
+    T* Find(uint32_t key)
+    {
+        return const_cast<T*>(static_cast<const MfxC2FlatIndexMap*>(this)->Find(key));
+    }
+
+    // Inserts value if the key is not there yet, returns pointer to the value
+    // kept under the key and whether insertion took place.
+    std::pair<T*, bool> Emplace(uint32_t key, T&& value)
+    {
+        T* found = Find(key);
+        if (found) return { found, false };
+
+        // keep load factor under 1/2 so probe sequences stay short
+        if ((m_values.size() + 1) * 2 > m_slots.size()) {
+            Rehash(std::max<size_t>(MIN_SLOTS, m_slots.size() * 2));
+        }
+
+        const uint32_t value_pos = m_values.size();
+        m_keys.push_back(key);
+        m_values.push_back(std::move(value));
+        InsertSlot(key, value_pos);
+
+        return { &m_values.back(), true };
+    }
+
+    size_t Size() const { return m_values.size(); }
+
+    void Clear()
+    {
+        m_slots.clear();
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    // Access in insertion order.
+    uint32_t KeyAt(size_t pos) const { return m_keys[pos]; }
+    const T& ValueAt(size_t pos) const { return m_values[pos]; }
+    T& ValueAt(size_t pos) { return m_values[pos]; }
+
+private:
+    struct Slot
+    {
+        uint32_t key;
+        uint32_t value_pos;
+    };
+
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t MIN_SLOTS = 16;
+
+    static size_t Hash(uint32_t key)
+    {
+        // Parameter indices differ in high (kind, direction, stream) and low (type) bits,
+        // multiplicative hashing mixes both into the low bits used for the slot.
+        uint64_t hash = (uint64_t)key * 0x9E3779B97F4A7C15ull;
+        return (size_t)(hash ^ (hash >> 32));
+    }
+
+    void InsertSlot(uint32_t key, uint32_t value_pos)
+    {
+        const size_t mask = m_slots.size() - 1;
+        size_t pos = Hash(key) & mask;
+        while (m_slots[pos].value_pos != EMPTY) {
+            pos = (pos + 1) & mask;
+        }
+        m_slots[pos] = Slot{ key, value_pos };
+    }
+
+    void Rehash(size_t slot_count)
+    {
+        m_slots.assign(slot_count, Slot{ 0, EMPTY });
+        for (size_t i = 0; i < m_keys.size(); ++i) {
+            InsertSlot(m_keys[i], i);
+        }
+    }
+
+private:
+    std::vector<Slot> m_slots; // size is zero or power of 2
+    std::vector<uint32_t> m_keys;
+    std::vector<T> m_values;
+};
@@ -0,0 +1,148 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "mfx_defs.h"
+
+// Process-wide runtime metrics: counters, gauges and histograms registered by name.
+// Registration takes a lock and is done once per metric (callers keep returned pointer),
+// updates are lock-free and cheap enough to be left on in production builds.
+// Metrics live till the process exits, so pointers to them never dangle.
+
+class MfxC2Counter
+{
+public:
+    MfxC2Counter() = default;
+    MFX_CLASS_NO_COPY(MfxC2Counter)
+
+    void Add(uint64_t value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+
+    uint64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value { 0 };
+};
+
+class MfxC2Gauge
+{
+public:
+    MfxC2Gauge() = default;
+    MFX_CLASS_NO_COPY(MfxC2Gauge)
+
+    void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+
+    void Add(int64_t value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+
+    int64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value { 0 };
+};
+
+// Distribution of values over log-linear buckets:
+// values under SUB_BUCKET_COUNT have a bucket each, every power of 2 range [2^e, 2^(e+1))
+// above is split into SUB_BUCKET_COUNT equal buckets.
+// So a bucket is narrower than 1/SUB_BUCKET_COUNT of the values it counts.
+class MfxC2Histogram
+{
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    // exact buckets plus sub-buckets of power of 2 ranges from 2^SUB_BUCKET_BITS to 2^63
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT * (64 - SUB_BUCKET_BITS + 1);
+
+    struct Summary
+    {
+        uint64_t count { 0 };
+        uint64_t sum { 0 };
+        uint64_t min { 0 };
+        uint64_t max { 0 };
+        std::array<uint64_t, BUCKET_COUNT> buckets {};
+
+        // Returns the percentile interpolated linearly within the bucket holding it,
+        // limited by min and max, percentile is in [0, 100].
+        // Exact for values under SUB_BUCKET_COUNT and if all values in the bucket are equal
+        // to min or max, otherwise relative error is under 1/SUB_BUCKET_COUNT (12.5%).
+        uint64_t GetPercentile(double percentile) const;
+    };
+
+public:
+    MfxC2Histogram() = default;
+    MFX_CLASS_NO_COPY(MfxC2Histogram)
+
+    void Record(uint64_t value);
+
+    // Fields are read one by one, so the summary might miss values being recorded concurrently.
+    Summary GetSummary() const;
+
+    static size_t GetBucketIndex(uint64_t value);
+
+    // Returns the smallest and the biggest value counted by the bucket.
+    static std::pair<uint64_t, uint64_t> GetBucketBounds(size_t index);
+
+private:
+    std::atomic<uint64_t> m_count { 0 };
+    std::atomic<uint64_t> m_sum { 0 };
+    std::atomic<uint64_t> m_min { UINT64_MAX };
+    std::atomic<uint64_t> m_max { 0 };
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets {};
+};
+
+class MfxC2Metrics
+{
+public:
+    static MfxC2Metrics& GetInstance();
+
+    // Return the metric registered with the name, registering it on the first call.
+    MfxC2Counter* GetCounter(const std::string& name);
+    MfxC2Gauge* GetGauge(const std::string& name);
+    MfxC2Histogram* GetHistogram(const std::string& name);
+
+    // Prints all metrics sorted by name, one per line:
+    // counter <name> <value>
+    // gauge <name> <value>
+    // histogram <name> count=<n> min=<v> max=<v> avg=<v> p50=<v> p90=<v> p99=<v>
+    void Dump(std::ostream& os) const;
+
+    std::string Dump() const;
+
+private:
+    MfxC2Metrics() = default;
+    MFX_CLASS_NO_COPY(MfxC2Metrics)
+
+    template<typename Metric>
+    Metric* GetMetric(std::map<std::string, std::unique_ptr<Metric>>* metrics, const std::string& name);
+
+private:
+    mutable std::mutex m_mutex; // guards registration, not values
+    std::map<std::string, std::unique_ptr<MfxC2Counter>> m_counters;
+    std::map<std::string, std::unique_ptr<MfxC2Gauge>> m_gauges;
+    std::map<std::string, std::unique_ptr<MfxC2Histogram>> m_histograms;
+};
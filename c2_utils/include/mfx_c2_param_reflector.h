@@ -26,6 +26,7 @@
 #include <unordered_map>
 #include <thread>
 #include "mfx_debug.h"
+#include "mfx_c2_snapshot.h"
 #include <C2Param.h>
 #include <C2Component.h>
 #include <C2Work.h>
@@ -48,15 +49,21 @@ public: // C2ParamReflector
 #endif
 
 private:
-    std::map<C2Param::CoreIndex, C2StructDescriptor> m_paramsStructDescriptors;
-    mutable std::mutex m_descriptorsMutex_;
+    typedef std::map<C2Param::CoreIndex, C2StructDescriptor> StructDescriptors;
+    // Descriptions are added on components creation and read by every query,
+    // so describe works on a snapshot and doesn't lock.
+    MfxC2Snapshot<StructDescriptors> m_paramsStructDescriptors { StructDescriptors() };
 };
 
 template<typename ParamType>
 void MfxC2ParamReflector::AddDescription()
 {
-    std::lock_guard<std::mutex> lock(m_descriptorsMutex_);
-    m_paramsStructDescriptors.insert({ C2Param::Type(ParamType::PARAM_TYPE).coreIndex(), C2StructDescriptor(ParamType::PARAM_TYPE, ParamType::FieldList()) });
+    const C2Param::CoreIndex core_index = C2Param::Type(ParamType::PARAM_TYPE).coreIndex();
+    if (m_paramsStructDescriptors.Load()->count(core_index)) return;
+
+    m_paramsStructDescriptors.Update([core_index] (StructDescriptors* descriptors) {
+        descriptors->insert({ core_index, C2StructDescriptor(ParamType::PARAM_TYPE, ParamType::FieldList()) });
+    });
 }
 
 // Google uses a trick to access private fields/methods of some classes
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "mfx_c2_param_reflector.h"
+#include "mfx_c2_flat_index_map.h"
 
 // deprecated
 class MfxC2ParamStorage
@@ -89,16 +90,35 @@ private:
         C2ParamSet set_;
     };
 
+    // Place of the param value in m_valuesData.
+    struct C2ParamLocation
+    {
+        size_t offset_; // in m_valuesData elements
+        size_t capacity_; // in bytes
+    };
+
+    const C2Param* GetValue(const C2ParamLocation& location) const
+    {
+        return (const C2Param*)&m_valuesData[location.offset_];
+    }
+
+    void StoreValue(const C2Param& value, C2ParamLocation* location);
+
 private:
     std::shared_ptr<MfxC2ParamReflector> m_reflector;
 
     std::vector<std::shared_ptr<C2ParamDescriptor>> m_paramsDescriptors;
+    // Positions in m_paramsDescriptors, for exact index match.
+    MfxC2FlatIndexMap<size_t> m_paramsDescriptorsIndex;
 
     std::map<C2ParamField, C2FieldSupportedValues> m_paramsSupportedValues;
 
-    std::map<C2Param::Index, C2ParamOperations> m_paramOperations;
+    MfxC2FlatIndexMap<C2ParamOperations> m_paramOperations;
 
-    std::map<C2Param::Index, std::unique_ptr<const C2Param>> m_values;
+    // Param values are copied one after another into m_valuesData,
+    // so queries and updates don't allocate and stay within few cache lines.
+    MfxC2FlatIndexMap<C2ParamLocation> m_values;
+    std::vector<uint64_t> m_valuesData;
 
     mutable std::mutex m_valuesMutex;
 };
@@ -108,6 +128,7 @@ void MfxC2ParamStorage::RegisterParam(const char* param_name)
 {
     using namespace android;
 
+    m_paramsDescriptorsIndex.Emplace(ParamType::PARAM_TYPE, m_paramsDescriptors.size());
     m_paramsDescriptors.push_back(
         std::make_shared<C2ParamDescriptor>(false, param_name, ParamType::PARAM_TYPE));
 
@@ -151,7 +172,10 @@ void MfxC2ParamStorage::AddValue(
 
     {
         std::lock_guard<std::mutex> lock(m_valuesMutex);
-        m_values.emplace(index, std::move(value));
+        auto emplaced = m_values.Emplace(index, C2ParamLocation{});
+        if (emplaced.second) {
+            StoreValue(*value, emplaced.first);
+        }
     }
 }
 
@@ -160,10 +184,10 @@ c2_status_t MfxC2ParamStorage::UpdateValue(C2Param::Index param_index, std::uniq
 {
     {
         std::lock_guard<std::mutex> lock(m_valuesMutex);
-        auto found = m_values.find(param_index);
+        C2ParamLocation* found = m_values.Find(param_index);
 
-        if (found != m_values.end()) {
-            found->second = std::move(value);
+        if (nullptr != found) {
+            StoreValue(*value, found);
             return C2_OK;
         }
     }
@@ -192,6 +216,6 @@ void MfxC2ParamStorage::AddStreamInfo(const char* param_name, unsigned int strea
     };
 
     C2Param::Index index{ParamType::PARAM_TYPE};
-    m_paramOperations.emplace(index.withStream(stream_id),
+    m_paramOperations.Emplace(index.withStream(stream_id),
         C2ParamOperations{allocate, get_function, set_function});
 }
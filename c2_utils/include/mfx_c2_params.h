@@ -0,0 +1,101 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <C2Config.h>
+
+// Vendor specific parameters of Intel C2 components.
+// Mock components own the first vendor indices, so these start with an offset.
+
+namespace android {
+
+enum C2ParamIndexKindIntel : uint32_t {
+    kParamIndexIntelVendorStart = C2Param::TYPE_INDEX_VENDOR_START + 0x100,
+
+    kParamIndexRenditions = kParamIndexIntelVendorStart,
+    kParamIndexRenditionId,
+    kParamIndexSceneChangeDetection,
+    kParamIndexLookAheadDepth,
+    kParamIndexMetrics,
+    kParamIndexDeinterlace,
+    kParamIndexBottomFieldFirst,
+};
+
+// One additional output of the encoder, scaled from the input frame.
+struct C2RenditionStruct {
+    C2RenditionStruct() : width(0), height(0), bitrate(0) {}
+
+    C2RenditionStruct(uint32_t width_, uint32_t height_, uint32_t bitrate_)
+        : width(width_), height(height_), bitrate(bitrate_) {}
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitrate; // bits per second, 0 - scaled from the main stream bitrate
+
+    DEFINE_AND_DESCRIBE_C2STRUCT(Rendition)
+    C2FIELD(width, "width")
+    C2FIELD(height, "height")
+    C2FIELD(bitrate, "bitrate")
+};
+
+// Simulcast (ABR ladder): list of renditions encoded from the same input
+// in addition to the main stream. Works for frames in video memory only,
+// with system memory input the main stream is encoded alone.
+typedef C2StreamParam<C2Tuning, C2SimpleArrayStruct<C2RenditionStruct>, kParamIndexRenditions>
+        C2StreamRenditionsTuning;
+constexpr char C2_PARAMKEY_RENDITIONS[] = "coding.renditions";
+
+// Attached to output buffers of the additional renditions,
+// value is 1-based index in C2StreamRenditionsTuning list.
+typedef C2StreamParam<C2Info, C2Uint32Value, kParamIndexRenditionId>
+        C2StreamRenditionIdInfo;
+constexpr char C2_PARAMKEY_RENDITION_ID[] = "coding.rendition-id";
+
+// Enables insertion of sync frames on scene cuts detected in input frames,
+// works for frames in system memory only.
+typedef C2StreamParam<C2Tuning, C2EasyBoolValue, kParamIndexSceneChangeDetection>
+        C2StreamSceneChangeDetectionTuning;
+constexpr char C2_PARAMKEY_SCENE_CHANGE_DETECTION[] = "coding.scene-change-detection";
+
+// Number of frames analyzed ahead by lookahead bitrate control, 0 - lookahead is off.
+// Makes encoder hold that many more input frames.
+typedef C2StreamParam<C2Tuning, C2Uint32Value, kParamIndexLookAheadDepth>
+        C2StreamLookAheadDepthTuning;
+constexpr char C2_PARAMKEY_LOOKAHEAD_DEPTH[] = "coding.lookahead-depth";
+
+// Process-wide runtime metrics of the components as text, see MfxC2Metrics::Dump.
+// Read-only, the value is collected on every query.
+typedef C2GlobalParam<C2Info, C2StringValue, kParamIndexMetrics>
+        C2MetricsInfo;
+constexpr char C2_PARAMKEY_METRICS[] = "runtime.metrics";
+
+// Enables motion adaptive deinterlacing of the input in VPP component,
+// one progressive frame is output per interlaced input frame.
+typedef C2StreamParam<C2Tuning, C2EasyBoolValue, kParamIndexDeinterlace>
+        C2StreamDeinterlaceTuning;
+constexpr char C2_PARAMKEY_DEINTERLACE[] = "processing.deinterlace";
+
+// Field order of the interlaced input of VPP component, top field first by default.
+typedef C2StreamParam<C2Tuning, C2EasyBoolValue, kParamIndexBottomFieldFirst>
+        C2StreamBottomFieldFirstTuning;
+constexpr char C2_PARAMKEY_BOTTOM_FIELD_FIRST[] = "processing.bottom-field-first";
+
+} // namespace android
@@ -0,0 +1,58 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "mfx_defs.h"
+
+#include <vector>
+
+// Detects scene cuts in a sequence of frames comparing their downscaled luma.
+// Only frames in system memory are supported.
+class MfxC2SceneChangeDetector
+{
+public:
+    MfxC2SceneChangeDetector();
+
+    // Returns true if the frame starts a new scene. The first frame after Reset
+    // or after resolution change is never reported as a scene change.
+    bool DetectSceneChange(const mfxU8* luma, mfxU32 width, mfxU32 height, mfxU32 pitch);
+
+    void Reset();
+
+private:
+    // Averages luma in blocks of BLOCK_SIZE x BLOCK_SIZE into m_curFrame.
+    void Downscale(const mfxU8* luma, mfxU32 pitch);
+    // Returns mean absolute difference of m_curFrame and m_prevFrame.
+    float CompareFrames() const;
+
+private:
+    mfxU32 m_uWidth { 0 }; // downscaled frame size
+    mfxU32 m_uHeight { 0 };
+
+    std::vector<mfxU8> m_curFrame;
+    std::vector<mfxU8> m_prevFrame;
+    bool m_bHasPrevFrame { false };
+    // Moving average of frame differences within the current scene.
+    float m_fAvgDiff { 0.0f };
+
+    MFX_CLASS_NO_COPY(MfxC2SceneChangeDetector)
+};
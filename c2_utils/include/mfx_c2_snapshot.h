@@ -0,0 +1,74 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "mfx_defs.h"
+
+// Read-mostly state published as immutable snapshots.
+// Readers get shared_ptr to the current value and keep it alive while they need it,
+// so they never wait for writers preparing the next value.
+// Writers build a new value aside and swap it in, writers are serialized between each other.
+template<typename T>
+class MfxC2Snapshot
+{
+public:
+    MfxC2Snapshot() = default;
+
+    explicit MfxC2Snapshot(T value)
+    {
+        Store(std::move(value));
+    }
+
+    MFX_CLASS_NO_COPY(MfxC2Snapshot<T>)
+
+public:
+    // Returns nullptr if nothing has been stored yet.
+    std::shared_ptr<const T> Load() const
+    {
+        return std::atomic_load(&m_value);
+    }
+
+    void Store(T value)
+    {
+        std::shared_ptr<const T> new_value = std::make_shared<const T>(std::move(value));
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        std::atomic_store(&m_value, std::move(new_value));
+    }
+
+    // Copies current value, lets modifier change the copy and publishes it.
+    // Default constructed value is modified if nothing has been stored yet.
+    template<typename Modifier>
+    void Update(Modifier modifier)
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        std::shared_ptr<const T> old_value = std::atomic_load(&m_value);
+        std::shared_ptr<T> new_value = old_value ? std::make_shared<T>(*old_value) : std::make_shared<T>();
+        modifier(new_value.get());
+        std::atomic_store(&m_value, std::shared_ptr<const T>(std::move(new_value)));
+    }
+
+private:
+    std::shared_ptr<const T> m_value;
+    std::mutex m_writeMutex;
+};
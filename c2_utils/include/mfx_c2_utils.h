@@ -22,6 +22,7 @@
 
 #include "mfx_defs.h"
 #include "mfx_c2_defs.h"
+#include "mfx_c2_copy_planes.h"
 #include <C2Buffer.h>
 #include <C2Param.h>
 #include <fstream>
@@ -112,6 +113,9 @@ void InitNV12PlaneData(int32_t pitch_y, int32_t alloc_height, uint8_t* base, uin
 
 int MfxFourCCToGralloc(mfxU32 fourcc, bool using_video_memory = true);
 
+// Returns 0 for gralloc formats having no MediaSDK equivalent.
+mfxU32 GrallocToMfxFourCC(int format);
+
 bool IsYUV420(const C2GraphicView &view);
 
 bool IsNV12(const C2GraphicView &view);
@@ -123,6 +127,10 @@ bool IsYV12(const C2GraphicView &view);
 void ParseGop(const std::shared_ptr<C2StreamGopTuning::output> gop, 
     uint32_t &syncInterval, uint32_t &iInterval, uint32_t &maxBframes);
 
+// Returns temporal layer of the frame for dyadic layers structure
+// (layer i has scale 2^i), frame_order is counted from the last IDR.
+uint32_t GetTemporalLayerId(uint32_t frame_order, uint32_t layers_count);
+
 inline mfxU16 av1_mfx_profile_to_native_profile(mfxU16 profile)
 {
     switch (profile)
@@ -156,11 +164,17 @@ bool operator==(const C2PlaneInfo& p0, const C2PlaneInfo& p1);
 
 bool operator==(const C2PlanarLayout& src, const C2PlanarLayout& dst);
 
+// Copies views of the same size, see CopyPlanes for supported layouts conversions.
 c2_status_t CopyGraphicView(const C2GraphicView* src, C2GraphicView* dst);
 
 std::string FormatHex(const uint8_t* data, size_t len);
 
-// Writes binary buffers to file.
+// Returns path dir/<sub_dirs[0]>/.../<sub_dirs[N-1]>/name, missing folders are created.
+std::string CreateDumpFilePath(const std::string& dir,
+    const std::vector<std::string>& sub_dirs, const std::string& name);
+
+// Writes binary buffers to file synchronously in the calling thread,
+// see MfxC2AsyncWriter for dumps made from component threads.
 class BinaryWriter
 {
 public:
@@ -181,27 +195,15 @@ private:
     std::ofstream stream_;
 };
 
-// Writes YUV format frame to file.It useful for debug.
-class YUVWriter
-{
-public:
-    YUVWriter(const std::string& dir,
-        const std::vector<std::string>& sub_dirs, const std::string& name);
-
-    //TODO:
-    //Only support NV12 for now.
-    void Write(const uint8_t* yuv_data, int stride, int height, int frameIndex/*, int fourCC*/);
-
-private:
-    std::ofstream stream_;
-};
-
 //declare used extension buffers
 template<class T>
 struct mfx_ext_buffer_id{};
 template<>struct mfx_ext_buffer_id<mfxExtCodingOption> {
     enum {id = MFX_EXTBUFF_CODING_OPTION};
 };
+template<>struct mfx_ext_buffer_id<mfxExtCodingOption2> {
+    enum {id = MFX_EXTBUFF_CODING_OPTION2};
+};
 template<>struct mfx_ext_buffer_id<mfxExtCodingOptionSPSPPS> {
     enum {id = MFX_EXTBUFF_CODING_OPTION_SPSPPS};
 };
@@ -217,6 +219,9 @@ template<>struct mfx_ext_buffer_id<mfxExtVideoSignalInfo> {
 template<>struct mfx_ext_buffer_id<mfxExtEncoderResetOption> {
     enum {id = MFX_EXTBUFF_ENCODER_RESET_OPTION };
 };
+template<>struct mfx_ext_buffer_id<mfxExtAvcTemporalLayers> {
+    enum {id = MFX_EXTBUFF_AVC_TEMPORAL_LAYERS };
+};
 
 template <typename R>
 struct ExtParamAccessor
@@ -407,7 +412,8 @@ private:
             MFX_EXTBUFF_HEVC_PARAM,
             MFX_EXTBUFF_VP9_PARAM,
             MFX_EXTBUFF_VIDEO_SIGNAL_INFO,
-            MFX_EXTBUFF_ENCODER_RESET_OPTION
+            MFX_EXTBUFF_ENCODER_RESET_OPTION,
+            MFX_EXTBUFF_AVC_TEMPORAL_LAYERS
         };
 
         auto it = std::find_if(std::begin(allowed), std::end(allowed),
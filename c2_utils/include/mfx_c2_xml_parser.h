@@ -41,6 +41,16 @@
 #include "mfx_c2_defs.h"
 #include <map>
 
+// Frame rate range measured for the resolution,
+// read from <Limit name="measured-frame-rate-WxH" range="min-max" />.
+struct MfxC2MeasuredFrameRate
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t min_fps;
+    uint32_t max_fps;
+};
+
 class MfxXmlParser
 {
 public:
@@ -50,6 +60,7 @@ public:
     C2Component::kind_t getKind(const char *name);
     C2String getMediaType(const char *name);
     bool dumpOutputEnabled(const char *name);
+    std::vector<MfxC2MeasuredFrameRate> getMeasuredFrameRates(const char *name);
 
 private:
 
@@ -60,6 +71,7 @@ private:
         size_t order;      // order of appearance in the file (starting from 0)
         std::map<C2String, AttributeMap> typeMap;   // map of types supported by this codec
         bool dump_output{false};
+        std::vector<MfxC2MeasuredFrameRate> measured_frame_rates;
     };
 
     enum Section {
@@ -79,6 +91,8 @@ private:
 
     c2_status_t addDiagnostics(const char **attrs);
 
+    c2_status_t addLimit(const char **attrs);
+
     void startElementHandler(const char *name, const char **attrs);
     void endElementHandler(const char *name);
 
@@ -27,6 +27,7 @@
 #define MFX_PERF MFX_DEBUG_NO // enables PERF output, doesn't depends on MFX_DEBUG
 #define MFX_ATRACE MFX_DEBUG_NO // enables systrace
 #define MFX_DEBUG_DUMP_FRAME MFX_DEBUG_NO // enables write frame to file
+#define MFX_BINARY_TRACE MFX_DEBUG_YES // enables runtime switchable binary trace of per-frame spans, see mfx_binary_trace.h
 
 #define MFX_DEBUG_FILE MFX_DEBUG_NO // sends DEBUG and PERF output to file, otherwise to logcat
 
@@ -273,27 +274,38 @@ private:
 
 #endif // #if MFX_DEBUG == MFX_DEBUG_YES
 
-#if MFX_PERF == MFX_DEBUG_YES
-
 #include <chrono>
 
+class MfxC2Histogram;
+
+// Scoped timer, records duration of the scope in microseconds into the histogram.
+// Durations are aggregated rather than logged, so the measurement isn't distorted by logging
+// and tail latency is visible: histograms are named "perf.<module>:<function>[:<task>]"
+// and printed with the rest of runtime metrics, see MfxC2Metrics::Dump.
+// Count, min, max and avg are exact, p50/p90/p99 are within 12.5% of the actual
+// durations, see MfxC2Histogram::Summary::GetPercentile.
 class mfxPerf
 {
 public:
-    mfxPerf(const char* _modulename, const char* _function, const char* _taskname);
+    explicit mfxPerf(MfxC2Histogram* _histogram);
     ~mfxPerf(void);
     mfxPerf(const mfxPerf&) = delete;
     mfxPerf& operator=(const mfxPerf&) = delete;
 
+    // Called once per measured scope, the result is cached by MFX_AUTO_PERF.
+    static MfxC2Histogram* GetHistogram(const char* _modulename, const char* _function, const char* _taskname);
+
 protected:
-    const char* modulename;
-    const char* function;
-    const char* taskname;
-    std::chrono::high_resolution_clock::time_point start;
+    MfxC2Histogram* histogram;
+    std::chrono::steady_clock::time_point start;
 };
 
+#if MFX_PERF == MFX_DEBUG_YES
+
 #define MFX_AUTO_PERF(_task_name) \
-    mfxPerf _mfx_perf(MFX_DEBUG_MODULE_NAME, __FUNCTION__, _task_name)
+    static MfxC2Histogram* const _mfx_perf_histogram = \
+        mfxPerf::GetHistogram(MFX_DEBUG_MODULE_NAME, __FUNCTION__, _task_name); \
+    mfxPerf _mfx_perf(_mfx_perf_histogram)
 
 #define MFX_AUTO_PERF_FUNC \
     MFX_AUTO_PERF(NULL)
@@ -321,3 +333,18 @@ protected:
 #define MFX_DEBUG_TRACE_FUNC ATRACE_CALL()
 
 #endif
+
+#if MFX_BINARY_TRACE == MFX_DEBUG_YES
+
+// Only explicit trace points (MFX_BINARY_TRACE_SCOPE, _FRAME, _EVENT) go to the binary trace,
+// MFX_DEBUG_TRACE_FUNC stays compiled out of release builds.
+#include "mfx_binary_trace.h"
+
+#else // #if MFX_BINARY_TRACE == MFX_DEBUG_YES
+
+#define MFX_BINARY_TRACE_SCOPE(_name)
+#define MFX_BINARY_TRACE_FUNC
+#define MFX_BINARY_TRACE_FRAME(_frame_index)
+#define MFX_BINARY_TRACE_EVENT(_name, _arg)
+
+#endif // #if MFX_BINARY_TRACE == MFX_DEBUG_YES
@@ -121,6 +121,9 @@ protected: // functions
     mfxStatus BstBufMalloc (mfxU32 new_size);
     // cleaning up of internal buffers
     mfxStatus BstBufSync();
+    // update statistics and process-wide metrics
+    void CountCopyBytes(mfxU32 bytes);
+    void CountRealloc();
 
 protected: // data
     // parameters which define FC behavior
@@ -0,0 +1,399 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_binary_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef ANDROID
+#include <cutils/properties.h>
+#endif
+
+// Saved trace layout, all numbers are little-endian:
+//   char[8]  magic "MFXC2TRC"
+//   uint32   version, uint32 event size
+//   uint64   steady clock and uint64 realtime clock at the save moment, ns,
+//            to map event times to wall-clock time
+//   uint32   names count, then for each name: uint32 length, chars ("module:name")
+//   uint32   threads count, then for each thread: uint32 tid, uint32 events count,
+//            events (MfxBinaryTraceEvent) from the oldest to the newest
+
+static const char TRACE_MAGIC[8] = { 'M', 'F', 'X', 'C', '2', 'T', 'R', 'C' };
+static const uint32_t TRACE_VERSION = 1;
+
+static_assert((MfxBinaryTrace::RING_SIZE & (MfxBinaryTrace::RING_SIZE - 1)) == 0,
+    "ring size must be power of 2");
+
+namespace {
+
+// Events are kept as atomic words, so the save could copy slots the owner is overwriting
+// and tell that from `written` (see CollectEvents).
+const size_t EVENT_WORDS = sizeof(MfxBinaryTraceEvent) / sizeof(uint64_t);
+static_assert(sizeof(MfxBinaryTraceEvent) % sizeof(uint64_t) == 0, "event is stored in 64-bit words");
+
+struct Ring
+{
+    std::unique_ptr<std::atomic<uint64_t>[]> words { new std::atomic<uint64_t>[MfxBinaryTrace::RING_SIZE * EVENT_WORDS] };
+    // Position of the next event, written by the owning thread only.
+    std::atomic<uint64_t> written { 0 };
+    uint32_t tid { 0 };
+    bool in_use { false }; // guarded by Registry::mutex
+    uint64_t release_order { 0 }; // guarded by Registry::mutex
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<std::string> names;
+    uint64_t release_count { 0 };
+};
+
+// Rings of exited threads are kept till that many rings are allocated,
+// then the longest released ring is reused.
+const size_t MAX_KEPT_RINGS = 32;
+
+// Never destroyed as threads might trace while the process exits.
+Registry& GetRegistry()
+{
+    static Registry* registry = new Registry;
+    return *registry;
+}
+
+// Releases the ring of exited thread for reuse, its events stay saveable till then.
+struct RingOwner
+{
+    Ring* ring { nullptr };
+
+    ~RingOwner();
+};
+
+thread_local Ring* t_ring = nullptr;
+thread_local uint64_t t_frame = MfxBinaryTrace::NO_FRAME;
+thread_local bool t_exited = false;
+thread_local RingOwner t_owner;
+
+RingOwner::~RingOwner()
+{
+    if (ring) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        ring->in_use = false;
+        ring->release_order = ++registry.release_count;
+    }
+    t_ring = nullptr;
+    t_exited = true;
+}
+
+Ring* AcquireRing()
+{
+    if (t_exited) return nullptr; // traced from other thread_local destructors
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    Ring* ring = nullptr;
+    if (registry.rings.size() >= MAX_KEPT_RINGS) {
+        for (auto& free_ring : registry.rings) {
+            if (!free_ring->in_use && (!ring || free_ring->release_order < ring->release_order)) {
+                ring = free_ring.get();
+            }
+        }
+    }
+    if (!ring) {
+        registry.rings.emplace_back(new Ring);
+        ring = registry.rings.back().get();
+    }
+    ring->in_use = true;
+    ring->tid = (uint32_t)gettid();
+    ring->written.store(0, std::memory_order_relaxed);
+
+    t_owner.ring = ring;
+    t_ring = ring;
+    return ring;
+}
+
+void StoreEvent(Ring* ring, uint64_t pos, const MfxBinaryTraceEvent& event)
+{
+    uint64_t words[EVENT_WORDS];
+    memcpy(words, &event, sizeof(event));
+
+    std::atomic<uint64_t>* slot = &ring->words[(pos & (MfxBinaryTrace::RING_SIZE - 1)) * EVENT_WORDS];
+    for (size_t i = 0; i < EVENT_WORDS; ++i) {
+        slot[i].store(words[i], std::memory_order_relaxed);
+    }
+}
+
+MfxBinaryTraceEvent LoadEvent(const Ring& ring, uint64_t pos)
+{
+    uint64_t words[EVENT_WORDS];
+
+    const std::atomic<uint64_t>* slot = &ring.words[(pos & (MfxBinaryTrace::RING_SIZE - 1)) * EVENT_WORDS];
+    for (size_t i = 0; i < EVENT_WORDS; ++i) {
+        words[i] = slot[i].load(std::memory_order_relaxed);
+    }
+
+    MfxBinaryTraceEvent event;
+    memcpy(&event, words, sizeof(event));
+    return event;
+}
+
+template<typename T>
+void WriteValue(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint64_t GetClockNs(clockid_t clock)
+{
+    struct timespec ts {};
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint64_t GetSteadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct ThreadEvents
+{
+    uint32_t tid;
+    std::vector<MfxBinaryTraceEvent> events;
+};
+
+// Copies events of all rings, should be called under Registry::mutex.
+std::vector<ThreadEvents> CollectEvents(const Registry& registry)
+{
+    const uint64_t RING_SIZE = MfxBinaryTrace::RING_SIZE;
+    std::vector<ThreadEvents> threads;
+
+    for (const auto& ring : registry.rings) {
+        const uint64_t end = ring->written.load(std::memory_order_acquire);
+        const uint64_t begin = (end > RING_SIZE) ? end - RING_SIZE : 0;
+
+        std::vector<MfxBinaryTraceEvent> events;
+        events.reserve(end - begin);
+        for (uint64_t pos = begin; pos < end; ++pos) {
+            events.push_back(LoadEvent(*ring, pos));
+        }
+        // The owner keeps writing: drop events which slots were reused during the copy,
+        // including the slot of the event being written now if the owner is alive.
+        // Pairs with the release fence in Write: if any word of a reused slot is copied,
+        // `written` read below covers the event overwriting it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t written = ring->written.load(std::memory_order_relaxed) + (ring->in_use ? 1 : 0);
+        const uint64_t first_valid = (written > RING_SIZE) ? written - RING_SIZE : 0;
+        if (first_valid > begin) {
+            events.erase(events.begin(), events.begin() + std::min(first_valid - begin, end - begin));
+        }
+        threads.push_back({ ring->tid, std::move(events) });
+    }
+    return threads;
+}
+
+void SaveBinary(std::ostream& os, const std::vector<std::string>& names,
+    const std::vector<ThreadEvents>& threads)
+{
+    os.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    WriteValue(os, TRACE_VERSION);
+    WriteValue(os, (uint32_t)sizeof(MfxBinaryTraceEvent));
+    WriteValue(os, GetSteadyNs());
+    WriteValue(os, GetClockNs(CLOCK_REALTIME));
+
+    WriteValue(os, (uint32_t)names.size());
+    for (const std::string& name : names) {
+        WriteValue(os, (uint32_t)name.size());
+        os.write(name.data(), name.size());
+    }
+
+    WriteValue(os, (uint32_t)threads.size());
+    for (const ThreadEvents& thread : threads) {
+        WriteValue(os, thread.tid);
+        WriteValue(os, (uint32_t)thread.events.size());
+        os.write(reinterpret_cast<const char*>(thread.events.data()),
+            thread.events.size() * sizeof(MfxBinaryTraceEvent));
+    }
+}
+
+void WriteJsonString(std::ostream& os, const std::string& str)
+{
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            os << ' ';
+        } else {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+// Chrome trace-event JSON as read by chrome://tracing and Perfetto UI, spans are
+// begin/end pairs on thread tracks. Names "module:function" are split into category and name.
+void SaveJson(std::ostream& os, const std::vector<std::string>& names,
+    const std::vector<ThreadEvents>& threads)
+{
+    const int pid = getpid();
+    bool first = true;
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const ThreadEvents& thread : threads) {
+        for (const MfxBinaryTraceEvent& event : thread.events) {
+            const char* phase = nullptr;
+            switch (event.type) {
+                case MfxBinaryTrace::EVENT_BEGIN: phase = "B"; break;
+                case MfxBinaryTrace::EVENT_END: phase = "E"; break;
+                case MfxBinaryTrace::EVENT_INSTANT: phase = "i"; break;
+                default: break;
+            }
+            if (!phase || event.name_id >= names.size()) continue;
+
+            const std::string& full_name = names[event.name_id];
+            const size_t sep = full_name.find(':');
+
+            os << (first ? "\n" : ",\n");
+            first = false;
+
+            os << "{\"name\":";
+            WriteJsonString(os, (sep == std::string::npos) ? full_name : full_name.substr(sep + 1));
+            os << ",\"cat\":";
+            WriteJsonString(os, (sep == std::string::npos) ? std::string() : full_name.substr(0, sep));
+            // microseconds with nanosecond precision
+            os << ",\"ph\":\"" << phase << "\",\"ts\":" << event.time_ns / 1000 << '.'
+               << std::to_string(1000 + event.time_ns % 1000).substr(1)
+               << ",\"pid\":" << pid << ",\"tid\":" << thread.tid;
+            if (event.type == MfxBinaryTrace::EVENT_INSTANT) {
+                os << ",\"s\":\"t\"";
+            }
+            if (event.flags & MfxBinaryTrace::FLAG_FRAME) {
+                os << ",\"args\":{\"frame\":" << event.arg << "}";
+            } else if (event.flags & MfxBinaryTrace::FLAG_ARG) {
+                os << ",\"args\":{\"arg\":" << event.arg << "}";
+            }
+            os << "}";
+        }
+    }
+    os << "\n]}\n";
+}
+
+} // namespace
+
+std::atomic<bool> MfxBinaryTrace::s_enabled { false };
+
+void MfxBinaryTrace::Enable(bool enable)
+{
+    s_enabled.store(enable, std::memory_order_relaxed);
+}
+
+void MfxBinaryTrace::UpdateFromProperty()
+{
+#ifdef ANDROID
+    char szTrace[PROPERTY_VALUE_MAX] = {'\0'};
+    if (property_get("vendor.intel.video.c2.trace", szTrace, NULL) > 0) {
+        if (strncmp(szTrace, "1", PROPERTY_VALUE_MAX) == 0) {
+            Enable(true);
+        } else if (strncmp(szTrace, "0", PROPERTY_VALUE_MAX) == 0) {
+            Enable(false);
+        }
+    }
+#endif
+}
+
+uint32_t MfxBinaryTrace::RegisterName(const char* module, const char* name)
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    registry.names.push_back(std::string(module ? module : "") + ":" + (name ? name : ""));
+    return (uint32_t)(registry.names.size() - 1);
+}
+
+void MfxBinaryTrace::Write(EventType type, uint32_t name_id, uint64_t arg)
+{
+    Ring* ring = t_ring ? t_ring : AcquireRing();
+    if (!ring) return;
+
+    uint64_t pos = ring->written.load(std::memory_order_relaxed);
+    MfxBinaryTraceEvent event;
+    event.time_ns = GetSteadyNs();
+    event.name_id = name_id;
+    event.type = type;
+    if (EVENT_INSTANT == type) {
+        event.flags = FLAG_ARG;
+        event.arg = arg;
+    } else {
+        event.flags = (NO_FRAME != t_frame) ? FLAG_FRAME : 0;
+        event.arg = t_frame;
+    }
+    // Orders the previous `written` store before the slot stores, see CollectEvents.
+    std::atomic_thread_fence(std::memory_order_release);
+    StoreEvent(ring, pos, event);
+    ring->written.store(pos + 1, std::memory_order_release);
+}
+
+uint64_t MfxBinaryTrace::SetFrame(uint64_t frame_index)
+{
+    uint64_t prev_frame = t_frame;
+    t_frame = frame_index;
+    return prev_frame;
+}
+
+bool MfxBinaryTrace::Save(std::ostream& os, Format format)
+{
+    Registry& registry = GetRegistry();
+    std::vector<std::string> names;
+    std::vector<ThreadEvents> threads;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        names = registry.names;
+        threads = CollectEvents(registry);
+    }
+
+    if (FORMAT_JSON == format) {
+        SaveJson(os, names, threads);
+    } else {
+        SaveBinary(os, names, threads);
+    }
+    return os.good();
+}
+
+bool MfxBinaryTrace::Save(const char* filename)
+{
+    const std::string name(filename ? filename : "");
+    const std::string json_ext = ".json";
+    const bool json = name.size() >= json_ext.size() &&
+        0 == name.compare(name.size() - json_ext.size(), json_ext.size(), json_ext);
+
+    std::ofstream file(name, std::ios::binary | std::ios::trunc);
+    return file.is_open() && Save(file, json ? FORMAT_JSON : FORMAT_BINARY);
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_c2_async_writer.h"
+#include "mfx_c2_utils.h"
+#include "mfx_debug.h"
+
+#include <string.h>
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_c2_async_writer"
+
+MfxC2AsyncWriter::MfxC2AsyncWriter(const std::string& dir, const std::vector<std::string>& sub_dirs,
+    const std::string& name, size_t max_queued_bytes):
+    m_maxQueuedBytes(max_queued_bytes),
+    m_droppedMetric(MfxC2Metrics::GetInstance().GetCounter("dump.dropped"))
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_stream.open(CreateDumpFilePath(dir, sub_dirs, name).c_str(), std::fstream::trunc | std::fstream::binary);
+    if (!m_stream.is_open()) {
+        MFX_LOG_ERROR("Cannot open dump file %s", name.c_str());
+    }
+    m_queue.Start();
+}
+
+MfxC2AsyncWriter::~MfxC2AsyncWriter()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_queue.Stop();
+}
+
+bool MfxC2AsyncWriter::Reserve(size_t length)
+{
+    size_t queued = m_queuedBytes.load(std::memory_order_relaxed);
+    do {
+        if (queued + length > m_maxQueuedBytes) {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            m_droppedMetric->Add();
+            return false;
+        }
+    } while (!m_queuedBytes.compare_exchange_weak(queued, queued + length, std::memory_order_relaxed));
+    return true;
+}
+
+void MfxC2AsyncWriter::Queue(std::vector<uint8_t>&& payload)
+{
+    m_queue.Push([this, payload = std::move(payload)] () {
+        if (m_stream.is_open()) {
+            m_stream.write((const char*)payload.data(), payload.size());
+        }
+        m_queuedBytes.fetch_sub(payload.size(), std::memory_order_relaxed);
+    });
+}
+
+bool MfxC2AsyncWriter::Write(const uint8_t* data, size_t length)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!Reserve(length)) return false;
+
+    Queue(std::vector<uint8_t>(data, data + length));
+    return true;
+}
+
+bool MfxC2AsyncWriter::WriteNV12(const uint8_t* y, const uint8_t* uv, size_t pitch, uint32_t width, uint32_t height)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    const size_t length = (size_t)width * height + (size_t)width * (height / 2);
+    if (!Reserve(length)) return false;
+
+    std::vector<uint8_t> payload(length);
+    uint8_t* dst = payload.data();
+    for (uint32_t row = 0; row < height; ++row, dst += width) {
+        memcpy(dst, y + row * pitch, width);
+    }
+    for (uint32_t row = 0; row < height / 2; ++row, dst += width) {
+        memcpy(dst, uv + row * pitch, width);
+    }
+    Queue(std::move(payload));
+    return true;
+}
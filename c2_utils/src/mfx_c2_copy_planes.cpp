@@ -0,0 +1,249 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "mfx_c2_copy_planes.h"
+#include "mfx_debug.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_c2_copy_planes"
+
+// Interleaves samples of two planar rows into one semi-planar row:
+// dst = { first[0], second[0], first[1], second[1], ... }.
+template<typename T>
+static void InterleaveRow(const uint8_t* first, const uint8_t* second, uint8_t* dst, uint32_t count)
+{
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    const uint32_t step = sizeof(__m128i) / sizeof(T);
+    for (; i + step <= count; i += step) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i * sizeof(T)));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i * sizeof(T)));
+        __m128i lo, hi;
+        if constexpr (sizeof(T) == 1) {
+            lo = _mm_unpacklo_epi8(a, b);
+            hi = _mm_unpackhi_epi8(a, b);
+        } else {
+            lo = _mm_unpacklo_epi16(a, b);
+            hi = _mm_unpackhi_epi16(a, b);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i * sizeof(T)), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * i + step) * sizeof(T)), hi);
+    }
+#endif
+    for (; i < count; ++i) {
+        memcpy(dst + 2 * i * sizeof(T), first + i * sizeof(T), sizeof(T));
+        memcpy(dst + (2 * i + 1) * sizeof(T), second + i * sizeof(T), sizeof(T));
+    }
+}
+
+// Splits samples of semi-planar row into two planar rows, reverse of InterleaveRow.
+template<typename T>
+static void DeinterleaveRow(const uint8_t* src, uint8_t* first, uint8_t* second, uint32_t count)
+{
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    const uint32_t step = sizeof(__m128i) / sizeof(T);
+    for (; i + step <= count; i += step) {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i * sizeof(T)));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (2 * i + step) * sizeof(T)));
+        __m128i a, b;
+        if constexpr (sizeof(T) == 1) {
+            const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+            a = _mm_packus_epi16(_mm_and_si128(v0, low_bytes), _mm_and_si128(v1, low_bytes));
+            b = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+        } else {
+            // gather even words to low and odd words to high half of every register
+            for (__m128i* v : { &v0, &v1 }) {
+                *v = _mm_shufflelo_epi16(*v, _MM_SHUFFLE(3, 1, 2, 0));
+                *v = _mm_shufflehi_epi16(*v, _MM_SHUFFLE(3, 1, 2, 0));
+                *v = _mm_shuffle_epi32(*v, _MM_SHUFFLE(3, 1, 2, 0));
+            }
+            a = _mm_unpacklo_epi64(v0, v1);
+            b = _mm_unpackhi_epi64(v0, v1);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(first + i * sizeof(T)), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(second + i * sizeof(T)), b);
+    }
+#endif
+    for (; i < count; ++i) {
+        memcpy(first + i * sizeof(T), src + 2 * i * sizeof(T), sizeof(T));
+        memcpy(second + i * sizeof(T), src + (2 * i + 1) * sizeof(T), sizeof(T));
+    }
+}
+
+static void CopyPlane(uint32_t width, uint32_t height, uint32_t sample_size,
+    const uint8_t* src, const C2PlaneInfo& src_plane, uint8_t* dst, const C2PlaneInfo& dst_plane)
+{
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* src_row = src + (ptrdiff_t)y * src_plane.rowInc;
+        uint8_t* dst_row = dst + (ptrdiff_t)y * dst_plane.rowInc;
+
+        if (src_plane.colInc == (int32_t)sample_size && dst_plane.colInc == (int32_t)sample_size) {
+            memcpy(dst_row, src_row, (size_t)width * sample_size);
+        } else {
+            for (uint32_t x = 0; x < width; ++x) {
+                memcpy(dst_row + (ptrdiff_t)x * dst_plane.colInc,
+                    src_row + (ptrdiff_t)x * src_plane.colInc, sample_size);
+            }
+        }
+    }
+}
+
+// Returns true if U and V planes share rows with samples interleaved,
+// first_plane receives the plane starting the pair (U for NV12, V for NV21).
+static bool IsSemiPlanarChroma(const C2PlanarLayout& layout, const uint8_t* const* data,
+    uint32_t sample_size, C2PlanarLayout::plane_index_t* first_plane)
+{
+    const C2PlaneInfo& u_plane = layout.planes[C2PlanarLayout::PLANE_U];
+    const C2PlaneInfo& v_plane = layout.planes[C2PlanarLayout::PLANE_V];
+
+    bool res = false;
+    do {
+        if (u_plane.colInc != (int32_t)(2 * sample_size)) break;
+        if (v_plane.colInc != u_plane.colInc) break;
+        if (v_plane.rowInc != u_plane.rowInc) break;
+
+        intptr_t distance = reinterpret_cast<intptr_t>(data[C2PlanarLayout::PLANE_V]) -
+            reinterpret_cast<intptr_t>(data[C2PlanarLayout::PLANE_U]);
+        if (distance == (intptr_t)sample_size) {
+            *first_plane = C2PlanarLayout::PLANE_U;
+        } else if (distance == -(intptr_t)sample_size) {
+            *first_plane = C2PlanarLayout::PLANE_V;
+        } else {
+            break;
+        }
+        res = true;
+    } while (false);
+    return res;
+}
+
+c2_status_t CopyPlanes(uint32_t width, uint32_t height,
+    const C2PlanarLayout& src_layout, const uint8_t* const* src_data,
+    const C2PlanarLayout& dst_layout, uint8_t* const* dst_data)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_DEBUG_TRACE_U32(width);
+    MFX_DEBUG_TRACE_U32(height);
+
+    c2_status_t res = C2_OK;
+    do {
+        if (src_layout.type != C2PlanarLayout::TYPE_YUV || dst_layout.type != C2PlanarLayout::TYPE_YUV ||
+            src_layout.numPlanes != 3 || dst_layout.numPlanes != 3) {
+            res = C2_CANNOT_DO;
+            break;
+        }
+
+        for (uint32_t i = 0; i < src_layout.numPlanes; ++i) {
+            const C2PlaneInfo& src_plane = src_layout.planes[i];
+            const C2PlaneInfo& dst_plane = dst_layout.planes[i];
+            // only sample positions may differ, conversion of sample values is not supported
+            if (src_plane.channel != dst_plane.channel ||
+                src_plane.colSampling != dst_plane.colSampling ||
+                src_plane.rowSampling != dst_plane.rowSampling ||
+                src_plane.allocatedDepth != dst_plane.allocatedDepth ||
+                src_plane.bitDepth != dst_plane.bitDepth ||
+                src_plane.rightShift != dst_plane.rightShift ||
+                src_plane.endianness != dst_plane.endianness ||
+                (src_plane.allocatedDepth != 8 && src_plane.allocatedDepth != 16) ||
+                src_plane.colSampling == 0 || src_plane.rowSampling == 0) {
+                res = C2_CANNOT_DO;
+                break;
+            }
+        }
+        if (C2_OK != res) break;
+
+        const C2PlaneInfo& src_u = src_layout.planes[C2PlanarLayout::PLANE_U];
+        const C2PlaneInfo& src_v = src_layout.planes[C2PlanarLayout::PLANE_V];
+        const C2PlaneInfo& dst_u = dst_layout.planes[C2PlanarLayout::PLANE_U];
+        const C2PlaneInfo& dst_v = dst_layout.planes[C2PlanarLayout::PLANE_V];
+
+        if (src_u.colSampling != src_v.colSampling || src_u.rowSampling != src_v.rowSampling ||
+            src_u.allocatedDepth != src_v.allocatedDepth) {
+            res = C2_CANNOT_DO;
+            break;
+        }
+
+        const C2PlaneInfo& y_plane = src_layout.planes[C2PlanarLayout::PLANE_Y];
+        CopyPlane(width, height, y_plane.allocatedDepth / 8,
+            src_data[C2PlanarLayout::PLANE_Y], y_plane,
+            dst_data[C2PlanarLayout::PLANE_Y], dst_layout.planes[C2PlanarLayout::PLANE_Y]);
+
+        const uint32_t sample_size = src_u.allocatedDepth / 8;
+        const uint32_t chroma_width = (width + src_u.colSampling - 1) / src_u.colSampling;
+        const uint32_t chroma_height = (height + src_u.rowSampling - 1) / src_u.rowSampling;
+
+        C2PlanarLayout::plane_index_t src_first {}, dst_first {};
+        const bool src_semi_planar = IsSemiPlanarChroma(src_layout, src_data, sample_size, &src_first);
+        const bool dst_semi_planar = IsSemiPlanarChroma(dst_layout, dst_data, sample_size, &dst_first);
+        const bool src_planar = src_u.colInc == (int32_t)sample_size && src_v.colInc == (int32_t)sample_size;
+        const bool dst_planar = dst_u.colInc == (int32_t)sample_size && dst_v.colInc == (int32_t)sample_size;
+
+        if (src_planar && dst_semi_planar) { // I420/YV12 -> NV12
+            const C2PlanarLayout::plane_index_t first = dst_first;
+            const C2PlanarLayout::plane_index_t second =
+                (first == C2PlanarLayout::PLANE_U) ? C2PlanarLayout::PLANE_V : C2PlanarLayout::PLANE_U;
+            for (uint32_t y = 0; y < chroma_height; ++y) {
+                const uint8_t* first_row = src_data[first] + (ptrdiff_t)y * src_layout.planes[first].rowInc;
+                const uint8_t* second_row = src_data[second] + (ptrdiff_t)y * src_layout.planes[second].rowInc;
+                uint8_t* dst_row = dst_data[first] + (ptrdiff_t)y * dst_u.rowInc;
+                if (sample_size == 1) {
+                    InterleaveRow<uint8_t>(first_row, second_row, dst_row, chroma_width);
+                } else {
+                    InterleaveRow<uint16_t>(first_row, second_row, dst_row, chroma_width);
+                }
+            }
+        } else if (src_semi_planar && dst_planar) { // NV12 -> I420/YV12
+            const C2PlanarLayout::plane_index_t first = src_first;
+            const C2PlanarLayout::plane_index_t second =
+                (first == C2PlanarLayout::PLANE_U) ? C2PlanarLayout::PLANE_V : C2PlanarLayout::PLANE_U;
+            for (uint32_t y = 0; y < chroma_height; ++y) {
+                const uint8_t* src_row = src_data[first] + (ptrdiff_t)y * src_u.rowInc;
+                uint8_t* first_row = dst_data[first] + (ptrdiff_t)y * dst_layout.planes[first].rowInc;
+                uint8_t* second_row = dst_data[second] + (ptrdiff_t)y * dst_layout.planes[second].rowInc;
+                if (sample_size == 1) {
+                    DeinterleaveRow<uint8_t>(src_row, first_row, second_row, chroma_width);
+                } else {
+                    DeinterleaveRow<uint16_t>(src_row, first_row, second_row, chroma_width);
+                }
+            }
+        } else if (src_semi_planar && dst_semi_planar && src_first == dst_first) { // NV12 with another pitch
+            for (uint32_t y = 0; y < chroma_height; ++y) {
+                memcpy(dst_data[dst_first] + (ptrdiff_t)y * dst_u.rowInc,
+                    src_data[src_first] + (ptrdiff_t)y * src_u.rowInc, (size_t)2 * chroma_width * sample_size);
+            }
+        } else { // planar with another pitch or swapped chroma order
+            for (C2PlanarLayout::plane_index_t plane_index : { C2PlanarLayout::PLANE_U, C2PlanarLayout::PLANE_V }) {
+                CopyPlane(chroma_width, chroma_height, sample_size,
+                    src_data[plane_index], src_layout.planes[plane_index],
+                    dst_data[plane_index], dst_layout.planes[plane_index]);
+            }
+        }
+    } while (false);
+
+    MFX_DEBUG_TRACE_I32(res);
+    return res;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_c2_metrics.h"
+
+#include <algorithm>
+#include <sstream>
+
+size_t MfxC2Histogram::GetBucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKET_COUNT) return value;
+
+    size_t exponent = 0; // of the highest bit
+    for (uint64_t rest = value >> 1; rest; rest >>= 1) {
+        ++exponent;
+    }
+    // bits following the highest one select the sub-bucket
+    const size_t sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return SUB_BUCKET_COUNT * (exponent - SUB_BUCKET_BITS + 1) + sub_bucket;
+}
+
+std::pair<uint64_t, uint64_t> MfxC2Histogram::GetBucketBounds(size_t index)
+{
+    if (index < SUB_BUCKET_COUNT) return { index, index };
+
+    const size_t shift = index / SUB_BUCKET_COUNT - 1; // exponent - SUB_BUCKET_BITS
+    const uint64_t lower = (uint64_t)(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return { lower, lower + ((1ull << shift) - 1) };
+}
+
+void MfxC2Histogram::Record(uint64_t value)
+{
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    m_buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t min = m_min.load(std::memory_order_relaxed);
+    while (value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed)) {}
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+MfxC2Histogram::Summary MfxC2Histogram::GetSummary() const
+{
+    Summary summary;
+    summary.count = m_count.load(std::memory_order_relaxed);
+    summary.sum = m_sum.load(std::memory_order_relaxed);
+    summary.min = summary.count ? m_min.load(std::memory_order_relaxed) : 0;
+    summary.max = m_max.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        summary.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return summary;
+}
+
+uint64_t MfxC2Histogram::Summary::GetPercentile(double percentile) const
+{
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) total += bucket;
+    if (0 == total) return 0;
+
+    // rank of the value in sorted values, 1-based
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)(percentile * total / 100 + 0.5));
+
+    uint64_t passed = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        if (passed + buckets[i] >= rank) {
+            // values are taken as spread evenly over the bucket
+            std::pair<uint64_t, uint64_t> bounds = GetBucketBounds(i);
+            double position = (double)(rank - passed) / buckets[i];
+            uint64_t value = bounds.first + (uint64_t)((bounds.second - bounds.first) * position);
+            return std::max(min, std::min(value, max));
+        }
+        passed += buckets[i];
+    }
+    return max;
+}
+
+MfxC2Metrics& MfxC2Metrics::GetInstance()
+{
+    // never destroyed, components might update metrics during process exit
+    static MfxC2Metrics* s_instance = new MfxC2Metrics();
+    return *s_instance;
+}
+
+template<typename Metric>
+Metric* MfxC2Metrics::GetMetric(std::map<std::string, std::unique_ptr<Metric>>* metrics, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unique_ptr<Metric>& metric = (*metrics)[name];
+    if (!metric) {
+        metric = std::make_unique<Metric>();
+    }
+    return metric.get();
+}
+
+MfxC2Counter* MfxC2Metrics::GetCounter(const std::string& name)
+{
+    return GetMetric(&m_counters, name);
+}
+
+MfxC2Gauge* MfxC2Metrics::GetGauge(const std::string& name)
+{
+    return GetMetric(&m_gauges, name);
+}
+
+MfxC2Histogram* MfxC2Metrics::GetHistogram(const std::string& name)
+{
+    return GetMetric(&m_histograms, name);
+}
+
+void MfxC2Metrics::Dump(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (const auto& counter : m_counters) {
+        os << "counter " << counter.first << " " << counter.second->Get() << std::endl;
+    }
+    for (const auto& gauge : m_gauges) {
+        os << "gauge " << gauge.first << " " << gauge.second->Get() << std::endl;
+    }
+    for (const auto& histogram : m_histograms) {
+        MfxC2Histogram::Summary summary = histogram.second->GetSummary();
+        os << "histogram " << histogram.first
+           << " count=" << summary.count
+           << " min=" << summary.min
+           << " max=" << summary.max
+           << " avg=" << (summary.count ? summary.sum / summary.count : 0)
+           << " p50=" << summary.GetPercentile(50)
+           << " p90=" << summary.GetPercentile(90)
+           << " p99=" << summary.GetPercentile(99) << std::endl;
+    }
+}
+
+std::string MfxC2Metrics::Dump() const
+{
+    std::ostringstream ss;
+    Dump(ss);
+    return ss.str();
+}
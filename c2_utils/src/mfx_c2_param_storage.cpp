@@ -23,6 +23,7 @@
 #include "mfx_debug.h"
 #include "mfx_c2_utils.h"
 #include <sstream>
+#include <string.h>
 
 #undef MFX_DEBUG_MODULE_NAME
 #define MFX_DEBUG_MODULE_NAME "mfx_c2_param_storage"
@@ -80,14 +81,15 @@ c2_status_t MfxC2ParamStorage::QueryParam(C2Param::Index index, C2Param** dst) c
 
     {
         std::lock_guard<std::mutex> lock(m_valuesMutex);
-        auto value_found = m_values.find(index);
+        const C2ParamLocation* value_found = m_values.Find(index);
 
-        if (value_found != m_values.end()) {
+        if (nullptr != value_found) {
+            const C2Param* value = GetValue(*value_found);
             if (nullptr == *dst) {
-                *dst = C2Param::Copy(*value_found->second).release();
+                *dst = C2Param::Copy(*value).release();
             }
             else {
-                bool copy_res = (*dst)->updateFrom(*value_found->second);
+                bool copy_res = (*dst)->updateFrom(*value);
                 if (!copy_res) {
                     (*dst)->invalidate();
                     res = C2_NO_MEMORY;
@@ -95,9 +97,9 @@ c2_status_t MfxC2ParamStorage::QueryParam(C2Param::Index index, C2Param** dst) c
             }
 
         } else {
-            auto operations_found = m_paramOperations.find(index);
-            if (operations_found != m_paramOperations.end()) {
-                const C2ParamOperations& operations = operations_found->second;
+            const C2ParamOperations* operations_found = m_paramOperations.Find(index);
+            if (nullptr != operations_found) {
+                const C2ParamOperations& operations = *operations_found;
                 if (nullptr == *dst) {
                     *dst = operations.allocate_();
                 }
@@ -141,20 +143,19 @@ c2_status_t MfxC2ParamStorage::ConfigParam(const C2Param& param, bool component_
         C2Param::Index index = param.index();
         {
             std::lock_guard<std::mutex> lock(m_valuesMutex);
-            auto value_found = m_values.find(index);
-            if (value_found != m_values.end()) {
+            if (nullptr != m_values.Find(index)) {
                 failures->push_back(MakeC2SettingResult(C2ParamField(&param), C2SettingResult::READ_ONLY));
                 break;
             }
         }
 
-        auto operations_found = m_paramOperations.find(index);
-        if (operations_found == m_paramOperations.end()) {
+        const C2ParamOperations* operations_found = m_paramOperations.Find(index);
+        if (nullptr == operations_found) {
             failures->push_back(MakeC2SettingResult(C2ParamField(&param), C2SettingResult::READ_ONLY));
             break;
         }
 
-        const C2ParamOperations& operations = operations_found->second;
+        const C2ParamOperations& operations = *operations_found;
         if (!operations.set_) {
             failures->push_back(MakeC2SettingResult(C2ParamField(&param), C2SettingResult::READ_ONLY));
             break;
@@ -247,14 +248,31 @@ bool MfxC2ParamStorage::ValidateParam(const C2Param* param,
 
 bool MfxC2ParamStorage::FindParam(C2Param::Index param_index) const
 {
-    return FindC2Param(m_paramsDescriptors, param_index);
+    return nullptr != m_paramsDescriptorsIndex.Find(param_index);
 }
 
 std::unique_ptr<C2SettingResult> MfxC2ParamStorage::FindParam(const C2Param* param) const
 {
+    if (nullptr != m_paramsDescriptorsIndex.Find(param->index())) {
+        return nullptr;
+    }
+    // slow path to tell bad port from bad type
     return FindC2Param(m_paramsDescriptors, param);
 }
 
+void MfxC2ParamStorage::StoreValue(const C2Param& value, C2ParamLocation* location)
+{
+    const size_t size = value.size();
+    // flexible params might grow, then new place is taken at the end
+    if (size > location->capacity_) {
+        const size_t element_size = sizeof(m_valuesData[0]);
+        location->offset_ = m_valuesData.size();
+        location->capacity_ = (size + element_size - 1) / element_size * element_size;
+        m_valuesData.resize(m_valuesData.size() + location->capacity_ / element_size);
+    }
+    memcpy(&m_valuesData[location->offset_], &value, size);
+}
+
 c2_status_t MfxC2ParamStorage::getSupportedParams(
     std::vector<std::shared_ptr<C2ParamDescriptor>>* const params) const
 {
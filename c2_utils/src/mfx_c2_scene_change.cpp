@@ -0,0 +1,156 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "mfx_c2_scene_change.h"
+#include "mfx_debug.h"
+
+#include <cstdlib>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_c2_scene_change"
+
+// Luma is averaged in 8x8 blocks, 1080p frame gives 240x135 downscaled one.
+const mfxU32 BLOCK_SIZE = 8;
+// Mean absolute difference of downscaled frames (0..255) below this is never a cut.
+const float MIN_SCENE_CHANGE_DIFF = 16.0f;
+// Difference should exceed average difference within the scene this many times,
+// this keeps high motion scenes from being reported as cuts.
+const float SCENE_CHANGE_RATIO = 3.0f;
+// Weight of the new frame difference in the moving average.
+const float AVG_DIFF_WEIGHT = 0.25f;
+
+MfxC2SceneChangeDetector::MfxC2SceneChangeDetector()
+{
+    MFX_DEBUG_TRACE_FUNC;
+}
+
+void MfxC2SceneChangeDetector::Reset()
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_bHasPrevFrame = false;
+    m_fAvgDiff = 0.0f;
+}
+
+void MfxC2SceneChangeDetector::Downscale(const mfxU8* luma, mfxU32 pitch)
+{
+    for (mfxU32 y = 0; y < m_uHeight; ++y) {
+        const mfxU8* src = luma + y * BLOCK_SIZE * pitch;
+        mfxU8* dst = m_curFrame.data() + y * m_uWidth;
+        mfxU32 x = 0;
+#ifdef __SSE2__
+        // Two blocks per iteration: sum of absolute differences with zero
+        // gives sums of the low and high 8 bytes of the row.
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 2 <= m_uWidth; x += 2) {
+            __m128i sum = zero;
+            for (mfxU32 row = 0; row < BLOCK_SIZE; ++row) {
+                __m128i pixels = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + row * pitch + x * BLOCK_SIZE));
+                sum = _mm_add_epi32(sum, _mm_sad_epu8(pixels, zero));
+            }
+            const mfxU32 half = BLOCK_SIZE * BLOCK_SIZE / 2;
+            dst[x] = (mfxU8)((_mm_cvtsi128_si32(sum) + half) / (BLOCK_SIZE * BLOCK_SIZE));
+            dst[x + 1] = (mfxU8)((_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)) + half) / (BLOCK_SIZE * BLOCK_SIZE));
+        }
+#endif
+        for (; x < m_uWidth; ++x) {
+            mfxU32 sum = 0;
+            for (mfxU32 row = 0; row < BLOCK_SIZE; ++row) {
+                const mfxU8* block_row = src + row * pitch + x * BLOCK_SIZE;
+                for (mfxU32 col = 0; col < BLOCK_SIZE; ++col) {
+                    sum += block_row[col];
+                }
+            }
+            dst[x] = (mfxU8)((sum + BLOCK_SIZE * BLOCK_SIZE / 2) / (BLOCK_SIZE * BLOCK_SIZE));
+        }
+    }
+}
+
+float MfxC2SceneChangeDetector::CompareFrames() const
+{
+    const mfxU8* cur = m_curFrame.data();
+    const mfxU8* prev = m_prevFrame.data();
+    const size_t size = m_curFrame.size();
+
+    uint64_t sad = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(a, b));
+    }
+    sad = (uint64_t)_mm_cvtsi128_si32(sum) + (uint64_t)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#endif
+    for (; i < size; ++i) {
+        sad += std::abs((int)cur[i] - (int)prev[i]);
+    }
+    return (float)sad / size;
+}
+
+bool MfxC2SceneChangeDetector::DetectSceneChange(const mfxU8* luma, mfxU32 width, mfxU32 height, mfxU32 pitch)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    bool scene_change = false;
+
+    do {
+        if (nullptr == luma) break;
+
+        mfxU32 ds_width = width / BLOCK_SIZE;
+        mfxU32 ds_height = height / BLOCK_SIZE;
+        if (0 == ds_width || 0 == ds_height) break;
+
+        if (ds_width != m_uWidth || ds_height != m_uHeight) {
+            m_uWidth = ds_width;
+            m_uHeight = ds_height;
+            m_curFrame.resize(m_uWidth * m_uHeight);
+            m_prevFrame.resize(m_uWidth * m_uHeight);
+            Reset();
+        }
+
+        Downscale(luma, pitch);
+
+        if (m_bHasPrevFrame) {
+            float diff = CompareFrames();
+            MFX_DEBUG_TRACE_STREAM(NAMED(diff) << NAMED(m_fAvgDiff));
+
+            scene_change = (diff >= MIN_SCENE_CHANGE_DIFF) && (diff > SCENE_CHANGE_RATIO * m_fAvgDiff);
+            // the cut itself is not taken into account as motion of the scene
+            if (!scene_change) {
+                m_fAvgDiff += AVG_DIFF_WEIGHT * (diff - m_fAvgDiff);
+            }
+        }
+
+        m_curFrame.swap(m_prevFrame);
+        m_bHasPrevFrame = true;
+
+    } while(false);
+
+    MFX_DEBUG_TRACE_I32(scene_change);
+    return scene_change;
+}
@@ -24,6 +24,7 @@
 #include "mfx_c2_debug.h"
 
 #include <iomanip>
+#include <cstring>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -515,6 +516,28 @@ int MfxFourCCToGralloc(mfxU32 fourcc, bool using_video_memory)
             return using_video_memory ? HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL : HAL_PIXEL_FORMAT_NV12;
         case MFX_FOURCC_P010:
             return HAL_PIXEL_FORMAT_P010_INTEL;
+        case MFX_FOURCC_RGB4:
+            return HAL_PIXEL_FORMAT_RGBA_8888;
+        default:
+            return 0;
+    }
+}
+
+mfxU32 GrallocToMfxFourCC(int format)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_DEBUG_TRACE_I32(format);
+
+    switch (format)
+    {
+        case HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL:
+        case HAL_PIXEL_FORMAT_NV12:
+            return MFX_FOURCC_NV12;
+        case HAL_PIXEL_FORMAT_P010_INTEL:
+            return MFX_FOURCC_P010;
+        case HAL_PIXEL_FORMAT_RGBA_8888:
+        case HAL_PIXEL_FORMAT_RGBX_8888:
+            return MFX_FOURCC_RGB4;
         default:
             return 0;
     }
@@ -568,14 +591,17 @@ c2_status_t CopyGraphicView(const C2GraphicView* src, C2GraphicView* dst)
 
     c2_status_t res = C2_OK;
     do {
-        if (src->width() != dst->width()) break;
-        if (src->height() != dst->height()) break;
+        if (src->width() != dst->width() || src->height() != dst->height()) {
+            res = C2_BAD_VALUE;
+            break;
+        }
 
         C2PlanarLayout src_layout = src->layout();
         C2PlanarLayout dst_layout = dst->layout();
 
         if (!(src_layout == dst_layout)) {
-            res = C2_CANNOT_DO; // copy if layouts match
+            // strides, plane offsets or chroma layouts differ, copy plane by plane
+            res = CopyPlanes(src->width(), src->height(), src_layout, src->data(), dst_layout, dst->data());
             break;
         }
 
@@ -617,7 +643,7 @@ std::string FormatHex(const uint8_t* data, size_t len)
     return ss.str();
 }
 
-BinaryWriter::BinaryWriter(const std::string& dir,
+std::string CreateDumpFilePath(const std::string& dir,
     const std::vector<std::string>& sub_dirs, const std::string& name)
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -645,58 +671,15 @@ BinaryWriter::BinaryWriter(const std::string& dir,
     }
 
     full_name << name;
-    stream_.open(full_name.str().c_str(), std::fstream::trunc | std::fstream::binary);
+    return full_name.str();
 }
 
-YUVWriter::YUVWriter(const std::string& dir,
+BinaryWriter::BinaryWriter(const std::string& dir,
     const std::vector<std::string>& sub_dirs, const std::string& name)
 {
     MFX_DEBUG_TRACE_FUNC;
 
-    std::stringstream full_name;
-    full_name << dir << "/";
-
-    for(const std::string& sub_dir : sub_dirs) {
-        full_name << sub_dir;
-
-        bool dir_exists = false;
-
-        struct stat info;
-
-        if (stat(full_name.str().c_str(), &info) == 0) {
-            dir_exists = (info.st_mode & S_IFDIR) != 0;
-        }
-
-        if (!dir_exists) {
-            MFX_DEBUG_TRACE_STREAM(NAMED(full_name.str()));
-            mkdir(full_name.str().c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-        }
-
-        full_name << "/";
-    }
-
-    full_name << name;
-    stream_.open(full_name.str().c_str()/*, std::ios::app*/);
-}
-
-void YUVWriter::Write(const uint8_t* yuv_data, int stride, int height, int frameIndex) {
-    stream_ << "frame " << frameIndex << std::endl;
-
-    for(int i = 0; i < height; i++) {
-        for(int j = 0; j < stride; j++) {
-            stream_ << (int)yuv_data[i*stride + j] << " ";
-        }
-        stream_ << std::endl;
-    }
-    stream_ << std::endl;
-
-    auto ptr = &yuv_data[stride * height];
-    for(int i = 0; i < height/2; i++) {
-        for(int j = 0; j < stride; j++) {
-            stream_ << (int)ptr[i*stride + j] << " ";
-        }
-        stream_ << std::endl;
-    }
+    stream_.open(CreateDumpFilePath(dir, sub_dirs, name).c_str(), std::fstream::trunc | std::fstream::binary);
 }
 
 bool IsYUV420(const C2GraphicView &view) {
@@ -794,4 +777,20 @@ void ParseGop(
     if (iInterval) {
         iInterval = iInt;
     }
-}
\ No newline at end of file
+}
+
+uint32_t GetTemporalLayerId(uint32_t frame_order, uint32_t layers_count)
+{
+    uint32_t layer_id = 0;
+
+    if (layers_count > 1) {
+        // frames of the base layer repeat with the period of the highest layer scale
+        uint32_t period = 1 << (layers_count - 1);
+        uint32_t pos = frame_order % period;
+        if (pos != 0) {
+            // every trailing zero bit of the position moves frame one layer lower
+            layer_id = layers_count - 1 - __builtin_ctz(pos);
+        }
+    }
+    return layer_id;
+}
@@ -93,12 +93,33 @@ bool MfxXmlParser::dumpOutputEnabled(const char *name) {
     return codec->second.dump_output;
 }
 
+std::vector<MfxC2MeasuredFrameRate> MfxXmlParser::getMeasuredFrameRates(const char *name) {
+
+    MFX_DEBUG_TRACE_FUNC;
+
+    auto codec = m_codecMap.find(name);
+    if (codec == m_codecMap.end()) {
+        MFX_DEBUG_TRACE_STREAM("codec " << name << "wasn't found");
+        return {};
+    }
+    return codec->second.measured_frame_rates;
+}
+
+static bool parseBoolean(const char* s) {
+    return strcasecmp(s, "y") == 0 ||
+        strcasecmp(s, "yes") == 0 ||
+        strcasecmp(s, "t") == 0 ||
+        strcasecmp(s, "true") == 0 ||
+        strcasecmp(s, "1") == 0;
+}
+
 c2_status_t MfxXmlParser::addMediaCodecFromAttributes(bool encoder, const char** attrs) {
 
     MFX_DEBUG_TRACE_FUNC;
 
     const char* name = nullptr;
     const char* type = nullptr;
+    bool update = false;
 
     size_t i = 0;
     while (attrs[i] != nullptr) {
@@ -114,6 +135,12 @@ c2_status_t MfxXmlParser::addMediaCodecFromAttributes(bool encoder, const char**
                 return C2_BAD_VALUE;
             }
             type = attrs[i];
+        } else if (strcmp(attrs[i], "update") == 0) {
+            if (attrs[++i] == nullptr) {
+                MFX_DEBUG_TRACE_STREAM("update is null");
+                return C2_BAD_VALUE;
+            }
+            update = parseBoolean(attrs[i]);
         } else {
             MFX_DEBUG_TRACE_STREAM("unrecognized attribute: " << attrs[i]);
             return C2_BAD_VALUE;
@@ -135,7 +162,7 @@ c2_status_t MfxXmlParser::addMediaCodecFromAttributes(bool encoder, const char**
         }
         m_currentCodec->second.isEncoder = encoder;
         m_currentCodec->second.order = m_uCodecCounter++;
-    } else {
+    } else if (!update) {
         // existing codec name
         MFX_DEBUG_TRACE_STREAM("adding existing codec");
         return C2_BAD_VALUE;
@@ -144,14 +171,6 @@ c2_status_t MfxXmlParser::addMediaCodecFromAttributes(bool encoder, const char**
     return C2_OK;
 }
 
-static bool parseBoolean(const char* s) {
-    return strcasecmp(s, "y") == 0 ||
-        strcasecmp(s, "yes") == 0 ||
-        strcasecmp(s, "t") == 0 ||
-        strcasecmp(s, "true") == 0 ||
-        strcasecmp(s, "1") == 0;
-}
-
 c2_status_t MfxXmlParser::addDiagnostics(const char **attrs) {
     MFX_DEBUG_TRACE_FUNC;
 
@@ -177,6 +196,39 @@ c2_status_t MfxXmlParser::addDiagnostics(const char **attrs) {
     return C2_OK;
 }
 
+c2_status_t MfxXmlParser::addLimit(const char **attrs) {
+    MFX_DEBUG_TRACE_FUNC;
+
+    const char* name = nullptr;
+    const char* range = nullptr;
+
+    // other limits and their attributes are not needed by now
+    for (size_t i = 0; attrs[i] != nullptr && attrs[i + 1] != nullptr; i += 2) {
+        if (strcmp(attrs[i], "name") == 0) {
+            name = attrs[i + 1];
+        } else if (strcmp(attrs[i], "range") == 0) {
+            range = attrs[i + 1];
+        }
+    }
+
+    const char MEASURED_FRAME_RATE[] = "measured-frame-rate-";
+    if (name == nullptr || strncmp(name, MEASURED_FRAME_RATE, strlen(MEASURED_FRAME_RATE)) != 0) {
+        return C2_OK;
+    }
+
+    MfxC2MeasuredFrameRate frame_rate {};
+    if (range == nullptr ||
+        sscanf(name + strlen(MEASURED_FRAME_RATE), "%ux%u", &frame_rate.width, &frame_rate.height) != 2 ||
+        sscanf(range, "%u-%u", &frame_rate.min_fps, &frame_rate.max_fps) != 2 ||
+        frame_rate.width == 0 || frame_rate.height == 0 || frame_rate.min_fps == 0) {
+        MFX_DEBUG_TRACE_STREAM("bad limit: " << name);
+        return C2_BAD_VALUE;
+    }
+
+    m_currentCodec->second.measured_frame_rates.push_back(frame_rate);
+    return C2_OK;
+}
+
 void MfxXmlParser::startElementHandler(const char* name, const char** attrs) {
 
     MFX_DEBUG_TRACE_FUNC;
@@ -233,6 +285,9 @@ void MfxXmlParser::startElementHandler(const char* name, const char** attrs) {
             if (strcmp(name, "Diagnostics") == 0) {
                 m_parsingStatus =
                     addDiagnostics(attrs);
+            } else if (strcmp(name, "Limit") == 0) {
+                m_parsingStatus =
+                    addLimit(attrs);
             }
             break;
         }
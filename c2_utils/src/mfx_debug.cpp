@@ -24,6 +24,7 @@
 // MFX headers
 #include <mfxdefs.h>
 #include "mfx_defs.h"
+#include "mfx_c2_metrics.h"
 
 #include <string.h>
 #include <time.h>
@@ -349,43 +350,35 @@ MFX_HIDE std::unordered_map<void*, const char*> MfxTraceable::names_;
 
 #endif // #if MFX_DEBUG == MFX_DEBUG_YES
 
-#if MFX_PERF == MFX_DEBUG_YES
-
 /*------------------------------------------------------------------------------*/
 
-mfxPerf::mfxPerf(const char* _modulename, const char* _function, const char* _taskname)
+mfxPerf::mfxPerf(MfxC2Histogram* _histogram):
+    histogram(_histogram),
+    start(std::chrono::steady_clock::now())
 {
-    modulename = _modulename;
-    function = _function;
-    taskname = _taskname;
-    start = std::chrono::high_resolution_clock::now();
 }
 
 /*------------------------------------------------------------------------------*/
 
 mfxPerf::~mfxPerf(void)
 {
-    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<float, std::milli> task_period = end - start;
-    float task_time = task_period.count();
-
-#if !defined(ANDROID) || (MFX_DEBUG_FILE == MFX_DEBUG_YES)
-    if (GetDbgFile())
-    {
-        if (taskname)
-            fprintf(GetDbgFile(), "%s: %s: %s: time = %f ms\n", modulename, taskname, function, task_time);
-        else
-            fprintf(GetDbgFile(), "%s: %s: time = %f ms\n", modulename, function, task_time);
-        fflush(GetDbgFile());
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    if (histogram) {
+        histogram->Record(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
     }
-#else
-    if (taskname)
-        __android_log_print(MFX_DEBUG_LOG_LEVEL, MFX_DEBUG_LOG_TAG, "%s: %s: %s: time = %f ms", modulename, taskname, function, task_time);
-    else
-        __android_log_print(MFX_DEBUG_LOG_LEVEL, MFX_DEBUG_LOG_TAG, "%s: %s: time = %f ms", modulename, function, task_time);
-#endif
 }
 
 /*------------------------------------------------------------------------------*/
 
-#endif // #if MFX_PERF == MFX_DEBUG_YES
+MfxC2Histogram* mfxPerf::GetHistogram(const char* _modulename, const char* _function, const char* _taskname)
+{
+    std::string name = "perf.";
+    name += _modulename ? _modulename : "";
+    name += ":";
+    name += _function ? _function : "";
+    if (_taskname) {
+        name += ":";
+        name += _taskname;
+    }
+    return MfxC2Metrics::GetInstance().GetHistogram(name);
+}
@@ -89,29 +89,25 @@ mfxStatus MFXLoadSurfaceSW(uint8_t *data, uint32_t pitch, const mfxFrameInfo& in
         srf->Data.V = srf->Data.U + 1;
         srf->Data.PitchLow = nOPitch;
     } else {
-        uint32_t i = 0;
         uint8_t* Y  = data;
         uint8_t* UV = data + nOPitch * nOHeight;
 
         // if input surface width or height is not 16bit aligned, do copy here
-        for (i = 0; i < nCropH/2; ++i)
-        {
-            // copying Y
-            uint8_t *src = Y + nCropX + (nCropY + i)*nOPitch;
-            uint8_t *dst = srf->Data.Y + nCropX + (nCropY + i)*nPitch;
-            std::copy(src, src + nCropW, dst);
-
-            // copying UV
-            src = UV + nCropX + (nCropY/2 + i)*nOPitch;
-            dst = srf->Data.UV + nCropX + (nCropY/2 + i)*nPitch;
-            std::copy(src, src + nCropW, dst);
-        }
-        for (i = nCropH/2; i < nCropH; ++i)
-        {
-            // copying Y (remained data)
-            uint8_t *src = Y + nCropX + (nCropY + i)*nOPitch;
-            uint8_t *dst = srf->Data.Y + nCropX + (nCropY + i)*nPitch;
-            std::copy(src, src + nCropW, dst);
+        uint32_t src_pitches[C2PlanarLayout::MAX_NUM_PLANES] { nOPitch, nOPitch };
+        uint32_t dst_pitches[C2PlanarLayout::MAX_NUM_PLANES] { nPitch, nPitch };
+        C2PlanarLayout src_layout {}, dst_layout {};
+        InitNV12PlaneLayout(src_pitches, &src_layout);
+        InitNV12PlaneLayout(dst_pitches, &dst_layout);
+
+        uint8_t* src_uv = UV + nCropX + (nCropY/2)*nOPitch;
+        uint8_t* dst_uv = srf->Data.UV + nCropX + (nCropY/2)*nPitch;
+        const uint8_t* src_data[C2PlanarLayout::MAX_NUM_PLANES] {
+            Y + nCropX + nCropY*nOPitch, src_uv, src_uv + 1 };
+        uint8_t* dst_data[C2PlanarLayout::MAX_NUM_PLANES] {
+            srf->Data.Y + nCropX + nCropY*nPitch, dst_uv, dst_uv + 1 };
+
+        if (C2_OK != CopyPlanes(nCropW, nCropH, src_layout, src_data, dst_layout, dst_data)) {
+            res = MFX_ERR_UNSUPPORTED;
         }
     }
 
@@ -23,6 +23,7 @@
 #include "mfx_msdk_debug.h"
 #include "mfx_c2_bs_utils.h"
 #include "mfx_c2_hevc_bitstream.h"
+#include "mfx_c2_metrics.h"
 
 #undef MFX_DEBUG_MODULE_NAME
 #define MFX_DEBUG_MODULE_NAME "mfx_frame_constructor"
@@ -130,7 +131,7 @@ mfxStatus MfxC2FrameConstructor::LoadHeader(const mfxU8* data, mfxU32 size, bool
                     std::copy(m_bstHeader->Data + m_bstHeader->DataOffset,
                         m_bstHeader->Data + m_bstHeader->DataOffset + m_bstHeader->DataLength, buf);
                     m_bstBuf->DataLength += m_bstHeader->DataLength;
-                    m_uBstBufCopyBytes += m_bstHeader->DataLength;
+                    CountCopyBytes(m_bstHeader->DataLength);
                 }
                 m_bsState = MfxC2BS_HeaderObtained;
             }
@@ -153,7 +154,7 @@ mfxStatus MfxC2FrameConstructor::Load_None(const mfxU8* data, mfxU32 size, mfxU6
 
             std::copy(data, data + size, buf);
             m_bstBuf->DataLength += size;
-            m_uBstBufCopyBytes += size;
+            CountCopyBytes(size);
         }
     }
     if (MFX_ERR_NONE == mfx_res) {
@@ -234,6 +235,24 @@ mfxStatus MfxC2FrameConstructor::Reset()
     return mfx_res;
 }
 
+void MfxC2FrameConstructor::CountCopyBytes(mfxU32 bytes)
+{
+    static MfxC2Counter* s_copyBytes =
+        MfxC2Metrics::GetInstance().GetCounter("frame_constructor.copy_bytes");
+
+    m_uBstBufCopyBytes += bytes;
+    s_copyBytes->Add(bytes);
+}
+
+void MfxC2FrameConstructor::CountRealloc()
+{
+    static MfxC2Counter* s_reallocs =
+        MfxC2Metrics::GetInstance().GetCounter("frame_constructor.reallocs");
+
+    ++m_uBstBufReallocs;
+    s_reallocs->Add();
+}
+
 mfxStatus MfxC2FrameConstructor::BstBufRealloc(mfxU32 add_size)
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -248,8 +267,8 @@ mfxStatus MfxC2FrameConstructor::BstBufRealloc(mfxU32 add_size)
             new_data = (mfxU8*)realloc(m_bstBuf->Data, needed_MaxLength);
             if (new_data) {
                 // collecting statistics
-                ++m_uBstBufReallocs;
-                if (new_data != m_bstBuf->Data) m_uBstBufCopyBytes += m_bstBuf->MaxLength;
+                CountRealloc();
+                if (new_data != m_bstBuf->Data) CountCopyBytes(m_bstBuf->MaxLength);
                 // setting new values
                 m_bstBuf->Data = new_data;
                 m_bstBuf->MaxLength = needed_MaxLength;
@@ -274,7 +293,7 @@ mfxStatus MfxC2FrameConstructor::BstBufMalloc(mfxU32 new_size)
             MFX_FREE(m_bstBuf->Data);
             m_bstBuf->Data = (mfxU8*)malloc(needed_MaxLength);
             m_bstBuf->MaxLength = needed_MaxLength;
-            ++m_uBstBufReallocs;
+            CountRealloc();
         }
         if (!(m_bstBuf->Data)) {
             m_bstBuf->MaxLength = 0;
@@ -295,7 +314,7 @@ mfxStatus MfxC2FrameConstructor::BstBufSync()
             if (m_bstBuf->DataLength && m_bstBuf->DataOffset) {
                 // shifting data to the beginning of the buffer
                 memmove(m_bstBuf->Data, m_bstBuf->Data + m_bstBuf->DataOffset, m_bstBuf->DataLength);
-                m_uBstBufCopyBytes += m_bstBuf->DataLength;
+                CountCopyBytes(m_bstBuf->DataLength);
             }
             m_bstBuf->DataOffset = 0;
         }
@@ -310,7 +329,7 @@ mfxStatus MfxC2FrameConstructor::BstBufSync()
                 m_bstBuf->DataLength = m_bstIn->DataLength;
                 m_bstBuf->TimeStamp  = m_bstIn->TimeStamp;
                 m_bstBuf->DataFlag   = m_bstIn->DataFlag;
-                m_uBstBufCopyBytes += m_bstIn->DataLength;
+                CountCopyBytes(m_bstIn->DataLength);
             }
             m_bstIn = std::make_shared<mfxBitstream>();
             MFX_ZERO_MEMORY((*m_bstIn));
@@ -499,7 +518,7 @@ mfxStatus MfxC2AVCFrameConstructor::LoadHeader(const mfxU8* data, mfxU32 size, b
                     std::copy(m_pps.Data, m_pps.Data + m_pps.DataLength, buf);
 
                     m_bstBuf->DataLength += m_sps.DataLength + m_pps.DataLength;
-                    m_uBstBufCopyBytes += m_sps.DataLength + m_pps.DataLength;
+                    CountCopyBytes(m_sps.DataLength + m_pps.DataLength);
                 }
             }
             m_bsState = MfxC2BS_HeaderObtained;
@@ -7,6 +7,12 @@ ifeq ($(MFX_C2_IMPL_HW),)
   MFX_C2_IMPL_HW:=true
 endif
 
+# Build C2 plugins on CPU fake of MediaSDK runtime (mock/mfx_runtime),
+# used to benchmark components without GPU
+ifeq ($(MFX_C2_IMPL_FAKE),)
+  MFX_C2_IMPL_FAKE:=false
+endif
+
 # BOARD_HAVE_MEDIASDK_SRC is not set
 # BOARD_HAVE_MEDIASDK_OPEN_SOURCE is set
 ifeq ($(BOARD_HAVE_MEDIASDK_SRC),true)
@@ -24,14 +24,39 @@
 #include "mfx_c2_components_registry.h"
 #include "mfx_cmd_queue.h"
 
+#include <C2Config.h>
+#include <deque>
+
 namespace android {
 
 enum C2ParamIndexKindMock : uint32_t {
     kParamIndexProducerMemoryType = C2Param::TYPE_INDEX_VENDOR_START,
+    kParamIndexMockProcessingTime,
+    kParamIndexMockReorderDepth,
+    kParamIndexMockHoldDepth,
 };
 
 typedef C2PortParam<C2Setting, C2Uint64Value, kParamIndexProducerMemoryType>::output C2ProducerMemoryType;
 
+// Synthetic load of the mock components, all are zero by default.
+
+// Time in microseconds every frame is processed for, frames are processed one by one.
+typedef C2GlobalParam<C2Tuning, C2Uint32Value, kParamIndexMockProcessingTime>
+        C2MockProcessingTimeTuning;
+constexpr char C2_PARAMKEY_MOCK_PROCESSING_TIME[] = "mock.processing-time";
+
+// Works are completed in groups of (depth + 1): the last queued work goes first,
+// then the rest in queue order, like a reference frame decoded ahead of B-frames.
+typedef C2GlobalParam<C2Tuning, C2Uint32Value, kParamIndexMockReorderDepth>
+        C2MockReorderDepthTuning;
+constexpr char C2_PARAMKEY_MOCK_REORDER_DEPTH[] = "mock.reorder-depth";
+
+// Number of the latest output buffers kept referenced after their works are completed,
+// like reference frames, so they are not returned to the block pool.
+typedef C2GlobalParam<C2Tuning, C2Uint32Value, kParamIndexMockHoldDepth>
+        C2MockHoldDepthTuning;
+constexpr char C2_PARAMKEY_MOCK_HOLD_DEPTH[] = "mock.hold-depth";
+
 } // namespace android
 
 class MfxC2MockComponent : public MfxC2Component
@@ -50,9 +75,6 @@ protected:
 public:
     static void RegisterClass(MfxC2ComponentsRegistry& registry);
 
-protected: // C2Component
-    c2_status_t queue_nb(std::list<std::unique_ptr<C2Work>>* const items) override;
-
 protected:  // MfxC2Component overrides
     c2_status_t Init() override;
 
@@ -64,21 +86,38 @@ protected:  // MfxC2Component overrides
 
     c2_status_t Resume() override;
 
-    c2_status_t Query(
+    c2_status_t UpdateMfxParamToC2(
         std::unique_lock<std::mutex>,
         const std::vector<C2Param*>&,
         const std::vector<C2Param::Index> &,
         c2_blocking_t,
         std::vector<std::unique_ptr<C2Param>>* const) const override
-    { return C2_OK; } // query not needed for mock component
+    { return C2_OK; } // declared parameters are kept by interface helper
 
-    c2_status_t Config(
+    c2_status_t UpdateC2ParamToMfx(
         std::unique_lock<std::mutex> state_lock,
         const std::vector<C2Param*> &params,
         c2_blocking_t mayBlock,
         std::vector<std::unique_ptr<C2SettingResult>>* const failures) override;
 
+    c2_status_t Queue(std::list<std::unique_ptr<C2Work>>* const items) override;
+
+    c2_status_t Flush(std::list<std::unique_ptr<C2Work>>* const flushedWork) override;
+
 private:
+    struct Load
+    {
+        uint32_t width { 0 }; // decoder output size, guessed from input size if zero
+        uint32_t height { 0 };
+        uint32_t processing_time_us { 0 };
+        uint32_t reorder_depth { 0 };
+        uint32_t hold_depth { 0 };
+    };
+
+    static C2R OutputDelaySetter(bool mayBlock, C2P<C2PortActualDelayTuning::output> &me,
+        const C2P<C2MockReorderDepthTuning> &reorderDepth, const C2P<C2MockHoldDepthTuning> &holdDepth);
+
+
     // Allocates linear block of the length as input and copies input there.
     c2_status_t CopyGraphicToLinear(const C2FrameData& input,
         const std::shared_ptr<C2BlockPool>& allocator,
@@ -89,6 +128,11 @@ private:
         std::shared_ptr<C2Buffer>* out_buffer);
 
     void DoWork(std::unique_ptr<C2Work>&& work);
+    // Completes the work taking into account configured reordering,
+    // pending works are completed all together on end of stream.
+    void CompleteWork(std::unique_ptr<C2Work>&& work, c2_status_t res);
+
+    void ReleasePendingWorks(std::list<std::unique_ptr<C2Work>>* works);
 
 private:
     Type m_type;
@@ -98,4 +142,15 @@ private:
     uint64_t m_uProducerMemoryType { C2MemoryUsage::CPU_WRITE };
 
     std::shared_ptr<C2BlockPool> m_c2Allocator;
+
+    std::shared_ptr<C2StreamPictureSizeInfo::output> m_size;
+    std::shared_ptr<C2MockProcessingTimeTuning> m_processingTime;
+    std::shared_ptr<C2MockReorderDepthTuning> m_reorderDepth;
+    std::shared_ptr<C2MockHoldDepthTuning> m_holdDepth;
+    std::shared_ptr<C2PortActualDelayTuning::output> m_actualOutputDelay;
+
+    // Accessed from working thread only, updated there when component is running.
+    Load m_load;
+    std::list<std::unique_ptr<C2Work>> m_reorderedWorks;
+    std::deque<std::shared_ptr<C2Buffer>> m_heldBuffers;
 };
@@ -27,13 +27,73 @@
 
 #include "C2PlatformSupport.h"
 
+#include <chrono>
+#include <future>
+#include <thread>
+
 using namespace android;
 
+// Upper bound of synthetic processing time, keeps misconfigured mock from hanging tests.
+const uint32_t MFX_MOCK_MAX_PROCESSING_TIME_US = 1000000;
+// Upper bound of reordered and held frames, like max DPB size of AVC.
+const uint32_t MFX_MOCK_MAX_DEPTH = 16;
+
 MfxC2MockComponent::MfxC2MockComponent(const C2String name, const CreateConfig& config,
     std::shared_ptr<MfxC2ParamReflector> reflector, Type type) :
         MfxC2Component(name, config, std::move(reflector)), m_type(type)
 {
     MFX_DEBUG_TRACE_FUNC;
+
+    const unsigned int SINGLE_STREAM_ID = 0u;
+
+    if (m_type == Decoder) {
+        // input is not parsed, so the size of output frames is set by client
+        addParameter(
+            DefineParam(m_size, C2_PARAMKEY_PICTURE_SIZE)
+            .withDefault(new C2StreamPictureSizeInfo::output(SINGLE_STREAM_ID, 0u, 0u))
+            .withFields({
+                C2F(m_size, width).inRange(0, WIDTH_8K, 2),
+                C2F(m_size, height).inRange(0, HEIGHT_8K, 2),})
+            .withSetter(Setter<decltype(*m_size)>::StrictValuesWithNoDeps)
+            .build());
+    }
+
+    addParameter(
+        DefineParam(m_processingTime, C2_PARAMKEY_MOCK_PROCESSING_TIME)
+        .withDefault(new C2MockProcessingTimeTuning(0u))
+        .withFields({C2F(m_processingTime, value).inRange(0, MFX_MOCK_MAX_PROCESSING_TIME_US)})
+        .withSetter(Setter<decltype(*m_processingTime)>::StrictValueWithNoDeps)
+        .build());
+
+    addParameter(
+        DefineParam(m_reorderDepth, C2_PARAMKEY_MOCK_REORDER_DEPTH)
+        .withDefault(new C2MockReorderDepthTuning(0u))
+        .withFields({C2F(m_reorderDepth, value).inRange(0, MFX_MOCK_MAX_DEPTH)})
+        .withSetter(Setter<decltype(*m_reorderDepth)>::StrictValueWithNoDeps)
+        .build());
+
+    addParameter(
+        DefineParam(m_holdDepth, C2_PARAMKEY_MOCK_HOLD_DEPTH)
+        .withDefault(new C2MockHoldDepthTuning(0u))
+        .withFields({C2F(m_holdDepth, value).inRange(0, MFX_MOCK_MAX_DEPTH)})
+        .withSetter(Setter<decltype(*m_holdDepth)>::StrictValueWithNoDeps)
+        .build());
+
+    addParameter(
+        DefineParam(m_actualOutputDelay, C2_PARAMKEY_OUTPUT_DELAY)
+        .withDefault(new C2PortActualDelayTuning::output(0u))
+        .withFields({C2F(m_actualOutputDelay, value).inRange(0, 2 * MFX_MOCK_MAX_DEPTH)})
+        .withSetter(OutputDelaySetter, m_reorderDepth, m_holdDepth)
+        .build());
+}
+
+C2R MfxC2MockComponent::OutputDelaySetter(bool mayBlock, C2P<C2PortActualDelayTuning::output> &me,
+    const C2P<C2MockReorderDepthTuning> &reorderDepth, const C2P<C2MockHoldDepthTuning> &holdDepth)
+{
+    (void)mayBlock;
+    // both reordered works and held buffers keep output blocks from the client
+    me.set().value = reorderDepth.v.value + holdDepth.v.value;
+    return C2R::Ok();
 }
 
 void MfxC2MockComponent::RegisterClass(MfxC2ComponentsRegistry& registry)
@@ -99,6 +159,9 @@ static c2_status_t GuessFrameSize(uint32_t buffer_size, uint32_t* width, uint32_
     uint32_t typical_frame_sizes[][2] = {
         { 320, 240 },
         { 640, 480 },
+        { 1280, 720 },
+        { 1920, 1080 },
+        { 3840, 2160 },
     };
 
     c2_status_t res = C2_BAD_VALUE;
@@ -129,10 +192,12 @@ c2_status_t MfxC2MockComponent::CopyLinearToGraphic(const C2FrameData& input,
         uint32_t size = const_linear_block->size();
         MFX_DEBUG_TRACE_U32(size);
 
-        uint32_t width = 0;
-        uint32_t height = 0;
-        res = GuessFrameSize(size, &width, &height);
-        if(C2_OK != res) break;
+        uint32_t width = m_load.width;
+        uint32_t height = m_load.height;
+        if (0 == width || 0 == height) {
+            res = GuessFrameSize(size, &width, &height);
+            if(C2_OK != res) break;
+        }
 
         MFX_DEBUG_TRACE_U32(width);
         MFX_DEBUG_TRACE_U32(height);
@@ -154,8 +219,9 @@ c2_status_t MfxC2MockComponent::CopyLinearToGraphic(const C2FrameData& input,
             res = MapGraphicBlock(*out_block, TIMEOUT_NS, &out_view);
             if(C2_OK != res) break;
 
-            //  copy input buffer to output as is to identify data in test
-            std::copy(in_raw, in_raw + MEM_SIZE, out_view->data()[0]);
+            //  copy input buffer to output as is to identify data in test,
+            //  input of configured size might be shorter than the frame
+            std::copy(in_raw, in_raw + std::min<size_t>(size, MEM_SIZE), out_view->data()[0]);
         }
         // C2Event event; // not supported yet, left for future use
         // event.fire(); // pre-fire event as output buffer is ready to use
@@ -188,8 +254,9 @@ void MfxC2MockComponent::DoWork(std::unique_ptr<C2Work>&& work)
             break;
         }
 
-        if (work->worklets.size() != 1) {
-            MFX_DEBUG_TRACE_MSG("Cannot handle multiple worklets");
+        // the rest of worklets are for tunnel target, if any
+        if (work->worklets.empty()) {
+            MFX_DEBUG_TRACE_MSG("No worklet to process");
             res = C2_BAD_VALUE;
             break;
         }
@@ -222,17 +289,71 @@ void MfxC2MockComponent::DoWork(std::unique_ptr<C2Work>&& work)
             &MfxC2MockComponent::CopyGraphicToLinear : &MfxC2MockComponent::CopyLinearToGraphic;
 
         res = (this->*process_method)(input, m_c2Allocator, &worklet->output.buffers.front());
+        if (C2_OK != res) break;
+
+        if (m_load.processing_time_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(m_load.processing_time_us));
+        }
+
+        if (input.flags & C2FrameData::FLAG_END_OF_STREAM) {
+            m_heldBuffers.clear(); // nothing is referenced after the last frame
+        } else if (m_load.hold_depth > 0) {
+            m_heldBuffers.push_back(worklet->output.buffers.front());
+            while (m_heldBuffers.size() > m_load.hold_depth) {
+                m_heldBuffers.pop_front();
+            }
+        }
 
     } while(false); // fake loop to have a cleanup point there
 
     if (work) {
-        NotifyWorkDone(std::move(work), res);
+        CompleteWork(std::move(work), res);
     } else {
         FatalError(res);
     }
 }
 
-c2_status_t MfxC2MockComponent::Config(
+void MfxC2MockComponent::CompleteWork(std::unique_ptr<C2Work>&& work, c2_status_t res)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    bool eos = (work->input.flags & C2FrameData::FLAG_END_OF_STREAM);
+
+    if (C2_OK != res || eos || 0 == m_load.reorder_depth) {
+        // pending works go first, so the last work is completed the last
+        ReleasePendingWorks(nullptr);
+        NotifyWorkDone(std::move(work), res);
+        return;
+    }
+
+    m_reorderedWorks.push_back(std::move(work));
+    MFX_DEBUG_TRACE_U32(m_reorderedWorks.size());
+
+    if (m_reorderedWorks.size() > m_load.reorder_depth) {
+        NotifyWorkDone(std::move(m_reorderedWorks.back()), C2_OK);
+        m_reorderedWorks.pop_back();
+        ReleasePendingWorks(nullptr);
+    }
+}
+
+// Completes pending works in queue order or moves them to the list if it is specified.
+void MfxC2MockComponent::ReleasePendingWorks(std::list<std::unique_ptr<C2Work>>* works)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    std::list<std::unique_ptr<C2Work>> pending_works;
+    pending_works.swap(m_reorderedWorks);
+
+    if (works) {
+        works->splice(works->end(), pending_works);
+    } else {
+        for (auto& pending_work : pending_works) {
+            NotifyWorkDone(std::move(pending_work), C2_OK);
+        }
+    }
+}
+
+c2_status_t MfxC2MockComponent::UpdateC2ParamToMfx(
         std::unique_lock<std::mutex> state_lock,
         const std::vector<C2Param*> &params,
         c2_blocking_t mayBlock,
@@ -244,10 +365,19 @@ c2_status_t MfxC2MockComponent::Config(
 
     c2_status_t res = C2_OK;
     std::vector<std::shared_ptr<C2SettingResult>> tripped_reasons;
+    bool load_updated = false;
 
     for (C2Param* param : params) {
 
         switch (C2Param::Type(param->type()).type()) {
+            // values of declared parameters are already validated by interface helper
+            case C2StreamPictureSizeInfo::output::PARAM_TYPE:
+            case C2MockProcessingTimeTuning::PARAM_TYPE:
+            case C2MockReorderDepthTuning::PARAM_TYPE:
+            case C2MockHoldDepthTuning::PARAM_TYPE:
+                load_updated = true;
+                break;
+
             case C2ProducerMemoryType::PARAM_TYPE: {
                 const C2ProducerMemoryType* memory_param = (const C2ProducerMemoryType*)param;
                 m_uProducerMemoryType = memory_param->value;
@@ -270,6 +400,31 @@ c2_status_t MfxC2MockComponent::Config(
         }
     }
 
+    if (load_updated) {
+        Load load;
+        if (m_size) {
+            load.width = m_size->width;
+            load.height = m_size->height;
+        }
+        load.processing_time_us = m_processingTime->value;
+        load.reorder_depth = m_reorderDepth->value;
+        load.hold_depth = m_holdDepth->value;
+        MFX_DEBUG_TRACE_U32(load.width);
+        MFX_DEBUG_TRACE_U32(load.height);
+        MFX_DEBUG_TRACE_U32(load.processing_time_us);
+        MFX_DEBUG_TRACE_U32(load.reorder_depth);
+        MFX_DEBUG_TRACE_U32(load.hold_depth);
+
+        if (State::STOPPED != m_state) {
+            // applied to the works queued after this call
+            m_cmdQueue.Push( [ load, this ] () {
+                m_load = load;
+            } );
+        } else {
+            m_load = load;
+        }
+    }
+
     if (tripped_reasons.size() > 0) {
         state_lock.unlock(); // allow state to be changed
         ConfigError(tripped_reasons);
@@ -277,7 +432,7 @@ c2_status_t MfxC2MockComponent::Config(
     return res;
 }
 
-c2_status_t MfxC2MockComponent::queue_nb(std::list<std::unique_ptr<C2Work>>* const items)
+c2_status_t MfxC2MockComponent::Queue(std::list<std::unique_ptr<C2Work>>* const items)
 {
     MFX_DEBUG_TRACE_FUNC;
 
@@ -291,6 +446,22 @@ c2_status_t MfxC2MockComponent::queue_nb(std::list<std::unique_ptr<C2Work>>* con
     return C2_OK;
 }
 
+c2_status_t MfxC2MockComponent::Flush(std::list<std::unique_ptr<C2Work>>* const flushedWork)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // Works queued before are processed, only reordered ones are returned as flushed.
+    std::promise<void> flushed;
+    m_cmdQueue.Push( [ flushedWork, &flushed, this ] () {
+        ReleasePendingWorks(flushedWork);
+        m_heldBuffers.clear();
+        flushed.set_value();
+    } );
+    flushed.get_future().wait();
+
+    return C2_OK;
+}
+
 c2_status_t MfxC2MockComponent::Init()
 {
     MFX_DEBUG_TRACE_FUNC;
@@ -322,6 +493,9 @@ c2_status_t MfxC2MockComponent::DoStop(bool abort)
     } else {
         m_cmdQueue.Stop();
     }
+    // working thread is over, pending works are abandoned
+    m_reorderedWorks.clear();
+    m_heldBuffers.clear();
 
     return C2_OK;
 }
@@ -0,0 +1,142 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "mfx_fake_device.h"
+#include "mfx_fake_runtime.h"
+
+// Common part of the fake codecs: limits number of queued tasks
+// and simulates device busy state.
+class MfxFakeCodec
+{
+public:
+    explicit MfxFakeCodec(std::shared_ptr<MfxFakeDevice> device);
+    virtual ~MfxFakeCodec();
+
+protected:
+    // Fills AsyncDepth if not set and reads task limits from the config.
+    void InitAsync(mfxVideoParam* par);
+    // Returns MFX_WRN_DEVICE_BUSY if a task cannot be queued right now.
+    mfxStatus CheckBusy();
+
+    mfxSyncPoint Submit(MfxFakeDevice::Completion completion);
+
+    static void LockSurface(mfxFrameSurface1* surface);
+    static void UnlockSurface(mfxFrameSurface1* surface);
+
+protected:
+    std::shared_ptr<MfxFakeDevice> m_device;
+    std::atomic<uint32_t> m_queuedCount { 0 };
+    uint32_t m_maxQueued { 1 };
+    uint32_t m_busyPeriod { 0 };
+    uint32_t m_submitCount { 0 };
+
+private:
+    MFX_CLASS_NO_COPY(MfxFakeCodec)
+};
+
+class MfxFakeDecoder : public MfxFakeCodec
+{
+public:
+    explicit MfxFakeDecoder(std::shared_ptr<MfxFakeDevice> device);
+
+    static mfxStatus Query(mfxVideoParam* in, mfxVideoParam* out);
+    static mfxStatus QueryIOSurf(mfxVideoParam* par, mfxFrameAllocRequest* request);
+    // Parses AVC and HEVC sequence parameter set, other codecs get frame size from the config.
+    static mfxStatus DecodeHeader(mfxBitstream* bs, mfxVideoParam* par);
+
+    mfxStatus Init(mfxVideoParam* par);
+    mfxStatus Reset(mfxVideoParam* par);
+    mfxStatus GetVideoParam(mfxVideoParam* par);
+    mfxStatus GetDecodeStat(mfxDecodeStat* stat);
+
+    // Every access unit produces a frame task, surface content is left as is.
+    mfxStatus DecodeFrameAsync(mfxBitstream* bs, mfxFrameSurface1* surface_work,
+        mfxFrameSurface1** surface_out, mfxSyncPoint* syncp);
+
+private:
+    // Takes one access unit from the bitstream, leaving the rest of data in it.
+    // Partial access units are accumulated internally as MediaSDK does.
+    bool ExtractFrame(mfxBitstream* bs, mfxU64* timestamp);
+    // Returns position of the next access unit start in m_buffer or 0 if not found yet.
+    size_t FindFrameEnd();
+
+private:
+    mfxVideoParam m_params {};
+    std::vector<mfxU8> m_buffer;
+    mfxU64 m_bufferTimeStamp { 0 };
+    size_t m_scanPos { 0 };
+    bool m_seenSlice { false };
+    mfxU32 m_frameOrder { 0 };
+};
+
+class MfxFakeEncoder : public MfxFakeCodec
+{
+public:
+    explicit MfxFakeEncoder(std::shared_ptr<MfxFakeDevice> device);
+
+    static mfxStatus Query(mfxVideoParam* in, mfxVideoParam* out);
+    static mfxStatus QueryIOSurf(mfxVideoParam* par, mfxFrameAllocRequest* request);
+
+    mfxStatus Init(mfxVideoParam* par);
+    mfxStatus Reset(mfxVideoParam* par);
+    // Fills coding option buffers with placeholder headers.
+    mfxStatus GetVideoParam(mfxVideoParam* par);
+    mfxStatus GetEncodeStat(mfxEncodeStat* stat);
+
+    // Produces a frame of the size expected from bitrate settings, no frames are buffered.
+    mfxStatus EncodeFrameAsync(mfxEncodeCtrl* ctrl, mfxFrameSurface1* surface,
+        mfxBitstream* bs, mfxSyncPoint* syncp);
+
+private:
+    mfxU32 GetFrameSize() const;
+
+private:
+    mfxVideoParam m_params {};
+    mfxU32 m_frameOrder { 0 };
+    mfxU64 m_bitsEncoded { 0 };
+};
+
+class MfxFakeVpp : public MfxFakeCodec
+{
+public:
+    explicit MfxFakeVpp(std::shared_ptr<MfxFakeDevice> device);
+
+    static mfxStatus Query(mfxVideoParam* in, mfxVideoParam* out);
+    static mfxStatus QueryIOSurf(mfxVideoParam* par, mfxFrameAllocRequest request[2]);
+
+    mfxStatus Init(mfxVideoParam* par);
+    mfxStatus Reset(mfxVideoParam* par);
+    mfxStatus GetVideoParam(mfxVideoParam* par);
+    mfxStatus GetVPPStat(mfxVPPStat* stat);
+
+    // Passes frame info and timestamp to the output, surface content is left as is.
+    mfxStatus RunFrameVPPAsync(mfxFrameSurface1* in, mfxFrameSurface1* out,
+        mfxExtVppAuxData* aux, mfxSyncPoint* syncp);
+
+private:
+    mfxVideoParam m_params {};
+    mfxU32 m_frameCount { 0 };
+};
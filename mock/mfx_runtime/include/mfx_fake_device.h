@@ -0,0 +1,75 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "mfx_defs.h"
+
+// Simulates hardware engine of the fake runtime: tasks are executed one by one
+// in submission order on own thread, every task takes configured latency.
+// Shared by all the codecs of the session and sessions joined to it.
+class MfxFakeDevice
+{
+public:
+    typedef std::function<void()> Completion;
+
+public:
+    MfxFakeDevice();
+    ~MfxFakeDevice();
+
+    // Queues the task, completion is called on the device thread once latency passes.
+    mfxSyncPoint Submit(const void* owner, Completion completion);
+
+    // Waits for the task up to wait_ms, forgets the task once completed.
+    mfxStatus Sync(mfxSyncPoint syncp, mfxU32 wait_ms);
+
+    // Waits for all tasks of the owner and forgets them, called when codec is closed.
+    void Flush(const void* owner);
+
+private:
+    void Run();
+
+private:
+    struct Task
+    {
+        const void* owner;
+        Completion completion;
+        bool done;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_queueCond;
+    std::condition_variable m_doneCond;
+    std::deque<uint64_t> m_queue;
+    std::map<uint64_t, Task> m_tasks;
+    uint64_t m_nextId { 1 };
+    bool m_stop { false };
+    std::thread m_thread;
+
+private:
+    MFX_CLASS_NO_COPY(MfxFakeDevice)
+};
@@ -0,0 +1,47 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdint.h>
+
+// Behaviour of the CPU fake of MediaSDK runtime (libmfx_fake_runtime).
+// The fake implements MediaSDK/oneVPL API entry points used by the components,
+// schedules frame tasks like the hardware does but never touches pixels.
+// Initial values are read from properties vendor.intel.video.c2.fake.<field>,
+// for example vendor.intel.video.c2.fake.latency_us.
+struct MfxFakeRuntimeConfig
+{
+    // Time every frame task occupies the device.
+    uint32_t latency_us { 1000 };
+    // Max tasks queued by one codec, 0 - AsyncDepth of the codec is used.
+    uint32_t async_depth { 0 };
+    // Every N-th submission returns MFX_WRN_DEVICE_BUSY, 0 - never.
+    uint32_t busy_period { 0 };
+    // Frame size reported by DecodeHeader for codecs with headers not parsed (all except AVC and HEVC).
+    uint32_t default_width { 1920 };
+    uint32_t default_height { 1080 };
+};
+
+// Thread-safe. Latency applies to the next executed task,
+// other values apply to codecs initialized after the call.
+MfxFakeRuntimeConfig MfxFakeGetConfig();
+
+void MfxFakeSetConfig(const MfxFakeRuntimeConfig& config);
@@ -0,0 +1,42 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <map>
+
+#include "mfx_fake_codecs.h"
+
+// Session of the fake runtime, mfxSession handle points to it.
+struct _mfxSession
+{
+    mfxIMPL impl { MFX_IMPL_HARDWARE };
+    mfxVersion version {};
+    mfxPriority priority { MFX_PRIORITY_NORMAL };
+    std::shared_ptr<MfxFakeDevice> device;
+    // Session this one is joined to.
+    _mfxSession* parent { nullptr };
+    mfxFrameAllocator* allocator { nullptr };
+    std::map<mfxHandleType, mfxHDL> handles;
+
+    std::unique_ptr<MfxFakeDecoder> decoder;
+    std::unique_ptr<MfxFakeEncoder> encoder;
+    std::unique_ptr<MfxFakeVpp> vpp;
+};
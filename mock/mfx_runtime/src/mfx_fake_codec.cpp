@@ -0,0 +1,82 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_codecs.h"
+#include "mfx_debug.h"
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_codec"
+
+MfxFakeCodec::MfxFakeCodec(std::shared_ptr<MfxFakeDevice> device)
+    : m_device(std::move(device))
+{
+    MFX_DEBUG_TRACE_FUNC;
+}
+
+MfxFakeCodec::~MfxFakeCodec()
+{
+    MFX_DEBUG_TRACE_FUNC;
+    // completions refer to the codec
+    m_device->Flush(this);
+}
+
+void MfxFakeCodec::InitAsync(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    // components wait for AsyncDepth synced points, so it should never be reported as 0
+    if (!par->AsyncDepth) par->AsyncDepth = 1;
+
+    MfxFakeRuntimeConfig config = MfxFakeGetConfig();
+    m_maxQueued = config.async_depth ? config.async_depth : par->AsyncDepth;
+    m_busyPeriod = config.busy_period;
+    m_submitCount = 0;
+
+    MFX_DEBUG_TRACE_U32(m_maxQueued);
+    MFX_DEBUG_TRACE_U32(m_busyPeriod);
+}
+
+mfxStatus MfxFakeCodec::CheckBusy()
+{
+    ++m_submitCount;
+    if (m_busyPeriod && 0 == m_submitCount % m_busyPeriod) return MFX_WRN_DEVICE_BUSY;
+    if (m_queuedCount >= m_maxQueued) return MFX_WRN_DEVICE_BUSY;
+    return MFX_ERR_NONE;
+}
+
+mfxSyncPoint MfxFakeCodec::Submit(MfxFakeDevice::Completion completion)
+{
+    ++m_queuedCount;
+    return m_device->Submit(this, [this, completion] () {
+        completion();
+        --m_queuedCount;
+    });
+}
+
+void MfxFakeCodec::LockSurface(mfxFrameSurface1* surface)
+{
+    // Locked is read by component threads while the device thread updates it
+    __atomic_add_fetch(&surface->Data.Locked, 1, __ATOMIC_SEQ_CST);
+}
+
+void MfxFakeCodec::UnlockSurface(mfxFrameSurface1* surface)
+{
+    __atomic_sub_fetch(&surface->Data.Locked, 1, __ATOMIC_SEQ_CST);
+}
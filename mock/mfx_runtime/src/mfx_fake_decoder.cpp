@@ -0,0 +1,412 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_codecs.h"
+#include "mfx_debug.h"
+#include "mfx_msdk_debug.h"
+#include "mfx_c2_bs_utils.h"
+#include "mfx_c2_avc_bitstream.h"
+#include "mfx_c2_hevc_bitstream.h"
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_decoder"
+
+namespace {
+
+const size_t START_CODE_SIZE = 3;
+const size_t NAL_HEADER_SIZE = 3; // enough to see first slice flags
+
+const mfxU32 AVC_NAL_SPS = 7;
+const mfxU32 HEVC_NAL_SPS = 33;
+
+struct NalUnitInfo
+{
+    mfxU32 type;
+    bool slice;
+    bool first_slice;
+    // non-VCL unit which can only precede the first slice of access unit
+    bool au_start;
+};
+
+NalUnitInfo ParseNalHeader(mfxU32 codec, const mfxU8* header)
+{
+    NalUnitInfo info {};
+    if (MFX_CODEC_AVC == codec) {
+        info.type = header[0] & 0x1F;
+        info.slice = info.type >= 1 && info.type <= 5;
+        // first_mb_in_slice is ue(v), zero is coded as single 1 bit
+        info.first_slice = info.slice && (header[1] & 0x80);
+        info.au_start = (info.type >= 6 && info.type <= 9) || (info.type >= 14 && info.type <= 18);
+    } else {
+        info.type = (header[0] >> 1) & 0x3F;
+        info.slice = info.type <= 31;
+        // first_slice_segment_in_pic_flag
+        info.first_slice = info.slice && (header[2] & 0x80);
+        info.au_start = (info.type >= 32 && info.type <= 35) || info.type == 39 ||
+            (info.type >= 41 && info.type <= 44) || (info.type >= 48 && info.type <= 55);
+    }
+    return info;
+}
+
+// Returns position of the next 00 00 01 start code or size if there is none.
+size_t FindStartCode(const mfxU8* data, size_t size, size_t pos)
+{
+    for (; pos + START_CODE_SIZE <= size; ++pos) {
+        if (data[pos + 2] > 1) {
+            pos += 2; // no start code can end within next 2 bytes
+        } else if (0 == data[pos] && 0 == data[pos + 1] && 1 == data[pos + 2]) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+// Copies payload of the first NAL unit of the type removing emulation prevention bytes,
+// as the headers parsers expect.
+bool GetNalUnit(mfxU32 codec, const mfxBitstream* bs, mfxU32 type, std::vector<mfxU8>* swapped, mfxU32* swapped_size)
+{
+    mfxU8* data = bs->Data + bs->DataOffset;
+    size_t size = bs->DataLength;
+
+    size_t pos = FindStartCode(data, size, 0);
+    while (pos + START_CODE_SIZE + NAL_HEADER_SIZE <= size) {
+        size_t header = pos + START_CODE_SIZE;
+        size_t next = FindStartCode(data, size, header);
+
+        if (ParseNalHeader(codec, data + header).type == type) {
+            mfxU32 nal_size = next - header;
+            swapped->resize(nal_size + 8);
+            *swapped_size = nal_size;
+            BytesSwapper::SwapMemory(swapped->data(), *swapped_size, data + header, nal_size);
+            return true;
+        }
+        pos = next;
+    }
+    return false;
+}
+
+mfxStatus ParseAvcHeader(const mfxBitstream* bs, mfxVideoParam* par)
+{
+    std::vector<mfxU8> swapped;
+    mfxU32 size = 0;
+    if (!GetNalUnit(MFX_CODEC_AVC, bs, AVC_NAL_SPS, &swapped, &size)) return MFX_ERR_MORE_DATA;
+
+    AVCParser::AVCSeqParamSet sps;
+    try {
+        AVCParser::AVCHeadersBitstream bitstream;
+        AVCParser::NAL_Unit_Type nal_type;
+        mfxU8 storage_idc;
+        bitstream.Reset(swapped.data(), size);
+        bitstream.GetNALUnitType(nal_type, storage_idc);
+        mfxStatus sts = bitstream.GetSequenceParamSet(&sps);
+        if (MFX_ERR_NONE != sts) return sts;
+    } catch (const AVCParser::AVC_exception&) {
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+
+    mfxFrameInfo& info = par->mfx.FrameInfo;
+    mfxU32 crop_unit_x = sps.chroma_format_idc ? 2 : 1;
+    mfxU32 crop_unit_y = (sps.chroma_format_idc == 1 ? 2 : 1) * (2 - sps.frame_mbs_only_flag);
+
+    info.Width = sps.frame_width_in_mbs * 16;
+    info.Height = sps.frame_height_in_mbs * 16;
+    info.CropX = info.CropY = 0;
+    info.CropW = info.Width;
+    info.CropH = info.Height;
+    if (sps.frame_cropping_flag) {
+        info.CropX = sps.frame_cropping_rect_left_offset * crop_unit_x;
+        info.CropY = sps.frame_cropping_rect_top_offset * crop_unit_y;
+        info.CropW -= (sps.frame_cropping_rect_left_offset + sps.frame_cropping_rect_right_offset) * crop_unit_x;
+        info.CropH -= (sps.frame_cropping_rect_top_offset + sps.frame_cropping_rect_bottom_offset) * crop_unit_y;
+    }
+    info.BitDepthLuma = sps.bit_depth_luma;
+    info.BitDepthChroma = sps.bit_depth_chroma;
+    par->mfx.CodecProfile = sps.profile_idc;
+    par->mfx.CodecLevel = sps.level_idc;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus ParseHevcHeader(const mfxBitstream* bs, mfxVideoParam* par)
+{
+    std::vector<mfxU8> swapped;
+    mfxU32 size = 0;
+    if (!GetNalUnit(MFX_CODEC_HEVC, bs, HEVC_NAL_SPS, &swapped, &size)) return MFX_ERR_MORE_DATA;
+
+    HEVCParser::H265SeqParamSet sps;
+    try {
+        HEVCParser::HEVCHeadersBitstream bitstream;
+        HEVCParser::NalUnitType nal_type;
+        mfxU32 temporal_id;
+        bitstream.Reset(swapped.data(), size);
+        bitstream.GetNALUnitType(nal_type, temporal_id);
+        mfxStatus sts = bitstream.GetSequenceParamSet(&sps);
+        if (MFX_ERR_NONE != sts) return sts;
+    } catch (const AVCParser::AVC_exception&) {
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+
+    mfxFrameInfo& info = par->mfx.FrameInfo;
+    // conformance window offsets are in luma samples after parsing
+    info.Width = MFX_ALIGN_16(sps.pic_width_in_luma_samples);
+    info.Height = MFX_ALIGN_16(sps.pic_height_in_luma_samples);
+    info.CropX = sps.conf_win_left_offset;
+    info.CropY = sps.conf_win_top_offset;
+    info.CropW = sps.pic_width_in_luma_samples - sps.conf_win_left_offset - sps.conf_win_right_offset;
+    info.CropH = sps.pic_height_in_luma_samples - sps.conf_win_top_offset - sps.conf_win_bottom_offset;
+    info.BitDepthLuma = sps.bit_depth_luma;
+    info.BitDepthChroma = sps.bit_depth_chroma;
+    par->mfx.CodecProfile = sps.getPTL()->GetGeneralPTL()->profile_idc;
+    par->mfx.CodecLevel = sps.getPTL()->GetGeneralPTL()->level_idc / 3;
+    return MFX_ERR_NONE;
+}
+
+} // namespace
+
+MfxFakeDecoder::MfxFakeDecoder(std::shared_ptr<MfxFakeDevice> device)
+    : MfxFakeCodec(std::move(device))
+{
+    MFX_DEBUG_TRACE_FUNC;
+}
+
+mfxStatus MfxFakeDecoder::Query(mfxVideoParam* in, mfxVideoParam* out)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!out) return MFX_ERR_NULL_PTR;
+    if (in) {
+        out->mfx = in->mfx;
+        out->AsyncDepth = in->AsyncDepth;
+        out->IOPattern = in->IOPattern;
+    }
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeDecoder::QueryIOSurf(mfxVideoParam* par, mfxFrameAllocRequest* request)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par || !request) return MFX_ERR_NULL_PTR;
+
+    MFX_ZERO_MEMORY(*request);
+    request->Info = par->mfx.FrameInfo;
+    // frame being decoded and the ones waiting for sync
+    request->NumFrameMin = std::max<mfxU16>(par->AsyncDepth, 1) + 1;
+    request->NumFrameSuggested = request->NumFrameMin;
+    request->Type = MFX_MEMTYPE_EXTERNAL_FRAME | MFX_MEMTYPE_FROM_DECODE |
+        ((par->IOPattern & MFX_IOPATTERN_OUT_VIDEO_MEMORY) ?
+            MFX_MEMTYPE_VIDEO_MEMORY_DECODER_TARGET : MFX_MEMTYPE_SYSTEM_MEMORY);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeDecoder::DecodeHeader(mfxBitstream* bs, mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!bs || !par) return MFX_ERR_NULL_PTR;
+
+    mfxStatus sts = MFX_ERR_NONE;
+    mfxFrameInfo& info = par->mfx.FrameInfo;
+
+    info.BitDepthLuma = info.BitDepthChroma = 8;
+
+    switch (par->mfx.CodecId) {
+        case MFX_CODEC_AVC:
+            sts = ParseAvcHeader(bs, par);
+            break;
+        case MFX_CODEC_HEVC:
+            sts = ParseHevcHeader(bs, par);
+            break;
+        default: {
+            MfxFakeRuntimeConfig config = MfxFakeGetConfig();
+            info.CropX = info.CropY = 0;
+            info.CropW = config.default_width;
+            info.CropH = config.default_height;
+            info.Width = MFX_ALIGN_16(config.default_width);
+            info.Height = MFX_ALIGN_16(config.default_height);
+            break;
+        }
+    }
+
+    if (MFX_ERR_NONE == sts) {
+        bool high_depth = info.BitDepthLuma > 8;
+        info.FourCC = high_depth ? MFX_FOURCC_P010 : MFX_FOURCC_NV12;
+        info.Shift = high_depth ? 1 : 0;
+        info.ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+        info.PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+        info.AspectRatioW = info.AspectRatioH = 1;
+        if (!info.FrameRateExtN || !info.FrameRateExtD) {
+            info.FrameRateExtN = 30;
+            info.FrameRateExtD = 1;
+        }
+        MFX_DEBUG_TRACE__mfxFrameInfo(info);
+    }
+
+    MFX_DEBUG_TRACE__mfxStatus(sts);
+    return sts;
+}
+
+mfxStatus MfxFakeDecoder::Init(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par) return MFX_ERR_NULL_PTR;
+    if (!par->mfx.FrameInfo.Width || !par->mfx.FrameInfo.Height) return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    m_params = *par;
+    m_params.NumExtParam = 0;
+    m_params.ExtParam = nullptr;
+    InitAsync(&m_params);
+
+    m_buffer.clear();
+    m_scanPos = 0;
+    m_seenSlice = false;
+    m_frameOrder = 0;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeDecoder::Reset(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_device->Flush(this);
+    return Init(par);
+}
+
+mfxStatus MfxFakeDecoder::GetVideoParam(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par) return MFX_ERR_NULL_PTR;
+
+    par->mfx = m_params.mfx;
+    par->AsyncDepth = m_params.AsyncDepth;
+    par->IOPattern = m_params.IOPattern;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeDecoder::GetDecodeStat(mfxDecodeStat* stat)
+{
+    if (!stat) return MFX_ERR_NULL_PTR;
+
+    MFX_ZERO_MEMORY(*stat);
+    stat->NumFrame = m_frameOrder;
+    return MFX_ERR_NONE;
+}
+
+size_t MfxFakeDecoder::FindFrameEnd()
+{
+    const mfxU8* data = m_buffer.data();
+    size_t size = m_buffer.size();
+    size_t pos = m_scanPos;
+
+    while (true) {
+        size_t start = FindStartCode(data, size, pos);
+        if (start + START_CODE_SIZE + NAL_HEADER_SIZE > size) {
+            // resume from the start code with incomplete header or from the bytes
+            // which could begin a start code
+            m_scanPos = (start < size) ? start : std::max(pos, size - std::min<size_t>(size, START_CODE_SIZE - 1));
+            return 0;
+        }
+
+        NalUnitInfo nal = ParseNalHeader(m_params.mfx.CodecId, data + start + START_CODE_SIZE);
+        if (m_seenSlice && (nal.au_start || nal.first_slice)) {
+            // zero byte of 4 bytes start code belongs to the next unit
+            return (start > 0 && 0 == data[start - 1]) ? start - 1 : start;
+        }
+        if (nal.slice) m_seenSlice = true;
+
+        pos = start + START_CODE_SIZE;
+    }
+}
+
+bool MfxFakeDecoder::ExtractFrame(mfxBitstream* bs, mfxU64* timestamp)
+{
+    size_t old_size = m_buffer.size();
+
+    if (bs && bs->DataLength) {
+        if (m_buffer.empty()) m_bufferTimeStamp = bs->TimeStamp;
+        const mfxU8* data = bs->Data + bs->DataOffset;
+        m_buffer.insert(m_buffer.end(), data, data + bs->DataLength);
+    }
+
+    size_t frame_end = 0;
+    if (MFX_CODEC_AVC == m_params.mfx.CodecId || MFX_CODEC_HEVC == m_params.mfx.CodecId) {
+        frame_end = FindFrameEnd();
+        bool complete = !bs || (bs->DataFlag & (MFX_BITSTREAM_COMPLETE_FRAME | MFX_BITSTREAM_EOS));
+        if (!frame_end && m_seenSlice && complete) frame_end = m_buffer.size();
+    } else {
+        // other codecs get complete frames from the components
+        frame_end = m_buffer.size();
+    }
+
+    if (!frame_end) {
+        if (bs) {
+            bs->DataOffset += bs->DataLength;
+            bs->DataLength = 0;
+        }
+        return false;
+    }
+
+    // data after the frame is left in the bitstream, unless it was already stored
+    size_t taken = std::max(frame_end, old_size) - old_size;
+    if (bs) {
+        bs->DataOffset += taken;
+        bs->DataLength -= taken;
+    }
+    m_buffer.resize(std::max(frame_end, old_size));
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + frame_end);
+
+    *timestamp = m_bufferTimeStamp;
+    if (bs) m_bufferTimeStamp = bs->TimeStamp;
+    m_scanPos = 0;
+    m_seenSlice = false;
+    return true;
+}
+
+mfxStatus MfxFakeDecoder::DecodeFrameAsync(mfxBitstream* bs, mfxFrameSurface1* surface_work,
+    mfxFrameSurface1** surface_out, mfxSyncPoint* syncp)
+{
+    if (!surface_work || !surface_out || !syncp) return MFX_ERR_NULL_PTR;
+    if (surface_work->Data.Locked) return MFX_ERR_MORE_SURFACE;
+
+    mfxStatus sts = CheckBusy();
+    if (MFX_ERR_NONE != sts) return sts;
+
+    mfxU64 timestamp = 0;
+    if (!ExtractFrame(bs, &timestamp)) return MFX_ERR_MORE_DATA;
+
+    const mfxFrameInfo& info = m_params.mfx.FrameInfo;
+    surface_work->Info.CropX = info.CropX;
+    surface_work->Info.CropY = info.CropY;
+    surface_work->Info.CropW = info.CropW;
+    surface_work->Info.CropH = info.CropH;
+    surface_work->Info.PicStruct = info.PicStruct;
+    surface_work->Info.FrameRateExtN = info.FrameRateExtN;
+    surface_work->Info.FrameRateExtD = info.FrameRateExtD;
+    surface_work->Data.TimeStamp = timestamp;
+    surface_work->Data.FrameOrder = m_frameOrder++;
+
+    // surface is locked until decoding completes, no references are kept
+    LockSurface(surface_work);
+    *surface_out = surface_work;
+    *syncp = Submit([surface_work] () { UnlockSurface(surface_work); });
+
+    return MFX_ERR_NONE;
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_device.h"
+#include "mfx_fake_runtime.h"
+#include "mfx_debug.h"
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_device"
+
+MfxFakeDevice::MfxFakeDevice()
+{
+    MFX_DEBUG_TRACE_FUNC;
+    m_thread = std::thread(&MfxFakeDevice::Run, this);
+}
+
+MfxFakeDevice::~MfxFakeDevice()
+{
+    MFX_DEBUG_TRACE_FUNC;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queueCond.notify_one();
+    // queued tasks are executed before the thread exits, so surfaces get unlocked
+    m_thread.join();
+}
+
+mfxSyncPoint MfxFakeDevice::Submit(const void* owner, Completion completion)
+{
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = m_nextId++;
+        m_tasks[id] = Task { owner, std::move(completion), false };
+        m_queue.push_back(id);
+    }
+    m_queueCond.notify_one();
+    return reinterpret_cast<mfxSyncPoint>(static_cast<uintptr_t>(id));
+}
+
+mfxStatus MfxFakeDevice::Sync(mfxSyncPoint syncp, mfxU32 wait_ms)
+{
+    if (!syncp) return MFX_ERR_NULL_PTR;
+
+    uint64_t id = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(syncp));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_tasks.find(id) == m_tasks.end()) return MFX_ERR_NOT_FOUND;
+
+    auto done = [this, id] {
+        auto it = m_tasks.find(id);
+        return it == m_tasks.end() || it->second.done;
+    };
+    if (MFX_TIMEOUT_INFINITE == wait_ms) {
+        m_doneCond.wait(lock, done);
+    } else if (!m_doneCond.wait_for(lock, std::chrono::milliseconds(wait_ms), done)) {
+        return MFX_WRN_IN_EXECUTION;
+    }
+    m_tasks.erase(id);
+    return MFX_ERR_NONE;
+}
+
+void MfxFakeDevice::Flush(const void* owner)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    auto owned_done = [this, owner] {
+        for (const auto& item : m_tasks) {
+            if (item.second.owner == owner && !item.second.done) return false;
+        }
+        return true;
+    };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCond.wait(lock, owned_done);
+
+    for (auto it = m_tasks.begin(); it != m_tasks.end();) {
+        if (it->second.owner == owner) {
+            it = m_tasks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MfxFakeDevice::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_queueCond.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) break;
+
+        uint64_t id = m_queue.front();
+        m_queue.pop_front();
+        Completion completion = std::move(m_tasks[id].completion);
+
+        lock.unlock();
+        uint32_t latency_us = MfxFakeGetConfig().latency_us;
+        if (latency_us) std::this_thread::sleep_for(std::chrono::microseconds(latency_us));
+        if (completion) completion();
+        lock.lock();
+
+        m_tasks[id].done = true;
+        m_doneCond.notify_all();
+    }
+}
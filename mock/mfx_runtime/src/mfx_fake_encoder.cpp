@@ -0,0 +1,237 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "mfx_fake_codecs.h"
+#include "mfx_debug.h"
+#include "mfx_msdk_debug.h"
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_encoder"
+
+namespace {
+
+// Placeholder headers, only NAL unit types are meaningful.
+const mfxU8 AVC_SPS[] = { 0, 0, 0, 1, 0x67, 0x64, 0x00, 0x28, 0xAC };
+const mfxU8 AVC_PPS[] = { 0, 0, 0, 1, 0x68, 0xEE, 0x3C, 0x80 };
+const mfxU8 HEVC_VPS[] = { 0, 0, 0, 1, 0x40, 0x01, 0x0C, 0x01, 0xFF };
+const mfxU8 HEVC_SPS[] = { 0, 0, 0, 1, 0x42, 0x01, 0x01, 0x01, 0x60 };
+const mfxU8 HEVC_PPS[] = { 0, 0, 0, 1, 0x44, 0x01, 0xC1, 0x72, 0xB4 };
+
+const mfxU8 AVC_IDR_SLICE[] = { 0, 0, 0, 1, 0x65, 0x88 };
+const mfxU8 AVC_SLICE[] = { 0, 0, 0, 1, 0x41, 0x9A };
+const mfxU8 HEVC_IDR_SLICE[] = { 0, 0, 0, 1, 0x26, 0x01, 0xAF };
+const mfxU8 HEVC_SLICE[] = { 0, 0, 0, 1, 0x02, 0x01, 0xD0 };
+
+const mfxU8 PAYLOAD_FILLER = 0xAA;
+
+template<size_t N>
+mfxStatus CopyHeader(const mfxU8 (&header)[N], mfxU8* buffer, mfxU16* buffer_size)
+{
+    if (!buffer) return MFX_ERR_NONE;
+    if (*buffer_size < N) return MFX_ERR_NOT_ENOUGH_BUFFER;
+    memcpy(buffer, header, N);
+    *buffer_size = N;
+    return MFX_ERR_NONE;
+}
+
+} // namespace
+
+MfxFakeEncoder::MfxFakeEncoder(std::shared_ptr<MfxFakeDevice> device)
+    : MfxFakeCodec(std::move(device))
+{
+    MFX_DEBUG_TRACE_FUNC;
+}
+
+mfxStatus MfxFakeEncoder::Query(mfxVideoParam* in, mfxVideoParam* out)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!out) return MFX_ERR_NULL_PTR;
+    if (in) {
+        out->mfx = in->mfx;
+        out->AsyncDepth = in->AsyncDepth;
+        out->IOPattern = in->IOPattern;
+    }
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeEncoder::QueryIOSurf(mfxVideoParam* par, mfxFrameAllocRequest* request)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par || !request) return MFX_ERR_NULL_PTR;
+
+    MFX_ZERO_MEMORY(*request);
+    request->Info = par->mfx.FrameInfo;
+    request->NumFrameMin = std::max<mfxU16>(par->AsyncDepth, 1);
+    request->NumFrameSuggested = request->NumFrameMin;
+    request->Type = MFX_MEMTYPE_EXTERNAL_FRAME | MFX_MEMTYPE_FROM_ENCODE |
+        ((par->IOPattern & MFX_IOPATTERN_IN_VIDEO_MEMORY) ?
+            MFX_MEMTYPE_VIDEO_MEMORY_DECODER_TARGET : MFX_MEMTYPE_SYSTEM_MEMORY);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeEncoder::Init(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par) return MFX_ERR_NULL_PTR;
+    if (!par->mfx.FrameInfo.Width || !par->mfx.FrameInfo.Height) return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    m_params = *par;
+    m_params.NumExtParam = 0;
+    m_params.ExtParam = nullptr;
+    InitAsync(&m_params);
+
+    mfxFrameInfo& info = m_params.mfx.FrameInfo;
+    if (!info.FrameRateExtN || !info.FrameRateExtD) {
+        info.FrameRateExtN = 30;
+        info.FrameRateExtD = 1;
+    }
+    // components size output buffers from these
+    if (!m_params.mfx.BRCParamMultiplier) m_params.mfx.BRCParamMultiplier = 1;
+    if (!m_params.mfx.BufferSizeInKB) {
+        m_params.mfx.BufferSizeInKB = (info.Width * info.Height * 3 / 2) / 1000 / m_params.mfx.BRCParamMultiplier + 1;
+    }
+
+    m_frameOrder = 0;
+    m_bitsEncoded = 0;
+
+    MFX_DEBUG_TRACE__mfxVideoParam_enc(m_params);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeEncoder::Reset(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_device->Flush(this);
+    return Init(par);
+}
+
+mfxStatus MfxFakeEncoder::GetVideoParam(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par) return MFX_ERR_NULL_PTR;
+
+    par->mfx = m_params.mfx;
+    par->AsyncDepth = m_params.AsyncDepth;
+    par->IOPattern = m_params.IOPattern;
+
+    mfxStatus sts = MFX_ERR_NONE;
+    bool hevc = MFX_CODEC_HEVC == m_params.mfx.CodecId;
+
+    for (mfxU16 i = 0; i < par->NumExtParam && MFX_ERR_NONE == sts; ++i) {
+        mfxExtBuffer* buffer = par->ExtParam[i];
+        if (!buffer) continue;
+
+        if (MFX_EXTBUFF_CODING_OPTION_SPSPPS == buffer->BufferId) {
+            mfxExtCodingOptionSPSPPS* spspps = reinterpret_cast<mfxExtCodingOptionSPSPPS*>(buffer);
+            sts = hevc ? CopyHeader(HEVC_SPS, spspps->SPSBuffer, &spspps->SPSBufSize) :
+                CopyHeader(AVC_SPS, spspps->SPSBuffer, &spspps->SPSBufSize);
+            if (MFX_ERR_NONE != sts) break;
+            sts = hevc ? CopyHeader(HEVC_PPS, spspps->PPSBuffer, &spspps->PPSBufSize) :
+                CopyHeader(AVC_PPS, spspps->PPSBuffer, &spspps->PPSBufSize);
+        } else if (MFX_EXTBUFF_CODING_OPTION_VPS == buffer->BufferId && hevc) {
+            mfxExtCodingOptionVPS* vps = reinterpret_cast<mfxExtCodingOptionVPS*>(buffer);
+            sts = CopyHeader(HEVC_VPS, vps->VPSBuffer, &vps->VPSBufSize);
+        }
+    }
+
+    MFX_DEBUG_TRACE__mfxStatus(sts);
+    return sts;
+}
+
+mfxStatus MfxFakeEncoder::GetEncodeStat(mfxEncodeStat* stat)
+{
+    if (!stat) return MFX_ERR_NULL_PTR;
+
+    MFX_ZERO_MEMORY(*stat);
+    stat->NumFrame = m_frameOrder;
+    stat->NumBit = m_bitsEncoded;
+    return MFX_ERR_NONE;
+}
+
+mfxU32 MfxFakeEncoder::GetFrameSize() const
+{
+    const mfxFrameInfo& info = m_params.mfx.FrameInfo;
+    // QPs share the fields with bitrates, constant QP frames are 1/12 of raw NV12 frame
+    if (MFX_RATECONTROL_CQP == m_params.mfx.RateControlMethod || !m_params.mfx.TargetKbps) {
+        return info.Width * info.Height * 3 / 2 / 12;
+    }
+    mfxU64 bytes_per_second = (mfxU64)m_params.mfx.TargetKbps * m_params.mfx.BRCParamMultiplier * 1000 / 8;
+    return (mfxU32)(bytes_per_second * info.FrameRateExtD / info.FrameRateExtN);
+}
+
+mfxStatus MfxFakeEncoder::EncodeFrameAsync(mfxEncodeCtrl* ctrl, mfxFrameSurface1* surface,
+    mfxBitstream* bs, mfxSyncPoint* syncp)
+{
+    // no frames are buffered, so draining is finished at once
+    if (!surface) return MFX_ERR_MORE_DATA;
+    if (!bs || !syncp) return MFX_ERR_NULL_PTR;
+
+    mfxStatus sts = CheckBusy();
+    if (MFX_ERR_NONE != sts) return sts;
+
+    mfxU16 gop_size = m_params.mfx.GopPicSize;
+    bool idr = 0 == m_frameOrder || (gop_size && 0 == m_frameOrder % gop_size) ||
+        (ctrl && (ctrl->FrameType & MFX_FRAMETYPE_IDR));
+
+    const mfxU8* slice = nullptr;
+    size_t slice_size = 0;
+    if (MFX_CODEC_AVC == m_params.mfx.CodecId) {
+        slice = idr ? AVC_IDR_SLICE : AVC_SLICE;
+        slice_size = idr ? sizeof(AVC_IDR_SLICE) : sizeof(AVC_SLICE);
+    } else if (MFX_CODEC_HEVC == m_params.mfx.CodecId) {
+        slice = idr ? HEVC_IDR_SLICE : HEVC_SLICE;
+        slice_size = idr ? sizeof(HEVC_IDR_SLICE) : sizeof(HEVC_SLICE);
+    }
+
+    mfxU32 available = bs->MaxLength - bs->DataOffset - bs->DataLength;
+    if (available <= slice_size) return MFX_ERR_NOT_ENOUGH_BUFFER;
+    mfxU32 frame_size = std::min(std::max<mfxU32>(GetFrameSize(), slice_size + 1), available);
+
+    mfxU16 frame_type = idr ? (MFX_FRAMETYPE_I | MFX_FRAMETYPE_REF | MFX_FRAMETYPE_IDR) :
+        (MFX_FRAMETYPE_P | MFX_FRAMETYPE_REF);
+    mfxU64 timestamp = surface->Data.TimeStamp;
+    mfxU16 pic_struct = m_params.mfx.FrameInfo.PicStruct;
+
+    ++m_frameOrder;
+    m_bitsEncoded += (mfxU64)frame_size * 8;
+
+    LockSurface(surface);
+    *syncp = Submit([=] () {
+        mfxU8* data = bs->Data + bs->DataOffset + bs->DataLength;
+        if (slice_size) memcpy(data, slice, slice_size);
+        memset(data + slice_size, PAYLOAD_FILLER, frame_size - slice_size);
+
+        bs->DataLength += frame_size;
+        bs->TimeStamp = timestamp;
+        bs->DecodeTimeStamp = timestamp;
+        bs->FrameType = frame_type;
+        bs->PicStruct = pic_struct;
+        UnlockSurface(surface);
+    });
+
+    return MFX_ERR_NONE;
+}
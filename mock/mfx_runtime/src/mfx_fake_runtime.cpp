@@ -0,0 +1,617 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <list>
+#include <mutex>
+#include <string.h>
+
+#include "mfx_fake_runtime.h"
+#include "mfx_fake_session.h"
+#include "mfx_debug.h"
+#include "mfx_msdk_debug.h"
+
+#ifdef ANDROID
+#include <cutils/properties.h>
+#endif
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_runtime"
+
+namespace {
+
+struct ConfigStorage
+{
+    ConfigStorage()
+    {
+#ifdef ANDROID
+        const struct {
+            const char* name;
+            uint32_t MfxFakeRuntimeConfig::*field;
+        } properties[] = {
+            { "vendor.intel.video.c2.fake.latency_us", &MfxFakeRuntimeConfig::latency_us },
+            { "vendor.intel.video.c2.fake.async_depth", &MfxFakeRuntimeConfig::async_depth },
+            { "vendor.intel.video.c2.fake.busy_period", &MfxFakeRuntimeConfig::busy_period },
+            { "vendor.intel.video.c2.fake.default_width", &MfxFakeRuntimeConfig::default_width },
+            { "vendor.intel.video.c2.fake.default_height", &MfxFakeRuntimeConfig::default_height },
+        };
+        for (const auto& property : properties) {
+            int32_t value = property_get_int32(property.name, config.*property.field);
+            if (value >= 0) config.*property.field = value;
+        }
+#endif
+    }
+
+    std::mutex mutex;
+    MfxFakeRuntimeConfig config;
+};
+
+ConfigStorage& GetConfigStorage()
+{
+    static ConfigStorage storage;
+    return storage;
+}
+
+mfxIMPL ResolveImpl(mfxIMPL impl)
+{
+    if (MFX_IMPL_SOFTWARE == MFX_IMPL_BASETYPE(impl)) return MFX_IMPL_SOFTWARE;
+
+    mfxIMPL via = MFX_IMPL_VIA_MASK(impl);
+    return MFX_IMPL_HARDWARE | ((via && MFX_IMPL_VIA_ANY != via) ? via : MFX_IMPL_VIA_VAAPI);
+}
+
+mfxStatus CreateSession(mfxIMPL impl, mfxSession* session)
+{
+    if (!session) return MFX_ERR_NULL_PTR;
+
+    _mfxSession* created = new (std::nothrow) _mfxSession;
+    if (!created) return MFX_ERR_MEMORY_ALLOC;
+
+    created->impl = ResolveImpl(impl);
+    created->version.Major = MFX_VERSION_MAJOR;
+    created->version.Minor = MFX_VERSION_MINOR;
+    created->device = std::make_shared<MfxFakeDevice>();
+
+    *session = created;
+    return MFX_ERR_NONE;
+}
+
+} // namespace
+
+MfxFakeRuntimeConfig MfxFakeGetConfig()
+{
+    ConfigStorage& storage = GetConfigStorage();
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    return storage.config;
+}
+
+void MfxFakeSetConfig(const MfxFakeRuntimeConfig& config)
+{
+    ConfigStorage& storage = GetConfigStorage();
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    storage.config = config;
+}
+
+#ifdef USE_ONEVPL
+
+struct _mfxConfig
+{
+    _mfxLoader* loader;
+};
+
+// Dispatcher of the fake runtime enumerates the only implementation,
+// which takes type from the filter.
+struct _mfxLoader
+{
+    std::list<_mfxConfig> configs;
+    mfxU32 impl_type { MFX_IMPL_TYPE_HARDWARE };
+};
+
+#endif
+
+extern "C" {
+
+#ifdef USE_ONEVPL
+
+mfxLoader MFXLoad()
+{
+    MFX_DEBUG_TRACE_FUNC;
+    return new (std::nothrow) _mfxLoader;
+}
+
+void MFXUnload(mfxLoader loader)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    delete loader;
+}
+
+mfxConfig MFXCreateConfig(mfxLoader loader)
+{
+    if (!loader) return nullptr;
+
+    loader->configs.push_back(_mfxConfig { loader });
+    return &loader->configs.back();
+}
+
+mfxStatus MFXSetConfigFilterProperty(mfxConfig config, const mfxU8* name, mfxVariant value)
+{
+    if (!config || !name) return MFX_ERR_NULL_PTR;
+
+    if (0 == strcmp((const char*)name, "mfxImplDescription.Impl")) {
+        if (MFX_VARIANT_TYPE_U32 != value.Type) return MFX_ERR_UNSUPPORTED;
+        config->loader->impl_type = value.Data.U32;
+    }
+    // other filters match the fake implementation
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXEnumImplementations(mfxLoader loader, mfxU32 i, mfxImplCapsDeliveryFormat format, mfxHDL* idesc)
+{
+    if (!loader || !idesc) return MFX_ERR_NULL_PTR;
+    if (i > 0) return MFX_ERR_NOT_FOUND;
+    if (MFX_IMPLCAPS_IMPLDESCSTRUCTURE != format) return MFX_ERR_UNSUPPORTED;
+
+    mfxImplDescription* desc = new (std::nothrow) mfxImplDescription();
+    if (!desc) return MFX_ERR_MEMORY_ALLOC;
+
+    desc->Version.Major = 1;
+    desc->Impl = (mfxImplType)loader->impl_type;
+    desc->AccelerationMode = (MFX_IMPL_TYPE_HARDWARE == loader->impl_type) ?
+        MFX_ACCEL_MODE_VIA_VAAPI : MFX_ACCEL_MODE_NA;
+    desc->ApiVersion.Major = MFX_VERSION_MAJOR;
+    desc->ApiVersion.Minor = MFX_VERSION_MINOR;
+    strncpy(desc->ImplName, "mfx_fake_runtime", sizeof(desc->ImplName) - 1);
+
+    *idesc = desc;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXCreateSession(mfxLoader loader, mfxU32 i, mfxSession* session)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!loader) return MFX_ERR_NULL_PTR;
+    if (i > 0) return MFX_ERR_NOT_FOUND;
+
+    return CreateSession((MFX_IMPL_TYPE_SOFTWARE == loader->impl_type) ?
+        MFX_IMPL_SOFTWARE : MFX_IMPL_HARDWARE, session);
+}
+
+mfxStatus MFXDispReleaseImplDescription(mfxLoader loader, mfxHDL hdl)
+{
+    if (!loader) return MFX_ERR_NULL_PTR;
+
+    delete static_cast<mfxImplDescription*>(hdl);
+    return MFX_ERR_NONE;
+}
+
+#endif // #ifdef USE_ONEVPL
+
+mfxStatus MFXInit(mfxIMPL impl, mfxVersion* /*ver*/, mfxSession* session)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    return CreateSession(impl, session);
+}
+
+mfxStatus MFXInitEx(mfxInitParam par, mfxSession* session)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    return CreateSession(par.Implementation, session);
+}
+
+mfxStatus MFXClose(mfxSession session)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+
+    delete session;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXQueryIMPL(mfxSession session, mfxIMPL* impl)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!impl) return MFX_ERR_NULL_PTR;
+
+    *impl = session->impl;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXQueryVersion(mfxSession session, mfxVersion* version)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!version) return MFX_ERR_NULL_PTR;
+
+    *version = session->version;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXJoinSession(mfxSession session, mfxSession child)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session || !child) return MFX_ERR_INVALID_HANDLE;
+    if (child->parent) return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    // tasks of joined sessions share the device queue
+    child->parent = session;
+    child->device = session->device;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXDisjoinSession(mfxSession session)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->parent) return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    session->parent = nullptr;
+    session->device = std::make_shared<MfxFakeDevice>();
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXCloneSession(mfxSession session, mfxSession* clone)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+
+    mfxStatus sts = CreateSession(session->impl, clone);
+    if (MFX_ERR_NONE == sts) (*clone)->handles = session->handles;
+    return sts;
+}
+
+mfxStatus MFXSetPriority(mfxSession session, mfxPriority priority)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+
+    session->priority = priority;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXGetPriority(mfxSession session, mfxPriority* priority)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!priority) return MFX_ERR_NULL_PTR;
+
+    *priority = session->priority;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoCORE_SetFrameAllocator(mfxSession session, mfxFrameAllocator* allocator)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+
+    // surfaces content is never accessed, allocator is only kept
+    session->allocator = allocator;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoCORE_SetHandle(mfxSession session, mfxHandleType type, mfxHDL hdl)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!hdl) return MFX_ERR_NULL_PTR;
+
+    session->handles[type] = hdl;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoCORE_GetHandle(mfxSession session, mfxHandleType type, mfxHDL* hdl)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!hdl) return MFX_ERR_NULL_PTR;
+
+    auto it = session->handles.find(type);
+    if (it == session->handles.end()) return MFX_ERR_NOT_FOUND;
+
+    *hdl = it->second;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoCORE_QueryPlatform(mfxSession session, mfxPlatform* platform)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!platform) return MFX_ERR_NULL_PTR;
+
+    MFX_ZERO_MEMORY(*platform);
+    platform->CodeName = MFX_PLATFORM_UNKNOWN;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoCORE_SyncOperation(mfxSession session, mfxSyncPoint syncp, mfxU32 wait)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+
+    return session->device->Sync(syncp, wait);
+}
+
+// DECODE
+
+mfxStatus MFXVideoDECODE_Query(mfxSession session, mfxVideoParam* in, mfxVideoParam* out)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeDecoder::Query(in, out);
+}
+
+mfxStatus MFXVideoDECODE_DecodeHeader(mfxSession session, mfxBitstream* bs, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeDecoder::DecodeHeader(bs, par);
+}
+
+mfxStatus MFXVideoDECODE_QueryIOSurf(mfxSession session, mfxVideoParam* par, mfxFrameAllocRequest* request)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeDecoder::QueryIOSurf(par, request);
+}
+
+mfxStatus MFXVideoDECODE_Init(mfxSession session, mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (session->decoder) return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    std::unique_ptr<MfxFakeDecoder> decoder(new (std::nothrow) MfxFakeDecoder(session->device));
+    if (!decoder) return MFX_ERR_MEMORY_ALLOC;
+
+    mfxStatus sts = decoder->Init(par);
+    if (MFX_ERR_NONE == sts) session->decoder = std::move(decoder);
+
+    MFX_DEBUG_TRACE__mfxStatus(sts);
+    return sts;
+}
+
+mfxStatus MFXVideoDECODE_Reset(mfxSession session, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->decoder->Reset(par);
+}
+
+mfxStatus MFXVideoDECODE_Close(mfxSession session)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+
+    session->decoder.reset();
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoDECODE_GetVideoParam(mfxSession session, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->decoder->GetVideoParam(par);
+}
+
+mfxStatus MFXVideoDECODE_GetDecodeStat(mfxSession session, mfxDecodeStat* stat)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->decoder->GetDecodeStat(stat);
+}
+
+mfxStatus MFXVideoDECODE_SetSkipMode(mfxSession session, mfxSkipMode /*mode*/)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoDECODE_GetPayload(mfxSession session, mfxU64* ts, mfxPayload* payload)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+    if (!ts || !payload) return MFX_ERR_NULL_PTR;
+
+    // no SEI payloads are collected
+    payload->NumBit = 0;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream* bs,
+    mfxFrameSurface1* surface_work, mfxFrameSurface1** surface_out, mfxSyncPoint* syncp)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->decoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->decoder->DecodeFrameAsync(bs, surface_work, surface_out, syncp);
+}
+
+// ENCODE
+
+mfxStatus MFXVideoENCODE_Query(mfxSession session, mfxVideoParam* in, mfxVideoParam* out)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeEncoder::Query(in, out);
+}
+
+mfxStatus MFXVideoENCODE_QueryIOSurf(mfxSession session, mfxVideoParam* par, mfxFrameAllocRequest* request)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeEncoder::QueryIOSurf(par, request);
+}
+
+mfxStatus MFXVideoENCODE_Init(mfxSession session, mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (session->encoder) return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    std::unique_ptr<MfxFakeEncoder> encoder(new (std::nothrow) MfxFakeEncoder(session->device));
+    if (!encoder) return MFX_ERR_MEMORY_ALLOC;
+
+    mfxStatus sts = encoder->Init(par);
+    if (MFX_ERR_NONE == sts) session->encoder = std::move(encoder);
+
+    MFX_DEBUG_TRACE__mfxStatus(sts);
+    return sts;
+}
+
+mfxStatus MFXVideoENCODE_Reset(mfxSession session, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->encoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->encoder->Reset(par);
+}
+
+mfxStatus MFXVideoENCODE_Close(mfxSession session)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->encoder) return MFX_ERR_NOT_INITIALIZED;
+
+    session->encoder.reset();
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoENCODE_GetVideoParam(mfxSession session, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->encoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->encoder->GetVideoParam(par);
+}
+
+mfxStatus MFXVideoENCODE_GetEncodeStat(mfxSession session, mfxEncodeStat* stat)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->encoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->encoder->GetEncodeStat(stat);
+}
+
+mfxStatus MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxEncodeCtrl* ctrl,
+    mfxFrameSurface1* surface, mfxBitstream* bs, mfxSyncPoint* syncp)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->encoder) return MFX_ERR_NOT_INITIALIZED;
+    return session->encoder->EncodeFrameAsync(ctrl, surface, bs, syncp);
+}
+
+// VPP
+
+mfxStatus MFXVideoVPP_Query(mfxSession session, mfxVideoParam* in, mfxVideoParam* out)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeVpp::Query(in, out);
+}
+
+mfxStatus MFXVideoVPP_QueryIOSurf(mfxSession session, mfxVideoParam* par, mfxFrameAllocRequest request[2])
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    return MfxFakeVpp::QueryIOSurf(par, request);
+}
+
+mfxStatus MFXVideoVPP_Init(mfxSession session, mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (session->vpp) return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+    std::unique_ptr<MfxFakeVpp> vpp(new (std::nothrow) MfxFakeVpp(session->device));
+    if (!vpp) return MFX_ERR_MEMORY_ALLOC;
+
+    mfxStatus sts = vpp->Init(par);
+    if (MFX_ERR_NONE == sts) session->vpp = std::move(vpp);
+
+    MFX_DEBUG_TRACE__mfxStatus(sts);
+    return sts;
+}
+
+mfxStatus MFXVideoVPP_Reset(mfxSession session, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->vpp) return MFX_ERR_NOT_INITIALIZED;
+    return session->vpp->Reset(par);
+}
+
+mfxStatus MFXVideoVPP_Close(mfxSession session)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->vpp) return MFX_ERR_NOT_INITIALIZED;
+
+    session->vpp.reset();
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFXVideoVPP_GetVideoParam(mfxSession session, mfxVideoParam* par)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->vpp) return MFX_ERR_NOT_INITIALIZED;
+    return session->vpp->GetVideoParam(par);
+}
+
+mfxStatus MFXVideoVPP_GetVPPStat(mfxSession session, mfxVPPStat* stat)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->vpp) return MFX_ERR_NOT_INITIALIZED;
+    return session->vpp->GetVPPStat(stat);
+}
+
+mfxStatus MFXVideoVPP_RunFrameVPPAsync(mfxSession session, mfxFrameSurface1* in,
+    mfxFrameSurface1* out, mfxExtVppAuxData* aux, mfxSyncPoint* syncp)
+{
+    if (!session) return MFX_ERR_INVALID_HANDLE;
+    if (!session->vpp) return MFX_ERR_NOT_INITIALIZED;
+    return session->vpp->RunFrameVPPAsync(in, out, aux, syncp);
+}
+
+// Entry points referenced by the C++ wrappers only, internal memory management
+// of the runtime is not simulated.
+
+#ifdef USE_ONEVPL
+
+mfxStatus MFXVideoVPP_ProcessFrameAsync(mfxSession session, mfxFrameSurface1* /*in*/, mfxFrameSurface1** /*out*/)
+{
+    return session ? MFX_ERR_UNSUPPORTED : MFX_ERR_INVALID_HANDLE;
+}
+
+mfxStatus MFXMemory_GetSurfaceForVPP(mfxSession session, mfxFrameSurface1** /*surface*/)
+{
+    return session ? MFX_ERR_UNSUPPORTED : MFX_ERR_INVALID_HANDLE;
+}
+
+mfxStatus MFXMemory_GetSurfaceForVPPOut(mfxSession session, mfxFrameSurface1** /*surface*/)
+{
+    return session ? MFX_ERR_UNSUPPORTED : MFX_ERR_INVALID_HANDLE;
+}
+
+mfxStatus MFXMemory_GetSurfaceForEncode(mfxSession session, mfxFrameSurface1** /*surface*/)
+{
+    return session ? MFX_ERR_UNSUPPORTED : MFX_ERR_INVALID_HANDLE;
+}
+
+mfxStatus MFXMemory_GetSurfaceForDecode(mfxSession session, mfxFrameSurface1** /*surface*/)
+{
+    return session ? MFX_ERR_UNSUPPORTED : MFX_ERR_INVALID_HANDLE;
+}
+
+#else
+
+mfxStatus MFXVideoVPP_RunFrameVPPAsyncEx(mfxSession session, mfxFrameSurface1* /*in*/,
+    mfxFrameSurface1* /*surface_work*/, mfxFrameSurface1** /*surface_out*/, mfxSyncPoint* /*syncp*/)
+{
+    return session ? MFX_ERR_UNSUPPORTED : MFX_ERR_INVALID_HANDLE;
+}
+
+#endif // #ifdef USE_ONEVPL
+
+} // extern "C"
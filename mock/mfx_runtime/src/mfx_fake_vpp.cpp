@@ -0,0 +1,144 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_codecs.h"
+#include "mfx_debug.h"
+#include "mfx_msdk_debug.h"
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_vpp"
+
+MfxFakeVpp::MfxFakeVpp(std::shared_ptr<MfxFakeDevice> device)
+    : MfxFakeCodec(std::move(device))
+{
+    MFX_DEBUG_TRACE_FUNC;
+}
+
+mfxStatus MfxFakeVpp::Query(mfxVideoParam* in, mfxVideoParam* out)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!out) return MFX_ERR_NULL_PTR;
+    if (in) {
+        out->vpp = in->vpp;
+        out->AsyncDepth = in->AsyncDepth;
+        out->IOPattern = in->IOPattern;
+    }
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeVpp::QueryIOSurf(mfxVideoParam* par, mfxFrameAllocRequest request[2])
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par || !request) return MFX_ERR_NULL_PTR;
+
+    mfxU16 frames = std::max<mfxU16>(par->AsyncDepth, 1);
+
+    MFX_ZERO_MEMORY(request[0]);
+    request[0].Info = par->vpp.In;
+    request[0].NumFrameMin = request[0].NumFrameSuggested = frames;
+    request[0].Type = MFX_MEMTYPE_EXTERNAL_FRAME | MFX_MEMTYPE_FROM_VPPIN |
+        ((par->IOPattern & MFX_IOPATTERN_IN_VIDEO_MEMORY) ?
+            MFX_MEMTYPE_VIDEO_MEMORY_PROCESSOR_TARGET : MFX_MEMTYPE_SYSTEM_MEMORY);
+
+    MFX_ZERO_MEMORY(request[1]);
+    request[1].Info = par->vpp.Out;
+    request[1].NumFrameMin = request[1].NumFrameSuggested = frames;
+    request[1].Type = MFX_MEMTYPE_EXTERNAL_FRAME | MFX_MEMTYPE_FROM_VPPOUT |
+        ((par->IOPattern & MFX_IOPATTERN_OUT_VIDEO_MEMORY) ?
+            MFX_MEMTYPE_VIDEO_MEMORY_PROCESSOR_TARGET : MFX_MEMTYPE_SYSTEM_MEMORY);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeVpp::Init(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par) return MFX_ERR_NULL_PTR;
+    if (!par->vpp.Out.Width || !par->vpp.Out.Height) return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    m_params = *par;
+    m_params.NumExtParam = 0;
+    m_params.ExtParam = nullptr;
+    InitAsync(&m_params);
+    m_frameCount = 0;
+
+    MFX_DEBUG_TRACE__mfxVideoParam_vpp(m_params);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeVpp::Reset(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    m_device->Flush(this);
+    return Init(par);
+}
+
+mfxStatus MfxFakeVpp::GetVideoParam(mfxVideoParam* par)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!par) return MFX_ERR_NULL_PTR;
+
+    par->vpp = m_params.vpp;
+    par->AsyncDepth = m_params.AsyncDepth;
+    par->IOPattern = m_params.IOPattern;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeVpp::GetVPPStat(mfxVPPStat* stat)
+{
+    if (!stat) return MFX_ERR_NULL_PTR;
+
+    MFX_ZERO_MEMORY(*stat);
+    stat->NumFrame = m_frameCount;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MfxFakeVpp::RunFrameVPPAsync(mfxFrameSurface1* in, mfxFrameSurface1* out,
+    mfxExtVppAuxData* /*aux*/, mfxSyncPoint* syncp)
+{
+    // no frames are buffered, so draining is finished at once
+    if (!in) return MFX_ERR_MORE_DATA;
+    if (!out || !syncp) return MFX_ERR_NULL_PTR;
+
+    mfxStatus sts = CheckBusy();
+    if (MFX_ERR_NONE != sts) return sts;
+
+    const mfxFrameInfo& info = m_params.vpp.Out;
+    out->Info.CropX = info.CropX;
+    out->Info.CropY = info.CropY;
+    out->Info.CropW = info.CropW;
+    out->Info.CropH = info.CropH;
+    out->Info.PicStruct = info.PicStruct;
+    out->Data.TimeStamp = in->Data.TimeStamp;
+    out->Data.FrameOrder = m_frameCount++;
+
+    LockSurface(in);
+    LockSurface(out);
+    *syncp = Submit([in, out] () {
+        UnlockSurface(in);
+        UnlockSurface(out);
+    });
+
+    return MFX_ERR_NONE;
+}
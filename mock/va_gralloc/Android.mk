@@ -0,0 +1,38 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(MFX_C2_HOME)/mfx_c2_env.mk
+
+# Plain memory fakes of libva and gralloc, replace libva, libva-android and libhardware
+# in allocator tests and benchmarks.
+include $(CLEAR_VARS)
+include $(MFX_C2_HOME)/mfx_c2_defs.mk
+
+LOCAL_SRC_FILES := $(addprefix src/, $(notdir $(wildcard $(LOCAL_PATH)/src/*.cpp)))
+
+LOCAL_C_INCLUDES := \
+    frameworks/av/media/codec2/vndk/include \
+    $(MFX_C2_HOME)/c2_utils/include/ \
+    $(MFX_C2_INCLUDES) \
+    $(MFX_C2_INCLUDES_LIBVA)
+
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := \
+    $(MFX_C2_CFLAGS) \
+    $(MFX_C2_CFLAGS_LIBVA)
+
+LOCAL_LDFLAGS := $(MFX_C2_LDFLAGS)
+
+LOCAL_SHARED_LIBRARIES := \
+    libcutils liblog \
+    $(MFX_C2_SHARED_LIBS)
+
+LOCAL_STATIC_LIBRARIES := \
+    libmfx_c2_utils
+
+LOCAL_HEADER_LIBRARIES := $(MFX_C2_HEADER_LIBRARIES)
+
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libmfx_fake_va_gralloc
+
+include $(BUILD_SHARED_LIBRARY)
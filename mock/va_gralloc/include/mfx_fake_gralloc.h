@@ -0,0 +1,77 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <hardware/gralloc1.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Buffer storage of the fake gralloc shared by fake gralloc1 device,
+// fake VA and fake C2 allocator of libmfx_fake_va_gralloc.
+// Handles carry buffer id in their ints, so clones of the handles made by C2 wrappers
+// (for example, UnwrapNativeCodec2GrallocHandle) resolve to the same buffer.
+
+struct MfxFakeGrallocBuffer
+{
+    static constexpr size_t MAX_PLANES = 4;
+
+    uint64_t id { 0 };
+    uint32_t width { 0 };
+    uint32_t height { 0 };
+    int32_t format { 0 };
+    uint32_t planes_count { 0 };
+    uint32_t pitches[MAX_PLANES] {};
+    uint32_t offsets[MAX_PLANES] {};
+    size_t size { 0 };
+    std::unique_ptr<uint8_t[]> data;
+};
+
+class MfxFakeGralloc
+{
+public:
+    static MfxFakeGralloc& Get();
+
+    // Creates memory of gralloc buffer with linear planes layout, not registered,
+    // so it has no handles. Returns nullptr on unsupported format or allocation failure.
+    static std::shared_ptr<MfxFakeGrallocBuffer> CreateBuffer(uint32_t width, uint32_t height,
+        int32_t format);
+
+    // Methods return gralloc1_error_t values.
+    int32_t Allocate(uint32_t width, uint32_t height, int32_t format, buffer_handle_t* handle);
+    // Registers one more handle of the buffer, the buffer lives while it has registered handles.
+    int32_t Import(buffer_handle_t raw_handle, buffer_handle_t* handle);
+    int32_t Release(buffer_handle_t handle);
+
+    // Finds buffer by any handle carrying its id, nullptr if the buffer is released.
+    std::shared_ptr<MfxFakeGrallocBuffer> Find(buffer_handle_t handle);
+
+    size_t GetHandleCount();
+
+private:
+    MfxFakeGralloc() = default;
+
+    std::mutex m_mutex;
+    uint64_t m_nextId { 1 };
+    std::map<uint64_t, std::shared_ptr<MfxFakeGrallocBuffer>> m_buffers;
+    std::map<buffer_handle_t, uint64_t> m_handles;
+};
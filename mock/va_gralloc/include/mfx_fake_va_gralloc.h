@@ -0,0 +1,48 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <C2Buffer.h>
+
+#include <memory>
+
+// In-process fakes of libva and gralloc (libmfx_fake_va_gralloc) backed by plain memory.
+// The library exports libva entry points and hw_get_module used by
+// MfxVaFrameAllocator and MfxGrallocAllocator, so code linked with it instead of
+// libva, libva-android and libhardware runs allocator paths without GPU.
+// Surfaces created from gralloc buffers share memory with them like the driver does.
+
+// Objects currently alive in the fakes, used to check for leaks.
+struct MfxFakeVaGrallocStats
+{
+    size_t gralloc_handles { 0 }; // allocated and imported gralloc handles
+    size_t va_surfaces { 0 };
+    size_t va_buffers { 0 }; // including buffers of derived images
+    size_t va_images { 0 };
+};
+
+MfxFakeVaGrallocStats MfxFakeVaGrallocGetStats();
+
+// Creates C2Allocator allocating graphic blocks from the fake gralloc,
+// handles of the blocks are wrapped as C2 gralloc handles.
+// For MfxC2BufferQueueBlockPool working without configured producer.
+// CPU mapping of the blocks supports NV12 only.
+std::shared_ptr<C2Allocator> MfxFakeCreateC2GrallocAllocator();
@@ -0,0 +1,183 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_va_gralloc.h"
+#include "mfx_fake_gralloc.h"
+#include "mfx_c2_utils.h"
+#include "mfx_debug.h"
+
+#include <C2AllocatorGralloc.h>
+#include <C2PlatformSupport.h>
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_c2_allocator"
+
+using namespace android;
+
+namespace {
+
+void DeleteC2Handle(const C2Handle* handle)
+{
+    native_handle_t* native_handle = const_cast<native_handle_t*>(reinterpret_cast<const native_handle_t*>(handle));
+    native_handle_close(native_handle);
+    native_handle_delete(native_handle);
+}
+
+// Owns registered handle of the fake gralloc buffer and its C2 wrapper.
+class FakeGraphicAllocation : public C2GraphicAllocation
+{
+public:
+    FakeGraphicAllocation(uint32_t width, uint32_t height, C2Allocator::id_t allocator_id,
+        buffer_handle_t gralloc_handle, const C2Handle* c2_handle)
+        : C2GraphicAllocation(width, height)
+        , m_allocatorId(allocator_id)
+        , m_grallocHandle(gralloc_handle)
+        , m_c2Handle(c2_handle)
+    {
+    }
+
+    ~FakeGraphicAllocation() override
+    {
+        MfxFakeGralloc::Get().Release(m_grallocHandle);
+        DeleteC2Handle(m_c2Handle);
+    }
+
+    c2_status_t map(C2Rect, C2MemoryUsage, C2Fence* fence, C2PlanarLayout* layout, uint8_t** addr) override
+    {
+        MFX_DEBUG_TRACE_FUNC;
+
+        if (!layout || !addr) return C2_BAD_VALUE;
+
+        std::shared_ptr<MfxFakeGrallocBuffer> buffer = MfxFakeGralloc::Get().Find(m_grallocHandle);
+        if (!buffer) return C2_CORRUPTED;
+
+        if (buffer->format != HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL &&
+            buffer->format != HAL_PIXEL_FORMAT_NV12) return C2_OMITTED;
+
+        InitNV12PlaneLayout(buffer->pitches, layout);
+        InitNV12PlaneData(buffer->pitches[0], buffer->offsets[1] / buffer->pitches[0], buffer->data.get(), addr);
+
+        if (fence) *fence = C2Fence();
+        return C2_OK;
+    }
+
+    c2_status_t unmap(uint8_t**, C2Rect, C2Fence* fence) override
+    {
+        if (fence) *fence = C2Fence();
+        return C2_OK;
+    }
+
+    C2Allocator::id_t getAllocatorId() const override { return m_allocatorId; }
+
+    const C2Handle* handle() const override { return m_c2Handle; }
+
+    bool equals(const std::shared_ptr<const C2GraphicAllocation>& other) const override
+    {
+        return other && other->handle() == m_c2Handle;
+    }
+
+private:
+    C2Allocator::id_t m_allocatorId;
+    buffer_handle_t m_grallocHandle;
+    const C2Handle* m_c2Handle;
+};
+
+class FakeC2GrallocAllocator : public C2Allocator
+{
+public:
+    FakeC2GrallocAllocator()
+        : m_traits(std::make_shared<Traits>(Traits {
+            "fake.gralloc", C2PlatformAllocatorStore::GRALLOC, C2Allocator::GRAPHIC,
+            C2MemoryUsage(0, 0), C2MemoryUsage(~(uint64_t)0, ~(uint64_t)0) }))
+    {
+    }
+
+    id_t getId() const override { return m_traits->id; }
+
+    C2String getName() const override { return m_traits->name; }
+
+    std::shared_ptr<const Traits> getTraits() const override { return m_traits; }
+
+    c2_status_t newGraphicAllocation(uint32_t width, uint32_t height, uint32_t format,
+        C2MemoryUsage usage, std::shared_ptr<C2GraphicAllocation>* allocation) override
+    {
+        MFX_DEBUG_TRACE_FUNC;
+
+        if (!allocation) return C2_BAD_VALUE;
+
+        buffer_handle_t gralloc_handle = nullptr;
+        int32_t gr1_err = MfxFakeGralloc::Get().Allocate(width, height, format, &gralloc_handle);
+        if (GRALLOC1_ERROR_NONE != gr1_err) {
+            MFX_DEBUG_TRACE_I32(gr1_err);
+            return C2_NO_MEMORY;
+        }
+
+        std::shared_ptr<MfxFakeGrallocBuffer> buffer = MfxFakeGralloc::Get().Find(gralloc_handle);
+        const C2Handle* c2_handle = WrapNativeCodec2GrallocHandle(gralloc_handle,
+            width, height, format, usage.expected, buffer->pitches[0]);
+        if (!c2_handle) {
+            MfxFakeGralloc::Get().Release(gralloc_handle);
+            return C2_NO_MEMORY;
+        }
+
+        *allocation = std::make_shared<FakeGraphicAllocation>(width, height, getId(),
+            gralloc_handle, c2_handle);
+        return C2_OK;
+    }
+
+    c2_status_t priorGraphicAllocation(const C2Handle* handle,
+        std::shared_ptr<C2GraphicAllocation>* allocation) override
+    {
+        MFX_DEBUG_TRACE_FUNC;
+
+        if (!handle || !allocation) return C2_BAD_VALUE;
+
+        uint32_t width, height, format, stride, generation, igbp_slot;
+        uint64_t usage, igbp_id;
+        if (!_UnwrapNativeCodec2GrallocMetadata(handle, &width, &height, &format, &usage,
+            &stride, &generation, &igbp_id, &igbp_slot)) return C2_BAD_VALUE;
+
+        native_handle_t* native_handle = UnwrapNativeCodec2GrallocHandle(handle);
+        if (!native_handle) return C2_BAD_VALUE;
+
+        buffer_handle_t gralloc_handle = nullptr;
+        int32_t gr1_err = MfxFakeGralloc::Get().Import(native_handle, &gralloc_handle);
+        native_handle_delete(native_handle);
+        if (GRALLOC1_ERROR_NONE != gr1_err) {
+            MFX_DEBUG_TRACE_I32(gr1_err);
+            return C2_BAD_VALUE;
+        }
+
+        // takes ownership of the handle as C2Allocator contract demands
+        *allocation = std::make_shared<FakeGraphicAllocation>(width, height, getId(),
+            gralloc_handle, handle);
+        return C2_OK;
+    }
+
+private:
+    std::shared_ptr<const Traits> m_traits;
+};
+
+} // namespace
+
+std::shared_ptr<C2Allocator> MfxFakeCreateC2GrallocAllocator()
+{
+    return std::make_shared<FakeC2GrallocAllocator>();
+}
@@ -0,0 +1,507 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_gralloc.h"
+#include "mfx_defs.h"
+#include "mfx_debug.h"
+
+#include <cutils/native_handle.h>
+#include <hardware/hardware.h>
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_gralloc"
+
+namespace {
+
+// Handle ints: magic, low and high halves of buffer id.
+const int kHandleMagic = 0x46474d42; // "FGMB"
+const int kHandleIntsCount = 3;
+
+const uint32_t kPitchAlignment = 128;
+// Chroma follows luma of 16 lines aligned height as MfxGrallocAllocator and VA mapping
+// of encoder surfaces expect, memory is enough for 32 lines alignment of decoder surfaces.
+const uint32_t kPlaneHeightAlignment = 16;
+const uint32_t kAllocHeightAlignment = 32;
+
+uint32_t Align(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool GetBufferId(buffer_handle_t handle, uint64_t* id)
+{
+    if (!handle || handle->numInts < kHandleIntsCount) return false;
+
+    const int* ints = handle->data + handle->numFds;
+    if (ints[0] != kHandleMagic) return false;
+
+    *id = (uint64_t)(uint32_t)ints[1] | ((uint64_t)(uint32_t)ints[2] << 32);
+    return true;
+}
+
+native_handle_t* CreateHandle(uint64_t id)
+{
+    native_handle_t* handle = native_handle_create(0, kHandleIntsCount);
+    if (handle) {
+        handle->data[0] = kHandleMagic;
+        handle->data[1] = (int)(uint32_t)id;
+        handle->data[2] = (int)(uint32_t)(id >> 32);
+    }
+    return handle;
+}
+
+// Fills planes layout of linear buffer with 128 bytes aligned pitch.
+bool InitLayout(MfxFakeGrallocBuffer* buffer)
+{
+    const uint32_t plane_height = Align(buffer->height, kPlaneHeightAlignment);
+    const uint32_t alloc_height = Align(buffer->height, kAllocHeightAlignment);
+
+    switch (buffer->format) {
+        case HAL_PIXEL_FORMAT_NV12:
+        case HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL:
+        case HAL_PIXEL_FORMAT_NV12_LINEAR_CAMERA_INTEL:
+        case HAL_PIXEL_FORMAT_P010_INTEL:
+        {
+            const uint32_t bytes = (HAL_PIXEL_FORMAT_P010_INTEL == buffer->format) ? 2 : 1;
+            buffer->planes_count = 2;
+            buffer->pitches[0] = buffer->pitches[1] = Align(buffer->width * bytes, kPitchAlignment);
+            buffer->offsets[1] = buffer->pitches[0] * plane_height;
+            buffer->size = buffer->pitches[0] * alloc_height * 3 / 2;
+            break;
+        }
+        case HAL_PIXEL_FORMAT_YV12:
+            buffer->planes_count = 3;
+            buffer->pitches[0] = Align(buffer->width, kPitchAlignment);
+            buffer->pitches[1] = buffer->pitches[2] = buffer->pitches[0] / 2;
+            buffer->offsets[1] = buffer->pitches[0] * plane_height;
+            buffer->offsets[2] = buffer->offsets[1] + buffer->pitches[1] * plane_height / 2;
+            buffer->size = buffer->pitches[0] * alloc_height * 3 / 2;
+            break;
+        case HAL_PIXEL_FORMAT_RGBA_8888:
+        case HAL_PIXEL_FORMAT_RGBX_8888:
+        case HAL_PIXEL_FORMAT_BGRA_8888:
+            buffer->planes_count = 1;
+            buffer->pitches[0] = Align(buffer->width * 4, kPitchAlignment);
+            buffer->size = buffer->pitches[0] * alloc_height;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+MfxFakeGralloc& MfxFakeGralloc::Get()
+{
+    static MfxFakeGralloc g_gralloc;
+    return g_gralloc;
+}
+
+std::shared_ptr<MfxFakeGrallocBuffer> MfxFakeGralloc::CreateBuffer(uint32_t width, uint32_t height,
+    int32_t format)
+{
+    if (!width || !height) return nullptr;
+
+    std::shared_ptr<MfxFakeGrallocBuffer> buffer = std::make_shared<MfxFakeGrallocBuffer>();
+    buffer->width = width;
+    buffer->height = height;
+    buffer->format = format;
+    if (!InitLayout(buffer.get())) return nullptr;
+
+    buffer->data.reset(new (std::nothrow)uint8_t[buffer->size]);
+    if (!buffer->data) return nullptr;
+
+    return buffer;
+}
+
+int32_t MfxFakeGralloc::Allocate(uint32_t width, uint32_t height, int32_t format, buffer_handle_t* handle)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!handle) return GRALLOC1_ERROR_BAD_VALUE;
+
+    std::shared_ptr<MfxFakeGrallocBuffer> buffer = CreateBuffer(width, height, format);
+    if (!buffer) return GRALLOC1_ERROR_UNSUPPORTED;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    buffer->id = m_nextId++;
+    native_handle_t* new_handle = CreateHandle(buffer->id);
+    if (!new_handle) return GRALLOC1_ERROR_NO_RESOURCES;
+
+    m_buffers[buffer->id] = buffer;
+    m_handles[new_handle] = buffer->id;
+    *handle = new_handle;
+
+    MFX_DEBUG_TRACE_P(*handle);
+    return GRALLOC1_ERROR_NONE;
+}
+
+int32_t MfxFakeGralloc::Import(buffer_handle_t raw_handle, buffer_handle_t* handle)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    uint64_t id = 0;
+    if (!handle || !GetBufferId(raw_handle, &id)) return GRALLOC1_ERROR_BAD_HANDLE;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_buffers.find(id) == m_buffers.end()) return GRALLOC1_ERROR_BAD_HANDLE;
+
+    native_handle_t* new_handle = CreateHandle(id);
+    if (!new_handle) return GRALLOC1_ERROR_NO_RESOURCES;
+
+    m_handles[new_handle] = id;
+    *handle = new_handle;
+    return GRALLOC1_ERROR_NONE;
+}
+
+int32_t MfxFakeGralloc::Release(buffer_handle_t handle)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_DEBUG_TRACE_P(handle);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_handles.find(handle);
+    if (found == m_handles.end()) return GRALLOC1_ERROR_BAD_HANDLE;
+
+    uint64_t id = found->second;
+    m_handles.erase(found);
+    native_handle_delete(const_cast<native_handle_t*>(handle));
+
+    bool id_referenced = std::any_of(m_handles.begin(), m_handles.end(),
+        [id] (const auto& item) { return item.second == id; });
+    if (!id_referenced) m_buffers.erase(id);
+
+    return GRALLOC1_ERROR_NONE;
+}
+
+std::shared_ptr<MfxFakeGrallocBuffer> MfxFakeGralloc::Find(buffer_handle_t handle)
+{
+    uint64_t id = 0;
+    if (!GetBufferId(handle, &id)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_buffers.find(id);
+    return (found != m_buffers.end()) ? found->second : nullptr;
+}
+
+size_t MfxFakeGralloc::GetHandleCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_handles.size();
+}
+
+namespace {
+
+struct BufferDescriptor
+{
+    uint32_t width { 0 };
+    uint32_t height { 0 };
+    int32_t format { 0 };
+};
+
+struct FakeGralloc1Device : public gralloc1_device_t
+{
+    std::mutex mutex;
+    gralloc1_buffer_descriptor_t next_descriptor { 1 };
+    std::map<gralloc1_buffer_descriptor_t, BufferDescriptor> descriptors;
+};
+
+FakeGralloc1Device* ToFakeDevice(gralloc1_device_t* device)
+{
+    return static_cast<FakeGralloc1Device*>(device);
+}
+
+int32_t CreateDescriptor(gralloc1_device_t* device, gralloc1_buffer_descriptor_t* descriptor)
+{
+    if (!descriptor) return GRALLOC1_ERROR_BAD_VALUE;
+
+    FakeGralloc1Device* fake = ToFakeDevice(device);
+    std::lock_guard<std::mutex> lock(fake->mutex);
+    *descriptor = fake->next_descriptor++;
+    fake->descriptors[*descriptor] = BufferDescriptor {};
+    return GRALLOC1_ERROR_NONE;
+}
+
+int32_t DestroyDescriptor(gralloc1_device_t* device, gralloc1_buffer_descriptor_t descriptor)
+{
+    FakeGralloc1Device* fake = ToFakeDevice(device);
+    std::lock_guard<std::mutex> lock(fake->mutex);
+    return fake->descriptors.erase(descriptor) ? GRALLOC1_ERROR_NONE : GRALLOC1_ERROR_BAD_DESCRIPTOR;
+}
+
+// Calls func on descriptor found under device lock.
+template<typename Func>
+int32_t ModifyDescriptor(gralloc1_device_t* device, gralloc1_buffer_descriptor_t descriptor, Func func)
+{
+    FakeGralloc1Device* fake = ToFakeDevice(device);
+    std::lock_guard<std::mutex> lock(fake->mutex);
+    auto found = fake->descriptors.find(descriptor);
+    if (found == fake->descriptors.end()) return GRALLOC1_ERROR_BAD_DESCRIPTOR;
+    func(found->second);
+    return GRALLOC1_ERROR_NONE;
+}
+
+int32_t SetUsage(gralloc1_device_t* device, gralloc1_buffer_descriptor_t descriptor, uint64_t)
+{
+    // memory is the same for all usages
+    return ModifyDescriptor(device, descriptor, [] (BufferDescriptor&) {});
+}
+
+int32_t SetDimensions(gralloc1_device_t* device, gralloc1_buffer_descriptor_t descriptor,
+    uint32_t width, uint32_t height)
+{
+    return ModifyDescriptor(device, descriptor, [=] (BufferDescriptor& desc) {
+        desc.width = width;
+        desc.height = height;
+    });
+}
+
+int32_t SetFormat(gralloc1_device_t* device, gralloc1_buffer_descriptor_t descriptor, int32_t format)
+{
+    return ModifyDescriptor(device, descriptor, [=] (BufferDescriptor& desc) { desc.format = format; });
+}
+
+int32_t Allocate(gralloc1_device_t* device, uint32_t descriptors_count,
+    const gralloc1_buffer_descriptor_t* descriptors, buffer_handle_t* buffers)
+{
+    if (!descriptors || !buffers) return GRALLOC1_ERROR_BAD_VALUE;
+
+    int32_t res = GRALLOC1_ERROR_NONE;
+    uint32_t allocated = 0;
+
+    for (; allocated < descriptors_count; ++allocated) {
+        BufferDescriptor desc;
+        res = ModifyDescriptor(device, descriptors[allocated],
+            [&desc] (BufferDescriptor& found) { desc = found; });
+        if (GRALLOC1_ERROR_NONE != res) break;
+
+        res = MfxFakeGralloc::Get().Allocate(desc.width, desc.height, desc.format, &buffers[allocated]);
+        if (GRALLOC1_ERROR_NONE != res) break;
+    }
+
+    if (GRALLOC1_ERROR_NONE != res) {
+        for (uint32_t i = 0; i < allocated; ++i) {
+            MfxFakeGralloc::Get().Release(buffers[i]);
+            buffers[i] = nullptr;
+        }
+    }
+    return res;
+}
+
+int32_t Release(gralloc1_device_t*, buffer_handle_t buffer)
+{
+    return MfxFakeGralloc::Get().Release(buffer);
+}
+
+int32_t ImportBuffer(gralloc1_device_t*, const buffer_handle_t raw_handle, buffer_handle_t* buffer)
+{
+    return MfxFakeGralloc::Get().Import(raw_handle, buffer);
+}
+
+// Calls func on buffer of the handle, the buffer is kept alive during the call.
+template<typename Func>
+int32_t QueryBuffer(buffer_handle_t handle, Func func)
+{
+    std::shared_ptr<MfxFakeGrallocBuffer> buffer = MfxFakeGralloc::Get().Find(handle);
+    if (!buffer) return GRALLOC1_ERROR_BAD_HANDLE;
+    return func(*buffer);
+}
+
+int32_t GetBackingStore(gralloc1_device_t*, buffer_handle_t handle, gralloc1_backing_store_t* store)
+{
+    if (!store) return GRALLOC1_ERROR_BAD_VALUE;
+    return QueryBuffer(handle, [store] (const MfxFakeGrallocBuffer& buffer) {
+        *store = buffer.id;
+        return GRALLOC1_ERROR_NONE;
+    });
+}
+
+int32_t GetFormat(gralloc1_device_t*, buffer_handle_t handle, int32_t* format)
+{
+    if (!format) return GRALLOC1_ERROR_BAD_VALUE;
+    return QueryBuffer(handle, [format] (const MfxFakeGrallocBuffer& buffer) {
+        *format = buffer.format;
+        return GRALLOC1_ERROR_NONE;
+    });
+}
+
+int32_t GetDimensions(gralloc1_device_t*, buffer_handle_t handle, uint32_t* width, uint32_t* height)
+{
+    if (!width || !height) return GRALLOC1_ERROR_BAD_VALUE;
+    return QueryBuffer(handle, [=] (const MfxFakeGrallocBuffer& buffer) {
+        *width = buffer.width;
+        *height = buffer.height;
+        return GRALLOC1_ERROR_NONE;
+    });
+}
+
+int32_t GetNumFlexPlanes(gralloc1_device_t*, buffer_handle_t handle, uint32_t* planes_count)
+{
+    if (!planes_count) return GRALLOC1_ERROR_BAD_VALUE;
+    return QueryBuffer(handle, [planes_count] (const MfxFakeGrallocBuffer& buffer) {
+        *planes_count = buffer.planes_count;
+        return GRALLOC1_ERROR_NONE;
+    });
+}
+
+int32_t GetByteStride(gralloc1_device_t*, buffer_handle_t handle, uint32_t* pitches, uint32_t size)
+{
+    if (!pitches) return GRALLOC1_ERROR_BAD_VALUE;
+    return QueryBuffer(handle, [=] (const MfxFakeGrallocBuffer& buffer) {
+        if (size < buffer.planes_count) return GRALLOC1_ERROR_BAD_VALUE;
+        std::copy(buffer.pitches, buffer.pitches + buffer.planes_count, pitches);
+        return GRALLOC1_ERROR_NONE;
+    });
+}
+
+int32_t Lock(gralloc1_device_t*, buffer_handle_t handle, uint64_t, uint64_t,
+    const gralloc1_rect_t*, void** data, int32_t)
+{
+    if (!data) return GRALLOC1_ERROR_BAD_VALUE;
+    return QueryBuffer(handle, [data] (const MfxFakeGrallocBuffer& buffer) {
+        // the memory is always CPU visible, locking just exposes it
+        *data = buffer.data.get();
+        return GRALLOC1_ERROR_NONE;
+    });
+}
+
+int32_t Unlock(gralloc1_device_t*, buffer_handle_t handle, int32_t* release_fence)
+{
+    if (release_fence) *release_fence = -1;
+    return QueryBuffer(handle, [] (const MfxFakeGrallocBuffer&) { return GRALLOC1_ERROR_NONE; });
+}
+
+template<typename FuncType>
+gralloc1_function_pointer_t ToFunctionPointer(FuncType func)
+{
+    return reinterpret_cast<gralloc1_function_pointer_t>(func);
+}
+
+gralloc1_function_pointer_t GetFunction(gralloc1_device_t*, int32_t descriptor)
+{
+    // Assignments to PFN types check the fakes match gralloc1 prototypes.
+    switch (descriptor) {
+        case GRALLOC1_FUNCTION_CREATE_DESCRIPTOR:
+            { GRALLOC1_PFN_CREATE_DESCRIPTOR func = CreateDescriptor; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_DESTROY_DESCRIPTOR:
+            { GRALLOC1_PFN_DESTROY_DESCRIPTOR func = DestroyDescriptor; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_SET_CONSUMER_USAGE:
+            { GRALLOC1_PFN_SET_CONSUMER_USAGE func = SetUsage; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_SET_PRODUCER_USAGE:
+            { GRALLOC1_PFN_SET_PRODUCER_USAGE func = SetUsage; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_SET_DIMENSIONS:
+            { GRALLOC1_PFN_SET_DIMENSIONS func = SetDimensions; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_SET_FORMAT:
+            { GRALLOC1_PFN_SET_FORMAT func = SetFormat; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_ALLOCATE:
+            { GRALLOC1_PFN_ALLOCATE func = Allocate; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_RELEASE:
+            { GRALLOC1_PFN_RELEASE func = Release; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_IMPORT_BUFFER:
+            { GRALLOC1_PFN_IMPORT_BUFFER func = ImportBuffer; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_GET_BACKING_STORE:
+            { GRALLOC1_PFN_GET_BACKING_STORE func = GetBackingStore; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_GET_FORMAT:
+            { GRALLOC1_PFN_GET_FORMAT func = GetFormat; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_GET_DIMENSIONS:
+            { GRALLOC1_PFN_GET_DIMENSIONS func = GetDimensions; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_GET_NUM_FLEX_PLANES:
+            { GRALLOC1_PFN_GET_NUM_FLEX_PLANES func = GetNumFlexPlanes; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_GET_BYTE_STRIDE:
+            { GRALLOC1_PFN_GET_BYTE_STRIDE func = GetByteStride; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_LOCK:
+            { GRALLOC1_PFN_LOCK func = Lock; return ToFunctionPointer(func); }
+        case GRALLOC1_FUNCTION_UNLOCK:
+            { GRALLOC1_PFN_UNLOCK func = Unlock; return ToFunctionPointer(func); }
+        default:
+            // GET_PRIME is not provided: there are no dma-buf fds behind the buffers,
+            // so MfxGrallocModule falls back to passing gralloc handles to VA.
+            return nullptr;
+    }
+}
+
+void GetCapabilities(gralloc1_device_t*, uint32_t* count, int32_t*)
+{
+    if (count) *count = 0;
+}
+
+int CloseDevice(hw_device_t* device)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    delete ToFakeDevice(reinterpret_cast<gralloc1_device_t*>(device));
+    return 0;
+}
+
+int OpenDevice(const hw_module_t* module, const char* id, hw_device_t** device)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!device || !id || strcmp(id, GRALLOC_HARDWARE_MODULE_ID)) return -EINVAL;
+
+    FakeGralloc1Device* fake = new (std::nothrow)FakeGralloc1Device();
+    if (!fake) return -ENOMEM;
+
+    fake->common.tag = HARDWARE_DEVICE_TAG;
+    fake->common.version = HARDWARE_DEVICE_API_VERSION(1, 0);
+    fake->common.module = const_cast<hw_module_t*>(module);
+    fake->common.close = CloseDevice;
+    fake->getCapabilities = GetCapabilities;
+    fake->getFunction = GetFunction;
+
+    // common is the first member of gralloc1_device_t, as gralloc1_open expects
+    *device = &fake->common;
+    return 0;
+}
+
+hw_module_methods_t g_module_methods = {
+    .open = OpenDevice,
+};
+
+hw_module_t g_module = {
+    .tag = HARDWARE_MODULE_TAG,
+    .module_api_version = HARDWARE_MODULE_API_VERSION(1, 0),
+    .hal_api_version = HARDWARE_HAL_API_VERSION,
+    .id = GRALLOC_HARDWARE_MODULE_ID,
+    .name = "Fake gralloc1 of MediaSDK C2",
+    .author = "Intel Corporation",
+    .methods = &g_module_methods,
+};
+
+} // namespace
+
+// Replaces libhardware one, only gralloc module is available.
+int hw_get_module(const char* id, const hw_module_t** module)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!id || !module) return -EINVAL;
+    if (strcmp(id, GRALLOC_HARDWARE_MODULE_ID)) return -ENOENT;
+
+    *module = &g_module;
+    return 0;
+}
@@ -0,0 +1,470 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_fake_va_gralloc.h"
+#include "mfx_fake_gralloc.h"
+#include "mfx_defs.h"
+#include "mfx_debug.h"
+
+#include <va/va.h>
+#include <va/va_android.h>
+#include <va/va_drmcommon.h>
+
+#include <set>
+
+#undef MFX_DEBUG_MODULE_NAME
+#define MFX_DEBUG_MODULE_NAME "mfx_fake_va"
+
+namespace {
+
+struct Surface
+{
+    uint32_t width { 0 };
+    uint32_t height { 0 };
+    uint32_t fourcc { 0 };
+    uint32_t planes_count { 0 };
+    uint32_t pitches[3] {};
+    uint32_t offsets[3] {};
+    size_t size { 0 };
+    // own memory or memory of the gralloc buffer the surface is created from
+    std::shared_ptr<MfxFakeGrallocBuffer> memory;
+};
+
+struct Buffer
+{
+    VABufferType type { VABufferTypeMax };
+    std::unique_ptr<uint8_t[]> own_data;
+    // keeps memory of the derived image alive
+    std::shared_ptr<Surface> surface;
+    uint8_t* data { nullptr };
+    VACodedBufferSegment coded_segment {};
+};
+
+// All objects are kept in the single display returned by every vaGetDisplay call.
+class FakeVaDisplay
+{
+public:
+    std::mutex m_mutex;
+    uint32_t m_nextId { 1 };
+
+    std::map<VASurfaceID, std::shared_ptr<Surface>> m_surfaces;
+    std::map<VABufferID, std::unique_ptr<Buffer>> m_buffers;
+    std::map<VAImageID, VABufferID> m_images;
+    std::set<VAConfigID> m_configs;
+    std::set<VAContextID> m_contexts;
+
+    uint32_t NewId() { return m_nextId++; }
+};
+
+FakeVaDisplay g_display;
+
+FakeVaDisplay* ToFakeDisplay(VADisplay dpy)
+{
+    return (dpy == &g_display) ? &g_display : nullptr;
+}
+
+int32_t VaFourccToGralloc(uint32_t fourcc)
+{
+    switch (fourcc) {
+        case VA_FOURCC_NV12: return HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL;
+        case VA_FOURCC_P010: return HAL_PIXEL_FORMAT_P010_INTEL;
+        case VA_FOURCC_YV12: return HAL_PIXEL_FORMAT_YV12;
+        case VA_FOURCC_RGBA: return HAL_PIXEL_FORMAT_RGBA_8888;
+        case VA_FOURCC_RGBX: return HAL_PIXEL_FORMAT_RGBX_8888;
+        case VA_FOURCC_BGRA: return HAL_PIXEL_FORMAT_BGRA_8888;
+        default: return 0;
+    }
+}
+
+uint32_t RtFormatToVaFourcc(unsigned int rt_format)
+{
+    switch (rt_format) {
+        case VA_RT_FORMAT_YUV420: return VA_FOURCC_NV12;
+        case VA_RT_FORMAT_YUV420_10: return VA_FOURCC_P010;
+        case VA_RT_FORMAT_RGB32: return VA_FOURCC_BGRA;
+        default: return 0;
+    }
+}
+
+uint32_t GetBitsPerPixel(uint32_t fourcc)
+{
+    switch (fourcc) {
+        case VA_FOURCC_NV12:
+        case VA_FOURCC_YV12:
+            return 12;
+        case VA_FOURCC_P010:
+            return 24;
+        default:
+            return 32;
+    }
+}
+
+VAStatus CreateOwnSurface(unsigned int rt_format, uint32_t fourcc,
+    unsigned int width, unsigned int height, std::shared_ptr<Surface>* surface)
+{
+    if (!fourcc) fourcc = RtFormatToVaFourcc(rt_format);
+    if (!fourcc) return VA_STATUS_ERROR_UNSUPPORTED_RT_FORMAT;
+
+    int32_t format = VaFourccToGralloc(fourcc);
+    if (!format) return VA_STATUS_ERROR_INVALID_IMAGE_FORMAT;
+
+    std::shared_ptr<MfxFakeGrallocBuffer> memory = MfxFakeGralloc::CreateBuffer(width, height, format);
+    if (!memory) return VA_STATUS_ERROR_ALLOCATION_FAILED;
+
+    auto new_surface = std::make_shared<Surface>();
+    new_surface->width = width;
+    new_surface->height = height;
+    new_surface->fourcc = fourcc;
+    new_surface->planes_count = memory->planes_count;
+    std::copy(memory->pitches, memory->pitches + memory->planes_count, new_surface->pitches);
+    std::copy(memory->offsets, memory->offsets + memory->planes_count, new_surface->offsets);
+    new_surface->size = memory->size;
+    new_surface->memory = std::move(memory);
+
+    *surface = std::move(new_surface);
+    return VA_STATUS_SUCCESS;
+}
+
+// Wraps memory of the gralloc buffer with the layout described by external buffer descriptor,
+// the way the driver does for VA_SURFACE_ATTRIB_MEM_TYPE_ANDROID_GRALLOC.
+VAStatus CreateGrallocSurface(const VASurfaceAttribExternalBuffers& ext, unsigned int index,
+    unsigned int width, unsigned int height, std::shared_ptr<Surface>* surface)
+{
+    if (!ext.buffers || index >= ext.num_buffers) return VA_STATUS_ERROR_INVALID_PARAMETER;
+    if (!ext.num_planes || ext.num_planes > 3) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    buffer_handle_t handle = reinterpret_cast<buffer_handle_t>(ext.buffers[index]);
+    std::shared_ptr<MfxFakeGrallocBuffer> memory = MfxFakeGralloc::Get().Find(handle);
+    if (!memory) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    // descriptor must not address memory out of the buffer
+    if (ext.data_size > memory->size) return VA_STATUS_ERROR_INVALID_PARAMETER;
+    for (uint32_t i = 0; i < ext.num_planes; ++i) {
+        if (ext.offsets[i] >= memory->size) return VA_STATUS_ERROR_INVALID_PARAMETER;
+    }
+
+    auto new_surface = std::make_shared<Surface>();
+    new_surface->width = width;
+    new_surface->height = height;
+    new_surface->fourcc = ext.pixel_format;
+    new_surface->planes_count = ext.num_planes;
+    std::copy(ext.pitches, ext.pitches + ext.num_planes, new_surface->pitches);
+    std::copy(ext.offsets, ext.offsets + ext.num_planes, new_surface->offsets);
+    new_surface->size = memory->size;
+    new_surface->memory = std::move(memory);
+
+    *surface = std::move(new_surface);
+    return VA_STATUS_SUCCESS;
+}
+
+} // namespace
+
+MfxFakeVaGrallocStats MfxFakeVaGrallocGetStats()
+{
+    MfxFakeVaGrallocStats stats;
+    stats.gralloc_handles = MfxFakeGralloc::Get().GetHandleCount();
+
+    std::lock_guard<std::mutex> lock(g_display.m_mutex);
+    stats.va_surfaces = g_display.m_surfaces.size();
+    stats.va_buffers = g_display.m_buffers.size();
+    stats.va_images = g_display.m_images.size();
+    return stats;
+}
+
+VADisplay vaGetDisplay(void*)
+{
+    return &g_display;
+}
+
+VAStatus vaInitialize(VADisplay dpy, int* major_version, int* minor_version)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    if (!ToFakeDisplay(dpy)) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (major_version) *major_version = VA_MAJOR_VERSION;
+    if (minor_version) *minor_version = VA_MINOR_VERSION;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaTerminate(VADisplay dpy)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    // Objects are kept, the display is shared by all vaGetDisplay callers.
+    return ToFakeDisplay(dpy) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_DISPLAY;
+}
+
+const char* vaQueryVendorString(VADisplay)
+{
+    return "Fake VA driver of MediaSDK C2";
+}
+
+VAStatus vaCreateConfig(VADisplay dpy, VAProfile, VAEntrypoint, VAConfigAttrib*, int, VAConfigID* config_id)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!config_id) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    *config_id = display->NewId();
+    display->m_configs.insert(*config_id);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyConfig(VADisplay dpy, VAConfigID config_id)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    return display->m_configs.erase(config_id) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_CONFIG;
+}
+
+VAStatus vaCreateContext(VADisplay dpy, VAConfigID config_id, int, int, int,
+    VASurfaceID*, int, VAContextID* context)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!context) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    if (display->m_configs.find(config_id) == display->m_configs.end()) return VA_STATUS_ERROR_INVALID_CONFIG;
+
+    *context = display->NewId();
+    display->m_contexts.insert(*context);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyContext(VADisplay dpy, VAContextID context)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    return display->m_contexts.erase(context) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_CONTEXT;
+}
+
+VAStatus vaCreateSurfaces(VADisplay dpy, unsigned int format, unsigned int width, unsigned int height,
+    VASurfaceID* surfaces, unsigned int num_surfaces, VASurfaceAttrib* attrib_list, unsigned int num_attribs)
+{
+    MFX_DEBUG_TRACE_FUNC;
+    MFX_DEBUG_TRACE_U32(format);
+    MFX_DEBUG_TRACE_U32(width);
+    MFX_DEBUG_TRACE_U32(height);
+    MFX_DEBUG_TRACE_U32(num_surfaces);
+
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!surfaces || !num_surfaces || !width || !height) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    uint32_t fourcc = 0;
+    uint32_t memory_type = VA_SURFACE_ATTRIB_MEM_TYPE_VA;
+    const VASurfaceAttribExternalBuffers* ext = nullptr;
+
+    for (unsigned int i = 0; attrib_list && i < num_attribs; ++i) {
+        const VASurfaceAttrib& attrib = attrib_list[i];
+        if (!(attrib.flags & VA_SURFACE_ATTRIB_SETTABLE)) continue;
+
+        switch (attrib.type) {
+            case VASurfaceAttribPixelFormat:
+                fourcc = attrib.value.value.i;
+                break;
+            case VASurfaceAttribMemoryType:
+                memory_type = attrib.value.value.i;
+                break;
+            case VASurfaceAttribExternalBufferDescriptor:
+                ext = static_cast<const VASurfaceAttribExternalBuffers*>(attrib.value.value.p);
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::vector<std::shared_ptr<Surface>> new_surfaces(num_surfaces);
+    VAStatus va_res = VA_STATUS_SUCCESS;
+
+    for (unsigned int i = 0; i < num_surfaces && VA_STATUS_SUCCESS == va_res; ++i) {
+        switch (memory_type) {
+            case VA_SURFACE_ATTRIB_MEM_TYPE_VA:
+                va_res = CreateOwnSurface(format, fourcc, width, height, &new_surfaces[i]);
+                break;
+            case VA_SURFACE_ATTRIB_MEM_TYPE_ANDROID_GRALLOC:
+                va_res = ext ? CreateGrallocSurface(*ext, i, width, height, &new_surfaces[i]) :
+                    VA_STATUS_ERROR_INVALID_PARAMETER;
+                break;
+            default:
+                // no dma-buf behind fake gralloc buffers, so PRIME import is never expected
+                va_res = VA_STATUS_ERROR_UNSUPPORTED_MEMORY_TYPE;
+                break;
+        }
+    }
+
+    if (VA_STATUS_SUCCESS == va_res) {
+        std::lock_guard<std::mutex> lock(display->m_mutex);
+        for (unsigned int i = 0; i < num_surfaces; ++i) {
+            surfaces[i] = display->NewId();
+            display->m_surfaces[surfaces[i]] = std::move(new_surfaces[i]);
+        }
+    }
+
+    MFX_DEBUG_TRACE_I32(va_res);
+    return va_res;
+}
+
+VAStatus vaDestroySurfaces(VADisplay dpy, VASurfaceID* surfaces, int num_surfaces)
+{
+    MFX_DEBUG_TRACE_FUNC;
+
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!surfaces) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    VAStatus va_res = VA_STATUS_SUCCESS;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    for (int i = 0; i < num_surfaces; ++i) {
+        if (!display->m_surfaces.erase(surfaces[i])) va_res = VA_STATUS_ERROR_INVALID_SURFACE;
+    }
+    return va_res;
+}
+
+VAStatus vaSyncSurface(VADisplay dpy, VASurfaceID render_target)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    // nothing is executed on surfaces, they are always ready
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    return (display->m_surfaces.find(render_target) != display->m_surfaces.end()) ?
+        VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_SURFACE;
+}
+
+VAStatus vaCreateBuffer(VADisplay dpy, VAContextID context, VABufferType type,
+    unsigned int size, unsigned int num_elements, void* data, VABufferID* buf_id)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!buf_id || !size || !num_elements) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    size_t total_size = (size_t)size * num_elements;
+
+    std::unique_ptr<Buffer> buffer = std::make_unique<Buffer>();
+    buffer->type = type;
+    buffer->own_data.reset(new (std::nothrow)uint8_t[total_size]);
+    if (!buffer->own_data) return VA_STATUS_ERROR_ALLOCATION_FAILED;
+    buffer->data = buffer->own_data.get();
+
+    if (VAEncCodedBufferType == type) {
+        // mapped coded buffer is a segment list, encoded data size is 0 until encoding happens
+        buffer->coded_segment.buf = buffer->data;
+    } else if (data) {
+        std::copy((const uint8_t*)data, (const uint8_t*)data + total_size, buffer->data);
+    }
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    if (display->m_contexts.find(context) == display->m_contexts.end()) return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    *buf_id = display->NewId();
+    display->m_buffers[*buf_id] = std::move(buffer);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyBuffer(VADisplay dpy, VABufferID buffer_id)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    return display->m_buffers.erase(buffer_id) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_BUFFER;
+}
+
+VAStatus vaMapBuffer(VADisplay dpy, VABufferID buf_id, void** pbuf)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!pbuf) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    auto found = display->m_buffers.find(buf_id);
+    if (found == display->m_buffers.end()) return VA_STATUS_ERROR_INVALID_BUFFER;
+
+    Buffer* buffer = found->second.get();
+    *pbuf = (VAEncCodedBufferType == buffer->type) ? (void*)&buffer->coded_segment : (void*)buffer->data;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaUnmapBuffer(VADisplay dpy, VABufferID buf_id)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    return (display->m_buffers.find(buf_id) != display->m_buffers.end()) ?
+        VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_BUFFER;
+}
+
+VAStatus vaDeriveImage(VADisplay dpy, VASurfaceID surface_id, VAImage* image)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!image) return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    auto found = display->m_surfaces.find(surface_id);
+    if (found == display->m_surfaces.end()) return VA_STATUS_ERROR_INVALID_SURFACE;
+
+    const std::shared_ptr<Surface>& surface = found->second;
+
+    // derived image maps surface memory directly, no copies
+    std::unique_ptr<Buffer> buffer = std::make_unique<Buffer>();
+    buffer->type = VAImageBufferType;
+    buffer->surface = surface;
+    buffer->data = surface->memory->data.get();
+
+    *image = VAImage {};
+    image->image_id = display->NewId();
+    image->buf = display->NewId();
+    image->format.fourcc = surface->fourcc;
+    image->format.byte_order = VA_LSB_FIRST;
+    image->format.bits_per_pixel = GetBitsPerPixel(surface->fourcc);
+    image->width = surface->width;
+    image->height = surface->height;
+    image->data_size = surface->size;
+    image->num_planes = surface->planes_count;
+    std::copy(surface->pitches, surface->pitches + surface->planes_count, image->pitches);
+    std::copy(surface->offsets, surface->offsets + surface->planes_count, image->offsets);
+
+    display->m_buffers[image->buf] = std::move(buffer);
+    display->m_images[image->image_id] = image->buf;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyImage(VADisplay dpy, VAImageID image)
+{
+    FakeVaDisplay* display = ToFakeDisplay(dpy);
+    if (!display) return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> lock(display->m_mutex);
+    auto found = display->m_images.find(image);
+    if (found == display->m_images.end()) return VA_STATUS_ERROR_INVALID_IMAGE;
+
+    display->m_buffers.erase(found->second);
+    display->m_images.erase(found);
+    return VA_STATUS_SUCCESS;
+}
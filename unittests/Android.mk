@@ -79,6 +79,7 @@ LOCAL_SRC_FILES := \
     $(STREAM_CPP_FILES:$(LOCAL_PATH)/%=%) \
     src/c2_decoder_test.cpp \
     src/c2_encoder_test.cpp \
+    src/c2_vpp_test.cpp \
     src/test_components.cpp \
     src/test_streams.cpp \
     src/test_main.cpp
@@ -117,6 +118,205 @@ include $(BUILD_EXECUTABLE)
 
 # =============================================================================
 
+include $(CLEAR_VARS)
+include $(MFX_C2_HOME)/mfx_c2_defs.mk
+
+STREAM_CPP_FILES := $(wildcard $(LOCAL_PATH)/streams/*/*.cpp)
+
+LOCAL_SRC_FILES := \
+    $(STREAM_CPP_FILES:$(LOCAL_PATH)/%=%) \
+    src/c2_bitstream_benchmark.cpp \
+    src/c2_pure_utils_benchmark.cpp \
+    src/c2_utils_benchmark.cpp \
+    src/test_benchmark.cpp
+
+LOCAL_C_INCLUDES := \
+    $(MFX_C2_INCLUDES) \
+    $(MFX_C2_HOME)/unittests/include \
+    $(MFX_C2_HOME)/c2_utils/include
+
+LOCAL_CFLAGS := $(MFX_C2_CFLAGS)
+
+LOCAL_LDFLAGS := $(MFX_C2_EXE_LDFLAGS)
+
+LOCAL_STATIC_LIBRARIES := libgtest_main libgtest libmfx_c2_utils
+LOCAL_SHARED_LIBRARIES := \
+    libdl \
+    liblog \
+    libcutils \
+    $(MFX_C2_SHARED_LIBS)
+
+LOCAL_HEADER_LIBRARIES := $(MFX_C2_HEADER_LIBRARIES)
+
+LOCAL_MULTILIB := both
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := mfx_c2_benchmarks
+LOCAL_MODULE_STEM_32 := mfx_c2_benchmarks32
+LOCAL_MODULE_STEM_64 := mfx_c2_benchmarks64
+
+include $(BUILD_EXECUTABLE)
+
+# =============================================================================
+
+# Benchmarks of c2_utils parts without device dependencies, run on the build machine:
+# flat index map, metrics, scene change detection and plane copy.
+# Sources are built in directly as libmfx_c2_utils is built for device only.
+include $(CLEAR_VARS)
+include $(MFX_C2_HOME)/mfx_c2_defs.mk
+
+LOCAL_PROPRIETARY_MODULE := false
+
+LOCAL_SRC_FILES := \
+    ../c2_utils/src/mfx_c2_copy_planes.cpp \
+    ../c2_utils/src/mfx_c2_metrics.cpp \
+    ../c2_utils/src/mfx_c2_scene_change.cpp \
+    src/c2_pure_utils_benchmark.cpp \
+    src/test_benchmark.cpp
+
+LOCAL_C_INCLUDES := \
+    $(MFX_C2_INCLUDES) \
+    $(MFX_C2_HOME)/unittests/include \
+    $(MFX_C2_HOME)/c2_utils/include
+
+LOCAL_CFLAGS := $(MFX_C2_CFLAGS)
+
+LOCAL_STATIC_LIBRARIES := libgtest_main_host libgtest_host
+
+LOCAL_HEADER_LIBRARIES := $(MFX_C2_HEADER_LIBRARIES)
+
+LOCAL_MODULE_HOST_OS := linux
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := mfx_c2_benchmarks_host
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# =============================================================================
+
+include $(CLEAR_VARS)
+include $(MFX_C2_HOME)/mfx_c2_defs.mk
+
+LOCAL_SRC_FILES := \
+    src/c2_performance_tool.cpp \
+    src/test_performance_backends.cpp
+
+LOCAL_C_INCLUDES := \
+    $(MFX_C2_INCLUDES) \
+    $(MFX_C2_HOME)/c2_components/include \
+    $(MFX_C2_HOME)/unittests/include \
+    $(MFX_C2_HOME)/c2_utils/include
+
+LOCAL_CFLAGS := $(MFX_C2_CFLAGS)
+
+LOCAL_LDFLAGS := $(MFX_C2_EXE_LDFLAGS)
+
+# Components are loaded at runtime from the module of selected backend.
+LOCAL_STATIC_LIBRARIES := libmfx_c2_utils
+LOCAL_SHARED_LIBRARIES := \
+    libdl \
+    liblog \
+    libcutils \
+    $(MFX_C2_SHARED_LIBS)
+
+LOCAL_HEADER_LIBRARIES := $(MFX_C2_HEADER_LIBRARIES)
+
+LOCAL_MULTILIB := both
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := mfx_c2_performance
+LOCAL_MODULE_STEM_32 := mfx_c2_performance32
+LOCAL_MODULE_STEM_64 := mfx_c2_performance64
+
+include $(BUILD_EXECUTABLE)
+
+# =============================================================================
+
+ifeq ($(MFX_C2_IMPL_FAKE),true)
+
+include $(CLEAR_VARS)
+include $(MFX_C2_HOME)/mfx_c2_defs.mk
+
+STREAM_CPP_FILES := $(wildcard $(LOCAL_PATH)/streams/*/*.cpp)
+
+LOCAL_SRC_FILES := \
+    $(STREAM_CPP_FILES:$(LOCAL_PATH)/%=%) \
+    src/mfx_fake_runtime_test.cpp \
+    src/test_streams.cpp
+
+LOCAL_C_INCLUDES := \
+    $(MFX_C2_INCLUDES) \
+    $(MFX_C2_HOME)/mock/mfx_runtime/include \
+    $(MFX_C2_HOME)/unittests/include \
+    $(MFX_C2_HOME)/c2_utils/include
+
+LOCAL_CFLAGS := $(MFX_C2_CFLAGS)
+
+LOCAL_LDFLAGS := $(MFX_C2_EXE_LDFLAGS)
+
+LOCAL_STATIC_LIBRARIES := libgtest_main libgtest libmfx_c2_utils
+LOCAL_SHARED_LIBRARIES := \
+    libdl \
+    liblog \
+    libcutils \
+    libmfx_fake_runtime \
+    $(filter-out libvpl, $(MFX_C2_SHARED_LIBS))
+
+LOCAL_HEADER_LIBRARIES := $(MFX_C2_HEADER_LIBRARIES)
+
+LOCAL_MULTILIB := both
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := mfx_c2_fake_runtime_unittests
+LOCAL_MODULE_STEM_32 := mfx_c2_fake_runtime_unittests32
+LOCAL_MODULE_STEM_64 := mfx_c2_fake_runtime_unittests64
+
+include $(BUILD_EXECUTABLE)
+
+# Allocator tests and benchmarks, libva and gralloc are replaced with plain memory fakes.
+include $(CLEAR_VARS)
+include $(MFX_C2_HOME)/mfx_c2_defs.mk
+
+LOCAL_SRC_FILES := \
+    src/c2_allocator_benchmark.cpp \
+    src/mfx_fake_va_gralloc_test.cpp \
+    src/test_benchmark.cpp
+
+LOCAL_C_INCLUDES := \
+    $(MFX_C2_INCLUDES) \
+    $(MFX_C2_INCLUDES_LIBVA) \
+    frameworks/av/media/codec2/vndk/include \
+    $(MFX_C2_HOME)/mock/va_gralloc/include \
+    $(MFX_C2_HOME)/plugin_store/include \
+    $(MFX_C2_HOME)/unittests/include \
+    $(MFX_C2_HOME)/c2_utils/include
+
+LOCAL_CFLAGS := $(MFX_C2_CFLAGS) $(MFX_C2_CFLAGS_LIBVA)
+
+LOCAL_LDFLAGS := $(MFX_C2_EXE_LDFLAGS)
+
+# libmfx_fake_va_gralloc goes instead of libva, libva-android and libhardware,
+# it is listed first to take precedence over libhardware loaded by the plugin store.
+LOCAL_STATIC_LIBRARIES := libgtest_main libgtest libmfx_c2_utils_va
+LOCAL_SHARED_LIBRARIES := \
+    libmfx_fake_va_gralloc \
+    libc2plugin_store_celadon \
+    android.hardware.graphics.bufferqueue@2.0 \
+    libdl \
+    liblog \
+    libcutils \
+    $(MFX_C2_SHARED_LIBS)
+
+LOCAL_HEADER_LIBRARIES := $(MFX_C2_HEADER_LIBRARIES)
+
+LOCAL_MULTILIB := both
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := mfx_c2_fake_va_unittests
+LOCAL_MODULE_STEM_32 := mfx_c2_fake_va_unittests32
+LOCAL_MODULE_STEM_64 := mfx_c2_fake_va_unittests64
+
+include $(BUILD_EXECUTABLE)
+
+endif
+
+# =============================================================================
+
 # Usage: $(call build_mock_unittests, va|pure)
 define build_mock_unittests
 
@@ -22,6 +22,7 @@
 #include <C2Component.h>
 #include <fstream>
 
+#include "mfx_defs.h"
 #include "mfx_c2_defs.h"
 
 namespace {
@@ -51,7 +52,8 @@ ComponentDesc g_components[] = {
 // CANNOT LINK EXECUTABLE "cp": "/system/lib/vndk-28/libselinux.so" is 32-bit instead of 64-bit
 // That's why 'cp' and 'mv' need LD_LIBRARY_PATH reset.
 
-inline bool PrepareConfFile()
+inline bool PrepareConfFile(const ComponentDesc* components = g_components,
+    size_t components_count = MFX_GET_ARRAY_SIZE(g_components))
 {
     const char* backup_cmd_line = "cd " MFX_C2_CONFIG_FILE_PATH "; "
         "if [ -f " MFX_C2_CONFIG_FILE_NAME " ]; "
@@ -60,7 +62,8 @@ inline bool PrepareConfFile()
 
     std::ofstream fileConf(MFX_C2_CONFIG_FILE_PATH "/" MFX_C2_CONFIG_FILE_NAME);
 
-    for(const auto& component : g_components) {
+    for(size_t i = 0; i < components_count; ++i) {
+        const ComponentDesc& component = components[i];
         fileConf << component.component_name << " : " << component.module_name;
         if(component.flags != 0) {
             fileConf << " : " << component.flags;
@@ -71,7 +74,8 @@ inline bool PrepareConfFile()
     return true;
 }
 
-inline bool PrepareXmlConfFile()
+inline bool PrepareXmlConfFile(const ComponentDesc* components = g_components,
+    size_t components_count = MFX_GET_ARRAY_SIZE(g_components))
 {
     const char* backup_cmd_line = "cd " MFX_C2_CONFIG_XML_FILE_PATH "; "
         "if [ -f " MFX_C2_CONFIG_XML_FILE_NAME " ]; "
@@ -90,7 +94,8 @@ inline bool PrepareXmlConfFile()
 
     std::string decoders_str;
     std::string encoders_str;
-    for(const auto& component : g_components) {
+    for(size_t i = 0; i < components_count; ++i) {
+        const ComponentDesc& component = components[i];
         std::string line = "        <MediaCodec name=\"";
         line.append(component.component_name);
         line.append("\" type=\"");
@@ -119,6 +124,16 @@ inline bool PrepareXmlConfFile()
     return true;
 }
 
+// Moves configuration file away to make the store use built-in components table.
+// RestoreConfFile brings it back.
+inline void HideConfFile()
+{
+    const char* hide_cmd_line = "cd " MFX_C2_CONFIG_FILE_PATH "; "
+        "if [ -f " MFX_C2_CONFIG_FILE_NAME " ]; "
+            "then " RESET_LD_LIBRARY_PATH "mv " MFX_C2_CONFIG_FILE_NAME " " MFX_C2_CONFIG_FILE_NAME ".bak; fi";
+    std::system(hide_cmd_line);
+}
+
 inline void RestoreConfFile()
 {
     const char* restore_cmd_line = "cd " MFX_C2_CONFIG_FILE_PATH "; "
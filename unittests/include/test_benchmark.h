@@ -0,0 +1,97 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Micro-benchmarks are gtest cases printing their measurements,
+// they check correctness of the measured code but never the timings,
+// as those depend on device and its load.
+
+// Runs func count times and returns average duration of one call in nanoseconds.
+template<typename Func>
+double MeasureNsPerOp(size_t count, Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        func(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / count;
+}
+
+// Runs func count times on each of thread_count threads started together,
+// returns wall time divided by total number of calls in nanoseconds.
+template<typename Func>
+double MeasureNsPerOpThreaded(size_t thread_count, size_t count, Func func)
+{
+    std::atomic<size_t> ready { 0 };
+    std::atomic<bool> go { false };
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] () {
+            ++ready;
+            while (!go) std::this_thread::yield();
+            for (size_t i = 0; i < count; ++i) {
+                func(t, i);
+            }
+        });
+    }
+    while (ready != thread_count) std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / (thread_count * count);
+}
+
+// Number of heap allocations done with operator new in the process so far,
+// counted by replacement of global operator new linked into benchmarks (test_benchmark.cpp).
+size_t GetAllocationCount();
+
+inline void PrintBenchmark(const std::string& name, double ns_per_op)
+{
+    std::cout << "[  BENCH   ] " << name << ": " << ns_per_op << " ns/op" << std::endl;
+}
+
+// Prints duration of one operation together with throughput for bytes processed by it.
+inline void PrintBenchmark(const std::string& name, double ns_per_op, size_t bytes_per_op)
+{
+    double mb_per_s = (ns_per_op > 0) ? (bytes_per_op * 1e9 / ns_per_op / (1 << 20)) : 0;
+    std::cout << "[  BENCH   ] " << name << ": " << ns_per_op << " ns/op, "
+        << mb_per_s << " MB/s" << std::endl;
+}
+
+inline void PrintAllocations(const std::string& name, double allocations_per_op)
+{
+    std::cout << "[  BENCH   ] " << name << ": " << allocations_per_op << " allocations/op" << std::endl;
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <C2Component.h>
+
+// Source of components measured by mfx_c2_performance tool.
+// Backend decides which component stands for a codec and how
+// the component is set up for the measured resolution, so the same
+// measurement loop runs on hardware and on CPU-only fake components.
+class PerformanceBackend
+{
+public:
+    virtual ~PerformanceBackend() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // Creates component measured on behalf of codec_name,
+    // codec_name is a name from media codecs xml, like c2.intel.avc.decoder.
+    virtual c2_status_t CreateComponent(const std::string& codec_name,
+        std::shared_ptr<C2Component>* component) = 0;
+
+    // Configures component to process frames of specified resolution.
+    virtual c2_status_t Configure(const std::shared_ptr<C2Component>& component,
+        bool encoder, uint32_t width, uint32_t height) = 0;
+
+    // Completes work before queueing, for components having special requirements to it.
+    virtual void PrepareWork(C2Work* /*work*/) const {}
+};
+
+// Returns backend by name: "hw" - Intel C2 components on real hardware,
+// "fake" - the same components built on CPU fake runtime (libmfx_c2_components_fake),
+// "mock" - CPU components of libmfx_mock_c2_components copying frames as is.
+std::unique_ptr<PerformanceBackend> CreatePerformanceBackend(const std::string& name);
+
+// Returns names of all available backends.
+std::vector<std::string> GetPerformanceBackendNames();
@@ -0,0 +1,190 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "mfx_defs.h"
+#include "mfx_dev_va.h"
+#include "mfx_gralloc_allocator.h"
+#include "mfx_frame_converter.h"
+#include "mfx_frame_pool_allocator.h"
+#include "mfx_c2_buffer_queue.h"
+#include "mfx_fake_va_gralloc.h"
+#include "test_benchmark.h"
+
+// Benchmarks of VA and gralloc allocation paths on plain memory fakes (libmfx_fake_va_gralloc),
+// they measure the code of the allocators, not the driver.
+
+static const size_t ALLOC_ITERATIONS = 100;
+static const size_t CONVERT_ITERATIONS = 10000;
+
+static const uint16_t FRAME_WIDTH = 1920;
+static const uint16_t FRAME_HEIGHT = 1088;
+static const mfxU16 FRAME_COUNT = 8;
+
+static void InitNV12Request(mfxU16 type, mfxFrameAllocRequest* request)
+{
+    *request = mfxFrameAllocRequest {};
+    request->Type = type;
+    request->NumFrameMin = FRAME_COUNT;
+    request->NumFrameSuggested = FRAME_COUNT;
+    request->Info.FourCC = MFX_FOURCC_NV12;
+    request->Info.ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+    request->Info.Width = FRAME_WIDTH;
+    request->Info.Height = FRAME_HEIGHT;
+    request->Info.CropW = FRAME_WIDTH;
+    request->Info.CropH = FRAME_HEIGHT;
+}
+
+static void MeasureAllocFrames(const std::string& name, MfxFrameAllocator* allocator, mfxU16 type)
+{
+    std::atomic<size_t> failed { 0 };
+
+    size_t allocations = GetAllocationCount();
+    double ns = MeasureNsPerOp(ALLOC_ITERATIONS, [&] (size_t) {
+        mfxFrameAllocRequest request;
+        InitNV12Request(type, &request);
+        mfxFrameAllocResponse response {};
+        if (MFX_ERR_NONE != allocator->AllocFrames(&request, &response)) ++failed;
+        if (MFX_ERR_NONE != allocator->FreeFrames(&response)) ++failed;
+    });
+    allocations = GetAllocationCount() - allocations;
+
+    EXPECT_EQ(failed, 0u);
+
+    PrintBenchmark(name, ns);
+    PrintAllocations(name, (double)allocations / ALLOC_ITERATIONS);
+}
+
+// Measures MfxVaFrameAllocator AllocFrames and FreeFrames of a set of VA surfaces for encoder.
+TEST(MfxVaFrameAllocatorBenchmark, AllocFrames)
+{
+    MfxDevVa dev(MfxDev::Usage::Encoder);
+    ASSERT_EQ(dev.Init(), MFX_ERR_NONE);
+
+    MeasureAllocFrames("MfxVaFrameAllocator alloc/free " + std::to_string(FRAME_COUNT) + " frames",
+        dev.GetFrameAllocator().get(), MFX_MEMTYPE_FROM_ENCODE);
+
+    EXPECT_EQ(dev.Close(), MFX_ERR_NONE);
+}
+
+// Measures MfxVaFramePoolAllocator AllocFrames and FreeFrames of decoder surfaces:
+// blocks are fetched from MfxC2BufferQueueBlockPool and mapped to VA surfaces.
+TEST(MfxVaFramePoolAllocatorBenchmark, AllocFrames)
+{
+    MfxDevVa dev(MfxDev::Usage::Decoder);
+    ASSERT_EQ(dev.Init(), MFX_ERR_NONE);
+
+    std::shared_ptr<MfxFramePoolAllocator> pool_allocator = dev.GetFramePoolAllocator();
+    ASSERT_NE(pool_allocator, nullptr);
+    pool_allocator->SetC2Allocator(
+        std::make_shared<MfxC2BufferQueueBlockPool>(MfxFakeCreateC2GrallocAllocator(), 0));
+    pool_allocator->SetBufferCount(FRAME_COUNT);
+
+    MeasureAllocFrames("MfxVaFramePoolAllocator alloc/free decoder frames",
+        dev.GetFrameAllocator().get(), MFX_MEMTYPE_VIDEO_MEMORY_DECODER_TARGET);
+
+    pool_allocator->Reset();
+    pool_allocator->SetC2Allocator(nullptr);
+    pool_allocator.reset();
+    EXPECT_EQ(dev.Close(), MFX_ERR_NONE);
+}
+
+// Measures ConvertGrallocToVa of gralloc buffers seen for the first time (VA surface is created
+// and the mapping freed after) and of buffers already mapped (found in the cache).
+TEST(MfxFrameConverterBenchmark, ConvertGrallocToVa)
+{
+    std::unique_ptr<MfxGrallocAllocator> gr_allocator;
+    ASSERT_EQ(MfxGrallocAllocator::Create(&gr_allocator), C2_OK);
+
+    MfxDevVa dev(MfxDev::Usage::Encoder);
+    ASSERT_EQ(dev.Init(), MFX_ERR_NONE);
+
+    std::shared_ptr<MfxFrameConverter> converter = dev.GetFrameConverter();
+    ASSERT_NE(converter, nullptr);
+
+    std::vector<buffer_handle_t> handles(FRAME_COUNT);
+    for (buffer_handle_t& handle : handles) {
+        EXPECT_EQ(gr_allocator->Alloc(FRAME_WIDTH, FRAME_HEIGHT, &handle), C2_OK);
+    }
+
+    const bool decode_target = false;
+    std::atomic<size_t> failed { 0 };
+
+    size_t allocations = GetAllocationCount();
+    double ns = MeasureNsPerOp(CONVERT_ITERATIONS, [&] (size_t i) {
+        mfxMemId mem_id {};
+        if (MFX_ERR_NONE != converter->ConvertGrallocToVa(handles[i % FRAME_COUNT], decode_target, &mem_id)) ++failed;
+        converter->FreeGrallocToVaMapping(mem_id);
+    });
+    allocations = GetAllocationCount() - allocations;
+
+    EXPECT_EQ(failed, 0u);
+
+    std::string name = "ConvertGrallocToVa new buffer";
+    PrintBenchmark(name, ns);
+    PrintAllocations(name, (double)allocations / CONVERT_ITERATIONS);
+
+    allocations = GetAllocationCount();
+    ns = MeasureNsPerOp(CONVERT_ITERATIONS, [&] (size_t i) {
+        mfxMemId mem_id {};
+        if (MFX_ERR_NONE != converter->ConvertGrallocToVa(handles[i % FRAME_COUNT], decode_target, &mem_id)) ++failed;
+    });
+    allocations = GetAllocationCount() - allocations;
+
+    EXPECT_EQ(failed, 0u);
+
+    name = "ConvertGrallocToVa cached buffer";
+    PrintBenchmark(name, ns);
+    PrintAllocations(name, (double)allocations / CONVERT_ITERATIONS);
+
+    converter->FreeAllMappings();
+    for (buffer_handle_t handle : handles) {
+        EXPECT_EQ(gr_allocator->Free(handle), C2_OK);
+    }
+    converter.reset();
+    EXPECT_EQ(dev.Close(), MFX_ERR_NONE);
+}
+
+// Measures fetchGraphicBlock of MfxC2BufferQueueBlockPool without producer and release of the block.
+TEST(MfxC2BufferQueueBlockPoolBenchmark, FetchGraphicBlock)
+{
+    auto block_pool = std::make_shared<MfxC2BufferQueueBlockPool>(MfxFakeCreateC2GrallocAllocator(), 0);
+
+    std::atomic<size_t> failed { 0 };
+
+    size_t allocations = GetAllocationCount();
+    double ns = MeasureNsPerOp(ALLOC_ITERATIONS, [&] (size_t) {
+        std::shared_ptr<C2GraphicBlock> block;
+        c2_status_t res = block_pool->fetchGraphicBlock(FRAME_WIDTH, FRAME_HEIGHT,
+            HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL,
+            { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE }, &block);
+        if (C2_OK != res || !block) ++failed;
+    });
+    allocations = GetAllocationCount() - allocations;
+
+    EXPECT_EQ(failed, 0u);
+
+    std::string name = "MfxC2BufferQueueBlockPool fetch/release";
+    PrintBenchmark(name, ns);
+    PrintAllocations(name, (double)allocations / ALLOC_ITERATIONS);
+}
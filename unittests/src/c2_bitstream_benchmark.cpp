@@ -0,0 +1,360 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <functional>
+#include <random>
+#include <vector>
+#include "mfx_frame_constructor.h"
+#include "mfx_c2_bs_utils.h"
+#include "mfx_c2_avc_bitstream.h"
+#include "mfx_c2_hevc_bitstream.h"
+#include "test_streams.h"
+#include "test_benchmark.h"
+#include "streams/h264/stream_nv12_352x288_cqp_g15_100.264.h"
+#include "streams/h265/stream_nv12_352x288_cqp_g15_100.265.h"
+
+// Benchmarks of the bitstream processing done on CPU before data reaches MediaSDK:
+// frame constructor, start code search, emulation prevention removal and headers parsing.
+// They don't need hardware and run on any machine the unittests run on.
+
+static const size_t HIGH_BITRATE_FRAME_COUNT = 60;
+static const size_t HIGH_BITRATE_FRAME_SIZE = 256 * 1024; // ~60 Mbps at 30 fps
+static const size_t FIXED_CHUNK_SIZE = 64 * 1024;
+static const size_t KEPT_TAIL_SIZE = 1024;
+
+static size_t GetHeadersEnd(const StreamDescription& stream)
+{
+    return std::max(stream.sps.offset + stream.sps.size, stream.pps.offset + stream.pps.size);
+}
+
+// Payload without start code emulation, all bytes are non-zero.
+static std::vector<char> MakePayload(size_t size, std::mt19937* generator)
+{
+    std::uniform_int_distribution<int> distribution(1, 255);
+    std::vector<char> payload(size);
+    for (char& byte : payload) {
+        byte = (char)distribution(*generator);
+    }
+    return payload;
+}
+
+// Builds stream having headers of the given one followed by large single slice frames
+// filled with random payload, simulates high bitrate content not fitting into embedded streams.
+static StreamDescription MakeHighBitrateStream(const StreamDescription& base, const char* name)
+{
+    std::mt19937 generator(base.fourcc);
+
+    StreamDescription stream {};
+    stream.name = name;
+    stream.fourcc = base.fourcc;
+    stream.sps = base.sps;
+    stream.pps = base.pps;
+    stream.data.assign(base.data.begin(), base.data.begin() + GetHeadersEnd(base));
+
+    for (size_t i = 0; i < HIGH_BITRATE_FRAME_COUNT; ++i) {
+        const bool idr = (i == 0);
+        std::vector<char> slice_header;
+        if (MFX_CODEC_AVC == base.fourcc) {
+            slice_header = { 0, 0, 0, 1, (char)(idr ? 0x65 : 0x41) };
+        } else {
+            slice_header = { 0, 0, 0, 1, (char)(idr ? 0x26 : 0x02), 0x01 };
+        }
+        std::vector<char> payload = MakePayload(HIGH_BITRATE_FRAME_SIZE - slice_header.size(), &generator);
+        stream.data.insert(stream.data.end(), slice_header.begin(), slice_header.end());
+        stream.data.insert(stream.data.end(), payload.begin(), payload.end());
+    }
+    return stream;
+}
+
+struct StreamChunk
+{
+    StreamDescription::Region region;
+    bool header;
+};
+
+// Slices stream in advance, so the benchmarks don't measure StreamReader.
+static std::vector<StreamChunk> SliceStream(const StreamDescription& stream, const StreamReader::Slicing& slicing)
+{
+    std::vector<StreamChunk> chunks;
+    SingleStreamReader reader(&stream);
+    StreamChunk chunk {};
+    while (reader.Read(slicing, &chunk.region, &chunk.header)) {
+        chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+// NAL unit of the region without leading start code.
+static std::vector<mfxU8> GetNalUnit(const StreamDescription& stream, const StreamDescription::Region& region)
+{
+    std::vector<mfxU8> nal_unit(stream.data.begin() + region.offset,
+        stream.data.begin() + region.offset + region.size);
+    const std::vector<mfxU8> start_codes[] = { { 0, 0, 0, 1 }, { 0, 0, 1 } };
+    for (const auto& start_code : start_codes) {
+        if (nal_unit.size() >= start_code.size() &&
+            std::equal(start_code.begin(), start_code.end(), nal_unit.begin())) {
+            nal_unit.erase(nal_unit.begin(), nal_unit.begin() + start_code.size());
+            break;
+        }
+    }
+    return nal_unit;
+}
+
+// Swaps NAL unit the way bitstream readers expect it, and removes emulation prevention bytes.
+static std::vector<mfxU8> SwapNalUnit(std::vector<mfxU8> nal_unit, mfxU32* swapped_size)
+{
+    std::vector<mfxU8> swapped(nal_unit.size() + 8);
+    *swapped_size = nal_unit.size();
+    BytesSwapper::SwapMemory(swapped.data(), *swapped_size, nal_unit.data(), nal_unit.size());
+    return swapped;
+}
+
+// Exposes headers search of frame constructors.
+template<typename FrameConstructor>
+class FindHeadersAccess : public FrameConstructor
+{
+public:
+    using FrameConstructor::FindHeaders;
+};
+
+struct BenchmarkStream
+{
+    MfxC2FrameConstructorType type;
+    const StreamDescription& stream;
+};
+
+// Measures the frame constructor processing whole stream,
+// either consumed completely after every Load (data is passed through without copy)
+// or with some tail kept as decoder does with incomplete frame (data is buffered).
+TEST(MfxC2FrameConstructorBenchmark, LoadUnload)
+{
+    const StreamDescription high_bitrate_264 = MakeHighBitrateStream(stream_nv12_352x288_cqp_g15_100_264, "high_bitrate_264");
+    const StreamDescription high_bitrate_265 = MakeHighBitrateStream(stream_nv12_352x288_cqp_g15_100_265, "high_bitrate_265");
+
+    const BenchmarkStream streams[] = {
+        { MfxC2FC_AVC, stream_nv12_352x288_cqp_g15_100_264 },
+        { MfxC2FC_AVC, high_bitrate_264 },
+        { MfxC2FC_HEVC, stream_nv12_352x288_cqp_g15_100_265 },
+        { MfxC2FC_HEVC, high_bitrate_265 },
+    };
+    const std::pair<StreamReader::Slicing, const char*> slicings[] = {
+        { StreamReader::Slicing::NalUnit(), "nal unit" },
+        { StreamReader::Slicing::Frame(), "frame" },
+        { StreamReader::Slicing(FIXED_CHUNK_SIZE), "fixed" },
+    };
+    const size_t PASS_COUNT = 20;
+
+    for (const BenchmarkStream& test_stream : streams) {
+        const StreamDescription& stream = test_stream.stream;
+        for (const auto& slicing : slicings) {
+            std::vector<StreamChunk> chunks = SliceStream(stream, slicing.first);
+            const bool complete_frame = (slicing.first.GetType() == StreamReader::Slicing::Type::Frame);
+
+            for (bool keep_tail : { false, true }) {
+                std::string name = std::string(stream.name) + ", " + slicing.second +
+                    (keep_tail ? ", kept tail" : ", consumed");
+                SCOPED_TRACE(name);
+
+                mfxStatus sts = MFX_ERR_NONE;
+                size_t consumed_bytes = 0;
+
+                double ns_per_pass = MeasureNsPerOp(PASS_COUNT, [&] (size_t) {
+                    std::shared_ptr<IMfxC2FrameConstructor> frame_constructor =
+                        MfxC2FrameConstructorFactory::CreateFrameConstructor(test_stream.type);
+                    frame_constructor->Init(0, {});
+                    consumed_bytes = 0;
+                    mfxU64 pts = 0;
+
+                    for (const StreamChunk& chunk : chunks) {
+                        mfxStatus res = frame_constructor->Load((const mfxU8*)stream.data.data() + chunk.region.offset,
+                            chunk.region.size, pts++, chunk.header, complete_frame);
+                        if (MFX_ERR_NONE != res) sts = res;
+
+                        std::shared_ptr<mfxBitstream> bitstream = frame_constructor->GetMfxBitstream();
+                        if (bitstream) {
+                            mfxU32 consumed = bitstream->DataLength;
+                            if (keep_tail) consumed -= std::min<mfxU32>(consumed, KEPT_TAIL_SIZE);
+                            bitstream->DataOffset += consumed;
+                            bitstream->DataLength -= consumed;
+                            consumed_bytes += consumed;
+                        }
+
+                        res = frame_constructor->Unload();
+                        if (MFX_ERR_NONE != res) sts = res;
+                    }
+                    frame_constructor->Close();
+                });
+
+                EXPECT_EQ(sts, MFX_ERR_NONE);
+                if (!keep_tail) EXPECT_EQ(consumed_bytes, stream.data.size());
+
+                PrintBenchmark("Load/Unload " + name, ns_per_pass / chunks.size(), stream.data.size() / chunks.size());
+            }
+        }
+    }
+}
+
+// Measures headers search in the chunk with headers, which scans the whole chunk for start codes.
+TEST(MfxC2FrameConstructorBenchmark, FindHeaders)
+{
+    const StreamDescription high_bitrate_264 = MakeHighBitrateStream(stream_nv12_352x288_cqp_g15_100_264, "high_bitrate_264");
+    const StreamDescription high_bitrate_265 = MakeHighBitrateStream(stream_nv12_352x288_cqp_g15_100_265, "high_bitrate_265");
+
+    FindHeadersAccess<MfxC2AVCFrameConstructor> avc_constructor;
+    FindHeadersAccess<MfxC2HEVCFrameConstructor> hevc_constructor;
+
+    struct TestCase
+    {
+        const StreamDescription& stream;
+        std::function<mfxStatus(const mfxU8*, mfxU32, bool&, bool&, bool&)> find_headers;
+    } test_cases[] = {
+        { stream_nv12_352x288_cqp_g15_100_264,
+            [&] (const mfxU8* data, mfxU32 size, bool& sps, bool& pps, bool& sei) {
+                return avc_constructor.FindHeaders(data, size, sps, pps, sei); } },
+        { high_bitrate_264,
+            [&] (const mfxU8* data, mfxU32 size, bool& sps, bool& pps, bool& sei) {
+                return avc_constructor.FindHeaders(data, size, sps, pps, sei); } },
+        { stream_nv12_352x288_cqp_g15_100_265,
+            [&] (const mfxU8* data, mfxU32 size, bool& sps, bool& pps, bool& sei) {
+                return hevc_constructor.FindHeaders(data, size, sps, pps, sei); } },
+        { high_bitrate_265,
+            [&] (const mfxU8* data, mfxU32 size, bool& sps, bool& pps, bool& sei) {
+                return hevc_constructor.FindHeaders(data, size, sps, pps, sei); } },
+    };
+    const size_t ITERATIONS = 200;
+
+    for (const TestCase& test_case : test_cases) {
+        SCOPED_TRACE(test_case.stream.name);
+
+        // headers and the first frame
+        std::vector<StreamChunk> chunks = SliceStream(test_case.stream, StreamReader::Slicing::Frame());
+        ASSERT_FALSE(chunks.empty());
+        const StreamDescription::Region& region = chunks.front().region;
+
+        mfxStatus sts = MFX_ERR_NONE;
+        bool found_sps = false, found_pps = false, found_sei = false;
+
+        double ns = MeasureNsPerOp(ITERATIONS, [&] (size_t) {
+            mfxStatus res = test_case.find_headers((const mfxU8*)test_case.stream.data.data() + region.offset,
+                region.size, found_sps, found_pps, found_sei);
+            if (MFX_ERR_NONE != res) sts = res;
+        });
+
+        EXPECT_EQ(sts, MFX_ERR_NONE);
+        EXPECT_TRUE(found_sps);
+        EXPECT_TRUE(found_pps);
+
+        PrintBenchmark(std::string("FindHeaders ") + test_case.stream.name, ns, region.size);
+    }
+}
+
+// Measures swapping with emulation prevention bytes removal done before parsing of SEI and headers.
+TEST(BytesSwapperBenchmark, SwapMemory)
+{
+    std::mt19937 generator(0);
+    std::vector<char> payload = MakePayload(HIGH_BITRATE_FRAME_SIZE, &generator);
+    // emulation prevention byte every 1KB
+    const size_t PREVENTION_INTERVAL = 1024;
+    size_t prevention_count = 0;
+    for (size_t pos = PREVENTION_INTERVAL; pos + 3 < payload.size(); pos += PREVENTION_INTERVAL) {
+        payload[pos] = 0;
+        payload[pos + 1] = 0;
+        payload[pos + 2] = 3;
+        ++prevention_count;
+    }
+    std::vector<mfxU8> source(payload.begin(), payload.end());
+    std::vector<mfxU8> destination(source.size() + 8);
+    const size_t ITERATIONS = 200;
+
+    mfxU32 dst_size = 0;
+    double ns = MeasureNsPerOp(ITERATIONS, [&] (size_t) {
+        dst_size = source.size();
+        BytesSwapper::SwapMemory(destination.data(), dst_size, source.data(), source.size());
+    });
+
+    // output is padded to 4 bytes
+    EXPECT_EQ(dst_size, (source.size() - prevention_count + 3) & ~3u);
+
+    PrintBenchmark("BytesSwapper::SwapMemory", ns, source.size());
+}
+
+// Measures parsing of sequence parameter sets, done on every header change.
+TEST(HeadersParserBenchmark, SequenceParamSet)
+{
+    const size_t ITERATIONS = 100000;
+
+    {
+        const StreamDescription& stream = stream_nv12_352x288_cqp_g15_100_264;
+        mfxU32 size = 0;
+        std::vector<mfxU8> swapped = SwapNalUnit(GetNalUnit(stream, stream.sps), &size);
+
+        AVCParser::AVCHeadersBitstream bitstream;
+        AVCParser::AVCSeqParamSet sps;
+        mfxStatus sts = MFX_ERR_NONE;
+
+        double ns = MeasureNsPerOp(ITERATIONS, [&] (size_t) {
+            try {
+                AVCParser::NAL_Unit_Type type;
+                mfxU8 storage_idc;
+                bitstream.Reset(swapped.data(), size);
+                bitstream.GetNALUnitType(type, storage_idc);
+                mfxStatus res = bitstream.GetSequenceParamSet(&sps);
+                if (MFX_ERR_NONE != res) sts = res;
+            } catch (const AVCParser::AVC_exception&) {
+                sts = MFX_ERR_UNDEFINED_BEHAVIOR;
+            }
+        });
+
+        EXPECT_EQ(sts, MFX_ERR_NONE);
+        EXPECT_EQ(sps.frame_width_in_mbs * 16, 352u);
+        EXPECT_EQ(sps.frame_height_in_mbs * 16, 288u);
+
+        PrintBenchmark("AVCHeadersBitstream::GetSequenceParamSet", ns, size);
+    }
+    {
+        const StreamDescription& stream = stream_nv12_352x288_cqp_g15_100_265;
+        mfxU32 size = 0;
+        std::vector<mfxU8> swapped = SwapNalUnit(GetNalUnit(stream, stream.sps), &size);
+
+        HEVCParser::HEVCHeadersBitstream bitstream;
+        HEVCParser::H265SeqParamSet sps;
+        mfxStatus sts = MFX_ERR_NONE;
+
+        double ns = MeasureNsPerOp(ITERATIONS, [&] (size_t) {
+            try {
+                HEVCParser::NalUnitType type;
+                mfxU32 temporal_id;
+                bitstream.Reset(swapped.data(), size);
+                bitstream.GetNALUnitType(type, temporal_id);
+                mfxStatus res = bitstream.GetSequenceParamSet(&sps);
+                if (MFX_ERR_NONE != res) sts = res;
+            } catch (const AVCParser::AVC_exception&) {
+                sts = MFX_ERR_UNDEFINED_BEHAVIOR;
+            }
+        });
+
+        EXPECT_EQ(sts, MFX_ERR_NONE);
+        EXPECT_EQ(sps.pic_width_in_luma_samples, 352u);
+        EXPECT_EQ(sps.pic_height_in_luma_samples, 288u);
+
+        PrintBenchmark("HEVCHeadersBitstream::GetSequenceParamSet", ns, size);
+    }
+}
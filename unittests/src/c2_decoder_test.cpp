@@ -1546,6 +1546,151 @@ TEST_P(DecoderDecode, Check)
     } );
 }
 
+// Checks works tunnelled from decoder to encoder come back to the decoder listener
+// with both worklets processed and encoded frames in the encoder worklet.
+class TunnelConsumer : public C2Component::Listener
+{
+public:
+    std::future<void> GetFuture() { return done_.get_future(); }
+
+protected:
+    void onWorkDone_nb(std::weak_ptr<C2Component>, std::list<std::unique_ptr<C2Work>> workItems) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(std::unique_ptr<C2Work>& work : workItems) {
+            if (C2_OK != work->result) {
+                EXPECT_EQ(work->result, C2_BAD_VALUE);
+                ++rejected_count_;
+                continue;
+            }
+            // input given to decoder is restored, encoder worklet is kept
+            EXPECT_EQ(work->worklets.size(), 2u);
+            if (work->worklets.size() != 2) continue;
+            EXPECT_EQ(work->worklets.back()->component, encoder_id_);
+
+            const C2FrameData& decoded = work->worklets.front()->output;
+            const C2FrameData& encoded = work->worklets.back()->output;
+            if (work->workletsProcessed == 2) {
+                // decoded frame is given to encoder, not to the client
+                EXPECT_TRUE(decoded.buffers.empty());
+                if (!encoded.buffers.empty()) {
+                    std::unique_ptr<C2ConstLinearBlock> linear_block;
+                    EXPECT_EQ(GetC2ConstLinearBlock(encoded, &linear_block), C2_OK);
+                    if (linear_block) {
+                        EXPECT_NE(linear_block->size(), 0u);
+                    }
+                    ++encoded_count_;
+                }
+            } else {
+                // nothing decoded to pass to encoder, like header
+                EXPECT_EQ(work->workletsProcessed, 1u);
+                EXPECT_TRUE(decoded.buffers.empty());
+            }
+
+            if (work->input.flags & C2FrameData::FLAG_END_OF_STREAM) {
+                done_.set_value();
+            }
+        }
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>, std::vector<std::shared_ptr<C2SettingResult>>) override
+    {
+        ADD_FAILURE() << "onTripped_nb callback shouldn't come";
+    }
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t) override
+    {
+        ADD_FAILURE() << "onError_nb callback shouldn't come";
+    }
+
+public:
+    std::mutex mutex_;
+    c2_node_id_t encoder_id_ = 0;
+    size_t encoded_count_ = 0;
+    size_t rejected_count_ = 0;
+    std::promise<void> done_;
+};
+
+// Tests avc decoder tunnelled to avc encoder: works queued to decoder with
+// a worklet for encoder pass decoder validation, decoded frames are encoded
+// and works come back to decoder listener processed by both components.
+TEST(DecoderTunnel, EncodeDecodedFrames)
+{
+    const std::vector<const StreamDescription*> streams = { &stream_nv12_176x144_cqp_g30_100_264 };
+
+    c2_status_t sts = C2_OK;
+    std::shared_ptr<MfxC2ParamReflector> reflector = std::make_shared<MfxC2ParamReflector>();
+    std::shared_ptr<C2Component> decoder(
+        MfxCreateC2Component("c2.intel.avc.decoder", MfxC2Component::CreateConfig{}, reflector, &sts));
+    EXPECT_EQ(sts, C2_OK);
+    std::shared_ptr<C2Component> encoder(
+        MfxCreateC2Component("c2.intel.avc.encoder", MfxC2Component::CreateConfig{}, reflector, &sts));
+    EXPECT_EQ(sts, C2_OK);
+    ASSERT_NE(decoder, nullptr);
+    ASSERT_NE(encoder, nullptr);
+
+    c2_node_id_t decoder_id = decoder->intf()->getId();
+    c2_node_id_t encoder_id = encoder->intf()->getId();
+
+    C2StreamPictureSizeInfo::input size(0/*stream id*/, 176, 144);
+    std::vector<std::unique_ptr<C2SettingResult>> failures;
+    EXPECT_EQ(encoder->intf()->config_vb({ &size }, C2_MAY_BLOCK, &failures), C2_OK);
+
+    std::shared_ptr<TunnelConsumer> validator = std::make_shared<TunnelConsumer>();
+    validator->encoder_id_ = encoder_id;
+    EXPECT_EQ(decoder->setListener_vb(validator, C2_MAY_BLOCK), C2_OK);
+
+    EXPECT_EQ(encoder->start(), C2_OK);
+    EXPECT_EQ(decoder->start(), C2_OK);
+
+    std::list<StreamChunk> stream_chunks = ReadChunks(streams);
+    std::unique_ptr<StreamReader> reader{StreamReader::Create(streams)};
+
+    // encoder worklet is rejected until the tunnel is created
+    {
+        std::list<std::unique_ptr<C2Work>> works{1};
+        PrepareWork(0, decoder, &works.front(), {}, false, false, true);
+        std::unique_ptr<C2Worklet> encoder_worklet = std::make_unique<C2Worklet>();
+        encoder_worklet->component = encoder_id;
+        works.front()->worklets.push_back(std::move(encoder_worklet));
+        EXPECT_EQ(decoder->queue_nb(&works), C2_OK); // completed with an error
+    }
+
+    EXPECT_EQ(decoder->createTunnel_sm(encoder_id), C2_OK);
+
+    uint32_t frame_index = 0;
+    for (const StreamChunk& chunk : stream_chunks) {
+        std::list<std::unique_ptr<C2Work>> works{1};
+        std::vector<char> stream_part = reader->GetRegionContents(chunk.region);
+
+        PrepareWork(frame_index++, decoder, &works.front(), stream_part,
+            chunk.end_stream, chunk.header, chunk.complete_frame);
+        works.front()->worklets.front()->component = decoder_id;
+
+        std::unique_ptr<C2Worklet> encoder_worklet = std::make_unique<C2Worklet>();
+        encoder_worklet->component = encoder_id;
+        works.front()->worklets.push_back(std::move(encoder_worklet));
+
+        EXPECT_EQ(decoder->queue_nb(&works), C2_OK);
+    }
+
+    std::future<void> future = validator->GetFuture();
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    {
+        std::lock_guard<std::mutex> lock(validator->mutex_);
+        EXPECT_EQ(validator->encoded_count_, stream_nv12_176x144_cqp_g30_100_264.frames_crc32_nv12.size());
+        EXPECT_EQ(validator->rejected_count_, 1u);
+    }
+
+    decoder->setListener_vb(nullptr, C2_MAY_BLOCK);
+    EXPECT_EQ(decoder->stop(), C2_OK);
+    EXPECT_EQ(encoder->stop(), C2_OK);
+    EXPECT_EQ(decoder->releaseTunnel_sm(encoder_id), C2_OK);
+
+    EXPECT_EQ(decoder->release(), C2_OK);
+    EXPECT_EQ(encoder->release(), C2_OK);
+}
+
 INSTANTIATE_TEST_CASE_P(MfxComponents, CreateDecoder,
     ::testing::ValuesIn(g_components_desc),
     ::testing::PrintToStringParamName());
@@ -1252,6 +1252,13 @@ TEST_P(Encoder, DynamicBitrate)
 
             EXPECT_TRUE(abs(real_bitrate_2 - BITRATE_2) < BITRATE_2 * 0.1)
                 << "Expected bitrate: " << BITRATE_2 << " Actual: " << real_bitrate_2;
+
+            // bitrate changed either way is queried back
+            param_bitrate_info->value = 0;
+            std::vector<std::unique_ptr<C2Param>> heap_params;
+            sts = comp_intf->query_vb(dynamic_params, {}, may_block, &heap_params);
+            EXPECT_EQ(sts, C2_OK);
+            EXPECT_EQ(param_bitrate_info->value, BITRATE_2);
         }
     }); // CallComponentTest
 }
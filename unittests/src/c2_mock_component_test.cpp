@@ -32,8 +32,10 @@
 #include "mfx_c2_mock_component.h"
 #include "C2PlatformSupport.h"
 
+#include <algorithm>
 #include <set>
 #include <future>
+#include <chrono>
 #include <iostream>
 
 using namespace android;
@@ -85,6 +87,91 @@ TEST(MfxMockComponent, intf)
     }
 }
 
+// Tests runtime metrics are served by interface helper as read-only param.
+TEST(MfxMockComponent, Metrics)
+{
+    MfxC2Component::CreateConfig config{};
+    c2_status_t sts = C2_OK;
+    std::shared_ptr<MfxC2ParamReflector> reflector = std::make_shared<MfxC2ParamReflector>();
+    std::shared_ptr<MfxC2Component> mfx_component(MfxCreateC2Component(MOCK_COMPONENT, config, reflector, &sts));
+
+    EXPECT_EQ(sts, C2_OK);
+    ASSERT_NE(mfx_component, nullptr);
+
+    std::vector<std::shared_ptr<C2ParamDescriptor>> descriptors;
+    EXPECT_EQ(mfx_component->querySupportedParams_nb(&descriptors), C2_OK);
+    EXPECT_TRUE(std::any_of(descriptors.begin(), descriptors.end(),
+        [] (const std::shared_ptr<C2ParamDescriptor>& desc) { return desc->index() == C2MetricsInfo::PARAM_TYPE; }));
+
+    std::vector<std::unique_ptr<C2Param>> heap_params;
+    EXPECT_EQ(mfx_component->query_vb({}, { C2MetricsInfo::PARAM_TYPE }, C2_MAY_BLOCK, &heap_params), C2_OK);
+    ASSERT_EQ(heap_params.size(), 1u);
+    ASSERT_NE(heap_params[0], nullptr);
+    EXPECT_EQ(heap_params[0]->index(), C2MetricsInfo::PARAM_TYPE);
+    const C2MetricsInfo* metrics = C2MetricsInfo::From(heap_params[0].get());
+    ASSERT_NE(metrics, nullptr);
+    // metrics of the component are registered on its creation
+    EXPECT_NE(std::string(metrics->m.value).find(MOCK_COMPONENT), std::string::npos);
+
+    std::vector<std::unique_ptr<C2SettingResult>> failures;
+    EXPECT_NE(mfx_component->config_vb({ heap_params[0].get() }, C2_MAY_BLOCK, &failures), C2_OK);
+}
+
+// Admission rejecting or admitting components, counts started ones.
+class TestAdmission : public MfxC2Component::Admission
+{
+public:
+    c2_status_t Admit(MfxC2Component* component) override
+    {
+        if (reject_) return C2_NO_MEMORY;
+        started_.insert(component);
+        return C2_OK;
+    }
+
+    void Leave(MfxC2Component* component) override
+    {
+        started_.erase(component);
+    }
+
+    bool reject_ { false };
+    std::set<MfxC2Component*> started_;
+};
+
+// Tests component is admitted on start and leaves on stop,
+// rejected component doesn't start.
+TEST(MfxMockComponent, Admission)
+{
+    std::shared_ptr<TestAdmission> admission = std::make_shared<TestAdmission>();
+
+    MfxC2Component::CreateConfig config{};
+    config.admission = admission;
+    c2_status_t sts = C2_OK;
+    std::shared_ptr<MfxC2ParamReflector> reflector = std::make_shared<MfxC2ParamReflector>();
+    std::shared_ptr<MfxC2Component> mfx_component(MfxCreateC2Component(MOCK_COMPONENT, config, reflector, &sts));
+
+    EXPECT_EQ(sts, C2_OK);
+    ASSERT_NE(mfx_component, nullptr);
+    // created component takes no capacity
+    EXPECT_TRUE(admission->started_.empty());
+
+    admission->reject_ = true;
+    EXPECT_EQ(mfx_component->start(), C2_NO_MEMORY);
+    EXPECT_TRUE(admission->started_.empty());
+    // not started component can't be stopped
+    EXPECT_EQ(mfx_component->stop(), C2_BAD_STATE);
+
+    admission->reject_ = false;
+    EXPECT_EQ(mfx_component->start(), C2_OK);
+    EXPECT_EQ(admission->started_.count(mfx_component.get()), 1u);
+
+    EXPECT_EQ(mfx_component->stop(), C2_OK);
+    EXPECT_TRUE(admission->started_.empty());
+
+    EXPECT_EQ(mfx_component->start(), C2_OK);
+    EXPECT_EQ(mfx_component->release(), C2_OK);
+    EXPECT_TRUE(admission->started_.empty());
+}
+
 // Allocates c2 graphic block of FRAME_WIDTH x FRAME_HEIGHT size and fills it with
 // specified byte value.
 static std::unique_ptr<C2ConstGraphicBlock> CreateFilledGraphicBlock(
@@ -475,6 +562,249 @@ TEST(MfxMockComponent, Decode)
     }
 }
 
+// Collects frame indices and output sizes of completed works.
+class MockLoadListener : public C2Component::Listener
+{
+public:
+    std::future<void> GetFuture() { return done_.get_future(); }
+
+protected:
+    void onWorkDone_nb(std::weak_ptr<C2Component>, std::list<std::unique_ptr<C2Work>> workItems) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(std::unique_ptr<C2Work>& work : workItems) {
+            EXPECT_EQ(work->result, C2_OK);
+            frame_indices_.push_back(work->input.ordinal.frameIndex.peeku());
+
+            std::unique_ptr<C2ConstGraphicBlock> graphic_block;
+            if (work->worklets.size() == 1 &&
+                C2_OK == GetC2ConstGraphicBlock(work->worklets.front()->output, &graphic_block)) {
+                EXPECT_EQ(graphic_block->width(), width_);
+                EXPECT_EQ(graphic_block->height(), height_);
+            } else {
+                ADD_FAILURE() << "no graphic output for frame " << frame_indices_.back();
+            }
+        }
+        if(frame_indices_.size() == FRAME_COUNT) {
+            done_.set_value();
+        }
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>, std::vector<std::shared_ptr<C2SettingResult>>) override
+    {
+        ADD_FAILURE() << "onTripped_nb callback shouldn't come";
+    }
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t) override
+    {
+        ADD_FAILURE() << "onError_nb callback shouldn't come";
+    }
+
+public:
+    std::mutex mutex_;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    std::vector<uint64_t> frame_indices_;
+    std::promise<void> done_;
+};
+
+// Checks synthetic load of the mock decoder: output frames get configured size
+// regardless of input size, processing takes configured time per frame,
+// works are completed in groups of (reorder depth + 1) with the last queued first,
+// reordered and held frames are reported as output delay.
+TEST(MfxMockComponent, SyntheticLoad)
+{
+    MfxC2Component::CreateConfig config{};
+    c2_status_t sts = C2_OK;
+    std::shared_ptr<MfxC2ParamReflector> reflector = std::make_shared<MfxC2ParamReflector>();
+    std::shared_ptr<C2Component> component(MfxCreateC2Component(MOCK_COMPONENT_DEC, config, reflector, &sts));
+
+    EXPECT_EQ(sts, C2_OK);
+    ASSERT_NE(component, nullptr);
+
+    const uint32_t OUTPUT_WIDTH = 1280;
+    const uint32_t OUTPUT_HEIGHT = 720;
+    const uint32_t PROCESSING_TIME_US = 1000;
+    const uint32_t REORDER_DEPTH = 2;
+    const uint32_t HOLD_DEPTH = 1;
+
+    std::shared_ptr<C2ComponentInterface> component_intf = component->intf();
+    ASSERT_NE(component_intf, nullptr);
+
+    C2StreamPictureSizeInfo::output picture_size(0/*stream*/, OUTPUT_WIDTH, OUTPUT_HEIGHT);
+    C2MockProcessingTimeTuning processing_time(PROCESSING_TIME_US);
+    C2MockReorderDepthTuning reorder_depth(REORDER_DEPTH);
+    C2MockHoldDepthTuning hold_depth(HOLD_DEPTH);
+    std::vector<std::unique_ptr<C2SettingResult>> failures;
+    sts = component_intf->config_vb({ &picture_size, &processing_time, &reorder_depth, &hold_depth },
+        C2_MAY_BLOCK, &failures);
+    EXPECT_EQ(sts, C2_OK);
+
+    C2PortActualDelayTuning::output output_delay;
+    sts = component_intf->query_vb({ &output_delay }, {}, C2_MAY_BLOCK, nullptr);
+    EXPECT_EQ(sts, C2_OK);
+    EXPECT_EQ(output_delay.value, REORDER_DEPTH + HOLD_DEPTH);
+
+    std::shared_ptr<MockLoadListener> listener = std::make_shared<MockLoadListener>();
+    listener->width_ = OUTPUT_WIDTH;
+    listener->height_ = OUTPUT_HEIGHT;
+    component->setListener_vb(listener, C2_MAY_BLOCK);
+
+    sts = component->start();
+    EXPECT_EQ(sts, C2_OK);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(uint32_t frame_index = 0; frame_index < FRAME_COUNT; ++frame_index) {
+        std::unique_ptr<C2Work> work;
+        // 640x480 input doesn't match configured size
+        PrepareWork(frame_index, component, &work, C2BufferData::LINEAR, C2MemoryUsage::CPU_READ);
+        std::list<std::unique_ptr<C2Work>> works;
+        works.push_back(std::move(work));
+
+        sts = component->queue_nb(&works);
+        EXPECT_EQ(sts, C2_OK);
+    }
+
+    std::future<void> future = listener->GetFuture();
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::microseconds(PROCESSING_TIME_US * FRAME_COUNT));
+
+    component->setListener_vb(nullptr, C2_MAY_BLOCK);
+    sts = component->stop();
+    EXPECT_EQ(sts, C2_OK);
+
+    // groups of 3 frames: the last one first, the frame with end of stream goes the last
+    std::vector<uint64_t> expected_indices = { 2, 0, 1, 5, 3, 4, 8, 6, 7, 9 };
+    ASSERT_EQ(FRAME_COUNT, expected_indices.size());
+    EXPECT_EQ(listener->frame_indices_, expected_indices);
+}
+
+// Checks works completed by decoder tunnelled to encoder.
+class MockTunnelValidator : public C2Component::Listener
+{
+public:
+    std::future<void> GetFuture() { return done_.get_future(); }
+
+protected:
+    void onWorkDone_nb(std::weak_ptr<C2Component>, std::list<std::unique_ptr<C2Work>> workItems) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(std::unique_ptr<C2Work>& work : workItems) {
+            EXPECT_EQ(work->result, C2_OK);
+            EXPECT_EQ(work->workletsProcessed, 2u);
+            // input queued to decoder is given back
+            EXPECT_EQ(work->input.buffers.size(), 1u);
+            EXPECT_EQ(work->worklets.size(), 2u);
+            if (work->worklets.size() != 2) continue;
+
+            uint64_t frame_index = work->input.ordinal.frameIndex.peeku();
+            EXPECT_EQ(frame_index, frame_expected_) << " frame " << frame_index << " is out of order";
+            ++frame_expected_;
+
+            EXPECT_EQ(work->worklets.front()->component, decoder_id_);
+            EXPECT_EQ(work->worklets.back()->component, encoder_id_);
+            // decoded frame went to encoder, encoded copy of it is the output
+            C2FrameData& output = work->worklets.back()->output;
+            EXPECT_EQ(output.ordinal.frameIndex.peeku(), frame_index);
+
+            std::unique_ptr<C2ConstLinearBlock> linear_block;
+            c2_status_t sts = GetC2ConstLinearBlock(output, &linear_block);
+            EXPECT_EQ(sts, C2_OK);
+            if(nullptr != linear_block) {
+                std::unique_ptr<C2ReadView> read_view;
+                sts = MapConstLinearBlock(*linear_block, TIMEOUT_NS, &read_view);
+                EXPECT_EQ(sts, C2_OK);
+                if(nullptr != read_view) {
+                    CheckFilledBuffer(read_view->data(), frame_index);
+                }
+            }
+        }
+        if(frame_expected_ == FRAME_COUNT) {
+            done_.set_value();
+        }
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>, std::vector<std::shared_ptr<C2SettingResult>>) override
+    {
+        ADD_FAILURE() << "onTripped_nb callback shouldn't come";
+    }
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t) override
+    {
+        ADD_FAILURE() << "onError_nb callback shouldn't come";
+    }
+
+public:
+    std::mutex mutex_;
+    c2_node_id_t decoder_id_ = 0;
+    c2_node_id_t encoder_id_ = 0;
+    uint64_t frame_expected_ = 0;
+    std::promise<void> done_;
+};
+
+// Tests decoder tunnelled to encoder: works queued to decoder with a worklet
+// for encoder come back from decoder processed by both components,
+// encoder gets decoded frames without passing them through the client.
+TEST(MfxMockComponent, Tunnel)
+{
+    MfxC2Component::CreateConfig config{};
+    c2_status_t sts = C2_OK;
+    std::shared_ptr<MfxC2ParamReflector> reflector = std::make_shared<MfxC2ParamReflector>();
+
+    std::shared_ptr<C2Component> decoder(MfxCreateC2Component(MOCK_COMPONENT_DEC, config, reflector, &sts));
+    EXPECT_EQ(sts, C2_OK);
+    std::shared_ptr<C2Component> encoder(MfxCreateC2Component(MOCK_COMPONENT_ENC, config, reflector, &sts));
+    EXPECT_EQ(sts, C2_OK);
+    ASSERT_NE(decoder, nullptr);
+    ASSERT_NE(encoder, nullptr);
+
+    c2_node_id_t decoder_id = decoder->intf()->getId();
+    c2_node_id_t encoder_id = encoder->intf()->getId();
+    EXPECT_NE(decoder_id, encoder_id);
+
+    EXPECT_EQ(decoder->createTunnel_sm(decoder_id), C2_BAD_VALUE);
+    EXPECT_EQ(decoder->createTunnel_sm(std::max(decoder_id, encoder_id) + 1000), C2_NOT_FOUND);
+    EXPECT_EQ(decoder->createTunnel_sm(encoder_id), C2_OK);
+    EXPECT_EQ(decoder->createTunnel_sm(encoder_id), C2_DUPLICATE);
+
+    std::shared_ptr<MockTunnelValidator> validator = std::make_shared<MockTunnelValidator>();
+    validator->decoder_id_ = decoder_id;
+    validator->encoder_id_ = encoder_id;
+    decoder->setListener_vb(validator, C2_MAY_BLOCK);
+
+    EXPECT_EQ(encoder->start(), C2_OK);
+    EXPECT_EQ(decoder->start(), C2_OK);
+
+    for(uint32_t frame_index = 0; frame_index < FRAME_COUNT; ++frame_index) {
+        std::unique_ptr<C2Work> work;
+        PrepareWork(frame_index, decoder, &work, C2BufferData::LINEAR, C2MemoryUsage::CPU_READ);
+        ASSERT_EQ(work->worklets.size(), 1u);
+        work->worklets.front()->component = decoder_id;
+
+        std::unique_ptr<C2Worklet> encoder_worklet = std::make_unique<C2Worklet>();
+        encoder_worklet->component = encoder_id;
+        encoder_worklet->output.buffers.push_back(nullptr);
+        work->worklets.push_back(std::move(encoder_worklet));
+
+        std::list<std::unique_ptr<C2Work>> works;
+        works.push_back(std::move(work));
+        sts = decoder->queue_nb(&works);
+        EXPECT_EQ(sts, C2_OK);
+    }
+
+    std::future<void> future = validator->GetFuture();
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+    decoder->setListener_vb(nullptr, C2_MAY_BLOCK);
+    EXPECT_EQ(decoder->stop(), C2_OK);
+    EXPECT_EQ(encoder->stop(), C2_OK);
+
+    EXPECT_EQ(decoder->releaseTunnel_sm(encoder_id), C2_OK);
+    EXPECT_EQ(decoder->releaseTunnel_sm(encoder_id), C2_NOT_FOUND);
+}
+
 class C2ComponentStateListener : public C2Component::Listener
 {
 private:
@@ -0,0 +1,550 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures frame rates of decoders and encoders on a set of resolutions
+// and prints them as media codecs performance xml, like media_codecs_performance_tgl.xml.
+// Every component is run for fixed time several times, the range of the produced
+// <Limit name="measured-frame-rate-WxH" range="min-max" /> entries spans
+// the lowest and the highest rate of the runs.
+// Decoders are fed with bitstreams made by the encoder of the same media type
+// just before the measurement, decoders without such encoder are skipped.
+
+#include "test_performance.h"
+
+#include "mfx_c2_defs.h"
+#include "mfx_c2_utils.h"
+#include "C2PlatformSupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <mutex>
+
+using namespace android;
+
+struct CodecDesc
+{
+    const char* name;
+    const char* media_type;
+    bool encoder;
+};
+
+static const CodecDesc g_codecs[] = {
+    { "c2.intel.avc.decoder", "video/avc", false },
+    { "c2.intel.hevc.decoder", "video/hevc", false },
+    { "c2.intel.vp9.decoder", "video/x-vnd.on2.vp9", false },
+    { "c2.intel.vp8.decoder", "video/x-vnd.on2.vp8", false },
+    { "c2.intel.mp2.decoder", "video/mpeg2", false },
+    { "c2.intel.av1.decoder", "video/av01", false },
+    { "c2.intel.avc.encoder", "video/avc", true },
+    { "c2.intel.hevc.encoder", "video/hevc", true },
+    { "c2.intel.vp9.encoder", "video/x-vnd.on2.vp9", true },
+};
+
+struct Resolution
+{
+    uint32_t width;
+    uint32_t height;
+};
+
+// Resolutions measured by CTS MediaCodec performance tests.
+static const Resolution g_resolutions[] = {
+    { 320, 240 },
+    { 352, 288 },
+    { 640, 360 },
+    { 720, 480 },
+    { 1280, 720 },
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+struct Options
+{
+    std::string backend { "hw" };
+    std::string codec; // measure codecs with names containing this string only
+    std::string output; // file name, stdout if empty
+    double duration_s { 3.0 }; // of one run
+    uint32_t runs { 3 };
+    uint32_t depth { 8 }; // works queued to component at once
+};
+
+const uint64_t FRAME_DURATION_US = 1000000 / 30; // timestamps of 30 fps stream
+const uint32_t BITSTREAM_FRAME_COUNT = 30; // decoders loop bitstream of that many frames
+const c2_nsecs_t TIMEOUT_NS = MFX_SECOND_NS;
+const std::chrono::seconds WORK_TIMEOUT(5);
+
+// Counts completed works and produced frames, limits number of works in flight.
+class ThroughputListener : public C2Component::Listener
+{
+public:
+    typedef std::function<void(const C2FrameData& output)> OnOutput;
+
+public:
+    explicit ThroughputListener(OnOutput on_output = {}) : m_onOutput(std::move(on_output)) {}
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight = 0;
+        m_completed = 0;
+        m_produced = 0;
+        m_failed = false;
+    }
+
+    void OnQueued()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_inFlight;
+    }
+
+    // Waits till works in flight are less than limit.
+    c2_status_t WaitInFlightBelow(uint32_t limit)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        bool ready = m_condition.wait_for(lock, WORK_TIMEOUT,
+            [&] { return m_failed || m_inFlight < limit; });
+        return m_failed ? C2_CORRUPTED : (ready ? C2_OK : C2_TIMED_OUT);
+    }
+
+    c2_status_t WaitCompleted(uint64_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        bool ready = m_condition.wait_for(lock, WORK_TIMEOUT,
+            [&] { return m_failed || m_completed >= count; });
+        return m_failed ? C2_CORRUPTED : (ready ? C2_OK : C2_TIMED_OUT);
+    }
+
+    uint64_t GetProduced()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_produced;
+    }
+
+protected:
+    void onWorkDone_nb(std::weak_ptr<C2Component>,
+        std::list<std::unique_ptr<C2Work>> workItems) override
+    {
+        for (std::unique_ptr<C2Work>& work : workItems) {
+            bool produced = false;
+            if (C2_OK == work->result && !work->worklets.empty()) {
+                const C2FrameData& output = work->worklets.front()->output;
+                produced = !output.buffers.empty() && output.buffers.front();
+                if (produced && m_onOutput) {
+                    m_onOutput(output);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_inFlight > 0) --m_inFlight;
+            ++m_completed;
+            if (produced) ++m_produced;
+            if (C2_OK != work->result && C2_NOT_FOUND != work->result) {
+                m_failed = true; // C2_NOT_FOUND is returned for flushed works
+            }
+        }
+        m_condition.notify_all();
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>,
+        std::vector<std::shared_ptr<C2SettingResult>>) override
+    {
+        SetFailed();
+    }
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t) override
+    {
+        SetFailed();
+    }
+
+private:
+    void SetFailed()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_failed = true;
+        }
+        m_condition.notify_all();
+    }
+
+private:
+    OnOutput m_onOutput;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    uint32_t m_inFlight { 0 };
+    uint64_t m_completed { 0 };
+    uint64_t m_produced { 0 };
+    bool m_failed { false };
+};
+
+static std::unique_ptr<C2Work> MakeWork(PerformanceBackend* backend, uint64_t frame_index,
+    std::shared_ptr<C2Buffer> buffer, bool end_of_stream)
+{
+    std::unique_ptr<C2Work> work = std::make_unique<C2Work>();
+    work->input.flags = end_of_stream ? C2FrameData::FLAG_END_OF_STREAM : C2FrameData::flags_t(0);
+    work->input.ordinal.timestamp = frame_index * FRAME_DURATION_US;
+    work->input.ordinal.frameIndex = frame_index;
+    work->input.ordinal.customOrdinal = 0;
+    work->input.buffers.push_back(std::move(buffer));
+    work->worklets.push_back(std::make_unique<C2Worklet>());
+    backend->PrepareWork(work.get());
+    return work;
+}
+
+// Allocates frames for encoder input, frames differ to keep encoder busy.
+static c2_status_t MakeFrames(const std::shared_ptr<C2Component>& component,
+    const Resolution& resolution, uint32_t count, std::vector<std::shared_ptr<C2Buffer>>* frames)
+{
+    std::shared_ptr<C2BlockPool> pool;
+    c2_status_t res = GetCodec2BlockPool(C2BlockPool::BASIC_GRAPHIC, component, &pool);
+
+    C2MemoryUsage mem_usage = { android::C2AndroidMemoryUsage::HW_CODEC_READ, C2MemoryUsage::CPU_WRITE };
+
+    for (uint32_t i = 0; C2_OK == res && i < count; ++i) {
+        std::shared_ptr<C2GraphicBlock> block;
+        res = pool->fetchGraphicBlock(resolution.width, resolution.height,
+            HAL_PIXEL_FORMAT_NV12_TILED_INTEL, mem_usage, &block);
+        if (C2_OK != res) break;
+
+        {
+            std::unique_ptr<C2GraphicView> view;
+            res = MapGraphicBlock(*block, TIMEOUT_NS, &view);
+            if (C2_OK != res) break;
+
+            const C2PlanarLayout layout = view->layout();
+            uint8_t* y = view->data()[C2PlanarLayout::PLANE_Y];
+            uint8_t* uv = view->data()[C2PlanarLayout::PLANE_U];
+            const uint32_t stride = layout.planes[C2PlanarLayout::PLANE_Y].rowInc;
+            // diagonal gradient moving frame by frame
+            for (uint32_t row = 0; row < resolution.height; ++row) {
+                for (uint32_t col = 0; col < resolution.width; ++col) {
+                    y[row * stride + col] = (uint8_t)(row + col + 8 * i);
+                }
+            }
+            for (uint32_t row = 0; row < resolution.height / 2; ++row) {
+                std::fill(uv + row * stride, uv + row * stride + resolution.width, 128);
+            }
+        }
+
+        C2ConstGraphicBlock const_block = block->share(block->crop(), C2Fence());
+        frames->push_back(std::make_shared<C2Buffer>(MakeC2Buffer({ const_block })));
+    }
+    return res;
+}
+
+static c2_status_t MakeLinearBuffer(const std::shared_ptr<C2Component>& component,
+    const std::vector<uint8_t>& data, std::shared_ptr<C2Buffer>* buffer)
+{
+    std::shared_ptr<C2BlockPool> pool;
+    c2_status_t res = GetCodec2BlockPool(C2BlockPool::BASIC_LINEAR, component, &pool);
+
+    do {
+        if (C2_OK != res) break;
+
+        C2MemoryUsage mem_usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+        std::shared_ptr<C2LinearBlock> block;
+        res = pool->fetchLinearBlock(data.size(), mem_usage, &block);
+        if (C2_OK != res) break;
+
+        std::unique_ptr<C2WriteView> write_view;
+        res = MapLinearBlock(*block, TIMEOUT_NS, &write_view);
+        if (C2_OK != res) break;
+
+        std::copy(data.begin(), data.end(), write_view->data());
+
+        C2ConstLinearBlock const_block = block->share(0, data.size(), C2Fence());
+        *buffer = std::make_shared<C2Buffer>(MakeC2Buffer({ const_block }));
+    } while (false);
+
+    return res;
+}
+
+// Queues works produced by source for options.duration_s seconds
+// and computes rate of frames output by component.
+static c2_status_t MeasureFrameRate(const std::shared_ptr<C2Component>& component,
+    const std::shared_ptr<ThroughputListener>& listener,
+    std::function<std::unique_ptr<C2Work>(uint64_t frame_index)> source,
+    const Options& options, double* fps)
+{
+    listener->Reset();
+
+    c2_status_t res = component->start();
+    if (C2_OK != res) return res;
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(options.duration_s);
+
+    for (uint64_t frame_index = 0; std::chrono::steady_clock::now() < deadline; ++frame_index) {
+
+        res = listener->WaitInFlightBelow(options.depth);
+        if (C2_OK != res) break;
+
+        std::list<std::unique_ptr<C2Work>> works;
+        works.push_back(source(frame_index));
+        listener->OnQueued();
+        res = component->queue_nb(&works);
+        if (C2_OK != res) break;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t produced = listener->GetProduced();
+
+    c2_status_t stop_res = component->stop();
+    if (C2_OK == res) res = stop_res;
+
+    if (C2_OK == res) {
+        *fps = produced / elapsed.count();
+    }
+    return res;
+}
+
+// Encodes BITSTREAM_FRAME_COUNT frames with specified encoder, one output buffer per frame.
+static c2_status_t MakeBitstream(PerformanceBackend* backend, const CodecDesc& encoder,
+    const Resolution& resolution, std::vector<std::vector<uint8_t>>* bitstream)
+{
+    std::mutex bitstream_mutex;
+    auto listener = std::make_shared<ThroughputListener>([&] (const C2FrameData& output) {
+        std::unique_ptr<C2ConstLinearBlock> block;
+        std::unique_ptr<C2ReadView> read_view;
+        if (C2_OK == GetC2ConstLinearBlock(output, &block) &&
+            C2_OK == MapConstLinearBlock(*block, TIMEOUT_NS, &read_view)) {
+            const uint8_t* data = read_view->data() + block->offset();
+            std::lock_guard<std::mutex> lock(bitstream_mutex);
+            bitstream->emplace_back(data, data + block->size());
+        }
+    });
+
+    std::shared_ptr<C2Component> component;
+    c2_status_t res = backend->CreateComponent(encoder.name, &component);
+
+    do {
+        if (C2_OK != res) break;
+
+        res = backend->Configure(component, true, resolution.width, resolution.height);
+        if (C2_OK != res) break;
+
+        std::vector<std::shared_ptr<C2Buffer>> frames;
+        res = MakeFrames(component, resolution, BITSTREAM_FRAME_COUNT, &frames);
+        if (C2_OK != res) break;
+
+        res = component->setListener_vb(listener, C2_MAY_BLOCK);
+        if (C2_OK != res) break;
+
+        res = component->start();
+        if (C2_OK != res) break;
+
+        for (uint32_t i = 0; C2_OK == res && i < BITSTREAM_FRAME_COUNT; ++i) {
+            std::list<std::unique_ptr<C2Work>> works;
+            works.push_back(MakeWork(backend, i, frames[i], i == BITSTREAM_FRAME_COUNT - 1));
+            listener->OnQueued();
+            res = component->queue_nb(&works);
+        }
+        if (C2_OK == res) {
+            res = listener->WaitCompleted(BITSTREAM_FRAME_COUNT);
+        }
+
+        component->stop();
+        component->setListener_vb(nullptr, C2_MAY_BLOCK);
+    } while (false);
+
+    if (C2_OK == res && bitstream->empty()) res = C2_CORRUPTED;
+
+    if (component) component->release();
+    return res;
+}
+
+// Measures one codec on one resolution, returns lowest and highest rate of all runs.
+static c2_status_t MeasureCodec(PerformanceBackend* backend, const CodecDesc& codec,
+    const Resolution& resolution, const Options& options, double* min_fps, double* max_fps)
+{
+    std::vector<std::shared_ptr<C2Buffer>> inputs;
+    std::shared_ptr<C2Component> component;
+    auto listener = std::make_shared<ThroughputListener>();
+
+    c2_status_t res = C2_OK;
+
+    do {
+        std::vector<std::vector<uint8_t>> bitstream;
+        if (!codec.encoder) {
+            auto encoder = std::find_if(std::begin(g_codecs), std::end(g_codecs), [&] (const CodecDesc& desc) {
+                return desc.encoder && std::string(desc.media_type) == codec.media_type;
+            });
+            if (encoder == std::end(g_codecs)) {
+                res = C2_OMITTED; // nothing to make a bitstream with
+                break;
+            }
+            res = MakeBitstream(backend, *encoder, resolution, &bitstream);
+            if (C2_OK != res) break;
+        }
+
+        res = backend->CreateComponent(codec.name, &component);
+        if (C2_OK != res) break;
+
+        res = backend->Configure(component, codec.encoder, resolution.width, resolution.height);
+        if (C2_OK != res) break;
+
+        if (codec.encoder) {
+            // one frame per work in flight, so a frame is never queued twice at once
+            res = MakeFrames(component, resolution, options.depth, &inputs);
+        } else {
+            for (const std::vector<uint8_t>& frame : bitstream) {
+                std::shared_ptr<C2Buffer> buffer;
+                res = MakeLinearBuffer(component, frame, &buffer);
+                if (C2_OK != res) break;
+                inputs.push_back(std::move(buffer));
+            }
+        }
+        if (C2_OK != res) break;
+
+        res = component->setListener_vb(listener, C2_MAY_BLOCK);
+        if (C2_OK != res) break;
+
+        auto source = [&] (uint64_t frame_index) {
+            return MakeWork(backend, frame_index, inputs[frame_index % inputs.size()], false);
+        };
+
+        *min_fps = 0;
+        *max_fps = 0;
+        for (uint32_t run = 0; run < options.runs; ++run) {
+            double fps = 0;
+            res = MeasureFrameRate(component, listener, source, options, &fps);
+            if (C2_OK != res) break;
+
+            *min_fps = (run == 0) ? fps : std::min(*min_fps, fps);
+            *max_fps = (run == 0) ? fps : std::max(*max_fps, fps);
+        }
+
+        component->setListener_vb(nullptr, C2_MAY_BLOCK);
+    } while (false);
+
+    if (component) component->release();
+    return res;
+}
+
+static void MeasureCodecs(PerformanceBackend* backend, bool encoders,
+    const Options& options, std::ostream& os)
+{
+    const char* section = encoders ? "Encoders" : "Decoders";
+    os << "    <" << section << ">" << std::endl;
+
+    for (const CodecDesc& codec : g_codecs) {
+        if (codec.encoder != encoders) continue;
+        if (std::string(codec.name).find(options.codec) == std::string::npos) continue;
+
+        os << "        <MediaCodec name=\"" << codec.name << "\" type=\"" << codec.media_type
+           << "\" update=\"true\">" << std::endl;
+
+        for (const Resolution& resolution : g_resolutions) {
+            std::cerr << codec.name << " " << resolution.width << "x" << resolution.height << std::endl;
+
+            double min_fps = 0, max_fps = 0;
+            c2_status_t res = MeasureCodec(backend, codec, resolution, options, &min_fps, &max_fps);
+            if (C2_OK == res) {
+                os << "            <Limit name=\"measured-frame-rate-"
+                   << resolution.width << "x" << resolution.height << "\" range=\""
+                   << (uint32_t)std::floor(min_fps) << "-" << (uint32_t)std::ceil(max_fps)
+                   << "\" />" << std::endl;
+            } else {
+                os << "            <!-- " << resolution.width << "x" << resolution.height
+                   << " is not measured, status " << res << " -->" << std::endl;
+            }
+        }
+
+        os << "        </MediaCodec>" << std::endl;
+    }
+
+    os << "    </" << section << ">" << std::endl;
+}
+
+static void PrintUsage()
+{
+    std::cout << "Usage: mfx_c2_performance [options]" << std::endl
+              << "  --backend <name>   source of components:";
+    for (const std::string& name : GetPerformanceBackendNames()) {
+        std::cout << " " << name;
+    }
+    std::cout << ", hw by default" << std::endl
+              << "  --codec <string>   measure codecs having the string in name only" << std::endl
+              << "  --duration <s>     duration of one run in seconds, 3 by default" << std::endl
+              << "  --runs <n>         number of runs per resolution, 3 by default" << std::endl
+              << "  --depth <n>        works queued to component at once, 8 by default" << std::endl
+              << "  -o <file>          output xml file, stdout by default" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--backend" && has_value) {
+            options.backend = argv[++i];
+        } else if (arg == "--codec" && has_value) {
+            options.codec = argv[++i];
+        } else if (arg == "--duration" && has_value) {
+            options.duration_s = atof(argv[++i]);
+        } else if (arg == "--runs" && has_value) {
+            options.runs = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--depth" && has_value) {
+            options.depth = std::min<uint32_t>(std::max(1, atoi(argv[++i])), BITSTREAM_FRAME_COUNT);
+        } else if (arg == "-o" && has_value) {
+            options.output = argv[++i];
+        } else {
+            std::cout << "Unexpected argument: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::unique_ptr<PerformanceBackend> backend = CreatePerformanceBackend(options.backend);
+    if (!backend) {
+        std::cout << "Unknown backend: " << options.backend << std::endl;
+        PrintUsage();
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cout << "Cannot open " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& os = options.output.empty() ? std::cout : file;
+
+    os << "<?xml version=\"1.0\" encoding=\"utf-8\" ?>" << std::endl
+       << "<!-- Measured by mfx_c2_performance with " << backend->GetName() << " backend, "
+       << options.runs << " runs of " << options.duration_s << " s -->" << std::endl
+       << "<MediaCodecs>" << std::endl;
+
+    MeasureCodecs(backend.get(), false, options, os);
+    MeasureCodecs(backend.get(), true, options, os);
+
+    os << "</MediaCodecs>" << std::endl;
+
+    return 0;
+}
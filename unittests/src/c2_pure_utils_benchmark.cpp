@@ -0,0 +1,236 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+#include "mfx_c2_copy_planes.h"
+#include "mfx_c2_flat_index_map.h"
+#include "mfx_c2_metrics.h"
+#include "mfx_c2_params.h"
+#include "mfx_c2_scene_change.h"
+#include "test_benchmark.h"
+
+// Benchmarks of c2_utils parts having no device dependencies,
+// built into host benchmarks executable too.
+
+using namespace android;
+
+// Indices of parameters typical for encoder configuration.
+static const std::vector<uint32_t> g_paramIndices = {
+    C2ComponentDomainSetting::PARAM_TYPE,
+    C2ComponentKindSetting::PARAM_TYPE,
+    C2ComponentNameSetting::PARAM_TYPE,
+    C2PortActualDelayTuning::input::PARAM_TYPE,
+    C2PortActualDelayTuning::output::PARAM_TYPE,
+    C2PortAllocatorsTuning::output::PARAM_TYPE,
+    C2PortBlockPoolsTuning::output::PARAM_TYPE,
+    C2PortDelayTuning::input::PARAM_TYPE,
+    C2PortDelayTuning::output::PARAM_TYPE,
+    C2PortMediaTypeSetting::input::PARAM_TYPE,
+    C2PortMediaTypeSetting::output::PARAM_TYPE,
+    C2StreamBitrateInfo::output::PARAM_TYPE,
+    C2StreamBitrateModeTuning::output::PARAM_TYPE,
+    C2StreamBufferTypeSetting::input::PARAM_TYPE,
+    C2StreamBufferTypeSetting::output::PARAM_TYPE,
+    C2StreamColorAspectsInfo::input::PARAM_TYPE,
+    C2StreamColorAspectsInfo::output::PARAM_TYPE,
+    C2StreamFrameRateInfo::output::PARAM_TYPE,
+    C2StreamGopTuning::output::PARAM_TYPE,
+    C2StreamIntraRefreshTuning::output::PARAM_TYPE,
+    C2StreamMaxBufferSizeInfo::input::PARAM_TYPE,
+    C2StreamPictureSizeInfo::input::PARAM_TYPE,
+    C2StreamPictureSizeInfo::output::PARAM_TYPE,
+    C2StreamProfileLevelInfo::output::PARAM_TYPE,
+    C2StreamRequestSyncFrameTuning::output::PARAM_TYPE,
+    C2StreamSyncFrameIntervalTuning::output::PARAM_TYPE,
+    C2StreamTemporalLayeringTuning::output::PARAM_TYPE,
+    C2StreamRenditionsTuning::output::PARAM_TYPE,
+    C2StreamSceneChangeDetectionTuning::output::PARAM_TYPE,
+    C2StreamLookAheadDepthTuning::output::PARAM_TYPE,
+};
+
+static const size_t BENCHMARK_ITERATIONS = 1000000;
+
+// Compares lookup of parameter index in flat map against std::map used before.
+TEST(MfxC2FlatIndexMapBenchmark, FindVsStdMap)
+{
+    std::map<uint32_t, size_t> std_map;
+    MfxC2FlatIndexMap<size_t> flat_map;
+
+    for (size_t i = 0; i < g_paramIndices.size(); ++i) {
+        std_map.emplace(g_paramIndices[i], i);
+        flat_map.Emplace(g_paramIndices[i], size_t(i));
+    }
+
+    const size_t count = g_paramIndices.size();
+    size_t std_found = 0;
+    size_t flat_found = 0;
+
+    double std_ns = MeasureNsPerOp(BENCHMARK_ITERATIONS, [&] (size_t i) {
+        auto found = std_map.find(g_paramIndices[i % count]);
+        if (found != std_map.end() && found->second == i % count) ++std_found;
+    });
+
+    double flat_ns = MeasureNsPerOp(BENCHMARK_ITERATIONS, [&] (size_t i) {
+        const size_t* found = flat_map.Find(g_paramIndices[i % count]);
+        if (found && *found == i % count) ++flat_found;
+    });
+
+    EXPECT_EQ(std_found, BENCHMARK_ITERATIONS);
+    EXPECT_EQ(flat_found, BENCHMARK_ITERATIONS);
+
+    PrintBenchmark("std::map find", std_ns);
+    PrintBenchmark("MfxC2FlatIndexMap find", flat_ns);
+}
+
+static const size_t CONTENTION_THREADS[] = { 1, 2, 4, 8 };
+
+// Measures metric updates done on per-frame paths, by one or more threads at once.
+TEST(MfxC2MetricsBenchmark, CounterHistogramUpdate)
+{
+    MfxC2Counter* counter = MfxC2Metrics::GetInstance().GetCounter("benchmark.counter");
+    MfxC2Histogram* histogram = MfxC2Metrics::GetInstance().GetHistogram("benchmark.histogram");
+    ASSERT_NE(counter, nullptr);
+    ASSERT_NE(histogram, nullptr);
+
+    for (size_t thread_count : CONTENTION_THREADS) {
+        const size_t iterations = BENCHMARK_ITERATIONS / thread_count;
+        const uint64_t counted = counter->Get();
+
+        double counter_ns = MeasureNsPerOpThreaded(thread_count, iterations, [&] (size_t, size_t) {
+            counter->Add();
+        });
+        double histogram_ns = MeasureNsPerOpThreaded(thread_count, iterations, [&] (size_t, size_t i) {
+            histogram->Record(i);
+        });
+
+        EXPECT_EQ(counter->Get() - counted, thread_count * iterations);
+
+        std::string threads = ", " + std::to_string(thread_count) + " threads";
+        PrintBenchmark("MfxC2Counter::Add" + threads, counter_ns);
+        PrintBenchmark("MfxC2Histogram::Record" + threads, histogram_ns);
+    }
+}
+
+// Measures scene change detection on 1080p luma, done for every encoded frame if enabled.
+TEST(MfxC2SceneChangeDetectorBenchmark, DetectSceneChange)
+{
+    const uint32_t WIDTH = 1920;
+    const uint32_t HEIGHT = 1080;
+    const size_t FRAME_COUNT = 60;
+    // frames of the same scene are shifted gradients, every 30th frame starts the new one
+    const size_t SCENE_LENGTH = 30;
+
+    std::vector<std::vector<uint8_t>> frames(FRAME_COUNT, std::vector<uint8_t>(WIDTH * HEIGHT));
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        const uint32_t scene = i / SCENE_LENGTH;
+        for (uint32_t y = 0; y < HEIGHT; ++y) {
+            for (uint32_t x = 0; x < WIDTH; ++x) {
+                frames[i][y * WIDTH + x] = scene ?
+                    ((((x / 32) + ((y + i) / 32)) % 2) ? 235 : 64) : (uint8_t)((x + i) / 8 + y / 8);
+            }
+        }
+    }
+
+    MfxC2SceneChangeDetector detector;
+    size_t detected = 0;
+
+    double ns = MeasureNsPerOp(FRAME_COUNT * 10, [&] (size_t i) {
+        if (i % FRAME_COUNT == 0) detector.Reset();
+        if (detector.DetectSceneChange(frames[i % FRAME_COUNT].data(), WIDTH, HEIGHT, WIDTH)) ++detected;
+    });
+
+    EXPECT_EQ(detected, 10u); // one cut within every pass
+
+    PrintBenchmark("MfxC2SceneChangeDetector 1080p", ns, WIDTH * HEIGHT);
+}
+
+// 8-bit YUV 4:2:0 layout with chroma either interleaved (NV12) or in separate planes (I420).
+static C2PlanarLayout MakeYuv420Layout(bool semi_planar, uint32_t pitch)
+{
+    C2PlanarLayout layout {};
+    layout.type = C2PlanarLayout::TYPE_YUV;
+    layout.numPlanes = 3;
+    layout.rootPlanes = semi_planar ? 2 : 3;
+
+    for (uint32_t i = 0; i < layout.numPlanes; ++i) {
+        C2PlaneInfo& plane = layout.planes[i];
+        bool chroma = (i != C2PlanarLayout::PLANE_Y);
+        plane.channel = (i == C2PlanarLayout::PLANE_Y) ? C2PlaneInfo::CHANNEL_Y :
+            (i == C2PlanarLayout::PLANE_U) ? C2PlaneInfo::CHANNEL_CB : C2PlaneInfo::CHANNEL_CR;
+        plane.colInc = (chroma && semi_planar) ? 2 : 1;
+        plane.rowInc = (chroma && !semi_planar) ? pitch / 2 : pitch;
+        plane.colSampling = chroma ? 2 : 1;
+        plane.rowSampling = chroma ? 2 : 1;
+        plane.allocatedDepth = 8;
+        plane.bitDepth = 8;
+        plane.rightShift = 0;
+        plane.endianness = C2PlaneInfo::NATIVE;
+        plane.rootIx = (semi_planar && i == C2PlanarLayout::PLANE_V) ? C2PlanarLayout::PLANE_U : i;
+        plane.offset = (semi_planar && i == C2PlanarLayout::PLANE_V) ? 1 : 0;
+    }
+    return layout;
+}
+
+// Measures 1080p copy between NV12 and I420 layouts and between NV12 of different pitches,
+// done for input frames not matching encoder surface layout.
+TEST(C2UtilsBenchmark, CopyPlanes)
+{
+    const uint32_t WIDTH = 1920;
+    const uint32_t HEIGHT = 1080;
+    const uint32_t PITCH = 2048;
+    const size_t ITERATIONS = 100;
+    const size_t FRAME_SIZE = PITCH * HEIGHT * 3 / 2;
+
+    std::vector<uint8_t> nv12(FRAME_SIZE, 0x80), i420(FRAME_SIZE, 0x80), nv12_out(FRAME_SIZE);
+
+    const C2PlanarLayout nv12_layout = MakeYuv420Layout(true, PITCH);
+    const C2PlanarLayout i420_layout = MakeYuv420Layout(false, PITCH);
+    const C2PlanarLayout nv12_out_layout = MakeYuv420Layout(true, WIDTH);
+
+    uint8_t* nv12_data[] = { nv12.data(), nv12.data() + PITCH * HEIGHT, nv12.data() + PITCH * HEIGHT + 1 };
+    uint8_t* i420_data[] = { i420.data(), i420.data() + PITCH * HEIGHT, i420.data() + PITCH * HEIGHT * 5 / 4 };
+    uint8_t* nv12_out_data[] = { nv12_out.data(), nv12_out.data() + WIDTH * HEIGHT, nv12_out.data() + WIDTH * HEIGHT + 1 };
+
+    struct Case {
+        const char* name;
+        const C2PlanarLayout& src_layout;
+        uint8_t* const* src_data;
+        const C2PlanarLayout& dst_layout;
+        uint8_t* const* dst_data;
+    };
+    const Case cases[] = {
+        { "I420 -> NV12", i420_layout, i420_data, nv12_layout, nv12_data },
+        { "NV12 -> I420", nv12_layout, nv12_data, i420_layout, i420_data },
+        { "NV12 -> NV12 another pitch", nv12_layout, nv12_data, nv12_out_layout, nv12_out_data },
+    };
+
+    for (const Case& c : cases) {
+        c2_status_t copy_res = C2_OK;
+        double ns = MeasureNsPerOp(ITERATIONS, [&] (size_t) {
+            c2_status_t res = CopyPlanes(WIDTH, HEIGHT, c.src_layout, c.src_data, c.dst_layout, c.dst_data);
+            if (C2_OK != res) copy_res = res;
+        });
+        EXPECT_EQ(copy_res, C2_OK) << c.name;
+
+        PrintBenchmark(std::string("CopyPlanes 1080p ") + c.name, ns, WIDTH * HEIGHT * 3 / 2);
+    }
+}
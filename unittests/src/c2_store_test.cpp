@@ -22,9 +22,12 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <set>
 #include <gtest/gtest.h>
 
 #include "mfx_c2_store.h"
+#include "mfx_c2_store_registry.h"
+#include "mfx_c2_store_capacity.h"
 #include "mfx_defs.h"
 #include "mfx_debug.h"
 #include "c2_store_test.h"
@@ -58,6 +61,8 @@ static std::shared_ptr<C2ComponentStore> CreateComponentStore()
         result.reset(MfxC2ComponentStore::Create(&status));
         EXPECT_EQ(status, C2_OK);
         EXPECT_TRUE(result);
+        // configuration files are parsed on the first listing
+        if (result) result->listComponents();
         RestoreConfFile();
         RestoreXmlConfFile();
     }
@@ -79,7 +84,8 @@ TEST(MfxComponentStore, Create)
 }
 
 // Tests if store returns correct list of supported components.
-// A list should be equal to the list prepared by test in file /vendor/etc/mfx_c2_store.conf
+// A list should be equal to built-in components list overridden and extended
+// by the list prepared by test in file /vendor/etc/mfx_c2_store.conf
 // For this test the running device should be rooted and remounted to able to write to /etc dir.
 TEST(MfxComponentStore, getComponents)
 {
@@ -88,12 +94,19 @@ TEST(MfxComponentStore, getComponents)
 
     auto components = componentStore->listComponents();
 
-    EXPECT_EQ(components.size(), MFX_GET_ARRAY_SIZE(g_components));
+    std::set<std::string> expected_names;
+    for (size_t i = 0; i < g_mfxC2StoreComponentsCount; ++i) {
+        expected_names.insert(g_mfxC2StoreComponents[i].name);
+    }
+    for (const auto& expected_comp : g_components) {
+        expected_names.insert(expected_comp.component_name);
+    }
+    EXPECT_EQ(components.size(), expected_names.size());
 
-    for (const auto& actual_comp : components) {
+    for (const auto& expected_comp : g_components) {
 
         bool found = false;
-        for (const auto& expected_comp : g_components) {
+        for (const auto& actual_comp : components) {
             if (actual_comp->name == expected_comp.component_name) {
                 EXPECT_NE(actual_comp->mediaType, "");
                 EXPECT_EQ(actual_comp->mediaType, expected_comp.media_type);
@@ -105,7 +118,7 @@ TEST(MfxComponentStore, getComponents)
             }
         }
 
-        EXPECT_EQ(found, true);
+        EXPECT_EQ(found, true) << expected_comp.component_name;
     }
 }
 
@@ -173,7 +186,56 @@ TEST(MfxComponentStore, createInterface)
     }
 }
 
-// Checks C2ComponentStore::copyBuffer returns C2_OMITTED for now.
+// Checks the store created without configuration files on the device gets
+// the same components from built-in table as the store parsing configuration files
+// with the same contents.
+TEST(MfxComponentStore, BuiltinConfig)
+{
+    std::vector<ComponentDesc> builtin_components;
+    for (size_t i = 0; i < g_mfxC2StoreComponentsCount; ++i) {
+        const MfxC2StoreComponentEntry& entry = g_mfxC2StoreComponents[i];
+        builtin_components.push_back(
+            { entry.name, entry.media_type, entry.kind, entry.dso_name, entry.flags, C2_OK });
+    }
+
+    // Configuration files are parsed on the first listing, so stores are listed
+    // before the files are restored.
+    std::vector<std::shared_ptr<const C2Component::Traits>> builtin_list;
+    {
+        HideConfFile();
+        c2_status_t status = C2_OK;
+        std::shared_ptr<C2ComponentStore> builtin_store(MfxC2ComponentStore::Create(&status));
+        EXPECT_EQ(status, C2_OK);
+        if (builtin_store) builtin_list = builtin_store->listComponents();
+        RestoreConfFile();
+        ASSERT_NE(builtin_store, nullptr);
+    }
+
+    std::vector<std::shared_ptr<const C2Component::Traits>> parsing_list;
+    {
+        EXPECT_TRUE(PrepareConfFile(builtin_components.data(), builtin_components.size()));
+        EXPECT_TRUE(PrepareXmlConfFile(builtin_components.data(), builtin_components.size()));
+        c2_status_t status = C2_OK;
+        std::shared_ptr<C2ComponentStore> parsing_store(MfxC2ComponentStore::Create(&status));
+        EXPECT_EQ(status, C2_OK);
+        if (parsing_store) parsing_list = parsing_store->listComponents();
+        RestoreConfFile();
+        RestoreXmlConfFile();
+        ASSERT_NE(parsing_store, nullptr);
+    }
+
+    EXPECT_EQ(builtin_list.size(), g_mfxC2StoreComponentsCount);
+    ASSERT_EQ(builtin_list.size(), parsing_list.size());
+
+    for (size_t i = 0; i < builtin_list.size(); ++i) { // both lists are sorted by name
+        EXPECT_EQ(builtin_list[i]->name, parsing_list[i]->name);
+        EXPECT_EQ(builtin_list[i]->mediaType, parsing_list[i]->mediaType) << builtin_list[i]->name;
+        EXPECT_EQ(builtin_list[i]->kind, parsing_list[i]->kind) << builtin_list[i]->name;
+        EXPECT_EQ(builtin_list[i]->domain, parsing_list[i]->domain) << builtin_list[i]->name;
+    }
+}
+
+// Checks C2ComponentStore::copyBuffer rejects missing buffers.
 TEST(MfxComponentStore, copyBuffer)
 {
     std::shared_ptr<C2ComponentStore> componentStore = GetCachedC2ComponentStore();
@@ -183,7 +245,7 @@ TEST(MfxComponentStore, copyBuffer)
     std::shared_ptr<C2GraphicBuffer> dst;
 
     c2_status_t status = componentStore->copyBuffer(src, dst);
-    EXPECT_EQ(status, C2_OMITTED);
+    EXPECT_EQ(status, C2_BAD_VALUE);
 }
 
 // Checks C2ComponentStore::query_sm (query global store parameter)
@@ -252,3 +314,35 @@ TEST(MfxComponentStore, getParamReflector)
         }
     }
 }
+
+// Checks load estimation from measured frame rates:
+// closest not smaller measured resolution is taken, lower bound of frame rate range is used.
+TEST(MfxC2StoreCapacity, GetLoad)
+{
+    const char* xml_path = MFX_C2_DUMP_DIR "/mfx_c2_performance_test.xml";
+    {
+        std::ofstream xml_file(xml_path);
+        xml_file << "<MediaCodecs><Encoders>"
+            "<MediaCodec name=\"c2.test.encoder\" type=\"video/avc\" update=\"true\">"
+            "<Limit name=\"measured-frame-rate-1280x720\" range=\"100-150\" />"
+            "<Limit name=\"measured-frame-rate-1920x1080\" range=\"60-80\" />"
+            "</MediaCodec></Encoders></MediaCodecs>";
+    }
+
+    MfxC2StoreCapacity capacity;
+    EXPECT_EQ(capacity.ReadConfig(xml_path), C2_OK);
+    EXPECT_TRUE(capacity.IsEnabled());
+    remove(xml_path);
+
+    EXPECT_FLOAT_EQ(capacity.GetLoad("c2.test.encoder", 1920, 1080, 60), 1.0f);
+    EXPECT_FLOAT_EQ(capacity.GetLoad("c2.test.encoder", 1920, 1080, 30), 0.5f);
+    EXPECT_FLOAT_EQ(capacity.GetLoad("c2.test.encoder", 1280, 720, 50), 0.5f);
+    // 640x360 is measured as 1280x720, 4 times less pixels
+    EXPECT_FLOAT_EQ(capacity.GetLoad("c2.test.encoder", 640, 360, 100), 0.25f);
+    // above all measured resolutions the biggest one is scaled
+    EXPECT_FLOAT_EQ(capacity.GetLoad("c2.test.encoder", 3840, 2160, 15), 1.0f);
+    // frame rate defaults to 30
+    EXPECT_FLOAT_EQ(capacity.GetLoad("c2.test.encoder", 1920, 1080, 0), 0.5f);
+
+    EXPECT_EQ(capacity.GetLoad("c2.unknown.encoder", 1920, 1080, 30), 0.0f);
+}
@@ -0,0 +1,189 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "mfx_cmd_queue.h"
+#include "mfx_debug.h"
+#include "mfx_pool.h"
+#include "mfx_c2_param_storage.h"
+#include "mfx_c2_params.h"
+#include "test_benchmark.h"
+
+using namespace android;
+
+static const size_t BENCHMARK_ITERATIONS = 1000000;
+
+// Measures query and update of a stored value, done for per-frame infos and tunings.
+TEST(MfxC2ParamStorageBenchmark, QueryUpdateValue)
+{
+    MfxC2ParamStorage storage(std::make_shared<MfxC2ParamReflector>());
+
+    storage.AddValue(C2_PARAMKEY_BITRATE,
+        std::make_unique<C2StreamBitrateInfo::output>(0u, 1000000));
+    storage.AddValue(C2_PARAMKEY_FRAME_RATE,
+        std::make_unique<C2StreamFrameRateInfo::output>(0u, 30.0));
+    storage.AddValue(C2_PARAMKEY_PICTURE_SIZE,
+        std::make_unique<C2StreamPictureSizeInfo::output>(0u, 1920, 1080));
+    storage.AddValue(C2_PARAMKEY_REQUEST_SYNC_FRAME,
+        std::make_unique<C2StreamRequestSyncFrameTuning::output>(0u, C2_FALSE));
+
+    C2StreamBitrateInfo::output bitrate;
+    C2Param* dst = &bitrate;
+
+    c2_status_t query_res = C2_OK;
+    double query_ns = MeasureNsPerOp(BENCHMARK_ITERATIONS, [&] (size_t) {
+        c2_status_t res = storage.QueryParam(C2StreamBitrateInfo::output::PARAM_TYPE, &dst);
+        if (C2_OK != res) query_res = res;
+    });
+    EXPECT_EQ(query_res, C2_OK);
+    EXPECT_EQ(bitrate.value, 1000000u);
+
+    c2_status_t update_res = C2_OK;
+    double update_ns = MeasureNsPerOp(BENCHMARK_ITERATIONS, [&] (size_t i) {
+        c2_status_t res = storage.UpdateValue(C2StreamRequestSyncFrameTuning::output::PARAM_TYPE,
+            std::make_unique<C2StreamRequestSyncFrameTuning::output>(0u, (i & 1) ? C2_TRUE : C2_FALSE));
+        if (C2_OK != res) update_res = res;
+    });
+    EXPECT_EQ(update_res, C2_OK);
+
+    PrintBenchmark("MfxC2ParamStorage::QueryParam", query_ns);
+    PrintBenchmark("MfxC2ParamStorage::UpdateValue", update_ns);
+}
+
+static const size_t CONTENTION_ITERATIONS = 100000;
+static const size_t CONTENTION_THREADS[] = { 1, 2, 4, 8 };
+
+// Measures time from MfxCmdQueue::Push to start of the task execution in working thread,
+// the next task is pushed when previous one started, so the working thread wakes up every time.
+TEST(MfxCmdQueueBenchmark, PushToExecuteLatency)
+{
+    const size_t ITERATIONS = 10000;
+
+    MfxCmdQueue queue;
+    queue.Start();
+
+    std::atomic<bool> executed { false };
+    std::chrono::steady_clock::time_point executed_time;
+    double latency_ns = 0;
+
+    size_t allocations = GetAllocationCount();
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        executed = false;
+        auto pushed_time = std::chrono::steady_clock::now();
+        queue.Push([&] () {
+            executed_time = std::chrono::steady_clock::now();
+            executed = true;
+        });
+        while (!executed) std::this_thread::yield();
+
+        latency_ns += std::chrono::duration<double, std::nano>(executed_time - pushed_time).count();
+    }
+    allocations = GetAllocationCount() - allocations;
+
+    queue.Stop();
+
+    PrintBenchmark("MfxCmdQueue push to execute latency", latency_ns / ITERATIONS);
+    PrintAllocations("MfxCmdQueue push", (double)allocations / ITERATIONS);
+}
+
+// Measures throughput of MfxCmdQueue filled by one or more threads at once.
+TEST(MfxCmdQueueBenchmark, Throughput)
+{
+    for (size_t thread_count : CONTENTION_THREADS) {
+        MfxCmdQueue queue;
+        queue.Start();
+
+        std::atomic<size_t> executed { 0 };
+
+        size_t allocations = GetAllocationCount();
+        auto start = std::chrono::steady_clock::now();
+        double push_ns = MeasureNsPerOpThreaded(thread_count, CONTENTION_ITERATIONS, [&] (size_t, size_t) {
+            queue.Push([&] () { ++executed; });
+        });
+        queue.WaitForEmpty();
+        auto end = std::chrono::steady_clock::now();
+        allocations = GetAllocationCount() - allocations;
+
+        queue.Stop();
+
+        const size_t total = thread_count * CONTENTION_ITERATIONS;
+        EXPECT_EQ(executed, total);
+
+        std::string threads = ", " + std::to_string(thread_count) + " threads";
+        PrintBenchmark("MfxCmdQueue push" + threads, push_ns);
+        PrintBenchmark("MfxCmdQueue push until executed" + threads,
+            std::chrono::duration<double, std::nano>(end - start).count() / total);
+        PrintAllocations("MfxCmdQueue push" + threads, (double)allocations / total);
+    }
+}
+
+// Measures MfxPool Alloc and release of the allocated item done by several threads,
+// pool has as many items as threads, so they compete for the pool lock but never wait for an item.
+TEST(MfxPoolBenchmark, AllocRelease)
+{
+    for (size_t thread_count : CONTENTION_THREADS) {
+        MfxPool<int> pool;
+        for (size_t i = 0; i < thread_count; ++i) {
+            pool.Append(std::make_unique<int>(i));
+        }
+
+        std::atomic<size_t> failed { 0 };
+
+        size_t allocations = GetAllocationCount();
+        double ns = MeasureNsPerOpThreaded(thread_count, CONTENTION_ITERATIONS, [&] (size_t, size_t) {
+            std::shared_ptr<int> item = pool.Alloc();
+            if (!item) ++failed;
+        });
+        allocations = GetAllocationCount() - allocations;
+
+        EXPECT_EQ(failed, 0u);
+
+        std::string name = "MfxPool alloc/release, " + std::to_string(thread_count) + " threads";
+        PrintBenchmark(name, ns);
+        PrintAllocations(name, (double)allocations / (thread_count * CONTENTION_ITERATIONS));
+    }
+}
+
+#if MFX_DEBUG == MFX_DEBUG_YES
+// Measures MfxTraceable registration and name lookup done by every traced object,
+// all threads share the same registry lock.
+TEST(MfxTraceableBenchmark, RegisterGetName)
+{
+    for (size_t thread_count : CONTENTION_THREADS) {
+        std::atomic<size_t> failed { 0 };
+
+        size_t allocations = GetAllocationCount();
+        double ns = MeasureNsPerOpThreaded(thread_count, CONTENTION_ITERATIONS, [&] (size_t, size_t) {
+            int object = 0;
+            MFX_TRACEABLE(object);
+            if (!MFX_PTR_NAME(&object)) ++failed;
+        });
+        allocations = GetAllocationCount() - allocations;
+
+        EXPECT_EQ(failed, 0u);
+
+        std::string name = "MfxTraceable register/get name, " + std::to_string(thread_count) + " threads";
+        PrintBenchmark(name, ns);
+        PrintAllocations(name, (double)allocations / (thread_count * CONTENTION_ITERATIONS));
+    }
+}
+#endif
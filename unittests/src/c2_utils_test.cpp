@@ -26,8 +26,18 @@
 #include "mfx_frame_pool_allocator.h"
 #include "C2PlatformSupport.h"
 #include "mfx_c2_utils.h"
+#include "mfx_c2_scene_change.h"
+#include "mfx_c2_snapshot.h"
+#include "mfx_c2_flat_index_map.h"
+#include "mfx_c2_metrics.h"
+#include "mfx_c2_async_writer.h"
+#include "mfx_binary_trace.h"
+#include "mfx_debug.h"
+#include <algorithm>
 #include <map>
 #include <set>
+#include <sstream>
+#include <unistd.h>
 #include "test_streams.h"
 #include "streams/h264/stream_nv12_176x144_cqp_g30_100.264.h"
 #include "streams/h264/stream_nv12_352x288_cqp_g15_100.264.h"
@@ -357,6 +367,418 @@ TEST(MfxPool, Alloc)
     }
 }
 
+// Tests readers of MfxC2Snapshot always see consistent values
+// while writer publishes new ones, and keep old values alive.
+TEST(MfxC2Snapshot, ConcurrentReadWrite)
+{
+    struct Pair
+    {
+        int first;
+        int second;
+    };
+    const int UPDATE_COUNT = 10000;
+    const int READER_COUNT = 4;
+
+    MfxC2Snapshot<Pair> snapshot(Pair{ 0, 0 });
+
+    std::shared_ptr<const Pair> initial = snapshot.Load();
+    ASSERT_NE(initial, nullptr);
+
+    std::atomic<bool> done { false };
+    std::atomic<int> inconsistent_count { 0 };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READER_COUNT; ++i) {
+        readers.emplace_back([&] {
+            int last_seen = 0;
+            while (!done) {
+                std::shared_ptr<const Pair> value = snapshot.Load();
+                // values are published completely and never go back
+                if (value->first != value->second || value->first < last_seen) {
+                    ++inconsistent_count;
+                }
+                last_seen = value->first;
+            }
+        });
+    }
+
+    for (int i = 1; i <= UPDATE_COUNT; ++i) {
+        snapshot.Update([i] (Pair* value) {
+            value->first = i;
+            value->second = i;
+        });
+    }
+    done = true;
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(inconsistent_count, 0);
+    EXPECT_EQ(snapshot.Load()->first, UPDATE_COUNT);
+    EXPECT_EQ(initial->first, 0); // retained value isn't changed by updates
+}
+
+// Tests MfxC2FlatIndexMap finds everything inserted, including keys colliding
+// in low bits, and keeps first inserted value for duplicate keys.
+TEST(MfxC2FlatIndexMap, EmplaceFind)
+{
+    const uint32_t COUNT = 1000;
+    MfxC2FlatIndexMap<uint32_t> map;
+
+    EXPECT_EQ(map.Find(0), nullptr);
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        // keys differ in high bits only, like the same param of different streams
+        auto emplaced = map.Emplace(i << 17, i * 2);
+        EXPECT_TRUE(emplaced.second);
+        EXPECT_EQ(*emplaced.first, i * 2);
+    }
+
+    auto emplaced = map.Emplace(5 << 17, 0);
+    EXPECT_FALSE(emplaced.second);
+    EXPECT_EQ(*emplaced.first, 10u);
+
+    EXPECT_EQ(map.Size(), COUNT);
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        const uint32_t* found = map.Find(i << 17);
+        ASSERT_NE(found, nullptr);
+        EXPECT_EQ(*found, i * 2);
+        EXPECT_EQ(map.Find((i << 17) + 1), nullptr);
+        EXPECT_EQ(map.KeyAt(i), i << 17);
+    }
+
+    map.Clear();
+    EXPECT_EQ(map.Size(), 0u);
+    EXPECT_EQ(map.Find(0), nullptr);
+}
+
+// Tests MfxC2Metrics returns the same metric for the same name and
+// its counters and histograms don't lose updates made from several threads.
+TEST(MfxC2Metrics, ConcurrentUpdates)
+{
+    const uint64_t UPDATE_COUNT = 10000;
+    const int THREAD_COUNT = 4;
+
+    MfxC2Metrics& metrics = MfxC2Metrics::GetInstance();
+    MfxC2Counter* counter = metrics.GetCounter("test.metrics.counter");
+    MfxC2Gauge* gauge = metrics.GetGauge("test.metrics.gauge");
+    MfxC2Histogram* histogram = metrics.GetHistogram("test.metrics.histogram");
+
+    EXPECT_EQ(counter, metrics.GetCounter("test.metrics.counter"));
+    EXPECT_EQ(histogram, metrics.GetHistogram("test.metrics.histogram"));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&] {
+            for (uint64_t value = 1; value <= UPDATE_COUNT; ++value) {
+                counter->Add();
+                gauge->Add(1);
+                histogram->Record(value);
+                gauge->Add(-1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(counter->Get(), THREAD_COUNT * UPDATE_COUNT);
+    EXPECT_EQ(gauge->Get(), 0);
+
+    MfxC2Histogram::Summary summary = histogram->GetSummary();
+    EXPECT_EQ(summary.count, THREAD_COUNT * UPDATE_COUNT);
+    EXPECT_EQ(summary.sum, THREAD_COUNT * UPDATE_COUNT * (UPDATE_COUNT + 1) / 2);
+    EXPECT_EQ(summary.min, 1u);
+    EXPECT_EQ(summary.max, UPDATE_COUNT);
+    // values are uniform in [1, 10000], median 5000 is interpolated in bucket [4608, 5119]
+    EXPECT_EQ(summary.GetPercentile(50), 5000u);
+    EXPECT_EQ(summary.GetPercentile(100), UPDATE_COUNT);
+    EXPECT_EQ(summary.GetPercentile(0), 1u);
+
+    std::string dump = metrics.Dump();
+    EXPECT_NE(dump.find("counter test.metrics.counter 40000\n"), std::string::npos);
+    EXPECT_NE(dump.find("histogram test.metrics.histogram count=40000 min=1 max=10000"), std::string::npos);
+}
+
+// Tests MfxC2Histogram percentiles are within 1/8 of recorded values
+// and mfxPerf aggregates scope durations into the histogram of its label.
+TEST(MfxPerf, AggregatesDurations)
+{
+    MfxC2Histogram histogram;
+    // all values equal min give exact percentiles
+    for (int i = 0; i < 100; ++i) histogram.Record(100);
+    MfxC2Histogram::Summary summary = histogram.GetSummary();
+    EXPECT_EQ(summary.GetPercentile(50), 100u);
+    EXPECT_EQ(summary.GetPercentile(99), 100u);
+
+    // every value is in the bucket of its own, bucket bounds cover values continuously
+    for (uint64_t value = 0; value < 1000; ++value) {
+        size_t index = MfxC2Histogram::GetBucketIndex(value);
+        std::pair<uint64_t, uint64_t> bounds = MfxC2Histogram::GetBucketBounds(index);
+        EXPECT_LE(bounds.first, value);
+        EXPECT_GE(bounds.second, value);
+        EXPECT_LE((bounds.second - bounds.first) * MfxC2Histogram::SUB_BUCKET_COUNT, value);
+    }
+    EXPECT_EQ(MfxC2Histogram::GetBucketIndex(UINT64_MAX), MfxC2Histogram::BUCKET_COUNT - 1);
+    EXPECT_EQ(MfxC2Histogram::GetBucketBounds(MfxC2Histogram::BUCKET_COUNT - 1).second, UINT64_MAX);
+
+    // 90 fast values, 10 slow
+    MfxC2Histogram fast_slow;
+    for (int i = 0; i < 90; ++i) fast_slow.Record(100);
+    for (int i = 0; i < 10; ++i) fast_slow.Record(5000);
+
+    summary = fast_slow.GetSummary();
+    EXPECT_EQ(summary.count, 100u);
+    EXPECT_EQ(summary.min, 100u);
+    EXPECT_EQ(summary.max, 5000u);
+    EXPECT_EQ(summary.GetPercentile(50), 100u); // limited by min
+    EXPECT_NEAR(summary.GetPercentile(90), 100, 100 / 8);
+    EXPECT_NEAR(summary.GetPercentile(91), 5000, 5000 / 8);
+    EXPECT_EQ(summary.GetPercentile(99), 5000u); // limited by max
+
+    const int SCOPE_COUNT = 5;
+    const std::chrono::milliseconds SCOPE_DURATION(2);
+
+    MfxC2Histogram* perf_histogram = mfxPerf::GetHistogram("test", "scope", "task");
+    EXPECT_EQ(perf_histogram, mfxPerf::GetHistogram("test", "scope", "task"));
+    EXPECT_NE(perf_histogram, mfxPerf::GetHistogram("test", "scope", nullptr));
+
+    for (int i = 0; i < SCOPE_COUNT; ++i) {
+        mfxPerf perf(perf_histogram);
+        std::this_thread::sleep_for(SCOPE_DURATION);
+    }
+
+    summary = perf_histogram->GetSummary();
+    EXPECT_EQ(summary.count, (uint64_t)SCOPE_COUNT);
+    EXPECT_GE(summary.min, (uint64_t)std::chrono::microseconds(SCOPE_DURATION).count());
+    EXPECT_LE(summary.min, summary.GetPercentile(50));
+    EXPECT_LE(summary.GetPercentile(50), summary.GetPercentile(99));
+    EXPECT_LE(summary.GetPercentile(99), summary.max);
+
+    std::string dump = MfxC2Metrics::GetInstance().Dump();
+    EXPECT_NE(dump.find("histogram perf.test:scope:task count=5 "), std::string::npos);
+}
+
+// Parses trace saved by MfxBinaryTrace::Save into names and events per thread.
+static bool ParseBinaryTrace(const std::string& trace, std::vector<std::string>* names,
+    std::map<uint32_t, std::vector<MfxBinaryTraceEvent>>* threads)
+{
+    size_t offset = 0;
+    auto read = [&] (void* dst, size_t size) {
+        if (offset + size > trace.size()) return false;
+        memcpy(dst, trace.data() + offset, size);
+        offset += size;
+        return true;
+    };
+
+    char magic[8] {};
+    uint32_t version = 0, event_size = 0, count = 0;
+    uint64_t clocks[2] {};
+    if (!read(magic, sizeof(magic)) || memcmp(magic, "MFXC2TRC", sizeof(magic))) return false;
+    if (!read(&version, sizeof(version)) || version != 1) return false;
+    if (!read(&event_size, sizeof(event_size)) || event_size != sizeof(MfxBinaryTraceEvent)) return false;
+    if (!read(clocks, sizeof(clocks))) return false;
+
+    if (!read(&count, sizeof(count))) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t length = 0;
+        if (!read(&length, sizeof(length)) || offset + length > trace.size()) return false;
+        names->emplace_back(trace.data() + offset, length);
+        offset += length;
+    }
+
+    if (!read(&count, sizeof(count))) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t tid = 0, event_count = 0;
+        if (!read(&tid, sizeof(tid)) || !read(&event_count, sizeof(event_count))) return false;
+        std::vector<MfxBinaryTraceEvent> events(event_count);
+        if (!read(events.data(), event_count * sizeof(MfxBinaryTraceEvent))) return false;
+        auto& thread_events = (*threads)[tid];
+        thread_events.insert(thread_events.end(), events.begin(), events.end());
+    }
+    return offset == trace.size();
+}
+
+// Tests MfxBinaryTrace keeps the latest events of every thread, including exited ones,
+// saves them in decodable format and writes nothing when disabled.
+TEST(MfxBinaryTrace, SaveThreads)
+{
+    const int THREAD_COUNT = 2;
+    const uint32_t ITERATIONS = MfxBinaryTrace::RING_SIZE; // twice more events than ring keeps
+
+    auto trace_func = [] (uint32_t iterations) {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            static const uint32_t name_id = MfxBinaryTrace::RegisterName("test", "trace_func");
+            MfxBinaryTraceScope scope(name_id);
+        }
+    };
+
+    MfxBinaryTrace::Enable(true);
+
+    std::atomic<int> started { 0 };
+    std::vector<std::thread> threads;
+    std::vector<uint32_t> tids(THREAD_COUNT);
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&, i] {
+            tids[i] = gettid();
+            // rings are taken on the first event, keep threads alive together
+            // till then, so they don't share a ring
+            trace_func(1);
+            ++started;
+            while (started < THREAD_COUNT) std::this_thread::yield();
+            trace_func(ITERATIONS - 1);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    MfxBinaryTrace::Enable(false);
+    std::thread(trace_func, 1).join();
+
+    std::ostringstream os;
+    EXPECT_TRUE(MfxBinaryTrace::Save(os));
+
+    std::vector<std::string> names;
+    std::map<uint32_t, std::vector<MfxBinaryTraceEvent>> saved_threads;
+    ASSERT_TRUE(ParseBinaryTrace(os.str(), &names, &saved_threads));
+
+    auto name_it = std::find(names.begin(), names.end(), "test:trace_func");
+    ASSERT_NE(name_it, names.end());
+    const uint32_t name_id = name_it - names.begin();
+
+    for (uint32_t tid : tids) {
+        ASSERT_EQ(saved_threads.count(tid), 1u);
+        const std::vector<MfxBinaryTraceEvent>& events = saved_threads[tid];
+
+        EXPECT_EQ(events.size(), MfxBinaryTrace::RING_SIZE);
+        for (size_t i = 0; i < events.size(); ++i) {
+            EXPECT_EQ(events[i].name_id, name_id);
+            EXPECT_EQ(events[i].type, (i % 2) ? MfxBinaryTrace::EVENT_END : MfxBinaryTrace::EVENT_BEGIN);
+            if (i > 0) {
+                EXPECT_LE(events[i - 1].time_ns, events[i].time_ns);
+            }
+        }
+    }
+}
+
+// Tests MfxBinaryTrace saved while the thread keeps writing gets only whole events,
+// consecutive ones without gaps.
+TEST(MfxBinaryTrace, SaveWhileWriting)
+{
+    const int SAVE_COUNT = 100;
+
+    static const uint32_t event_id = MfxBinaryTrace::RegisterName("test", "concurrent_event");
+
+    MfxBinaryTrace::Enable(true);
+
+    std::atomic<bool> stop { false };
+    std::atomic<uint32_t> tid { 0 };
+    std::thread writer([&] {
+        tid = gettid();
+        for (uint64_t i = 0; !stop; ++i) {
+            MfxBinaryTrace::Write(MfxBinaryTrace::EVENT_INSTANT, event_id, i);
+        }
+    });
+    while (tid == 0) std::this_thread::yield();
+
+    for (int i = 0; i < SAVE_COUNT; ++i) {
+        std::ostringstream os;
+        EXPECT_TRUE(MfxBinaryTrace::Save(os));
+
+        std::vector<std::string> names;
+        std::map<uint32_t, std::vector<MfxBinaryTraceEvent>> saved_threads;
+        ASSERT_TRUE(ParseBinaryTrace(os.str(), &names, &saved_threads));
+
+        const std::vector<MfxBinaryTraceEvent>& events = saved_threads[tid];
+        EXPECT_LE(events.size(), MfxBinaryTrace::RING_SIZE);
+        for (size_t j = 0; j < events.size(); ++j) {
+            EXPECT_EQ(events[j].name_id, event_id);
+            EXPECT_EQ(events[j].type, MfxBinaryTrace::EVENT_INSTANT);
+            if (j > 0) {
+                EXPECT_EQ(events[j - 1].arg + 1, events[j].arg);
+            }
+        }
+    }
+
+    stop = true;
+    writer.join();
+    MfxBinaryTrace::Enable(false);
+}
+
+// Tests MfxBinaryTrace saves Chrome trace-event JSON with spans carrying
+// index of the frame set for the thread.
+TEST(MfxBinaryTrace, SaveJson)
+{
+    static const uint32_t span_id = MfxBinaryTrace::RegisterName("test", "json_span");
+    static const uint32_t event_id = MfxBinaryTrace::RegisterName("test", "json_event");
+
+    MfxBinaryTrace::Enable(true);
+    std::thread([] {
+        MfxBinaryTraceFrame frame(42);
+        MfxBinaryTraceScope scope(span_id);
+        MfxBinaryTrace::Write(MfxBinaryTrace::EVENT_INSTANT, event_id, 7);
+    }).join();
+    MfxBinaryTrace::Enable(false);
+
+    std::ostringstream os;
+    EXPECT_TRUE(MfxBinaryTrace::Save(os, MfxBinaryTrace::FORMAT_JSON));
+    std::string json = os.str();
+
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+    EXPECT_EQ(json.rfind("]}\n"), json.size() - 3);
+
+    size_t begin = json.find("{\"name\":\"json_span\",\"cat\":\"test\",\"ph\":\"B\"");
+    size_t instant = json.find("{\"name\":\"json_event\",\"cat\":\"test\",\"ph\":\"i\"");
+    size_t end = json.find("{\"name\":\"json_span\",\"cat\":\"test\",\"ph\":\"E\"");
+    ASSERT_NE(begin, std::string::npos);
+    ASSERT_NE(instant, std::string::npos);
+    ASSERT_NE(end, std::string::npos);
+    EXPECT_LT(begin, instant);
+    EXPECT_LT(instant, end);
+
+    EXPECT_NE(json.find("\"args\":{\"frame\":42}", begin), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"arg\":7}", instant), std::string::npos);
+}
+
+// Tests MfxC2AsyncWriter writes queued dumps in order, strips pitch padding of NV12 frames
+// and drops dumps exceeding the queue limit instead of waiting.
+TEST(MfxC2AsyncWriter, WriteDrop)
+{
+    const size_t MAX_QUEUED_BYTES = 16;
+    const std::string name = "mfx_c2_async_writer_test.bin";
+
+    std::vector<uint8_t> expected;
+    {
+        MfxC2AsyncWriter writer(MFX_C2_DUMP_DIR, {}, name, MAX_QUEUED_BYTES);
+
+        uint8_t big[MAX_QUEUED_BYTES + 1] {};
+        EXPECT_FALSE(writer.Write(big, sizeof(big)));
+        EXPECT_EQ(writer.GetDroppedCount(), 1u);
+
+        // fit in the queue even if nothing is written yet
+        for (uint8_t i = 0; i < MAX_QUEUED_BYTES / 4; ++i) {
+            const uint8_t chunk[4] = { i, i, i, i };
+            EXPECT_TRUE(writer.Write(chunk, sizeof(chunk)));
+            expected.insert(expected.end(), chunk, chunk + sizeof(chunk));
+        }
+    }
+    {
+        MfxC2AsyncWriter writer(MFX_C2_DUMP_DIR, {}, name, MAX_QUEUED_BYTES);
+
+        // 4x2 frame with pitch 6: 2 luma rows and 1 chroma row
+        const uint8_t y[] = { 1, 2, 3, 4, 0, 0,  5, 6, 7, 8, 0, 0 };
+        const uint8_t uv[] = { 9, 10, 11, 12, 0, 0 };
+        EXPECT_TRUE(writer.WriteNV12(y, uv, 6, 4, 2));
+        expected = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    }
+
+    std::ifstream file(std::string(MFX_C2_DUMP_DIR) + "/" + name, std::ios::binary);
+    std::vector<uint8_t> written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(written, expected);
+}
+
 // Tests MfxDev could be created and released significant amount of times.
 // For pure build this tests MfxDevAndroid, for VA - MfxDevVa.
 TEST(MfxDev, InitCloseNoLeaks)
@@ -1375,3 +1797,218 @@ TEST(C2Utils, CopyGraphicView)
 
     } while(false);
 }
+
+// YUV 4:2:0 image of 8 or 16 bit samples in memory with arbitrary pitches and chroma arrangement.
+struct Yuv420Image
+{
+    enum Format { NV12, NV21, I420, YV12 };
+
+    Yuv420Image(uint32_t width, uint32_t height, Format format, uint32_t sample_size, uint32_t padding)
+        : sample_size(sample_size)
+    {
+        const uint32_t PLANE_OFFSET = 8; // to have planes start not at the buffer start
+        bool semi_planar = (format == NV12 || format == NV21);
+        uint32_t chroma_width = (width + 1) / 2;
+        uint32_t chroma_height = (height + 1) / 2;
+        uint32_t y_pitch = width * sample_size + padding;
+        uint32_t chroma_pitch = (semi_planar ? 2 : 1) * chroma_width * sample_size + padding;
+        uint32_t y_size = y_pitch * height;
+        uint32_t chroma_size = chroma_pitch * chroma_height;
+
+        buffer.resize(PLANE_OFFSET + y_size + (semi_planar ? 1 : 2) * chroma_size, 0xCD);
+
+        uint8_t* y = buffer.data() + PLANE_OFFSET;
+        uint8_t* first = y + y_size;
+        uint8_t* second = semi_planar ? first + sample_size : first + chroma_size;
+        bool u_first = (format == NV12 || format == I420);
+
+        data[C2PlanarLayout::PLANE_Y] = y;
+        data[C2PlanarLayout::PLANE_U] = u_first ? first : second;
+        data[C2PlanarLayout::PLANE_V] = u_first ? second : first;
+
+        layout.type = C2PlanarLayout::TYPE_YUV;
+        layout.numPlanes = 3;
+        layout.rootPlanes = semi_planar ? 2 : 3;
+
+        for (uint32_t i = 0; i < layout.numPlanes; ++i) {
+            C2PlaneInfo& plane = layout.planes[i];
+            bool chroma = (i != C2PlanarLayout::PLANE_Y);
+            plane.channel = (i == C2PlanarLayout::PLANE_Y) ? C2PlaneInfo::CHANNEL_Y :
+                (i == C2PlanarLayout::PLANE_U) ? C2PlaneInfo::CHANNEL_CB : C2PlaneInfo::CHANNEL_CR;
+            plane.colInc = (chroma && semi_planar ? 2 : 1) * sample_size;
+            plane.rowInc = chroma ? chroma_pitch : y_pitch;
+            plane.colSampling = chroma ? 2 : 1;
+            plane.rowSampling = chroma ? 2 : 1;
+            plane.allocatedDepth = 8 * sample_size;
+            plane.bitDepth = (sample_size == 1) ? 8 : 10;
+            plane.rightShift = (sample_size == 1) ? 0 : 6;
+            plane.endianness = C2PlaneInfo::NATIVE;
+            plane.rootIx = i;
+            plane.offset = 0;
+        }
+        if (semi_planar) {
+            C2PlanarLayout::plane_index_t second_index = u_first ? C2PlanarLayout::PLANE_V : C2PlanarLayout::PLANE_U;
+            layout.planes[second_index].rootIx = u_first ? C2PlanarLayout::PLANE_U : C2PlanarLayout::PLANE_V;
+            layout.planes[second_index].offset = sample_size;
+        }
+    }
+
+    uint8_t* Sample(uint32_t plane_index, uint32_t x, uint32_t y)
+    {
+        const C2PlaneInfo& plane = layout.planes[plane_index];
+        return data[plane_index] + y * plane.rowInc + x * plane.colInc;
+    }
+
+    uint32_t sample_size;
+    std::vector<uint8_t> buffer;
+    C2PlanarLayout layout {};
+    uint8_t* data[C2PlanarLayout::MAX_NUM_PLANES] {};
+};
+
+// Copies images between all combinations of NV12, NV21, I420 and YV12 layouts
+// of 8 bit and 16 bit (P010 like) samples with different pitches,
+// checks destination samples are bit exact and padding is not touched.
+TEST(C2Utils, CopyPlanesConvertsLayouts)
+{
+    const uint32_t WIDTH = 71; // odd width to cover both vector and scalar parts of rows
+    const uint32_t HEIGHT = 9;
+    const std::vector<Yuv420Image::Format> formats {
+        Yuv420Image::NV12, Yuv420Image::NV21, Yuv420Image::I420, Yuv420Image::YV12 };
+
+    auto plane_size = [] (uint32_t plane_index, uint32_t* width, uint32_t* height) {
+        if (plane_index != C2PlanarLayout::PLANE_Y) {
+            *width = (*width + 1) / 2;
+            *height = (*height + 1) / 2;
+        }
+    };
+
+    for (uint32_t sample_size : { 1, 2 }) {
+        for (Yuv420Image::Format src_format : formats) {
+            for (Yuv420Image::Format dst_format : formats) {
+
+                Yuv420Image src(WIDTH, HEIGHT, src_format, sample_size, 3/*padding*/);
+                Yuv420Image dst(WIDTH, HEIGHT, dst_format, sample_size, 21/*padding*/);
+                Yuv420Image expected(WIDTH, HEIGHT, dst_format, sample_size, 21/*padding*/);
+
+                for (uint32_t plane_index = 0; plane_index < src.layout.numPlanes; ++plane_index) {
+                    uint32_t width = WIDTH, height = HEIGHT;
+                    plane_size(plane_index, &width, &height);
+                    for (uint32_t y = 0; y < height; ++y) {
+                        for (uint32_t x = 0; x < width; ++x) {
+                            uint16_t value = (uint16_t)((x * 31 + y * 17 + plane_index * 97 + 1) * 0x0103);
+                            memcpy(src.Sample(plane_index, x, y), &value, sample_size);
+                            memcpy(expected.Sample(plane_index, x, y), &value, sample_size);
+                        }
+                    }
+                }
+
+                c2_status_t res = CopyPlanes(WIDTH, HEIGHT, src.layout, src.data, dst.layout, dst.data);
+                EXPECT_EQ(res, C2_OK) << NAMED(sample_size) << NAMED(src_format) << NAMED(dst_format);
+                EXPECT_TRUE(dst.buffer == expected.buffer) << NAMED(sample_size) << NAMED(src_format) << NAMED(dst_format);
+            }
+        }
+    }
+}
+
+// Checks samples of different bit depth are not copied.
+TEST(C2Utils, CopyPlanesRejectsDepthChange)
+{
+    const uint32_t WIDTH = 32;
+    const uint32_t HEIGHT = 8;
+
+    Yuv420Image nv12(WIDTH, HEIGHT, Yuv420Image::NV12, 1, 0/*padding*/);
+    Yuv420Image p010(WIDTH, HEIGHT, Yuv420Image::NV12, 2, 0/*padding*/);
+    std::vector<uint8_t> p010_contents = p010.buffer;
+
+    c2_status_t res = CopyPlanes(WIDTH, HEIGHT, nv12.layout, nv12.data, p010.layout, p010.data);
+    EXPECT_EQ(res, C2_CANNOT_DO);
+    EXPECT_TRUE(p010.buffer == p010_contents);
+}
+
+// Checks layer ids are assigned to frames according to dyadic temporal layers structure.
+TEST(C2Utils, GetTemporalLayerId)
+{
+    const uint32_t FRAME_COUNT = 16;
+
+    const std::map<uint32_t, std::vector<uint32_t>> expected_layers = {
+        { 1, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } },
+        { 2, { 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1 } },
+        { 3, { 0, 2, 1, 2, 0, 2, 1, 2, 0, 2, 1, 2, 0, 2, 1, 2 } },
+        { 4, { 0, 3, 2, 3, 1, 3, 2, 3, 0, 3, 2, 3, 1, 3, 2, 3 } },
+    };
+
+    for (const auto& layers : expected_layers) {
+        for (uint32_t frame_order = 0; frame_order < FRAME_COUNT; ++frame_order) {
+            EXPECT_EQ(GetTemporalLayerId(frame_order, layers.first), layers.second[frame_order])
+                << NAMED(layers.first) << NAMED(frame_order);
+        }
+    }
+}
+
+
+// Fills luma plane with one of synthetic scenes moving with the frame index.
+static void FillSceneFrame(uint32_t scene, uint32_t frame_index,
+    uint32_t width, uint32_t height, uint32_t pitch, uint8_t* luma)
+{
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t value = 0;
+            if (scene == 0) { // smooth gradient panning to the right
+                value = (uint8_t)((x + frame_index) / 2 + y / 4);
+            } else { // bright checkerboard moving down
+                value = (((x / 32) + ((y + frame_index) / 32)) % 2) ? 235 : 64;
+            }
+            luma[y * pitch + x] = value;
+        }
+    }
+}
+
+// Checks scene changes are detected on cuts between synthetic scenes only,
+// frame width is chosen to have downscaled width not multiple of SIMD step.
+TEST(MfxC2SceneChangeDetector, DetectCuts)
+{
+    const uint32_t WIDTH = 200;
+    const uint32_t HEIGHT = 120;
+    const uint32_t PITCH = 256;
+    const uint32_t SCENE_LENGTH = 20;
+    // scenes follow each other in this order
+    const std::vector<uint32_t> scenes = { 0, 1, 0 };
+
+    std::vector<uint8_t> luma(PITCH * HEIGHT);
+    MfxC2SceneChangeDetector detector;
+
+    uint32_t frame_index = 0;
+    for (size_t i = 0; i < scenes.size(); ++i) {
+        for (uint32_t j = 0; j < SCENE_LENGTH; ++j, ++frame_index) {
+            FillSceneFrame(scenes[i], frame_index, WIDTH, HEIGHT, PITCH, luma.data());
+
+            bool expected = (i != 0) && (j == 0); // the first frame of stream is not a cut
+            EXPECT_EQ(detector.DetectSceneChange(luma.data(), WIDTH, HEIGHT, PITCH), expected)
+                << NAMED(i) << NAMED(j);
+        }
+    }
+}
+
+// Checks detection starts over after reset or resolution change.
+TEST(MfxC2SceneChangeDetector, Reset)
+{
+    const uint32_t WIDTH = 176;
+    const uint32_t HEIGHT = 144;
+
+    std::vector<uint8_t> luma(WIDTH * HEIGHT);
+    MfxC2SceneChangeDetector detector;
+
+    FillSceneFrame(0, 0, WIDTH, HEIGHT, WIDTH, luma.data());
+    EXPECT_FALSE(detector.DetectSceneChange(luma.data(), WIDTH, HEIGHT, WIDTH));
+
+    detector.Reset();
+    FillSceneFrame(1, 0, WIDTH, HEIGHT, WIDTH, luma.data());
+    EXPECT_FALSE(detector.DetectSceneChange(luma.data(), WIDTH, HEIGHT, WIDTH));
+
+    FillSceneFrame(0, 0, WIDTH, HEIGHT, WIDTH, luma.data());
+    EXPECT_TRUE(detector.DetectSceneChange(luma.data(), WIDTH, HEIGHT, WIDTH));
+
+    // same contents in smaller frame
+    FillSceneFrame(1, 0, WIDTH / 2, HEIGHT / 2, WIDTH, luma.data());
+    EXPECT_FALSE(detector.DetectSceneChange(luma.data(), WIDTH / 2, HEIGHT / 2, WIDTH));
+}
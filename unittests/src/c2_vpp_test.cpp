@@ -0,0 +1,330 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_c2_defs.h"
+#include <gtest/gtest.h>
+#include "test_components.h"
+#include "mfx_c2_utils.h"
+#include "mfx_c2_params.h"
+#include "mfx_c2_component.h"
+#include "mfx_c2_components_registry.h"
+#include "C2PlatformSupport.h"
+
+#include <atomic>
+#include <future>
+
+using namespace android;
+
+namespace {
+
+const uint32_t IN_WIDTH = 320;
+const uint32_t IN_HEIGHT = 240;
+const uint32_t OUT_WIDTH = 640;
+const uint32_t OUT_HEIGHT = 480;
+const uint32_t FRAME_COUNT = 10;
+const uint64_t FRAME_DURATION_US = 33333;
+const c2_nsecs_t TIMEOUT_NS = MFX_SECOND_NS;
+
+struct ComponentDesc
+{
+    const char* component_name;
+    MfxC2Component::CreateConfig config;
+    c2_status_t creation_status;
+};
+
+ComponentDesc g_vpp_desc { "c2.intel.vpp", {}, C2_OK };
+
+// Collects processed works, checks every input frame comes out in order.
+class VppConsumer : public C2Component::Listener
+{
+public:
+    typedef std::function<void(const C2ConstGraphicBlock& block)> OnFrame;
+
+    explicit VppConsumer(OnFrame on_frame) : m_onFrame(on_frame) {}
+
+    std::future<void> GetFuture() { return m_done.get_future(); }
+
+protected:
+    void onWorkDone_nb(std::weak_ptr<C2Component>,
+        std::list<std::unique_ptr<C2Work>> workItems) override
+    {
+        for (std::unique_ptr<C2Work>& work : workItems) {
+            EXPECT_EQ(work->result, C2_OK);
+            EXPECT_EQ(work->workletsProcessed, 1u);
+
+            C2FrameData& output = work->worklets.front()->output;
+            EXPECT_EQ(output.ordinal.frameIndex.peeku(), m_uExpectedIndex);
+            EXPECT_EQ(output.ordinal.timestamp.peeku(), m_uExpectedIndex * FRAME_DURATION_US);
+
+            std::unique_ptr<C2ConstGraphicBlock> block;
+            EXPECT_EQ(GetC2ConstGraphicBlock(output, &block), C2_OK);
+            if (block) m_onFrame(*block);
+
+            if (++m_uExpectedIndex == FRAME_COUNT) m_done.set_value();
+        }
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>,
+        std::vector<std::shared_ptr<C2SettingResult>>) override
+    {
+        ADD_FAILURE() << "onTripped_nb callback shouldn't come";
+    }
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t) override
+    {
+        ADD_FAILURE() << "onError_nb callback shouldn't come";
+    }
+
+private:
+    OnFrame m_onFrame;
+    uint64_t m_uExpectedIndex { 0 };
+    std::promise<void> m_done;
+};
+
+// Counts processed works regardless of their content.
+class VppCounter : public C2Component::Listener
+{
+public:
+    uint32_t GetDone() const { return m_uDone; }
+
+protected:
+    void onWorkDone_nb(std::weak_ptr<C2Component>,
+        std::list<std::unique_ptr<C2Work>> workItems) override
+    {
+        m_uDone += workItems.size();
+    }
+
+    void onTripped_nb(std::weak_ptr<C2Component>,
+        std::vector<std::shared_ptr<C2SettingResult>>) override
+    {
+        ADD_FAILURE() << "onTripped_nb callback shouldn't come";
+    }
+
+    void onError_nb(std::weak_ptr<C2Component>, uint32_t) override
+    {
+        ADD_FAILURE() << "onError_nb callback shouldn't come";
+    }
+
+private:
+    std::atomic<uint32_t> m_uDone { 0 };
+};
+
+std::unique_ptr<C2Work> PrepareWork(uint32_t frame_index, std::shared_ptr<C2BlockPool> pool)
+{
+    std::unique_ptr<C2Work> work = std::make_unique<C2Work>();
+    work->input.flags = (frame_index == FRAME_COUNT - 1) ?
+        C2FrameData::FLAG_END_OF_STREAM : C2FrameData::flags_t(0);
+    work->input.ordinal.timestamp = frame_index * FRAME_DURATION_US;
+    work->input.ordinal.frameIndex = frame_index;
+
+    C2MemoryUsage mem_usage = { C2AndroidMemoryUsage::HW_CODEC_READ, C2MemoryUsage::CPU_WRITE };
+    std::shared_ptr<C2GraphicBlock> block;
+    c2_status_t sts = pool->fetchGraphicBlock(IN_WIDTH, IN_HEIGHT,
+        HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL, mem_usage, &block);
+    EXPECT_EQ(sts, C2_OK);
+
+    if (block) {
+        C2ConstGraphicBlock const_block = block->share(block->crop(), C2Fence());
+        work->input.buffers.push_back(std::make_shared<C2Buffer>(MakeC2Buffer({ const_block })));
+    }
+    work->worklets.push_back(std::make_unique<C2Worklet>());
+    return work;
+}
+
+} // namespace
+
+// Checks VPP component is created and describes itself as a raw video processor.
+TEST(MfxVppComponent, intf)
+{
+    CallComponentTest<ComponentDesc>(g_vpp_desc,
+        [] (const ComponentDesc& desc, C2CompPtr, C2CompIntfPtr comp_intf) {
+
+        EXPECT_EQ(comp_intf->getName(), desc.component_name);
+
+        C2ComponentKindSetting kind;
+        C2StreamBufferTypeSetting::input input_type;
+        C2StreamBufferTypeSetting::output output_type;
+        std::vector<std::unique_ptr<C2Param>> heap_params;
+        c2_status_t sts = comp_intf->query_vb({ &kind, &input_type, &output_type }, {},
+            C2_MAY_BLOCK, &heap_params);
+        EXPECT_EQ(sts, C2_OK);
+        EXPECT_EQ(kind.value, C2Component::KIND_OTHER);
+        EXPECT_EQ(input_type.value, C2BufferData::GRAPHIC);
+        EXPECT_EQ(output_type.value, C2BufferData::GRAPHIC);
+    });
+}
+
+// Odd output sizes are refused.
+TEST(MfxVppComponent, InvalidSize)
+{
+    CallComponentTest<ComponentDesc>(g_vpp_desc,
+        [] (const ComponentDesc&, C2CompPtr, C2CompIntfPtr comp_intf) {
+
+        C2StreamPictureSizeInfo::output size(0u, OUT_WIDTH + 1, OUT_HEIGHT);
+
+        std::vector<std::unique_ptr<C2SettingResult>> failures;
+        c2_status_t sts = comp_intf->config_vb({ &size }, C2_MAY_BLOCK, &failures);
+        EXPECT_EQ(sts, C2_BAD_VALUE);
+        EXPECT_EQ(failures.size(), 1u);
+    });
+}
+
+// Scales NV12 frames twice up, checks every output has configured size.
+TEST(MfxVppComponent, Scale)
+{
+    CallComponentTest<ComponentDesc>(g_vpp_desc,
+        [] (const ComponentDesc&, C2CompPtr comp, C2CompIntfPtr comp_intf) {
+
+        C2StreamPictureSizeInfo::output size(0u, OUT_WIDTH, OUT_HEIGHT);
+        std::vector<std::unique_ptr<C2SettingResult>> failures;
+        c2_status_t sts = comp_intf->config_vb({ &size }, C2_MAY_BLOCK, &failures);
+        EXPECT_EQ(sts, C2_OK);
+
+        std::shared_ptr<C2BlockPool> pool;
+        sts = GetCodec2BlockPool(C2BlockPool::BASIC_GRAPHIC, comp, &pool);
+        ASSERT_EQ(sts, C2_OK);
+
+        std::shared_ptr<VppConsumer> consumer = std::make_shared<VppConsumer>(
+            [] (const C2ConstGraphicBlock& block) {
+                EXPECT_EQ(block.width(), OUT_WIDTH);
+                EXPECT_EQ(block.height(), OUT_HEIGHT);
+
+                std::unique_ptr<const C2GraphicView> view;
+                EXPECT_EQ(MapConstGraphicBlock(block, TIMEOUT_NS, &view), C2_OK);
+                if (view) EXPECT_TRUE(IsNV12(*view));
+            });
+
+        sts = comp->setListener_vb(consumer, C2_MAY_BLOCK);
+        EXPECT_EQ(sts, C2_OK);
+
+        sts = comp->start();
+        EXPECT_EQ(sts, C2_OK);
+
+        for (uint32_t i = 0; i < FRAME_COUNT; ++i) {
+            std::list<std::unique_ptr<C2Work>> works;
+            works.push_back(PrepareWork(i, pool));
+            sts = comp->queue_nb(&works);
+            EXPECT_EQ(sts, C2_OK);
+        }
+
+        std::future<void> future = consumer->GetFuture();
+        EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+        comp->setListener_vb(nullptr, C2_MAY_BLOCK);
+        sts = comp->stop();
+        EXPECT_EQ(sts, C2_OK);
+    });
+}
+
+// Deinterlaces frames of the field order, checks every input comes out with its own ordinal
+// including frames held by deinterlacer until end of stream.
+static void DeinterlaceFrames(C2CompPtr comp, C2CompIntfPtr comp_intf, bool bottom_field_first)
+{
+    C2StreamDeinterlaceTuning::output deinterlace(0u, C2_TRUE);
+    C2StreamBottomFieldFirstTuning::input field_order(0u, bottom_field_first ? C2_TRUE : C2_FALSE);
+    std::vector<std::unique_ptr<C2SettingResult>> failures;
+    c2_status_t sts = comp_intf->config_vb({ &deinterlace, &field_order }, C2_MAY_BLOCK, &failures);
+    EXPECT_EQ(sts, C2_OK);
+
+    std::shared_ptr<C2BlockPool> pool;
+    sts = GetCodec2BlockPool(C2BlockPool::BASIC_GRAPHIC, comp, &pool);
+    ASSERT_EQ(sts, C2_OK);
+
+    std::shared_ptr<VppConsumer> consumer = std::make_shared<VppConsumer>(
+        [] (const C2ConstGraphicBlock& block) {
+            EXPECT_EQ(block.width(), IN_WIDTH);
+            EXPECT_EQ(block.height(), IN_HEIGHT);
+        });
+
+    sts = comp->setListener_vb(consumer, C2_MAY_BLOCK);
+    EXPECT_EQ(sts, C2_OK);
+
+    sts = comp->start();
+    EXPECT_EQ(sts, C2_OK);
+
+    for (uint32_t i = 0; i < FRAME_COUNT; ++i) {
+        std::list<std::unique_ptr<C2Work>> works;
+        works.push_back(PrepareWork(i, pool));
+        sts = comp->queue_nb(&works);
+        EXPECT_EQ(sts, C2_OK);
+    }
+
+    std::future<void> future = consumer->GetFuture();
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+    comp->setListener_vb(nullptr, C2_MAY_BLOCK);
+    sts = comp->stop();
+    EXPECT_EQ(sts, C2_OK);
+}
+
+// Deinterlaces top field first frames, the default field order.
+TEST(MfxVppComponent, Deinterlace)
+{
+    CallComponentTest<ComponentDesc>(g_vpp_desc,
+        [] (const ComponentDesc&, C2CompPtr comp, C2CompIntfPtr comp_intf) {
+        DeinterlaceFrames(comp, comp_intf, false);
+    });
+}
+
+// Deinterlaces bottom field first frames.
+TEST(MfxVppComponent, DeinterlaceBottomFieldFirst)
+{
+    CallComponentTest<ComponentDesc>(g_vpp_desc,
+        [] (const ComponentDesc&, C2CompPtr comp, C2CompIntfPtr comp_intf) {
+        DeinterlaceFrames(comp, comp_intf, true);
+    });
+}
+
+// Flushes VPP with frames queued, checks every work comes back either
+// processed through listener or in flushed list.
+TEST(MfxVppComponent, Flush)
+{
+    CallComponentTest<ComponentDesc>(g_vpp_desc,
+        [] (const ComponentDesc&, C2CompPtr comp, C2CompIntfPtr) {
+
+        std::shared_ptr<C2BlockPool> pool;
+        c2_status_t sts = GetCodec2BlockPool(C2BlockPool::BASIC_GRAPHIC, comp, &pool);
+        ASSERT_EQ(sts, C2_OK);
+
+        std::shared_ptr<VppCounter> listener = std::make_shared<VppCounter>();
+
+        sts = comp->setListener_vb(listener, C2_MAY_BLOCK);
+        EXPECT_EQ(sts, C2_OK);
+
+        sts = comp->start();
+        EXPECT_EQ(sts, C2_OK);
+
+        std::list<std::unique_ptr<C2Work>> works;
+        for (uint32_t i = 0; i < FRAME_COUNT; ++i) {
+            works.push_back(PrepareWork(i, pool));
+        }
+        sts = comp->queue_nb(&works);
+        EXPECT_EQ(sts, C2_OK);
+
+        std::list<std::unique_ptr<C2Work>> flushed_works;
+        sts = comp->flush_sm(C2Component::FLUSH_COMPONENT, &flushed_works);
+        EXPECT_EQ(sts, C2_OK);
+        EXPECT_EQ(listener->GetDone() + flushed_works.size(), FRAME_COUNT);
+
+        comp->setListener_vb(nullptr, C2_MAY_BLOCK);
+        sts = comp->stop();
+        EXPECT_EQ(sts, C2_OK);
+    });
+}
@@ -0,0 +1,266 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "mfx_defs.h"
+#include "mfx_fake_runtime.h"
+#include "test_streams.h"
+#include "streams/h264/stream_nv12_176x144_cqp_g30_100.264.h"
+#include "streams/h265/stream_nv12_176x144_cqp_g30_100.265.h"
+
+typedef std::unique_ptr<_mfxSession, decltype(&MFXClose)> SessionPtr;
+
+static SessionPtr CreateSession()
+{
+    mfxSession session = nullptr;
+    mfxVersion version {};
+    EXPECT_EQ(MFXInit(MFX_IMPL_HARDWARE, &version, &session), MFX_ERR_NONE);
+    return SessionPtr(session, &MFXClose);
+}
+
+// Restores fake runtime config changed by the test.
+class MfxFakeRuntime : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_config = MfxFakeGetConfig();
+        MfxFakeRuntimeConfig config = m_config;
+        config.latency_us = 0;
+        config.busy_period = 0;
+        MfxFakeSetConfig(config);
+    }
+
+    void TearDown() override
+    {
+        MfxFakeSetConfig(m_config);
+    }
+
+private:
+    MfxFakeRuntimeConfig m_config;
+};
+
+struct FakeDecodeStats
+{
+    size_t frames;
+    size_t busy;
+};
+
+// Decodes the stream the way decoder component does and counts output frames.
+static FakeDecodeStats Decode(mfxU32 codec, const StreamDescription& stream,
+    const StreamReader::Slicing& slicing)
+{
+    FakeDecodeStats stats {};
+    SessionPtr session = CreateSession();
+
+    mfxVideoParam par {};
+    par.mfx.CodecId = codec;
+    par.AsyncDepth = 1;
+    par.IOPattern = MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+
+    std::vector<char> header = stream.data;
+    mfxBitstream bs {};
+    bs.Data = reinterpret_cast<mfxU8*>(header.data());
+    bs.DataLength = bs.MaxLength = header.size();
+    EXPECT_EQ(MFXVideoDECODE_DecodeHeader(session.get(), &bs, &par), MFX_ERR_NONE);
+    EXPECT_EQ(par.mfx.FrameInfo.CropW, 176);
+    EXPECT_EQ(par.mfx.FrameInfo.CropH, 144);
+    EXPECT_EQ(par.mfx.FrameInfo.FourCC, (mfxU32)MFX_FOURCC_NV12);
+
+    mfxFrameAllocRequest request {};
+    EXPECT_EQ(MFXVideoDECODE_QueryIOSurf(session.get(), &par, &request), MFX_ERR_NONE);
+    EXPECT_EQ(MFXVideoDECODE_Init(session.get(), &par), MFX_ERR_NONE);
+
+    std::vector<mfxFrameSurface1> surfaces(request.NumFrameSuggested);
+    for (auto& surface : surfaces) surface.Info = par.mfx.FrameInfo;
+
+    auto decode = [&] (mfxBitstream* bs) {
+        while (true) {
+            auto free_surface = std::find_if(surfaces.begin(), surfaces.end(),
+                [] (const mfxFrameSurface1& surface) { return !surface.Data.Locked; });
+            if (free_surface == surfaces.end()) {
+                ADD_FAILURE() << "no free surfaces";
+                return;
+            }
+
+            mfxFrameSurface1* surface_out = nullptr;
+            mfxSyncPoint syncp = nullptr;
+            mfxStatus sts = MFXVideoDECODE_DecodeFrameAsync(session.get(), bs, &*free_surface, &surface_out, &syncp);
+            if (MFX_WRN_DEVICE_BUSY == sts) {
+                ++stats.busy;
+                continue;
+            }
+            if (MFX_ERR_MORE_DATA == sts) return;
+
+            EXPECT_EQ(sts, MFX_ERR_NONE);
+            if (MFX_ERR_NONE != sts) return;
+
+            EXPECT_EQ(MFXVideoCORE_SyncOperation(session.get(), syncp, MFX_TIMEOUT_INFINITE), MFX_ERR_NONE);
+            EXPECT_EQ(surface_out->Data.Locked, 0);
+            ++stats.frames;
+
+            if (bs && !bs->DataLength) return;
+        }
+    };
+
+    std::unique_ptr<StreamReader> reader { StreamReader::Create({ &stream }) };
+    StreamDescription::Region region {};
+    bool is_header = false;
+    while (reader->Read(slicing, &region, &is_header)) {
+        std::vector<char> chunk = reader->GetRegionContents(region);
+        mfxBitstream bs {};
+        bs.Data = reinterpret_cast<mfxU8*>(chunk.data());
+        bs.DataLength = bs.MaxLength = chunk.size();
+        decode(&bs);
+        EXPECT_EQ(bs.DataLength, 0u);
+    }
+    decode(nullptr); // drain
+
+    EXPECT_EQ(MFXVideoDECODE_Close(session.get()), MFX_ERR_NONE);
+    return stats;
+}
+
+// Checks fake decoder splits streams into the same frames regardless of input chunks.
+TEST_F(MfxFakeRuntime, DecodeFrameCount)
+{
+    const struct {
+        mfxU32 codec;
+        const StreamDescription& stream;
+    } streams[] = {
+        { MFX_CODEC_AVC, stream_nv12_176x144_cqp_g30_100_264 },
+        { MFX_CODEC_HEVC, stream_nv12_176x144_cqp_g30_100_265 },
+    };
+    const StreamReader::Slicing slicings[] = {
+        StreamReader::Slicing::NalUnit(),
+        StreamReader::Slicing::Frame(),
+        StreamReader::Slicing(1000),
+    };
+
+    for (const auto& test : streams) {
+        for (const auto& slicing : slicings) {
+            FakeDecodeStats stats = Decode(test.codec, test.stream, slicing);
+            EXPECT_EQ(stats.frames, test.stream.frames_crc32_nv12.size()) << test.stream.name;
+        }
+    }
+}
+
+// Checks busy device makes the caller retry without losing frames.
+TEST_F(MfxFakeRuntime, DeviceBusy)
+{
+    MfxFakeRuntimeConfig config = MfxFakeGetConfig();
+    config.busy_period = 3;
+    MfxFakeSetConfig(config);
+
+    const StreamDescription& stream = stream_nv12_176x144_cqp_g30_100_264;
+    FakeDecodeStats stats = Decode(MFX_CODEC_AVC, stream, StreamReader::Slicing::Frame());
+
+    EXPECT_EQ(stats.frames, stream.frames_crc32_nv12.size());
+    EXPECT_GT(stats.busy, 0u);
+}
+
+// Checks encoded frames sizes follow bitrate and key frames follow GOP.
+TEST_F(MfxFakeRuntime, Encode)
+{
+    const mfxU32 FRAME_COUNT = 10;
+    const mfxU16 GOP_SIZE = 5;
+
+    SessionPtr session = CreateSession();
+
+    mfxVideoParam par {};
+    par.mfx.CodecId = MFX_CODEC_AVC;
+    par.mfx.RateControlMethod = MFX_RATECONTROL_VBR;
+    par.mfx.TargetKbps = 3000;
+    par.mfx.GopPicSize = GOP_SIZE;
+    par.mfx.FrameInfo.FourCC = MFX_FOURCC_NV12;
+    par.mfx.FrameInfo.ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+    par.mfx.FrameInfo.Width = par.mfx.FrameInfo.CropW = 352;
+    par.mfx.FrameInfo.Height = par.mfx.FrameInfo.CropH = 288;
+    par.mfx.FrameInfo.FrameRateExtN = 30;
+    par.mfx.FrameInfo.FrameRateExtD = 1;
+    par.IOPattern = MFX_IOPATTERN_IN_SYSTEM_MEMORY;
+
+    ASSERT_EQ(MFXVideoENCODE_Init(session.get(), &par), MFX_ERR_NONE);
+
+    mfxVideoParam state {};
+    ASSERT_EQ(MFXVideoENCODE_GetVideoParam(session.get(), &state), MFX_ERR_NONE);
+    EXPECT_GT(state.AsyncDepth, 0);
+    mfxU32 buffer_size = state.mfx.BufferSizeInKB * 1000 * state.mfx.BRCParamMultiplier;
+    const mfxU32 expected_size = 3000 * 1000 / 8 / 30;
+    EXPECT_GE(buffer_size, expected_size);
+
+    mfxFrameSurface1 surface {};
+    surface.Info = par.mfx.FrameInfo;
+
+    for (mfxU32 i = 0; i < FRAME_COUNT; ++i) {
+        std::vector<mfxU8> data(buffer_size);
+        mfxBitstream bs {};
+        bs.Data = data.data();
+        bs.MaxLength = data.size();
+
+        surface.Data.TimeStamp = i;
+        mfxSyncPoint syncp = nullptr;
+        ASSERT_EQ(MFXVideoENCODE_EncodeFrameAsync(session.get(), nullptr, &surface, &bs, &syncp), MFX_ERR_NONE);
+        ASSERT_EQ(MFXVideoCORE_SyncOperation(session.get(), syncp, MFX_TIMEOUT_INFINITE), MFX_ERR_NONE);
+
+        EXPECT_EQ(surface.Data.Locked, 0);
+        EXPECT_EQ(bs.DataLength, expected_size);
+        EXPECT_EQ(bs.TimeStamp, i);
+        EXPECT_EQ((bs.FrameType & MFX_FRAMETYPE_IDR) != 0, i % GOP_SIZE == 0) << i;
+    }
+
+    mfxBitstream bs {};
+    mfxSyncPoint syncp = nullptr;
+    EXPECT_EQ(MFXVideoENCODE_EncodeFrameAsync(session.get(), nullptr, nullptr, &bs, &syncp), MFX_ERR_MORE_DATA);
+    EXPECT_EQ(MFXVideoENCODE_Close(session.get()), MFX_ERR_NONE);
+}
+
+// Checks sync point waits for configured latency.
+TEST_F(MfxFakeRuntime, SyncTimeout)
+{
+    MfxFakeRuntimeConfig config = MfxFakeGetConfig();
+    config.latency_us = 200000;
+    MfxFakeSetConfig(config);
+
+    SessionPtr session = CreateSession();
+
+    mfxFrameInfo info {};
+    info.FourCC = MFX_FOURCC_NV12;
+    info.Width = info.CropW = 176;
+    info.Height = info.CropH = 144;
+
+    mfxVideoParam par {};
+    par.vpp.In = par.vpp.Out = info;
+    ASSERT_EQ(MFXVideoVPP_Init(session.get(), &par), MFX_ERR_NONE);
+
+    mfxFrameSurface1 in {}, out {};
+    in.Data.TimeStamp = 42;
+    mfxSyncPoint syncp = nullptr;
+    ASSERT_EQ(MFXVideoVPP_RunFrameVPPAsync(session.get(), &in, &out, nullptr, &syncp), MFX_ERR_NONE);
+
+    EXPECT_EQ(MFXVideoCORE_SyncOperation(session.get(), syncp, 1), MFX_WRN_IN_EXECUTION);
+    EXPECT_NE(out.Data.Locked, 0);
+    EXPECT_EQ(MFXVideoCORE_SyncOperation(session.get(), syncp, MFX_TIMEOUT_INFINITE), MFX_ERR_NONE);
+    EXPECT_EQ(out.Data.Locked, 0);
+    EXPECT_EQ(out.Data.TimeStamp, 42u);
+
+    EXPECT_EQ(MFXVideoVPP_Close(session.get()), MFX_ERR_NONE);
+}
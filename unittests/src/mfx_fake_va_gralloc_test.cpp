@@ -0,0 +1,232 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "mfx_defs.h"
+#include "mfx_dev_va.h"
+#include "mfx_gralloc_allocator.h"
+#include "mfx_frame_converter.h"
+#include "mfx_frame_pool_allocator.h"
+#include "mfx_c2_buffer_queue.h"
+#include "mfx_fake_va_gralloc.h"
+
+// Tests of VA and gralloc allocators running on plain memory fakes (libmfx_fake_va_gralloc).
+
+// Checks all fake gralloc and VA objects are released by the end of the test.
+class MfxFakeVaGralloc : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        MfxFakeVaGrallocStats stats = MfxFakeVaGrallocGetStats();
+        EXPECT_EQ(stats.gralloc_handles, 0u);
+        EXPECT_EQ(stats.va_surfaces, 0u);
+        EXPECT_EQ(stats.va_buffers, 0u);
+        EXPECT_EQ(stats.va_images, 0u);
+    }
+};
+
+static uint8_t PatternValue(uint32_t x, uint32_t y, int seed)
+{
+    return (uint8_t)(x * 3 + y * 7 + seed);
+}
+
+// Fills (or checks) NV12 frame: luma and interleaved chroma plane following each other.
+static void ProcessNV12Pattern(uint32_t width, uint32_t height, int seed,
+    uint8_t* y_plane, uint8_t* uv_plane, uint32_t pitch, bool fill)
+{
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = y_plane + y * pitch;
+        uint8_t* uv_row = (y % 2) ? nullptr : uv_plane + y / 2 * pitch;
+        for (uint32_t x = 0; x < width; ++x) {
+            if (fill) {
+                row[x] = PatternValue(x, y, seed);
+                if (uv_row) uv_row[x] = PatternValue(x, y, seed + 1);
+            } else {
+                ASSERT_EQ(row[x], PatternValue(x, y, seed)) << "x " << x << " y " << y;
+                if (uv_row) ASSERT_EQ(uv_row[x], PatternValue(x, y, seed + 1)) << "x " << x << " y " << y;
+            }
+        }
+    }
+}
+
+static void InitNV12FrameInfo(uint16_t width, uint16_t height, mfxFrameInfo* frame_info)
+{
+    *frame_info = mfxFrameInfo {};
+    frame_info->FourCC = MFX_FOURCC_NV12;
+    frame_info->ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+    frame_info->BitDepthLuma = 8;
+    frame_info->BitDepthChroma = 8;
+    frame_info->Width = MFX_ALIGN_16(width);
+    frame_info->Height = MFX_ALIGN_32(height);
+    frame_info->CropW = width;
+    frame_info->CropH = height;
+    frame_info->FrameRateExtN = 30;
+    frame_info->FrameRateExtD = 1;
+    frame_info->PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+}
+
+// Writes pattern through gralloc lock, reads it through VA surface mapped from the buffer,
+// then the other way, proves fake VA surfaces share memory with gralloc buffers.
+TEST_F(MfxFakeVaGralloc, GrallocContentsMappedToVa)
+{
+    const uint16_t WIDTH = 600;
+    const uint16_t HEIGHT = 400;
+
+    std::unique_ptr<MfxGrallocAllocator> gr_allocator;
+    ASSERT_EQ(MfxGrallocAllocator::Create(&gr_allocator), C2_OK);
+
+    MfxDevVa dev(MfxDev::Usage::Encoder);
+    ASSERT_EQ(dev.Init(), MFX_ERR_NONE);
+
+    std::shared_ptr<MfxFrameAllocator> allocator = dev.GetFrameAllocator();
+    std::shared_ptr<MfxFrameConverter> converter = dev.GetFrameConverter();
+    ASSERT_NE(allocator, nullptr);
+    ASSERT_NE(converter, nullptr);
+
+    buffer_handle_t handle {};
+    ASSERT_EQ(gr_allocator->Alloc(WIDTH, HEIGHT, &handle), C2_OK);
+
+    uint8_t* data[C2PlanarLayout::MAX_NUM_PLANES] {};
+    C2PlanarLayout layout {};
+    ASSERT_EQ(gr_allocator->LockFrame(handle, data, &layout), C2_OK);
+    uint32_t gr_pitch = layout.planes[C2PlanarLayout::PLANE_Y].rowInc;
+    ProcessNV12Pattern(WIDTH, HEIGHT, 1, data[C2PlanarLayout::PLANE_Y], data[C2PlanarLayout::PLANE_U], gr_pitch, true);
+    EXPECT_EQ(gr_allocator->UnlockFrame(handle), C2_OK);
+
+    bool decode_target { false };
+    mfxMemId mem_id {};
+    EXPECT_EQ(converter->ConvertGrallocToVa(handle, decode_target, &mem_id), MFX_ERR_NONE);
+
+    mfxFrameData frame_data {};
+    EXPECT_EQ(allocator->LockFrame(mem_id, &frame_data), MFX_ERR_NONE);
+    if (frame_data.Y) {
+        ProcessNV12Pattern(WIDTH, HEIGHT, 1, frame_data.Y, frame_data.UV, frame_data.Pitch, false);
+        ProcessNV12Pattern(WIDTH, HEIGHT, 2, frame_data.Y, frame_data.UV, frame_data.Pitch, true);
+    }
+    EXPECT_EQ(allocator->UnlockFrame(mem_id, &frame_data), MFX_ERR_NONE);
+
+    ASSERT_EQ(gr_allocator->LockFrame(handle, data, &layout), C2_OK);
+    ProcessNV12Pattern(WIDTH, HEIGHT, 2, data[C2PlanarLayout::PLANE_Y], data[C2PlanarLayout::PLANE_U], gr_pitch, false);
+    EXPECT_EQ(gr_allocator->UnlockFrame(handle), C2_OK);
+
+    converter->FreeAllMappings();
+    EXPECT_EQ(gr_allocator->Free(handle), C2_OK);
+
+    converter.reset();
+    allocator.reset();
+    EXPECT_EQ(dev.Close(), MFX_ERR_NONE);
+}
+
+// Fetches blocks from MfxC2BufferQueueBlockPool without producer configured,
+// so they come from fake C2 gralloc allocator, checks they are mapped and released.
+TEST_F(MfxFakeVaGralloc, BufferQueueBlockPoolFetch)
+{
+    const uint32_t WIDTH = 1920;
+    const uint32_t HEIGHT = 1088;
+    const size_t BLOCK_COUNT = 8;
+
+    auto block_pool = std::make_shared<MfxC2BufferQueueBlockPool>(MfxFakeCreateC2GrallocAllocator(), 0);
+
+    std::vector<std::shared_ptr<C2GraphicBlock>> blocks;
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+        std::shared_ptr<C2GraphicBlock> block;
+        EXPECT_EQ(block_pool->fetchGraphicBlock(WIDTH, HEIGHT, HAL_PIXEL_FORMAT_NV12_Y_TILED_INTEL,
+            { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE }, &block), C2_OK);
+        ASSERT_NE(block, nullptr);
+
+        C2GraphicView view = block->map().get();
+        ASSERT_EQ(view.error(), C2_OK);
+        const C2PlanarLayout& layout = view.layout();
+        ProcessNV12Pattern(WIDTH, HEIGHT, i, view.data()[C2PlanarLayout::PLANE_Y],
+            view.data()[C2PlanarLayout::PLANE_U], layout.planes[C2PlanarLayout::PLANE_Y].rowInc, true);
+
+        blocks.push_back(std::move(block));
+    }
+    EXPECT_EQ(MfxFakeVaGrallocGetStats().gralloc_handles, BLOCK_COUNT);
+
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+        C2GraphicView view = blocks[i]->map().get();
+        ASSERT_EQ(view.error(), C2_OK);
+        ProcessNV12Pattern(WIDTH, HEIGHT, i, view.data()[C2PlanarLayout::PLANE_Y],
+            view.data()[C2PlanarLayout::PLANE_U], view.layout().planes[C2PlanarLayout::PLANE_Y].rowInc, false);
+    }
+    blocks.clear();
+}
+
+// Allocates decoder surfaces through MfxVaFramePoolAllocator::AllocFrames taking blocks
+// from MfxC2BufferQueueBlockPool, checks every surface is usable and everything is freed.
+TEST_F(MfxFakeVaGralloc, PoolAllocatorAllocFrames)
+{
+    const uint16_t WIDTH = 1920;
+    const uint16_t HEIGHT = 1080;
+    const mfxU16 FRAME_COUNT = 5;
+
+    MfxDevVa dev(MfxDev::Usage::Decoder);
+    ASSERT_EQ(dev.Init(), MFX_ERR_NONE);
+
+    std::shared_ptr<MfxFrameAllocator> allocator = dev.GetFrameAllocator();
+    std::shared_ptr<MfxFramePoolAllocator> pool_allocator = dev.GetFramePoolAllocator();
+    ASSERT_NE(allocator, nullptr);
+    ASSERT_NE(pool_allocator, nullptr);
+
+    pool_allocator->SetC2Allocator(
+        std::make_shared<MfxC2BufferQueueBlockPool>(MfxFakeCreateC2GrallocAllocator(), 0));
+    pool_allocator->SetBufferCount(FRAME_COUNT);
+
+    mfxFrameAllocRequest request {};
+    request.Type = MFX_MEMTYPE_VIDEO_MEMORY_DECODER_TARGET;
+    request.NumFrameMin = FRAME_COUNT;
+    request.NumFrameSuggested = FRAME_COUNT;
+    InitNV12FrameInfo(WIDTH, HEIGHT, &request.Info);
+
+    mfxFrameAllocResponse response {};
+    EXPECT_EQ(allocator->AllocFrames(&request, &response), MFX_ERR_NONE);
+    EXPECT_GE(response.NumFrameActual, FRAME_COUNT);
+    EXPECT_EQ(MfxFakeVaGrallocGetStats().va_surfaces, response.NumFrameActual);
+
+    std::set<mfxHDL> handles;
+    for (int i = 0; i < response.NumFrameActual; ++i) {
+        mfxHDL handle {};
+        EXPECT_EQ(allocator->GetFrameHDL(response.mids[i], &handle), MFX_ERR_NONE);
+        handles.insert(handle);
+
+        mfxFrameData frame_data {};
+        EXPECT_EQ(allocator->LockFrame(response.mids[i], &frame_data), MFX_ERR_NONE);
+        if (frame_data.Y) {
+            ProcessNV12Pattern(WIDTH, HEIGHT, i, frame_data.Y, frame_data.UV, frame_data.Pitch, true);
+            ProcessNV12Pattern(WIDTH, HEIGHT, i, frame_data.Y, frame_data.UV, frame_data.Pitch, false);
+        }
+        EXPECT_EQ(allocator->UnlockFrame(response.mids[i], &frame_data), MFX_ERR_NONE);
+    }
+    EXPECT_EQ(handles.size(), response.NumFrameActual);
+
+    EXPECT_EQ(allocator->FreeFrames(&response), MFX_ERR_NONE);
+
+    pool_allocator->Reset();
+    pool_allocator->SetC2Allocator(nullptr);
+    pool_allocator.reset();
+    allocator.reset();
+    EXPECT_EQ(dev.Close(), MFX_ERR_NONE);
+}
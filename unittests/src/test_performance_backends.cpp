@@ -0,0 +1,165 @@
+// Copyright (c) 2017-2021 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test_performance.h"
+
+#include "mfx_c2_defs.h"
+#include "mfx_c2_component.h"
+#include "mfx_c2_param_reflector.h"
+
+#include <dlfcn.h>
+#include <iostream>
+
+using namespace android;
+
+// Creates components with module entry point the same way the store does.
+class ModuleBackend : public PerformanceBackend
+{
+public:
+    explicit ModuleBackend(const char* module_name)
+    {
+        dlerror();
+        m_dso = std::shared_ptr<void>(dlopen(module_name, RTLD_NOW),
+            [] (void* handle) { if (handle) dlclose(handle); });
+        if (m_dso) {
+            m_createFunc = reinterpret_cast<CreateMfxC2ComponentFunc*>(
+                dlsym(m_dso.get(), CREATE_MFX_C2_COMPONENT_FUNC_NAME));
+        } else {
+            std::cerr << "Cannot load " << module_name << ": " << dlerror() << std::endl;
+        }
+    }
+
+    c2_status_t CreateComponent(const std::string& codec_name,
+        std::shared_ptr<C2Component>* component) override
+    {
+        if (!m_createFunc) return C2_NOT_FOUND;
+
+        c2_status_t res = C2_OK;
+        MfxC2Component::CreateConfig config;
+        MfxC2Component* mfx_component = (*m_createFunc)(GetComponentName(codec_name).c_str(),
+            config, std::make_shared<MfxC2ParamReflector>(), &res);
+        if (C2_OK == res) {
+            // component keeps the module loaded
+            auto component_deleter = [dso = m_dso] (MfxC2Component* p) { delete p; };
+            *component = std::shared_ptr<MfxC2Component>(mfx_component, component_deleter);
+        }
+        return res;
+    }
+
+protected:
+    virtual std::string GetComponentName(const std::string& codec_name) const = 0;
+
+private:
+    std::shared_ptr<void> m_dso;
+    CreateMfxC2ComponentFunc* m_createFunc { nullptr };
+};
+
+// Intel C2 components on real hardware.
+class HwBackend : public ModuleBackend
+{
+public:
+    explicit HwBackend(const char* module_name = "libmfx_c2_components_hw.so")
+        : ModuleBackend(module_name) {}
+
+    const char* GetName() const override { return "hw"; }
+
+    c2_status_t Configure(const std::shared_ptr<C2Component>& component,
+        bool encoder, uint32_t width, uint32_t height) override
+    {
+        if (!encoder) return C2_OK; // decoder takes resolution from bitstream
+
+        C2StreamPictureSizeInfo::input picture_size(0/*stream*/, width, height);
+
+        std::vector<std::unique_ptr<C2SettingResult>> failures;
+        return component->intf()->config_vb({ &picture_size }, C2_MAY_BLOCK, &failures);
+    }
+
+protected:
+    std::string GetComponentName(const std::string& codec_name) const override
+    {
+        return codec_name;
+    }
+};
+
+// Intel C2 components on CPU fake of MediaSDK runtime (mock/mfx_runtime):
+// the real components pipeline with hardware tasks replaced by configured delays.
+class FakeBackend : public HwBackend
+{
+public:
+    FakeBackend() : HwBackend("libmfx_c2_components_fake.so") {}
+
+    const char* GetName() const override { return "fake"; }
+};
+
+// Mock components copying frames as is, they stand for every encoder and decoder.
+// Measures overhead of C2 buffers and components threading without hardware.
+// Mock encoder takes frame size from input buffers, mock decoder gets it configured.
+class MockBackend : public ModuleBackend
+{
+public:
+    MockBackend() : ModuleBackend("libmfx_mock_c2_components.so") {}
+
+    const char* GetName() const override { return "mock"; }
+
+    c2_status_t Configure(const std::shared_ptr<C2Component>& component,
+        bool encoder, uint32_t width, uint32_t height) override
+    {
+        if (encoder) return C2_OK;
+
+        C2StreamPictureSizeInfo::output picture_size(0/*stream*/, width, height);
+
+        std::vector<std::unique_ptr<C2SettingResult>> failures;
+        return component->intf()->config_vb({ &picture_size }, C2_MAY_BLOCK, &failures);
+    }
+
+    void PrepareWork(C2Work* work) const override
+    {
+        // mock expects output items be allocated in buffers list and set to nulls
+        work->worklets.front()->output.buffers.push_back(nullptr);
+    }
+
+protected:
+    std::string GetComponentName(const std::string& codec_name) const override
+    {
+        const std::string encoder_suffix = ".encoder";
+        bool encoder = codec_name.size() > encoder_suffix.size() &&
+            codec_name.compare(codec_name.size() - encoder_suffix.size(),
+                encoder_suffix.size(), encoder_suffix) == 0;
+        return encoder ? "c2.intel.mock.encoder" : "c2.intel.mock.decoder";
+    }
+};
+
+std::unique_ptr<PerformanceBackend> CreatePerformanceBackend(const std::string& name)
+{
+    std::unique_ptr<PerformanceBackend> backend;
+    if (name == "hw") {
+        backend = std::make_unique<HwBackend>();
+    } else if (name == "fake") {
+        backend = std::make_unique<FakeBackend>();
+    } else if (name == "mock") {
+        backend = std::make_unique<MockBackend>();
+    }
+    return backend;
+}
+
+std::vector<std::string> GetPerformanceBackendNames()
+{
+    return { "hw", "fake", "mock" };
+}